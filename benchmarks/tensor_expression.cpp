@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2019-2020 Mohammad Ashar Khan
+// All rights reserved.
+//
+// This file is part of Boost.uBLAS. It is made available under the
+// Boost Software License, Version 1.0.
+// (Consult LICENSE or http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/program_options.hpp>
+#include "tensor_expression.hpp"
+#include <complex>
+#include <string>
+
+namespace po = boost::program_options;
+namespace ublas = boost::numeric::ublas;
+namespace bm = boost::numeric::ublas::benchmark;
+
+template <typename T>
+void benchmark(std::string const &type)
+{
+  auto const sizes = std::vector<long>({16, 32, 64, 128, 256, 512, 1024, 2048});
+  bm::tensor_expression<T, 0> e("eval(tensor<" + type + "> expression)");
+  bm::tensor_expression<T, 1> s("eval(tensor<" + type + "> expression), simplified");
+  bm::tensor_expression<T, 2> o("eval(tensor<" + type + "> expression), optimized");
+  std::cout << "# operations per element : " << e.operations() << '\n';
+  e.run(sizes);
+  std::cout << "# operations per element : " << s.operations() << '\n';
+  s.run(sizes);
+  std::cout << "# operations per element : " << o.operations() << '\n';
+  o.run(sizes);
+}
+
+int main(int argc, char **argv)
+{
+  po::variables_map vm;
+  try
+  {
+    po::options_description desc("Tensor expression optimization\n"
+                                 "Allowed options");
+    desc.add_options()("help,h", "produce help message");
+    desc.add_options()("type,t", po::value<std::string>(), "select value-type (float, double, fcomplex, dcomplex)");
+
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help"))
+    {
+      std::cout << desc << std::endl;
+      return 0;
+    }
+  }
+  catch(std::exception &e)
+  {
+    std::cerr << "error: " << e.what() << std::endl;
+    return 1;
+  }
+  std::string type = vm.count("type") ? vm["type"].as<std::string>() : "float";
+  if (type == "float")
+    benchmark<float>("float");
+  else if (type == "double")
+    benchmark<double>("double");
+  else if (type == "fcomplex")
+    benchmark<std::complex<float>>("std::complex<float>");
+  else if (type == "dcomplex")
+    benchmark<std::complex<double>>("std::complex<double>");
+  else
+    std::cerr << "unsupported value-type \"" << vm["type"].as<std::string>() << '\"' << std::endl;
+}
@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2019-2020 Mohammad Ashar Khan
+// All rights reserved.
+//
+// This file is part of Boost.uBLAS. It is made available under the
+// Boost Software License, Version 1.0.
+// (Consult LICENSE or http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/numeric/ublas/tensor.hpp>
+#include "benchmark.hpp"
+#include <cstdlib>
+
+// (a-b)*(a-b) + (a-b)*c which the algebraic simplification rewrites into
+// (a-b)*((a-b)+c), whose shared sub-expression (a-b) is then computed once
+// per element. The operators of tensor expressions are declared in the
+// global namespace.
+template <typename T>
+auto shared_subexpression(T &a, T &b, T &c)
+{
+  return (a - b) * (a - b) + (a - b) * c;
+}
+
+namespace boost { namespace numeric { namespace ublas { namespace benchmark {
+
+template <typename T>
+void init(tensor<T> &t, unsigned long size, int max_value)
+{
+  t = tensor<T>(shape{size, size});
+  for (unsigned long i = 0; i < t.size(); ++i)
+    t[i] = std::rand() % max_value + 1;
+}
+
+// evaluates shared_subexpression without the expression optimization
+// (level 0), only with the algebraic simplification (level 1) or with the
+// full expression optimization (level 2)
+template <typename T, int level>
+class tensor_expression : public benchmark
+{
+public:
+  tensor_expression(std::string const &name) : benchmark(name) {}
+  virtual void setup(long l)
+  {
+    init(a, l, 200);
+    init(b, l, 200);
+    init(c, l, 200);
+    r = tensor<T>(a.extents());
+  }
+  virtual void operation(long)
+  {
+    namespace transforms = detail::transforms;
+    auto expr = shared_subexpression(a, b, c);
+    if (level == 2)
+      expr.eval_optimized(r.data(), r.extents(), r.strides());
+    else if (level == 1)
+      transforms::simplify_expression{}(transforms::fold_scalars(expr))
+          .eval_elements(r.data(), r.extents(), r.strides());
+    else
+      expr.eval_elements(r.data(), r.extents(), r.strides());
+  }
+  // number of arithmetic operations per element at the given level
+  std::size_t operations()
+  {
+    namespace transforms = detail::transforms;
+    auto expr = shared_subexpression(a, b, c);
+    auto simplified = transforms::simplify_expression{}(transforms::fold_scalars(expr));
+    std::size_t n = 0;
+    if (level == 2)
+      transforms::visit_plan<first_order, false, true>(
+          simplified, [&n](auto const &plan) {
+            n = std::decay_t<decltype(plan)>::operations;
+          });
+    else if (level == 1)
+      n = transforms::count_operations<decltype(simplified)>();
+    else
+      n = transforms::count_operations<decltype(expr)>();
+    return n;
+  }
+private:
+  tensor<T> a, b, c, r;
+};
+
+}}}}
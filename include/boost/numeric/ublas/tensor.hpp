@@ -15,11 +15,17 @@
 #ifndef BOOST_NUMERIC_UBLAS_TENSOR_HPP
 #define BOOST_NUMERIC_UBLAS_TENSOR_HPP
 
+#include "tensor/allocator.hpp"
 #include "tensor/functions.hpp"
 #include "tensor/extents.hpp"
 #include "tensor/strides.hpp"
+#include "tensor/static_extents.hpp"
+#include "tensor/static_strides.hpp"
 #include "tensor/ostream.hpp"
+#include "tensor/binary_io.hpp"
+#include "tensor/batched.hpp"
 #include "tensor/tensor.hpp"
+#include "tensor/tensor_view.hpp"
 #include "tensor/expression_operator.hpp"
 #include "tensor/ublas_type_traits.hpp"
 
@@ -14,10 +14,13 @@
 #define _BOOST_UBLAS_TENSOR_ALGORITHMS_HPP
 
 
+#include <cstddef>
 #include <stdexcept>
 #include <complex>
 #include <functional>
 
+#include "transpose.hpp"
+
 namespace boost
 {
 namespace numeric
@@ -74,6 +77,82 @@ void copy ( const SizeType p, SizeType const*const n,
 }
 
 
+namespace detail
+{
+namespace recursive
+{
+
+/** @brief Assigns a value to all elements of a tensor up to mode r, see ublas::fill */
+template <class	PointerOut, class SizeType, class ValueType>
+void fill ( const SizeType r, SizeType const*const n,
+            PointerOut c, SizeType const*const wc,
+            ValueType const& v )
+{
+    if ( r > 0 )
+        for ( auto d = 0u; d < n[r]; c += wc[r], ++d )
+            fill ( r-1, n, c, wc, v );
+    else
+        for ( auto d = 0u; d < n[0]; c += wc[0], ++d )
+            *c = v;
+}
+
+} // namespace recursive
+
+/** @brief Copies a tensor to another tensor whose strides may be negative
+ *
+ * Implements C[i1,i2,...,ip] = A[i1,i2,...,ip] where a negative stride traverses a mode backwards
+ *
+ * @param[in]  r highest mode, i.e. the rank minus one
+ * @param[in]  n pointer to the extents of input or output tensor of length r+1
+ * @param[out] c pointer to the output tensor
+ * @param[in] wc pointer to the signed or unsigned strides of output tensor c
+ * @param[in]  a pointer to the input tensor
+ * @param[in] wa pointer to the signed or unsigned strides of input tensor a
+*/
+template <class PointerOut, class PointerIn, class StrideC, class StrideA>
+void copy_strided ( std::size_t const r, std::size_t const*const n,
+                    PointerOut c, StrideC const*const wc,
+                    PointerIn a,  StrideA const*const wa )
+{
+    auto const vc = std::ptrdiff_t ( wc[r] ), va = std::ptrdiff_t ( wa[r] );
+    for ( auto d = 0ul; d < n[r]; c += vc, a += va, ++d )
+        if ( r == 0 )
+            *c = *a;
+        else
+            copy_strided ( r-1, n, c, wc, a, wa );
+}
+
+} // namespace detail
+
+
+/** @brief Assigns a value to all elements of a tensor
+ *
+ * Implements C[i1,i2,...,ip] = v
+ *
+ * @param[in]  p rank of the output tensor
+ * @param[in]  n pointer to the extents of the output tensor of length p
+ * @param[out] c pointer to the output tensor
+ * @param[in] wc pointer to the strides of output tensor c
+ * @param[in]  v value that is assigned
+*/
+template <class	PointerOut, class SizeType, class ValueType>
+void fill ( const SizeType p, SizeType const*const n,
+            PointerOut c, SizeType const*const wc,
+            ValueType const& v )
+{
+    static_assert ( std::is_pointer<PointerOut>::value,
+                    "Static error in boost::numeric::ublas::fill: Argument type for pointer is not a pointer type." );
+    if ( p == 0 )
+        return;
+
+    if ( c == nullptr || wc == nullptr || n == nullptr )
+        throw std::length_error ( "Error in boost::numeric::ublas::fill: Pointers shall not be null pointers." );
+
+
+    detail::recursive::fill ( p-1, n, c, wc, v );
+}
+
+
 
 /** @brief Copies a tensor to another tensor with different layouts applying a unary operation
  *
@@ -226,6 +305,7 @@ ValueType accumulate ( SizeType const p, SizeType const*const n,
  * Implements C[tau[i1],tau[i2],...,tau[ip]] = A[i1,i2,...,ip]
  *
  * @note is used in function trans
+ * @note copies the elements in tiles that fit into the L1 cache, see detail::blocked::transpose
  *
  * @param[in]  p rank of input and output tensor
  * @param[in] na pointer to the extents of the input tensor a of length p
@@ -261,18 +341,7 @@ void trans ( SizeType const p,  SizeType const*const na, SizeType const*const pi
         throw std::length_error ( "Error in boost::numeric::ublas::trans: Pointers shall not be null pointers." );
 
 
-    std::function<void ( SizeType r, PointerOut c, PointerIn a ) > lambda;
-
-    lambda = [&lambda, na, wc, wa, pi] ( SizeType r, PointerOut c, PointerIn a ) {
-        if ( r > 0 )
-            for ( auto d = 0u; d < na[r]; c += wc[pi[r]-1], a += wa[r], ++d )
-                lambda ( r-1, c, a );
-        else
-            for ( auto d = 0u; d < na[0]; c += wc[pi[0]-1], a += wa[0], ++d )
-                *c = *a;
-    };
-
-    lambda ( p-1, c, a );
+    detail::blocked::transpose ( p, na, pi, c, wc, a, wa, detail::blocked::copy_element{} );
 }
 
 
@@ -314,18 +383,8 @@ void trans ( SizeType const p,
         throw std::length_error ( "Error in boost::numeric::ublas::trans: Pointers shall not be null pointers." );
 
 
-    std::function<void ( SizeType r, std::complex<ValueType>* c, std::complex<ValueType>* a ) > lambda;
-
-    lambda = [&lambda, na, wc, wa, pi] ( SizeType r, std::complex<ValueType>* c, std::complex<ValueType>* a ) {
-        if ( r > 0 )
-            for ( auto d = 0u; d < na[r]; c += wc[pi[r]-1], a += wa[r], ++d )
-                lambda ( r-1, c, a );
-        else
-            for ( auto d = 0u; d < na[0]; c += wc[pi[0]-1], a += wa[0], ++d )
-                *c = std::conj ( *a );
-    };
-
-    lambda ( p-1, c, a );
+    detail::blocked::transpose ( p, na, pi, c, wc, a, wa,
+                                 [] ( std::complex<ValueType> const& x ) { return std::conj ( x ); } );
 
 }
 
@@ -0,0 +1,369 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+/// \file allocator.hpp Definition of the aligned allocator and the tensor arena
+
+#ifndef BOOST_UBLAS_TENSOR_ALLOCATOR_HPP
+#define BOOST_UBLAS_TENSOR_ALLOCATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/** @brief Alignment in bytes of memory blocks that are cached by a tensor_arena
+ * and the default alignment of the aligned_allocator */
+#ifndef BOOST_UBLAS_TENSOR_ALIGNMENT
+#define BOOST_UBLAS_TENSOR_ALIGNMENT 64
+#endif
+
+namespace boost::numeric::ublas {
+
+class tensor_arena;
+
+namespace detail {
+
+// blocks are rounded up to 64 bytes or to one of four size classes between
+// two powers of two so that at most a quarter of a block is unused.
+inline constexpr std::size_t arena_min_bits = 6u;
+inline constexpr std::size_t arena_max_bits = 30u;
+inline constexpr std::size_t arena_classes =
+    1u + 4u * (arena_max_bits - arena_min_bits);
+
+/** @brief Returns the size class of a block with n bytes or arena_classes if
+ * blocks with n bytes are not cached */
+inline std::size_t arena_class(std::size_t n) noexcept {
+  if (n <= (std::size_t(1) << arena_min_bits)) return 0u;
+  if (n > (std::size_t(1) << arena_max_bits)) return arena_classes;
+  auto k = arena_min_bits + 1u;
+  while ((std::size_t(1) << k) < n) ++k;
+  auto const step = std::size_t(1) << (k - 3u);
+  auto const j = (n - (std::size_t(1) << (k - 1u)) + step - 1u) / step;
+  return 1u + 4u * (k - arena_min_bits - 1u) + (j - 1u);
+}
+
+/** @brief Returns the number of bytes of a block with size class c */
+inline std::size_t arena_class_size(std::size_t c) noexcept {
+  if (c == 0u) return std::size_t(1) << arena_min_bits;
+  auto const k = arena_min_bits + 1u + (c - 1u) / 4u;
+  auto const j = 1u + (c - 1u) % 4u;
+  return (std::size_t(1) << (k - 1u)) + j * (std::size_t(1) << (k - 3u));
+}
+
+inline tensor_arena *&current_arena() noexcept {
+  static thread_local tensor_arena *arena = nullptr;
+  return arena;
+}
+
+} // namespace detail
+
+/** @brief A cache of aligned memory blocks sorted by size classes
+ *
+ * Blocks that are released by an aligned_allocator while the arena is the
+ * current arena of the thread are kept in the arena and handed out again for
+ * requests of the same size class. Iterative computations that create and
+ * destroy temporaries of the same size therefore allocate from the heap only
+ * in the first iteration.
+ *
+ * Temporaries that a tensor expression creates internally are always
+ * allocated this way, i.e. the intermediate and materialized results of
+ * contractions in Einstein notation and the temporary of an aliased
+ * assignment. Tensors that are returned to the caller, including the results
+ * of prod() and trans(), keep the storage of their operands and use the arena
+ * only if that storage uses an aligned_allocator.
+ *
+ * @code
+ * using array_type = std::vector<float, aligned_allocator<float>>;
+ * using tensor_type = tensor<float, first_order, array_type>;
+ * auto arena = tensor_arena{};
+ * for(auto k = 0u; k < iterations; ++k){
+ *   auto scope = arena_scope(arena);
+ *   c = prod(a, v, 1) + b;
+ * }
+ * @endcode
+ *
+ * @note An arena is used by one thread at a time. Blocks are interchangeable
+ * between arenas and the heap so that a temporary may outlive the scope in
+ * which it was allocated.
+ */
+class tensor_arena {
+public:
+  static constexpr std::size_t alignment = BOOST_UBLAS_TENSOR_ALIGNMENT;
+
+  static_assert((alignment & (alignment - 1u)) == 0u,
+                "Static error in boost::numeric::ublas::tensor_arena: "
+                "BOOST_UBLAS_TENSOR_ALIGNMENT must be a power of two.");
+
+  tensor_arena() = default;
+  tensor_arena(tensor_arena const &) = delete;
+  tensor_arena &operator=(tensor_arena const &) = delete;
+
+  ~tensor_arena() { release(); }
+
+  /** @brief Returns a block of at least n bytes aligned to alignment bytes */
+  void *allocate(std::size_t n) {
+    auto const c = detail::arena_class(n);
+    if (c < detail::arena_classes && !free_[c].empty()) {
+      auto *p = free_[c].back();
+      free_[c].pop_back();
+      cached_ -= detail::arena_class_size(c);
+      return p;
+    }
+    return heap_allocate(n);
+  }
+
+  /** @brief Caches a block that has been returned by allocate for n bytes */
+  void deallocate(void *p, std::size_t n) noexcept {
+    auto const c = detail::arena_class(n);
+    if (c < detail::arena_classes) {
+      try {
+        free_[c].push_back(p);
+        cached_ += detail::arena_class_size(c);
+        return;
+      } catch (std::bad_alloc const &) {
+      }
+    }
+    heap_deallocate(p);
+  }
+
+  /** @brief Returns all cached blocks to the heap */
+  void release() noexcept {
+    for (auto &blocks : free_) {
+      for (auto *p : blocks) heap_deallocate(p);
+      blocks.clear();
+    }
+    cached_ = 0u;
+  }
+
+  /** @brief Returns the number of bytes of all cached blocks */
+  std::size_t cached() const noexcept { return cached_; }
+
+  /** @brief Returns the arena of the innermost arena_scope of this thread or
+   * nullptr */
+  static tensor_arena *current() noexcept { return detail::current_arena(); }
+
+  /** @brief Allocates a block of at least n bytes without using an arena
+   *
+   * Blocks are rounded up to their size class so that every block can be
+   * cached by an arena.
+   */
+  static void *heap_allocate(std::size_t n) {
+    auto const c = detail::arena_class(n);
+    return ::operator new(c < detail::arena_classes ? detail::arena_class_size(c) : n,
+                          std::align_val_t(alignment));
+  }
+
+  /** @brief Frees a block without using an arena */
+  static void heap_deallocate(void *p) noexcept {
+    ::operator delete(p, std::align_val_t(alignment));
+  }
+
+private:
+  std::array<std::vector<void *>, detail::arena_classes> free_;
+  std::size_t cached_ = 0u;
+};
+
+/** @brief Makes an arena the current arena of this thread during its lifetime
+ *
+ * Scopes can be nested. The previous arena of the thread is restored when the
+ * scope is destroyed. The arena must outlive the scope.
+ */
+class arena_scope {
+public:
+  explicit arena_scope(tensor_arena &arena) noexcept
+      : previous_(detail::current_arena()) {
+    detail::current_arena() = &arena;
+  }
+
+  arena_scope(arena_scope const &) = delete;
+  arena_scope &operator=(arena_scope const &) = delete;
+
+  ~arena_scope() { detail::current_arena() = previous_; }
+
+private:
+  tensor_arena *previous_;
+};
+
+/** @brief An allocator for aligned memory blocks
+ *
+ * Blocks are taken from and returned to the current tensor_arena of the
+ * thread if there is one and from the heap otherwise. Blocks with a larger
+ * alignment than tensor_arena::alignment are never cached.
+ *
+ * @code auto a = tensor<float,first_order,std::vector<float,aligned_allocator<float>>>{3,4}; @endcode
+ *
+ * @tparam T type of the allocated objects
+ * @tparam Alignment alignment of the allocated blocks in bytes
+ */
+template <class T, std::size_t Alignment = BOOST_UBLAS_TENSOR_ALIGNMENT>
+class aligned_allocator {
+  static_assert((Alignment & (Alignment - 1u)) == 0u && Alignment >= alignof(T),
+                "Static error in boost::numeric::ublas::aligned_allocator: "
+                "alignment must be a power of two and at least alignof(T).");
+
+  static constexpr bool cached = Alignment <= tensor_arena::alignment;
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  static constexpr std::size_t alignment = Alignment;
+
+  template <class U> struct rebind {
+    using other = aligned_allocator<U, Alignment>;
+  };
+
+  aligned_allocator() noexcept = default;
+
+  template <class U>
+  aligned_allocator(aligned_allocator<U, Alignment> const &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    auto const bytes = n * sizeof(T);
+    if constexpr (cached) {
+      auto *arena = tensor_arena::current();
+      return static_cast<T *>(arena ? arena->allocate(bytes)
+                                    : tensor_arena::heap_allocate(bytes));
+    } else {
+      return static_cast<T *>(::operator new(bytes, std::align_val_t(Alignment)));
+    }
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept {
+    if constexpr (cached) {
+      if (auto *arena = tensor_arena::current())
+        arena->deallocate(p, n * sizeof(T));
+      else
+        tensor_arena::heap_deallocate(p);
+    } else {
+      ::operator delete(p, std::align_val_t(Alignment));
+    }
+  }
+};
+
+template <class T, class U, std::size_t Alignment>
+bool operator==(aligned_allocator<T, Alignment> const &,
+                aligned_allocator<U, Alignment> const &) noexcept {
+  return true;
+}
+
+template <class T, class U, std::size_t Alignment>
+bool operator!=(aligned_allocator<T, Alignment> const &,
+                aligned_allocator<U, Alignment> const &) noexcept {
+  return false;
+}
+
+
+/** @brief An allocator adaptor that default-initializes elements which are
+ * constructed without arguments
+ *
+ * Containers such as std::vector value-initialize new elements so that
+ * arithmetic types are set to zero. With this adaptor the elements of
+ * `std::vector<T,default_init_allocator<std::allocator<T>>>(n)` are
+ * default-initialized and arithmetic types are not written at all. All other
+ * constructions are forwarded to the adapted allocator.
+ *
+ * @code auto a = tensor<float,first_order,std::vector<float,default_init_allocator<aligned_allocator<float>>>>(shape{3,4}, uninitialized); @endcode
+ *
+ * @tparam A adapted allocator type
+ */
+template <class A> class default_init_allocator : public A {
+  using traits = std::allocator_traits<A>;
+
+public:
+  template <class U> struct rebind {
+    using other =
+        default_init_allocator<typename traits::template rebind_alloc<U>>;
+  };
+
+  using A::A;
+
+  default_init_allocator() = default;
+
+  template <class B>
+  default_init_allocator(default_init_allocator<B> const &other) noexcept
+      : A(static_cast<B const &>(other)) {}
+
+  template <class U>
+  void construct(U *p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+    ::new (static_cast<void *>(p)) U;
+  }
+
+  template <class U, class... Args> void construct(U *p, Args &&... args) {
+    traits::construct(static_cast<A &>(*this), p, std::forward<Args>(args)...);
+  }
+};
+
+template <class A, class B>
+bool operator==(default_init_allocator<A> const &a,
+                default_init_allocator<B> const &b) noexcept {
+  return static_cast<A const &>(a) == static_cast<B const &>(b);
+}
+
+template <class A, class B>
+bool operator!=(default_init_allocator<A> const &a,
+                default_init_allocator<B> const &b) noexcept {
+  return !(a == b);
+}
+
+/** @brief Tag type of tensor constructors that do not initialize the elements
+ * with a value
+ *
+ * The elements are constructed by the allocator of the storage array without
+ * arguments. They are left uninitialized if the allocator is a
+ * default_init_allocator and the element type is trivially default
+ * constructible. Storage with std::allocator, the default storage of tensors,
+ * zero-initializes them. Results of prod, trans, outer_prod and eval are
+ * stored with a default_init_allocator, see tensor::tensor_temporary_type.
+ */
+struct uninitialized_t {
+  explicit uninitialized_t() = default;
+};
+
+/** @brief Selects tensor constructors that do not initialize the elements */
+inline constexpr uninitialized_t uninitialized{};
+
+namespace detail {
+
+/** @brief Array type of results that are overwritten by a kernel
+ *
+ * std::vector with an allocator A becomes std::vector with
+ * default_init_allocator<A> so that results are not zero-filled before the
+ * kernel writes them. Other array types are not changed.
+ */
+template <class A> struct uninitialized_array { using type = A; };
+
+template <class T, class A> struct uninitialized_array<std::vector<T, A>> {
+  using type = std::vector<T, default_init_allocator<A>>;
+};
+
+template <class T, class A>
+struct uninitialized_array<std::vector<T, default_init_allocator<A>>> {
+  using type = std::vector<T, default_init_allocator<A>>;
+};
+
+template <class A>
+using uninitialized_array_t = typename uninitialized_array<A>::type;
+
+} // namespace detail
+
+} // namespace boost::numeric::ublas
+
+#endif
@@ -0,0 +1,300 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+/// \file batched.hpp Definition of batched tensor-times-tensor products
+
+#ifndef BOOST_UBLAS_TENSOR_BATCHED_HPP
+#define BOOST_UBLAS_TENSOR_BATCHED_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "extents.hpp"
+#include "multiplication.hpp"
+#include "parallel.hpp"
+#include "tensor.hpp"
+
+namespace boost::numeric::ublas {
+
+/** @brief Validated q-mode tensor-times-tensor product for operands with
+ * fixed extents
+ *
+ * The extents and permutation tuples are checked and the extents of the
+ * result are computed once on construction. The plan is then applied to any
+ * number of operand pairs with these extents, see batched_prod.
+ *
+ * @code
+ * auto plan = contraction_plan<float>(shape{4,3,2}, shape{3,5}, {2}, {1});
+ * auto c = plan.make_result();
+ * plan(a, b, c);
+ * @endcode
+ *
+ * @tparam T element type of the operands
+ * @tparam F storage layout of the operands
+ */
+template <class T, class F = first_order> class contraction_plan {
+public:
+  using value_type = T;
+  using layout_type = F;
+  using size_type = std::size_t;
+  using result_type = tensor<T, F>;
+
+  /** @brief Plans C[i1,...,ir,j1,...,js] = sum( A[i1,...,ir+q] *
+   * B[j1,...,js+q] )
+   *
+   * @param na extents of the left-hand side tensors A with order r+q
+   * @param nb extents of the right-hand side tensors B with order s+q
+   * @param phia one-based contraction modes of A with length q
+   * @param phib one-based contraction modes of B with length q
+   *
+   * @note throws std::runtime_error if the arguments are not consistent as
+   * ublas::prod does.
+   */
+  contraction_plan(shape const &na, shape const &nb,
+                   std::vector<std::size_t> const &phia,
+                   std::vector<std::size_t> const &phib)
+      : na_(na), nb_(nb) {
+    auto const pa = na.size();
+    auto const pb = nb.size();
+    auto const q = phia.size();
+
+    if (pa == 0u || pb == 0u)
+      throw std::runtime_error("Error in boost::numeric::ublas::contraction_plan: "
+                               "order of the tensors must be greater than 0.");
+    if (q != phib.size())
+      throw std::runtime_error("Error in boost::numeric::ublas::contraction_plan: "
+                               "permutation tuples must have the same length.");
+    if (pa < q || pb < q)
+      throw std::runtime_error("Error in boost::numeric::ublas::contraction_plan: "
+                               "number of contraction dimensions cannot be "
+                               "greater than the order of the tensors.");
+
+    auto const distinct = [q](std::vector<std::size_t> phi, std::size_t p) {
+      std::sort(phi.begin(), phi.end());
+      return std::adjacent_find(phi.begin(), phi.end()) == phi.end() &&
+             (q == 0u || (phi.front() >= 1u && phi.back() <= p));
+    };
+    if (!distinct(phia, pa) || !distinct(phib, pb))
+      throw std::runtime_error("Error in boost::numeric::ublas::contraction_plan: "
+                               "contraction modes must be distinct modes of "
+                               "the tensors.");
+
+    for (auto i = 0u; i < q; ++i)
+      if (na[phia[i] - 1] != nb[phib[i] - 1])
+        throw std::runtime_error("Error in boost::numeric::ublas::contraction_plan: "
+                                 "permutations of the extents are not correct.");
+
+    // free modes first followed by the contraction modes as in ublas::prod
+    phia_.resize(pa);
+    phib_.resize(pb);
+    std::iota(phia_.begin(), phia_.end(), 1u);
+    std::iota(phib_.begin(), phib_.end(), 1u);
+    for (auto i = 0u; i < q; ++i)
+      *std::remove(phia_.begin(), phia_.end(), phia[i]) = phia[i];
+    for (auto i = 0u; i < q; ++i)
+      *std::remove(phib_.begin(), phib_.end(), phib[i]) = phib[i];
+
+    r_ = pa - q;
+    s_ = pb - q;
+    q_ = q;
+
+    auto nc = typename shape::base_type(std::max(r_ + s_, size_type(2)), 1u);
+    for (auto i = 0u; i < r_; ++i) nc[i] = na[phia_[i] - 1];
+    for (auto i = 0u; i < s_; ++i) nc[r_ + i] = nb[phib_[i] - 1];
+    nc_ = shape(std::move(nc));
+
+    work_ = nc_.product();
+    for (auto i = 0u; i < q_; ++i) work_ *= na[phia_[r_ + i] - 1];
+
+    // fused modes, copy strides and gemm dimensions of operands with
+    // contiguous storage
+    using strides_type = basic_strides<size_type, F>;
+    auto const wa = strides_type(na_), wb = strides_type(nb_),
+               wc = strides_type(nc_);
+    wa_.assign(wa.begin(), wa.end());
+    wb_.assign(wb.begin(), wb.end());
+    wc_.assign(wc.begin(), wc.end());
+    layout_ = detail::blocked::ttt_layout(
+        r_, s_, q_, phia_.data(), phib_.data(), nc_.data(), wc_.data(),
+        na_.data(), wa_.data(), wb_.data());
+  }
+
+  /** @brief Computes C = A*B, or C += A*B if accumulate is true
+   *
+   * @param a tensor or tensor_view with the extents of the plan
+   * @param b tensor or tensor_view with the extents of the plan
+   * @param c tensor or tensor_view with the extents of the result
+   *
+   * @note C is always overwritten if the plan has no contraction modes
+   */
+  template <class TA, class TB, class TC>
+  void operator()(TA const &a, TB const &b, TC &c,
+                  bool accumulate = false) const {
+    check(a, b, c);
+    run(a, b, c, accumulate);
+  }
+
+  /** @brief Returns an uninitialized tensor with the extents of the result */
+  result_type make_result() const { return result_type(nc_, uninitialized); }
+
+  shape const &lhs_extents() const noexcept { return na_; }
+  shape const &rhs_extents() const noexcept { return nb_; }
+  shape const &extents() const noexcept { return nc_; }
+
+  /** @brief Returns the number of multiply-adds of one product */
+  std::size_t work() const noexcept { return work_; }
+
+  /** @brief Throws std::runtime_error if the extents of the operands do not
+   * match the plan */
+  template <class TA, class TB, class TC>
+  void check(TA const &a, TB const &b, TC const &c) const {
+    static_assert(std::is_same_v<std::remove_const_t<typename TA::value_type>, T> &&
+                      std::is_same_v<std::remove_const_t<typename TB::value_type>, T> &&
+                      std::is_same_v<typename TC::value_type, T>,
+                  "Static error in boost::numeric::ublas::contraction_plan: "
+                  "element types of the operands must be the same.");
+    static_assert(std::is_same_v<typename TA::layout_type, F> &&
+                      std::is_same_v<typename TB::layout_type, F> &&
+                      std::is_same_v<typename TC::layout_type, F>,
+                  "Static error in boost::numeric::ublas::contraction_plan: "
+                  "layouts of the operands must be the same.");
+    if (a.extents() != na_ || b.extents() != nb_ || c.extents() != nc_)
+      throw std::runtime_error("Error in boost::numeric::ublas::contraction_plan: "
+                               "extents of the operands do not match the plan.");
+  }
+
+  /** @brief Computes the product without checking the operands
+   *
+   * Calls the blocked gemm kernel with the precomputed layout if the operands
+   * have the strides of the plan and the product is computed by one thread.
+   * Calls ublas::ttt otherwise.
+   */
+  template <class TA, class TB, class TC>
+  void run(TA const &a, TB const &b, TC &c, bool accumulate) const {
+    if constexpr (is_tensor_view_v<TC>) {
+      // the kernel writes with unsigned strides, views that traverse a mode
+      // backwards receive a copy of the result
+      auto const &w = c.strides();
+      if (std::any_of(w.begin(), w.end(), [](auto s) { return s < 0; })) {
+        auto t = result_type(c);
+        run(a, b, t, accumulate);
+        c = t;
+        return;
+      }
+    }
+    auto const &ka = detail::kernel_operand(a);
+    auto const &kb = detail::kernel_operand(b);
+    auto const wc = typename shape::base_type(c.strides().begin(),
+                                              c.strides().end());
+    auto const planned = [](auto const &w, auto const &wp) {
+      return std::equal(w.begin(), w.end(), wp.begin(), wp.end());
+    };
+    if (layout_.valid && planned(ka.strides(), wa_) &&
+        planned(kb.strides(), wb_) && planned(wc, wc_) &&
+        detail::parallel::num_threads(
+            work_, std::numeric_limits<std::size_t>::max()) < 2u) {
+      detail::blocked::ttt(layout_, c.data(), ka.data(), na_.size(),
+                           na_.data(), wa_.data(), kb.data(), nb_.size(),
+                           nb_.data(), wb_.data(), accumulate);
+      return;
+    }
+    ttt(na_.size(), nb_.size(), q_, phia_.data(), phib_.data(), c.data(),
+        nc_.data(), wc.data(), ka.data(), na_.data(), ka.strides().data(),
+        kb.data(), nb_.data(), kb.strides().data(), accumulate);
+  }
+
+private:
+  shape na_, nb_, nc_;
+  std::vector<std::size_t> phia_, phib_;
+  std::size_t r_ = 0u, s_ = 0u, q_ = 0u;
+  std::size_t work_ = 0u;
+  typename shape::base_type wa_, wb_, wc_;
+  detail::blocked::ttt_matrix_layout<size_type> layout_;
+};
+
+/** @brief Computes C[k] = A[k]*B[k] for all operand pairs of a batch
+ *
+ * All operands are checked before the first product is computed. The
+ * products are partitioned across the threads of an OpenMP team if the batch
+ * is large enough, see ublas::set_parallel_threshold. Batches with fewer
+ * products than threads are computed one after another with the threads of
+ * each product.
+ *
+ * @code
+ * auto plan = contraction_plan<float>(a[0].extents(), b[0].extents(), {2,3}, {1,2});
+ * auto c = std::vector<tensor<float>>(a.size(), plan.make_result());
+ * batched_prod(plan, a, b, c);
+ * @endcode
+ *
+ * @param plan contraction plan of the operands
+ * @param a random access range of tensors or tensor views A[k]
+ * @param b random access range of tensors or tensor views B[k]
+ * @param c random access range of tensors or tensor views C[k] with the
+ * extents of plan.extents()
+ * @param accumulate adds the products to C[k] if true
+ *
+ * @note C[k] is always overwritten if the plan has no contraction modes as
+ * in ublas::ttt
+ */
+template <class T, class F, class RangeA, class RangeB, class RangeC>
+void batched_prod(contraction_plan<T, F> const &plan, RangeA const &a,
+                  RangeB const &b, RangeC &c, bool accumulate = false) {
+  auto const n = std::size(a);
+  if (std::size(b) != n || std::size(c) != n)
+    throw std::length_error("Error in boost::numeric::ublas::batched_prod: "
+                            "batches must have the same number of operands.");
+
+  auto const ia = std::begin(a);
+  auto const ib = std::begin(b);
+  auto const ic = std::begin(c);
+  for (auto k = std::size_t(0); k < n; ++k)
+    plan.check(ia[k], ib[k], ic[k]);
+
+  auto const work = plan.work() * n;
+  auto const nt = detail::parallel::num_threads(
+      work, std::numeric_limits<std::size_t>::max());
+  if (n < nt) {
+    for (auto k = std::size_t(0); k < n; ++k)
+      plan.run(ia[k], ib[k], ic[k], accumulate);
+    return;
+  }
+
+  detail::parallel::for_each_range(
+      work, n, [&](std::size_t first, std::size_t last) {
+        for (auto k = first; k < last; ++k)
+          plan.run(ia[k], ib[k], ic[k], accumulate);
+      });
+}
+
+/** @brief Computes C[k] = A[k]*B[k] for all operand pairs of a batch
+ *
+ * @returns tensors C[k] with the extents of plan.extents()
+ */
+template <class T, class F, class RangeA, class RangeB>
+std::vector<tensor<T, F>> batched_prod(contraction_plan<T, F> const &plan,
+                                       RangeA const &a, RangeB const &b) {
+  auto c = std::vector<tensor<T, F>>{};
+  c.reserve(std::size(a));
+  for (auto k = std::size_t(0); k < std::size(a); ++k)
+    c.push_back(plan.make_result());
+  batched_prod(plan, a, b, c);
+  return c;
+}
+
+} // namespace boost::numeric::ublas
+
+#endif
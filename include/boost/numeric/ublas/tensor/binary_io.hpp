@@ -0,0 +1,293 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+/// \file binary_io.hpp Definition of the binary reader and writer of tensors
+
+#ifndef BOOST_UBLAS_TENSOR_BINARY_IO_HPP
+#define BOOST_UBLAS_TENSOR_BINARY_IO_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "allocator.hpp"
+#include "file_format.hpp"
+#include "tensor.hpp"
+
+/** @brief Number of bytes that are read or written at once and added to the
+ * checksum while they are still in the cache */
+#ifndef BOOST_UBLAS_TENSOR_IO_CHUNK_SIZE
+#define BOOST_UBLAS_TENSOR_IO_CHUNK_SIZE (std::size_t(1) << 22)
+#endif
+
+namespace boost::numeric::ublas {
+
+/** @brief Writes a tensor file element by element in chunks
+ *
+ * The header is written on construction, the elements are written in
+ * storage order with any number of calls of write. close must be called
+ * after the last element so that the checksum is written into the header.
+ *
+ * @code
+ * auto out = std::ofstream("state.tensor", std::ios::binary);
+ * auto w = tensor_writer<float>(out, shape{1u<<15, 1u<<15, 8}, true);
+ * while(w.remaining() > 0) w.write(chunk.data(), next_chunk(chunk));
+ * w.close();
+ * @endcode
+ *
+ * @note checksums require an output stream that supports seekp.
+ *
+ * @tparam T trivially copyable element type
+ * @tparam F storage layout of the elements
+ */
+template <class T, class F = first_order> class tensor_writer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Static error in boost::numeric::ublas::tensor_writer: element "
+                "type must be trivially copyable.");
+
+public:
+  /** @brief Writes the header of a tensor with extents e
+   *
+   * @param out binary output stream
+   * @param e extents of the tensor
+   * @param checksum if true the file_checksum of the elements is stored
+   */
+  tensor_writer(std::ostream &out, shape const &e, bool checksum = false)
+      : out_(out), header_(file_header::make<T, F>(e)),
+        remaining_(e.product()), checksum_(checksum) {
+    if (checksum_) {
+      header_.flags |= file_header::has_checksum;
+      start_ = out_.tellp();
+      if (start_ == std::streampos(-1))
+        throw std::invalid_argument(
+            "Error in boost::numeric::ublas::tensor_writer: checksums require "
+            "a seekable stream.");
+    }
+    auto const bytes = header_.encode();
+    put(bytes.data(), bytes.size());
+  }
+
+  tensor_writer(tensor_writer const &) = delete;
+  tensor_writer &operator=(tensor_writer const &) = delete;
+
+  /** @brief Writes the next n elements */
+  void write(T const *p, std::size_t n) {
+    if (n > remaining_)
+      throw std::length_error("Error in boost::numeric::ublas::tensor_writer: "
+                              "more elements than the tensor holds.");
+    auto const *bytes = reinterpret_cast<char const *>(p);
+    auto size = n * sizeof(T);
+    for (; size > 0u;) {
+      auto const m = std::min(size, std::size_t(BOOST_UBLAS_TENSOR_IO_CHUNK_SIZE));
+      if (checksum_) sum_.update(bytes, m);
+      put(bytes, m);
+      bytes += m, size -= m;
+    }
+    remaining_ -= n;
+  }
+
+  /** @brief Writes the checksum after the last element */
+  void close() {
+    if (remaining_ > 0u)
+      throw std::length_error("Error in boost::numeric::ublas::tensor_writer: "
+                              "tensor is incomplete.");
+    if (checksum_) {
+      auto const end = out_.tellp();
+      auto const value = sum_.value();
+      out_.seekp(start_ + std::streamoff(file_header::checksum_offset));
+      put(reinterpret_cast<char const *>(&value), sizeof(value));
+      out_.seekp(end);
+      checksum_ = false;
+    }
+    out_.flush();
+  }
+
+  /** @brief Returns the number of elements that are still to be written */
+  std::size_t remaining() const noexcept { return remaining_; }
+
+  file_header const &header() const noexcept { return header_; }
+
+private:
+  void put(char const *p, std::size_t n) {
+    if (!out_.write(p, std::streamsize(n)))
+      throw std::runtime_error("Error in boost::numeric::ublas::tensor_writer: "
+                               "cannot write stream.");
+  }
+
+  std::ostream &out_;
+  file_header header_;
+  std::size_t remaining_;
+  bool checksum_;
+  std::streampos start_ = 0;
+  file_checksum sum_;
+};
+
+/** @brief Reads a tensor file element by element in chunks
+ *
+ * The header is read and validated on construction. The checksum is
+ * verified when the last element has been read.
+ *
+ * @tparam T trivially copyable element type
+ * @tparam F storage layout of the elements
+ */
+template <class T, class F = first_order> class tensor_reader {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Static error in boost::numeric::ublas::tensor_reader: element "
+                "type must be trivially copyable.");
+
+public:
+  /** @brief Reads the header of a tensor file
+   *
+   * @note throws std::runtime_error if element type or layout of the file do
+   * not match T and F.
+   */
+  explicit tensor_reader(std::istream &in) : in_(in) {
+    char fixed[file_header::fixed_size];
+    get(fixed, sizeof(fixed));
+    auto bytes = std::vector<char>(
+        file_header::unpadded_size_of(file_header::rank_of(fixed)));
+    std::copy(fixed, fixed + sizeof(fixed), bytes.begin());
+    get(bytes.data() + sizeof(fixed), bytes.size() - sizeof(fixed));
+    header_ = file_header::decode(bytes.data(), bytes.size());
+    header_.check<T, F>();
+
+    auto const w = basic_strides<std::size_t, F>(header_.extents);
+    if (!std::equal(w.begin(), w.end(), header_.strides.begin(),
+                    header_.strides.end()))
+      throw std::runtime_error("Error in boost::numeric::ublas::tensor_reader: "
+                               "strides of the file are not supported.");
+
+    // skips the padding so that non-seekable streams can be read, writers
+    // align the elements to the next multiple of file_header::alignment
+    auto const padding = header_.data_offset - bytes.size();
+    if (padding >= file_header::alignment)
+      throw std::runtime_error("Error in boost::numeric::ublas::tensor_reader: "
+                               "header is corrupted.");
+    char skipped[file_header::alignment];
+    get(skipped, std::size_t(padding));
+    remaining_ = header_.extents.product();
+  }
+
+  tensor_reader(tensor_reader const &) = delete;
+  tensor_reader &operator=(tensor_reader const &) = delete;
+
+  /** @brief Reads the next elements into p and returns their number which is
+   * less than n if fewer elements remain
+   *
+   * @note throws std::runtime_error if the checksum does not match.
+   */
+  std::size_t read(T *p, std::size_t n) {
+    n = std::min(n, remaining_);
+    auto *bytes = reinterpret_cast<char *>(p);
+    auto size = n * sizeof(T);
+    auto const verify = (header_.flags & file_header::has_checksum) != 0u;
+    for (; size > 0u;) {
+      auto const m = std::min(size, std::size_t(BOOST_UBLAS_TENSOR_IO_CHUNK_SIZE));
+      get(bytes, m);
+      if (verify) sum_.update(bytes, m);
+      bytes += m, size -= m;
+    }
+    remaining_ -= n;
+    if (verify && remaining_ == 0u && n > 0u &&
+        sum_.value() != header_.checksum)
+      throw std::runtime_error("Error in boost::numeric::ublas::tensor_reader: "
+                               "checksum does not match.");
+    return n;
+  }
+
+  /** @brief Returns the number of elements that are still to be read */
+  std::size_t remaining() const noexcept { return remaining_; }
+
+  file_header const &header() const noexcept { return header_; }
+  shape const &extents() const noexcept { return header_.extents; }
+
+private:
+  void get(char *p, std::size_t n) {
+    if (!in_.read(p, std::streamsize(n)))
+      throw std::runtime_error("Error in boost::numeric::ublas::tensor_reader: "
+                               "cannot read stream.");
+  }
+
+  std::istream &in_;
+  file_header header_;
+  std::size_t remaining_ = 0u;
+  file_checksum sum_;
+};
+
+/** @brief Writes a tensor in the binary tensor file format
+ *
+ * The elements are written with a tensor_writer that adds every chunk to the
+ * checksum just before writing it, so the storage is traversed once. Files
+ * that are written to disk can be mapped with open_mapped_tensor.
+ *
+ * @code
+ * auto out = std::ofstream("a.tensor", std::ios::binary);
+ * write_binary(out, a, true);
+ * @endcode
+ *
+ * @param out binary output stream
+ * @param t tensor that is written
+ * @param checksum if true the file_checksum of the elements is stored
+ *
+ * @note checksums require an output stream that supports seekp.
+ */
+template <class T, class F, class A, class E>
+void write_binary(std::ostream &out, tensor<T, F, A, E> const &t,
+                  bool checksum = false) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Static error in boost::numeric::ublas::write_binary: element "
+                "type must be trivially copyable.");
+
+  auto w = tensor_writer<T, F>(out, t.extents(), checksum);
+  w.write(t.data(), t.size());
+  w.close();
+}
+
+/** @brief Reads a tensor from the binary tensor file format into t
+ *
+ * The elements are read in place if the extents of t and of the file match.
+ * Otherwise t is reshaped.
+ *
+ * @param in binary input stream
+ * @param t tensor that is read
+ */
+template <class T, class F, class A, class E>
+void read_binary(std::istream &in, tensor<T, F, A, E> &t) {
+  auto reader = tensor_reader<T, F>(in);
+  if (t.extents() != reader.extents())
+    t.reshape(E(reader.extents()));
+  reader.read(t.data(), t.size());
+}
+
+/** @brief Reads a tensor from the binary tensor file format
+ *
+ * @code
+ * auto in = std::ifstream("a.tensor", std::ios::binary);
+ * auto a = read_binary<float>(in);
+ * @endcode
+ *
+ * @param in binary input stream
+ */
+template <class T, class F = first_order, class A = std::vector<T, std::allocator<T>>>
+tensor<T, F, A> read_binary(std::istream &in) {
+  auto reader = tensor_reader<T, F>(in);
+  auto t = tensor<T, F, A>(reader.extents(), uninitialized);
+  reader.read(t.data(), t.size());
+  return t;
+}
+
+} // namespace boost::numeric::ublas
+
+#endif
@@ -0,0 +1,645 @@
+//  Copyright (c) 2019-2020
+//  Mohammad Ashar Khan, ashar786khan@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Google in producing this work
+//  which started as a Google Summer of Code project.
+
+#ifndef BOOST_UBLAS_TENSOR_EINSTEIN_NETWORK_HPP
+#define BOOST_UBLAS_TENSOR_EINSTEIN_NETWORK_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "algorithms.hpp"
+#include "allocator.hpp"
+#include "multiplication.hpp"
+#include "tensor_view.hpp"
+
+namespace boost::numeric::ublas::detail {
+
+/**
+ * @brief Maximum number of operands for which the contraction order is
+ * computed with dynamic programming. Larger networks are planned greedily.
+ */
+constexpr std::size_t einstein_optimal_max_operands = 12u;
+
+/**
+ * @brief One pairwise contraction of a contraction plan
+ *
+ * @note Operands are numbered from 0 to n-1, the result of the k-th step has
+ * the number n+k.
+ */
+struct contraction_step {
+  std::size_t lhs;
+  std::size_t rhs;
+};
+
+/**
+ * @brief Describes the indices of a tensor network
+ *
+ * @note labels[i] holds the dense label ids of the i-th operand, extents[l]
+ * the extent of label l and free[l] is true if label l is not contracted.
+ */
+struct network_shape {
+  std::vector<std::vector<std::size_t>> labels;
+  std::vector<std::size_t> extents;
+  std::vector<bool> free;
+};
+
+inline bool operator==(network_shape const &a, network_shape const &b) {
+  return a.labels == b.labels && a.extents == b.extents && a.free == b.free;
+}
+
+inline bool operator!=(network_shape const &a, network_shape const &b) {
+  return !(a == b);
+}
+
+/**
+ * @brief Returns the number of multiply-adds of a contraction plan
+ */
+inline double contraction_cost(network_shape const &s,
+                               std::vector<contraction_step> const &plan) {
+  auto nodes = s.labels;
+  auto cost = 0.0;
+  for (auto const &step : plan) {
+    auto const &a = nodes[step.lhs];
+    auto const &b = nodes[step.rhs];
+    auto r = std::vector<std::size_t>{};
+    auto loop = 1.0;
+    for (auto i : a) {
+      loop *= double(s.extents[i]);
+      if (std::find(b.begin(), b.end(), i) == b.end()) r.push_back(i);
+    }
+    for (auto i : b) {
+      if (std::find(a.begin(), a.end(), i) == a.end()) {
+        loop *= double(s.extents[i]);
+        r.push_back(i);
+      }
+    }
+    cost += loop;
+    nodes.push_back(std::move(r));
+  }
+  return cost;
+}
+
+/**
+ * @brief Computes a contraction order with minimal number of multiply-adds
+ *
+ * Dynamic programming over all subsets of operands. The cost of contracting
+ * two subsets is the product of the extents of all labels that connect either
+ * subset with the remaining network or with the output.
+ *
+ * @note requires at most 64 labels and einstein_optimal_max_operands operands
+ */
+inline std::vector<contraction_step> plan_contraction_optimal(
+    network_shape const &s) {
+  using mask_type = std::uint64_t;
+
+  auto const n = s.labels.size();
+  auto const full = (mask_type(1) << n) - 1u;
+
+  auto lab = std::vector<mask_type>(n, 0u);
+  for (auto i = 0u; i < n; ++i)
+    for (auto l : s.labels[i]) lab[i] |= mask_type(1) << l;
+
+  auto fr = mask_type(0);
+  for (auto l = 0u; l < s.extents.size(); ++l)
+    if (s.free[l]) fr |= mask_type(1) << l;
+
+  auto un = std::vector<mask_type>(full + 1u, 0u);
+  for (auto S = mask_type(1); S <= full; ++S) {
+    auto i = 0u;
+    while (!(S & (mask_type(1) << i))) ++i;
+    un[S] = un[S & (S - 1u)] | lab[i];
+  }
+
+  auto const out = [&](mask_type S) { return un[S] & (fr | un[full ^ S]); };
+  auto const size = [&](mask_type m) {
+    auto p = 1.0;
+    for (auto l = 0u; m; ++l, m >>= 1)
+      if (m & 1u) p *= double(s.extents[l]);
+    return p;
+  };
+
+  auto best = std::vector<double>(full + 1u, std::numeric_limits<double>::infinity());
+  auto split = std::vector<mask_type>(full + 1u, 0u);
+  for (auto i = 0u; i < n; ++i) best[mask_type(1) << i] = 0.0;
+
+  for (auto S = mask_type(1); S <= full; ++S) {
+    if ((S & (S - 1u)) == 0u) continue;
+    // the lowest operand is always part of the left subset
+    auto const low = S & (~S + 1u);
+    auto const rest = S ^ low;
+    for (auto sub = rest;; sub = (sub - 1u) & rest) {
+      auto const A = sub | low;
+      auto const B = S ^ A;
+      if (B != 0u) {
+        auto const c = best[A] + best[B] + size(out(A) | out(B));
+        if (c < best[S]) {
+          best[S] = c;
+          split[S] = A;
+        }
+      }
+      if (sub == 0u) break;
+    }
+  }
+
+  auto plan = std::vector<contraction_step>{};
+  auto emit = [&](auto &self, mask_type S) -> std::size_t {
+    if ((S & (S - 1u)) == 0u) {
+      auto i = 0u;
+      while (!(S & (mask_type(1) << i))) ++i;
+      return i;
+    }
+    auto const l = self(self, split[S]);
+    auto const r = self(self, S ^ split[S]);
+    plan.push_back({l, r});
+    return n + plan.size() - 1u;
+  };
+  emit(emit, full);
+  return plan;
+}
+
+/**
+ * @brief Computes a contraction order by greedily contracting the pair with the
+ * smallest number of multiply-adds
+ *
+ * Pairs that share at least one label are preferred over outer products.
+ */
+inline std::vector<contraction_step> plan_contraction_greedy(
+    network_shape const &s) {
+  auto const n = s.labels.size();
+
+  auto nodes = s.labels;
+  auto alive = std::vector<std::size_t>(n);
+  for (auto i = 0u; i < n; ++i) alive[i] = i;
+
+  auto plan = std::vector<contraction_step>{};
+  while (alive.size() > 1u) {
+    auto bi = 0u, bj = 1u;
+    auto bshared = false;
+    auto bcost = std::numeric_limits<double>::infinity();
+    for (auto i = 0u; i < alive.size(); ++i)
+      for (auto j = i + 1u; j < alive.size(); ++j) {
+        auto const &a = nodes[alive[i]];
+        auto const &b = nodes[alive[j]];
+        auto shared = false;
+        auto cost = 1.0;
+        for (auto l : a) cost *= double(s.extents[l]);
+        for (auto l : b) {
+          if (std::find(a.begin(), a.end(), l) == a.end())
+            cost *= double(s.extents[l]);
+          else
+            shared = true;
+        }
+        if ((shared && !bshared) || (shared == bshared && cost < bcost)) {
+          bi = i, bj = j, bshared = shared, bcost = cost;
+        }
+      }
+
+    auto const &a = nodes[alive[bi]];
+    auto const &b = nodes[alive[bj]];
+    auto r = std::vector<std::size_t>{};
+    for (auto l : a)
+      if (std::find(b.begin(), b.end(), l) == b.end()) r.push_back(l);
+    for (auto l : b)
+      if (std::find(a.begin(), a.end(), l) == a.end()) r.push_back(l);
+
+    plan.push_back({alive[bi], alive[bj]});
+    nodes.push_back(std::move(r));
+    alive.erase(alive.begin() + bj);
+    alive.erase(alive.begin() + bi);
+    alive.push_back(nodes.size() - 1u);
+  }
+  return plan;
+}
+
+/**
+ * @brief Computes a pairwise contraction order of a tensor network
+ *
+ * Uses dynamic programming for small networks and the greedy heuristic
+ * otherwise.
+ */
+inline std::vector<contraction_step> plan_contraction(network_shape const &s) {
+  if (s.labels.size() <= einstein_optimal_max_operands && s.extents.size() <= 64u)
+    return plan_contraction_optimal(s);
+  return plan_contraction_greedy(s);
+}
+
+/**
+ * @brief A lazily evaluated product of tensors in Einstein notation
+ *
+ * Collects all operands and indices of an expression like
+ * `A(_i,_j)*B(_j,_k)*C(_k,_l)` and contracts them in the order with the
+ * smallest number of multiply-adds once the network is evaluated. The order
+ * is planned once and reused by later evaluations, see plan().
+ *
+ * Indices that occur twice are contracted, indices that occur once and every
+ * `_` are free. The free indices form the modes of the result in the order in
+ * which they occur in the expression. Results with less than two modes are
+ * padded with modes of extent one.
+ *
+ * Operands that are lvalues are referenced and must outlive the network.
+ * Temporaries, e.g. `make()(_i,_j)`, are moved into the network like the
+ * values of yap terminals built from rvalues, so that a stored network can be
+ * evaluated later.
+ *
+ * @note A network is evaluated only if it has at least two operands.
+ *
+ * @tparam tensor_type type of all operands and of the result
+ */
+template <class tensor_type> class einstein_network {
+public:
+  using value_type = typename tensor_type::value_type;
+  using extents_type = typename tensor_type::extents_type;
+  using size_type = std::size_t;
+
+  /** @brief Type of the intermediate results which are allocated with an
+   * aligned_allocator, cached by the current tensor_arena and not initialized */
+  using buffer_type =
+      tensor<value_type, typename tensor_type::layout_type,
+             std::vector<value_type, default_init_allocator<
+                                         aligned_allocator<value_type>>>,
+             basic_extents<std::size_t>>;
+
+  /**
+   * @brief Appends an operand to the network
+   *
+   * @param t tensor which is not copied and must outlive the network
+   * @param indices tuple of index::index_type with one index per mode of t
+   */
+  template <class tuple_type>
+  void push_back(tensor_type const &t, tuple_type const &indices) {
+    push_back(&t, nullptr, indices);
+  }
+
+  /**
+   * @brief Appends a temporary operand to the network
+   *
+   * @param t tensor which is moved into the network and shared by its copies
+   * @param indices tuple of index::index_type with one index per mode of t
+   */
+  template <class tuple_type>
+  void push_back(tensor_type &&t, tuple_type const &indices) {
+    auto owned = std::make_shared<tensor_type const>(std::move(t));
+    auto const *p = owned.get();
+    push_back(p, std::move(owned), indices);
+  }
+
+  /** @brief Returns the number of operands */
+  size_type size() const { return operands_.size(); }
+
+  /** @brief Returns the extents of the result without evaluating the network */
+  extents_type extents() const {
+    auto const s = shape();
+    auto e = typename extents_type::base_type{};
+    for (auto l : output(s)) e.push_back(s.extents[l]);
+    return extents_type(padded(std::move(e)));
+  }
+
+  /** @brief Returns the indices of the network with dense label ids */
+  network_shape shape() const {
+    auto ids = std::map<std::size_t, std::size_t>{};
+    auto s = network_shape{};
+    auto count = std::vector<std::size_t>{};
+    for (auto const &op : operands_) {
+      auto dense = std::vector<std::size_t>{};
+      for (auto m = 0u; m < op.labels.size(); ++m) {
+        auto const ext = op.t->extents().at(m);
+        auto const it = ids.find(op.labels[m]);
+        auto id = std::size_t{};
+        if (it == ids.end()) {
+          id = s.extents.size();
+          ids.emplace(op.labels[m], id);
+          s.extents.push_back(ext);
+          count.push_back(0u);
+        } else {
+          id = it->second;
+          if (s.extents[id] != ext)
+            throw std::runtime_error(
+                "Error in boost::numeric::ublas::einstein_network: extents of "
+                "contracted modes are not equal.");
+          if (std::find(dense.begin(), dense.end(), id) != dense.end())
+            throw std::runtime_error(
+                "Error in boost::numeric::ublas::einstein_network: an index "
+                "occurs twice within one operand.");
+        }
+        if (++count[id] > 2u)
+          throw std::runtime_error(
+              "Error in boost::numeric::ublas::einstein_network: an index "
+              "occurs more than twice.");
+        dense.push_back(id);
+      }
+      s.labels.push_back(std::move(dense));
+    }
+    for (auto c : count) s.free.push_back(c == 1u);
+    return s;
+  }
+
+  /** @brief Returns true if t is an operand of the network */
+  bool references(tensor_type const &t) const {
+    return std::any_of(operands_.begin(), operands_.end(),
+                       [&t](auto const &op) { return op.t == &t; });
+  }
+
+  /**
+   * @brief Contracts the network and returns the result
+   *
+   * @tparam result_type tensor type of the result with the layout of
+   * tensor_type, e.g. buffer_type for a temporary that is taken from the
+   * current tensor_arena
+   */
+  template <class result_type = tensor_type>
+  result_type evaluate() const {
+    auto c = result_type{};
+    contract_to(c, value_type{1}, false);
+    return c;
+  }
+
+  /**
+   * @brief Returns the element of the result at the offset i
+   *
+   * The network is contracted for the first element access and the result is
+   * kept for later accesses, so that reading all elements of a network one by
+   * one costs one contraction. The result is contracted again if the extents
+   * of an operand have changed. Element accesses otherwise see the elements of
+   * the operands at the first access, evaluate() always contracts them again.
+   */
+  value_type at(size_type i) const {
+    auto r = std::atomic_load(&result_);
+    if (!r || !r->matches(operands_)) {
+      auto extents = std::vector<extents_type>{};
+      for (auto const &op : operands_) extents.push_back(op.t->extents());
+      r = std::make_shared<cached_result const>(
+          cached_result{std::move(extents), evaluate()});
+      std::atomic_store(&result_, r);
+    }
+    return r->result[i];
+  }
+
+  /**
+   * @brief Returns the contraction order of the network
+   *
+   * The order is computed by plan_contraction for the first evaluation and
+   * reused by later evaluations as long as shape() does not change, e.g. by
+   * reshaping an operand.
+   */
+  std::shared_ptr<std::vector<contraction_step> const> plan() const {
+    auto const s = shape();
+    return planned(s);
+  }
+
+  /**
+   * @brief Contracts the network in the order returned by plan()
+   *
+   * Computes target = alpha*network if accumulate is false and
+   * target += alpha*network otherwise. The last contraction writes directly
+   * into target. Intermediate results that are not needed anymore are reused
+   * as buffers for later intermediate results. Their memory is taken from the
+   * current tensor_arena of the thread if there is one.
+   *
+   * @note target must not be an operand of the network
+   *
+   * @param[in,out] target tensor with the layout of tensor_type that holds
+   * the extents of the network if accumulate is true
+   * @param[in] alpha scaling factor of the network
+   * @param[in] accumulate adds the result to target if true
+   */
+  template <class target_type>
+  void contract_to(target_type &target, value_type const &alpha,
+                   bool accumulate) const {
+    static_assert(std::is_same_v<typename target_type::layout_type,
+                                 typename tensor_type::layout_type>,
+                  "Static error in boost::numeric::ublas::einstein_network: "
+                  "target must have the layout of the operands.");
+
+    auto const s = shape();
+    auto const cached = planned(s);
+    auto const &plan = *cached;
+    auto const n = operands_.size();
+    constexpr auto pad = std::numeric_limits<std::size_t>::max();
+
+    auto const lo = output(s);
+    auto no = typename extents_type::base_type{};
+    for (auto l : lo) no.push_back(s.extents[l]);
+    auto const eo = extents_type(padded(no));
+
+    if (!accumulate) {
+      target.reshape(eo);
+    } else if (target.extents() != eo) {
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::einstein_network: extents of the "
+          "target and of the network are not equal.");
+    }
+
+    using operand_view = tensor_view<value_type const, typename tensor_type::layout_type>;
+
+    auto temps = std::vector<buffer_type>(plan.size());
+    auto labels = s.labels;
+    auto pool = std::vector<buffer_type>{};
+
+    // takes the smallest released buffer that fits or the largest one
+    auto const acquire = [&pool](extents_type const &e) {
+      if (pool.empty()) return buffer_type(e, uninitialized);
+      auto const need = e.product();
+      auto best = pool.begin();
+      for (auto it = pool.begin(); it != pool.end(); ++it) {
+        auto const fits = it->size() >= need, bfits = best->size() >= need;
+        if ((fits && (!bfits || it->size() < best->size())) ||
+            (!fits && !bfits && it->size() > best->size()))
+          best = it;
+      }
+      auto t = std::move(*best);
+      pool.erase(best);
+      t.reshape(e);
+      return t;
+    };
+    auto const node = [&](std::size_t id) -> operand_view {
+      if (id < n) return operand_view(*operands_[id].t);
+      return operand_view(temps[id - n]);
+    };
+    auto const contains = [](auto const &l, std::size_t i) {
+      return i != pad && std::find(l.begin(), l.end(), i) != l.end();
+    };
+
+    for (auto k = 0u; k < plan.size(); ++k) {
+      auto const last = k + 1u == plan.size();
+      auto const &la = labels[plan[k].lhs];
+      auto const &lb = labels[plan[k].rhs];
+
+      // the smaller input of the last contraction is scaled instead of target
+      auto scaled = buffer_type{};
+      auto const scale = last && alpha != value_type{1};
+      auto const size = [&](std::size_t id) {
+        return id < n ? operands_[id].t->size() : temps[id - n].size();
+      };
+      auto const left = size(plan[k].lhs) <= size(plan[k].rhs);
+      auto const sid = left ? plan[k].lhs : plan[k].rhs;
+      if (scale) {
+        if (sid >= n) {
+          for (auto &v : temps[sid - n]) v *= alpha;
+        } else {
+          auto const &x = *operands_[sid].t;
+          scaled = acquire(x.extents());
+          std::transform(x.begin(), x.end(), scaled.begin(),
+                         [&alpha](auto const &v) { return alpha * v; });
+        }
+      }
+      auto const input = [&](std::size_t id) {
+        return scale && id == sid && id < n ? operand_view(scaled) : node(id);
+      };
+      auto const a = input(plan[k].lhs);
+      auto const b = input(plan[k].rhs);
+      auto const &ka = detail::kernel_operand(a);
+      auto const &kb = detail::kernel_operand(b);
+
+      // free modes of a and b form the modes of c, shared modes are contracted
+      auto phia = std::vector<std::size_t>{}, phib = std::vector<std::size_t>{};
+      auto lc = std::vector<std::size_t>{};
+      auto nc = typename extents_type::base_type{};
+      for (auto i = 0u; i < la.size(); ++i)
+        if (!contains(lb, la[i]))
+          phia.push_back(i + 1u), lc.push_back(la[i]), nc.push_back(a.extents()[i]);
+      for (auto j = 0u; j < lb.size(); ++j)
+        if (!contains(la, lb[j]))
+          phib.push_back(j + 1u), lc.push_back(lb[j]), nc.push_back(b.extents()[j]);
+      auto q = std::size_t{0};
+      for (auto i = 0u; i < la.size(); ++i)
+        if (contains(lb, la[i])) {
+          phia.push_back(i + 1u), ++q;
+          phib.push_back(std::size_t(std::find(lb.begin(), lb.end(), la[i]) - lb.begin()) + 1u);
+        }
+
+      if (last) {
+        // the modes of c are mapped onto the modes of target
+        auto wc = std::vector<std::size_t>(nc.size(), 1u);
+        for (auto i = 0u; i < lc.size(); ++i)
+          if (lc[i] != pad)
+            wc[i] = target.strides()[std::size_t(std::find(lo.begin(), lo.end(), lc[i]) - lo.begin())];
+        nc.push_back(1u), wc.push_back(1u);
+        ::boost::numeric::ublas::ttt(
+            a.rank(), b.rank(), q, phia.data(), phib.data(), target.data(),
+            nc.data(), wc.data(), ka.data(), ka.extents().data(),
+            ka.strides().data(), kb.data(), kb.extents().data(),
+            kb.strides().data(), accumulate);
+        return;
+      }
+
+      auto c = acquire(extents_type(padded(nc)));
+      ::boost::numeric::ublas::ttt(
+          a.rank(), b.rank(), q, phia.data(), phib.data(), c.data(),
+          c.extents().data(), c.strides().data(), ka.data(),
+          ka.extents().data(), ka.strides().data(), kb.data(),
+          kb.extents().data(), kb.strides().data(), false);
+
+      // modes of extent one that only pad the rank are removed again
+      auto lr = std::vector<std::size_t>{};
+      auto nr = typename extents_type::base_type{};
+      for (auto i = 0u; i < lc.size(); ++i)
+        if (lc[i] != pad) lr.push_back(lc[i]), nr.push_back(nc[i]);
+      c.reshape(extents_type(padded(nr)));
+      while (lr.size() < 2u) lr.push_back(pad);
+
+      for (auto id : {plan[k].lhs, plan[k].rhs})
+        if (id >= n) pool.push_back(std::move(temps[id - n]));
+      temps[k] = std::move(c);
+      labels.push_back(std::move(lr));
+    }
+  }
+
+private:
+  struct operand {
+    tensor_type const *t;
+    std::vector<std::size_t> labels;
+    // holds temporaries, nullptr for referenced tensors
+    std::shared_ptr<tensor_type const> owned;
+  };
+
+  // contraction order for the shape of the network
+  struct cached_plan {
+    network_shape shape;
+    std::vector<contraction_step> steps;
+  };
+
+  // result of the first element access and the extents of the operands
+  struct cached_result {
+    std::vector<extents_type> extents;
+    tensor_type result;
+
+    bool matches(std::vector<operand> const &ops) const {
+      return std::equal(ops.begin(), ops.end(), extents.begin(), extents.end(),
+                        [](auto const &op, auto const &e) {
+                          return op.t->extents() == e;
+                        });
+    }
+  };
+
+  // plans the contraction order only if s differs from the cached shape
+  std::shared_ptr<std::vector<contraction_step> const>
+  planned(network_shape const &s) const {
+    auto p = std::atomic_load(&plan_);
+    if (!p || p->shape != s) {
+      p = std::make_shared<cached_plan const>(cached_plan{s, plan_contraction(s)});
+      std::atomic_store(&plan_, p);
+    }
+    return {p, &p->steps};
+  }
+
+  template <class tuple_type>
+  void push_back(tensor_type const *t, std::shared_ptr<tensor_type const> owned,
+                 tuple_type const &indices) {
+    auto labels = std::vector<std::size_t>{};
+    std::apply(
+        [&](auto... is) {
+          (labels.push_back(is() == 0u ? unnamed_label() : is()), ...);
+        },
+        indices);
+    if (labels.size() != t->rank())
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::einstein_network: number of "
+          "indices does not match with the rank.");
+    operands_.push_back({t, std::move(labels), std::move(owned)});
+    plan_.reset();
+    result_.reset();
+  }
+
+  // results with less than two modes get modes of extent one
+  static typename extents_type::base_type
+  padded(typename extents_type::base_type e) {
+    while (e.size() < 2u) e.push_back(1u);
+    return e;
+  }
+
+  static std::vector<std::size_t> output(network_shape const &s) {
+    auto o = std::vector<std::size_t>{};
+    for (auto const &l : s.labels)
+      for (auto i : l)
+        if (s.free[i]) o.push_back(i);
+    return o;
+  }
+
+  // every unnamed index `_` is a free index of its own
+  std::size_t unnamed_label() {
+    return std::numeric_limits<std::size_t>::max() - unnamed_++;
+  }
+
+  std::vector<operand> operands_;
+  std::size_t unnamed_ = 0u;
+  mutable std::shared_ptr<cached_plan const> plan_;
+  mutable std::shared_ptr<cached_result const> result_;
+};
+
+} // namespace boost::numeric::ublas::detail
+
+#endif
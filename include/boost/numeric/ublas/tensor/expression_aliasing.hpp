@@ -0,0 +1,153 @@
+//  Copyright (c) 2019-2020
+//  Mohammad Ashar Khan, ashar786khan@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Google in producing this work
+//  which started as a Google Summer of Code project.
+
+#ifndef BOOST_UBLAS_EXPRESSION_ALIASING_HPP
+#define BOOST_UBLAS_EXPRESSION_ALIASING_HPP
+
+#include <boost/numeric/ublas/detail/config.hpp>
+
+#include <boost/yap/yap.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include "ublas_type_traits.hpp"
+
+/**
+ * Decides whether an expression can be evaluated directly into the memory of
+ * its target. The elementwise evaluation writes the element of the target at
+ * a multi-index after reading the elements of all terminals at the same
+ * multi-index. A terminal that reads the memory of the target at any other
+ * multi-index would see elements that are already overwritten.
+ */
+
+namespace boost::numeric::ublas::detail {
+
+/** @brief How the terminals of an expression read the memory of a target */
+enum class aliasing {
+  /** no terminal reads the memory of the target */
+  none,
+  /** terminals read the element of the target that is written at the same
+   * multi-index, e.g. `A = A*2 + B` */
+  elementwise,
+  /** terminals read elements of the target that are written at other
+   * multi-indices, e.g. shifted or transposed views of the target, or the
+   * target is resized */
+  unsafe
+};
+
+/**
+ * @brief Returns the lowest address and the address after the highest
+ * address of the elements of a tensor or a view.
+ *
+ * @note views with a negative stride store elements below data().
+ */
+template <class tensor_type>
+BOOST_UBLAS_INLINE std::pair<void const *, void const *>
+memory_bounds(tensor_type const &t) {
+  auto const &n = t.extents();
+  auto const &w = t.strides();
+  if (n.empty() || n.product() == 0u) return {nullptr, nullptr};
+  auto lo = std::ptrdiff_t(0), hi = std::ptrdiff_t(0);
+  for (auto r = 0u; r < n.size(); ++r) {
+    auto const d = std::ptrdiff_t(w[r]) * std::ptrdiff_t(n[r] - 1u);
+    (d < 0 ? lo : hi) += d;
+  }
+  return {t.data() + lo, t.data() + hi + 1};
+}
+
+/**
+ * @brief Returns how the elements of a tensor or a view are read if the
+ * elements of target are written with the extents shape.
+ *
+ * @note Both are the same memory if they have the same first element, extents
+ * and strides, the strides of modes with the extent one are ignored. Every
+ * other overlap is unsafe because elements are read at another multi-index
+ * than they are written, or because the target is resized before.
+ */
+template <class operand_type, class target_type, class Extents>
+BOOST_UBLAS_INLINE aliasing get_aliasing(operand_type const &operand,
+                                         target_type const &target,
+                                         Extents const &shape) {
+  auto const a = memory_bounds(operand);
+  auto const b = memory_bounds(target);
+  auto const less = std::less<void const *>{};
+  if (a.first == a.second || b.first == b.second || !less(a.first, b.second) ||
+      !less(b.first, a.second))
+    return aliasing::none;
+  if (static_cast<void const *>(operand.data()) !=
+          static_cast<void const *>(target.data()) ||
+      operand.extents() != shape || target.extents() != shape)
+    return aliasing::unsafe;
+  auto const &v = operand.strides();
+  auto const &w = target.strides();
+  for (auto r = 0u; r < shape.size(); ++r)
+    if (shape[r] != 1u && std::ptrdiff_t(v[r]) != std::ptrdiff_t(w[r]))
+      return aliasing::unsafe;
+  return aliasing::elementwise;
+}
+
+template <class Expr, class target_type, class Extents, std::size_t... I>
+aliasing get_operands_aliasing(Expr const &, target_type const &,
+                               Extents const &, std::index_sequence<I...>);
+
+/**
+ * @brief Returns how the terminals of an expression read the memory of target
+ * if the elements of target are written with the extents shape.
+ *
+ * Only tensors and views are compared with target, the operands of lazy
+ * contractions are materialized before the elementwise evaluation.
+ *
+ * @param expr the expression that is evaluated
+ * @param target the tensor or view into which expr is evaluated
+ * @param shape the extents of expr, see transforms::get_extents
+ */
+template <class Expr, class target_type, class Extents>
+BOOST_UBLAS_INLINE aliasing get_expression_aliasing(Expr const &expr,
+                                                    target_type const &target,
+                                                    Extents const &shape) {
+  using boost::yap::expr_kind;
+  using E = std::remove_cv_t<std::remove_reference_t<Expr>>;
+  constexpr auto kind = E::kind;
+
+  if constexpr (kind == expr_kind::terminal) {
+    using V = std::remove_cv_t<
+        std::remove_reference_t<decltype(boost::yap::value(expr))>>;
+    if constexpr (is_tensor_operand_v<V>)
+      return get_aliasing(boost::yap::value(expr), target, shape);
+    else
+      return aliasing::none;
+  } else if constexpr (kind == expr_kind::expr_ref) {
+    return get_expression_aliasing(boost::yap::deref(expr), target, shape);
+  } else {
+    constexpr auto n = decltype(boost::hana::size(expr.elements))::value;
+    return get_operands_aliasing(expr, target, shape,
+                                 std::make_index_sequence<n>{});
+  }
+}
+
+template <class Expr, class target_type, class Extents, std::size_t... I>
+aliasing get_operands_aliasing(Expr const &expr, target_type const &target,
+                               Extents const &shape,
+                               std::index_sequence<I...>) {
+  auto result = aliasing::none;
+  ((result = std::max(result,
+                      get_expression_aliasing(
+                          boost::yap::get(expr, boost::hana::llong_c<I>),
+                          target, shape))),
+   ...);
+  return result;
+}
+
+}  // namespace boost::numeric::ublas::detail
+
+#endif
@@ -0,0 +1,203 @@
+//  Copyright (c) 2019-2020
+//  Mohammad Ashar Khan, ashar786khan@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Google in producing this work
+//  which started as a Google Summer of Code project.
+
+#ifndef BOOST_UBLAS_EXPRESSION_FUSION_HPP
+#define BOOST_UBLAS_EXPRESSION_FUSION_HPP
+
+#include <boost/numeric/ublas/detail/config.hpp>
+
+#include <boost/yap/yap.hpp>
+#include <type_traits>
+#include <utility>
+#include "expression_transforms.hpp"
+#include "expression_transforms_traits.hpp"
+#include "parallel.hpp"
+
+/**
+ * Evaluates tensor contractions that are followed by elementwise operations
+ * without a temporary tensor for the contraction. The contraction writes into
+ * the target, scalars are passed as alpha and an added expression is written
+ * into the target before the contraction accumulates into it.
+ */
+
+namespace boost::numeric::ublas::detail {
+
+template <class T>
+using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
+/**
+ * @brief Returns true if Expr is a terminal with a scalar that can be passed
+ * as scaling factor of a contraction with the value type V.
+ *
+ * @note Floating point scalars are not fused with integral tensors because the
+ * elementwise evaluation multiplies in floating point.
+ */
+template <class V, class Expr> constexpr bool is_fusable_scalar() {
+  using E = remove_cvref_t<Expr>;
+  if constexpr (E::kind == ::boost::yap::expr_kind::terminal) {
+    using S = remove_cvref_t<decltype(::boost::yap::value(std::declval<E &>()))>;
+    return std::is_arithmetic_v<S> && std::is_convertible_v<S, V> &&
+           !(std::is_floating_point_v<S> && std::is_integral_v<V>);
+  } else {
+    return false;
+  }
+}
+
+/**
+ * @brief Returns true if Expr is a lazy contraction of tensors with type
+ * tensor_type that is multiplied by scalars or negated.
+ */
+template <class tensor_type, class Expr> constexpr bool is_scaled_network() {
+  using namespace ::boost::hana::literals;
+  using E = remove_cvref_t<Expr>;
+  using V = typename tensor_type::value_type;
+  if constexpr (E::kind == ::boost::yap::expr_kind::terminal) {
+    using N = remove_cvref_t<decltype(::boost::yap::value(std::declval<E &>()))>;
+    return std::is_same_v<N, einstein_network<tensor_type>>;
+  } else if constexpr (E::kind == ::boost::yap::expr_kind::multiplies) {
+    using L = decltype(::boost::yap::left(std::declval<E &>()));
+    using R = decltype(::boost::yap::right(std::declval<E &>()));
+    return (is_fusable_scalar<V, L>() && is_scaled_network<tensor_type, R>()) ||
+           (is_scaled_network<tensor_type, L>() && is_fusable_scalar<V, R>());
+  } else if constexpr (E::kind == ::boost::yap::expr_kind::negate) {
+    using C = decltype(::boost::yap::get(std::declval<E &>(), 0_c));
+    return is_scaled_network<tensor_type, C>();
+  } else {
+    return false;
+  }
+}
+
+/**
+ * @brief Returns the lazy contraction and the product of all scalars of an
+ * expression for which is_scaled_network is true.
+ */
+template <class tensor_type, class Expr>
+BOOST_UBLAS_INLINE auto scaled_network(Expr &expr)
+    -> std::pair<einstein_network<tensor_type> const *,
+                 typename tensor_type::value_type> {
+  using namespace ::boost::hana::literals;
+  using E = remove_cvref_t<Expr>;
+  using V = typename tensor_type::value_type;
+  if constexpr (E::kind == ::boost::yap::expr_kind::terminal) {
+    return {&::boost::yap::value(expr), V{1}};
+  } else if constexpr (E::kind == ::boost::yap::expr_kind::multiplies) {
+    auto &l = ::boost::yap::left(expr);
+    auto &r = ::boost::yap::right(expr);
+    if constexpr (is_fusable_scalar<V, decltype(l)>()) {
+      auto s = scaled_network<tensor_type>(r);
+      return {s.first, V(::boost::yap::value(l)) * s.second};
+    } else {
+      auto s = scaled_network<tensor_type>(l);
+      return {s.first, s.second * V(::boost::yap::value(r))};
+    }
+  } else {
+    auto s = scaled_network<tensor_type>(::boost::yap::get(expr, 0_c));
+    return {s.first, -s.second};
+  }
+}
+
+/**
+ * @brief Computes target = e + alpha*network with one elementwise pass
+ *
+ * @returns false if e does not have the extents of the network or if the
+ * network reads from target.
+ */
+template <class tensor_type, class Expr, class Network>
+BOOST_UBLAS_INLINE bool eval_fused_sum(Expr &e, Network &n, bool negate,
+                                       tensor_type &target) {
+  if constexpr (std::is_const_v<std::remove_reference_t<Expr>>) {
+    return false;
+  } else {
+    auto const s = scaled_network<tensor_type>(n);
+    if (s.first->references(target)) return false;
+
+    auto const shape = ::boost::yap::transform(
+        ::boost::yap::as_expr<tensor_expression>(e), transforms::get_extents{});
+    if (shape != s.first->extents()) return false;
+
+    ::boost::yap::as_expr<tensor_expression>(e).eval_to(target);
+    s.first->contract_to(target, negate ? -s.second : s.second, true);
+    return true;
+  }
+}
+
+/**
+ * @brief Evaluates a tensor contraction and its elementwise epilogue into
+ * target
+ *
+ * The following expressions are fused, where N is a lazy contraction that is
+ * possibly scaled by scalars and E is an expression without contraction:
+ *
+ * - `N` and `alpha*N` are contracted directly into target.
+ * - `E + N`, `N + E` and `E - N` evaluate E into target and accumulate N.
+ * - `apply(X, f)` with a fused expression X applies f in-place on target.
+ *   The elements are partitioned across the threads of an OpenMP team like
+ *   an elementwise evaluation, see run_plan.
+ *
+ * @returns false if the expression cannot be fused, e.g. if the contraction
+ * reads from target.
+ */
+template <class Expr, class T, class F, class A, class S>
+BOOST_UBLAS_INLINE bool eval_fused(
+    Expr &expr, ::boost::numeric::ublas::tensor<T, F, A, S> &target) {
+  using namespace ::boost::hana::literals;
+  using tensor_type = ::boost::numeric::ublas::tensor<T, F, A, S>;
+  using E = remove_cvref_t<Expr>;
+  constexpr auto kind = E::kind;
+
+  if constexpr (is_scaled_network<tensor_type, E>()) {
+    auto const s = scaled_network<tensor_type>(expr);
+    if (s.first->references(target)) return false;
+    s.first->contract_to(target, s.second, false);
+    return true;
+  } else if constexpr (kind == ::boost::yap::expr_kind::plus ||
+                       kind == ::boost::yap::expr_kind::minus) {
+    auto &l = ::boost::yap::left(expr);
+    auto &r = ::boost::yap::right(expr);
+    using L = remove_cvref_t<decltype(l)>;
+    using R = remove_cvref_t<decltype(r)>;
+    if constexpr (is_scaled_network<tensor_type, R>() &&
+                  !transforms::has_einstein_network<L>::value)
+      return eval_fused_sum(l, r, kind == ::boost::yap::expr_kind::minus,
+                            target);
+    else if constexpr (kind == ::boost::yap::expr_kind::plus &&
+                       is_scaled_network<tensor_type, L>() &&
+                       !transforms::has_einstein_network<R>::value)
+      return eval_fused_sum(r, l, false, target);
+    else
+      return false;
+  } else if constexpr (kind == ::boost::yap::expr_kind::call &&
+                       decltype(::boost::hana::size(
+                           std::declval<E &>().elements))::value == 2u) {
+    // ublas::apply(X, f) is represented as call(f, X)
+    auto &f = ::boost::yap::value(::boost::yap::get(expr, 0_c));
+    auto &x = ::boost::yap::get(expr, 1_c);
+    if constexpr (std::is_invocable_r_v<T, decltype(f), T const &> &&
+                  !std::is_const_v<std::remove_reference_t<decltype(x)>>) {
+      if (!eval_fused(x, target)) return false;
+      auto *const data = target.data();
+      auto const n = target.size();
+      parallel::for_each_range(n, n, [&f, data](std::size_t first,
+                                                std::size_t last) {
+        for (auto i = first; i < last; ++i) data[i] = f(data[i]);
+      });
+      return true;
+    } else {
+      return false;
+    }
+  } else {
+    return false;
+  }
+}
+
+}  // namespace boost::numeric::ublas::detail
+
+#endif
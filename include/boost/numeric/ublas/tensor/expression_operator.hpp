@@ -15,6 +15,7 @@
 #include <boost/numeric/ublas/detail/config.hpp>
 
 #include <boost/yap/user_macros.hpp>
+#include "einstein_network.hpp"
 #include "expression_relational_operator.hpp"
 #include "functions.hpp"
 #include "multi_index_utility.hpp"
@@ -26,6 +27,11 @@ namespace detail {
 template <::boost::yap::expr_kind K, typename A>
 struct tensor_expression;
 
+/** @brief Type of the tensor of a pair returned by tensor::operator()(index...)
+ * which references lvalues and holds temporaries by value */
+template <class T>
+using indexed_tensor_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
 }
 
 BOOST_UBLAS_EAGER_TENSOR_CAST(static_tensor_cast, static_cast)
@@ -37,26 +43,26 @@ BOOST_UBLAS_EAGER_TENSOR_CAST(reinterpret_tensor_cast, reinterpret_cast)
 // Tensor to expr
 BOOST_YAP_USER_UDT_UNARY_OPERATOR(
     negate, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 BOOST_YAP_USER_UDT_UNARY_OPERATOR(
     unary_plus, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     plus, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     minus, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     multiplies, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     divides, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 // Expr to Expr
 BOOST_YAP_USER_BINARY_OPERATOR(plus,
@@ -79,12 +85,21 @@ BOOST_YAP_USER_UNARY_OPERATOR(negate,
                               boost::numeric::ublas::detail::tensor_expression)
 
 // Tensor Contraction
-template <class tensor_type_left, class tuple_type_left,
-          class tensor_type_right, class tuple_type_right>
+template <class indexed_left, class tuple_type_left, class indexed_right,
+          class tuple_type_right,
+          class = std::enable_if_t<
+              boost::numeric::ublas::is_tensor_v<
+                  boost::numeric::ublas::detail::indexed_tensor_t<
+                      indexed_left>> &&
+              boost::numeric::ublas::is_tensor_v<
+                  boost::numeric::ublas::detail::indexed_tensor_t<
+                      indexed_right>>>>
 BOOST_UBLAS_INLINE decltype(auto) operator*(
-    std::pair<tensor_type_left const &, tuple_type_left> lhs,
-    std::pair<tensor_type_right const &, tuple_type_right> rhs) {
+    std::pair<indexed_left, tuple_type_left> lhs,
+    std::pair<indexed_right, tuple_type_right> rhs) {
   using namespace boost::numeric::ublas;
+  using tensor_type_left = detail::indexed_tensor_t<indexed_left>;
+  using tensor_type_right = detail::indexed_tensor_t<indexed_right>;
 
   auto const &tensor_left = lhs.first;
   auto const &tensor_right = rhs.first;
@@ -96,34 +111,94 @@ BOOST_UBLAS_INLINE decltype(auto) operator*(
       number_equal_indexes<tuple_type_left, tuple_type_right>::value;
 
   if constexpr (num_equal_ind == 0) {
+    // temporaries are moved into terminals
     return boost::yap::make_expression<detail::tensor_expression,
                                        boost::yap::expr_kind::multiplies>(
-        tensor_left, tensor_right);
+        std::forward<indexed_left>(lhs.first),
+        std::forward<indexed_right>(rhs.first));
   } else if constexpr (num_equal_ind ==
                            std::tuple_size<tuple_type_left>::value &&
                        std::is_same<tuple_type_left, tuple_type_right>::value) {
     return boost::yap::make_terminal<detail::tensor_expression>(
         boost::numeric::ublas::inner_prod(tensor_left, tensor_right));
-  } else {
+  } else if constexpr (!std::is_same_v<tensor_type_left, tensor_type_right>) {
     auto array_index_pairs =
         index_position_pairs(multi_index_left, multi_index_right);
     auto index_pairs = array_to_vector(array_index_pairs);
     return boost::yap::make_terminal<detail::tensor_expression>(
         boost::numeric::ublas::prod(tensor_left, tensor_right,
                                     index_pairs.first, index_pairs.second));
+  } else {
+    // contracted lazily so that further operands can be appended
+    auto network = detail::einstein_network<tensor_type_left>{};
+    network.push_back(std::forward<indexed_left>(lhs.first), multi_index_left);
+    network.push_back(std::forward<indexed_right>(rhs.first),
+                      multi_index_right);
+    return boost::yap::make_terminal<detail::tensor_expression>(
+        std::move(network));
   }
 }
 
+// Appends an operand to a lazy tensor contraction
+template <class tensor_type, class indexed_type, class tuple_type,
+          class = std::enable_if_t<std::is_same_v<
+              boost::numeric::ublas::detail::indexed_tensor_t<indexed_type>,
+              tensor_type>>>
+BOOST_UBLAS_INLINE decltype(auto) operator*(
+    boost::numeric::ublas::detail::tensor_expression<
+        boost::yap::expr_kind::terminal,
+        boost::hana::tuple<
+            boost::numeric::ublas::detail::einstein_network<tensor_type>>>
+        &&lhs,
+    std::pair<indexed_type, tuple_type> rhs) {
+  auto network = std::move(boost::yap::value(lhs));
+  network.push_back(std::forward<indexed_type>(rhs.first), rhs.second);
+  return boost::yap::make_terminal<
+      boost::numeric::ublas::detail::tensor_expression>(std::move(network));
+}
+
+template <class tensor_type, class indexed_type, class tuple_type,
+          class = std::enable_if_t<std::is_same_v<
+              boost::numeric::ublas::detail::indexed_tensor_t<indexed_type>,
+              tensor_type>>>
+BOOST_UBLAS_INLINE decltype(auto) operator*(
+    boost::numeric::ublas::detail::tensor_expression<
+        boost::yap::expr_kind::terminal,
+        boost::hana::tuple<
+            boost::numeric::ublas::detail::einstein_network<tensor_type>>> const
+        &lhs,
+    std::pair<indexed_type, tuple_type> rhs) {
+  auto network = boost::yap::value(lhs);
+  network.push_back(std::forward<indexed_type>(rhs.first), rhs.second);
+  return boost::yap::make_terminal<
+      boost::numeric::ublas::detail::tensor_expression>(std::move(network));
+}
+
+template <class tensor_type, class indexed_type, class tuple_type,
+          class = std::enable_if_t<std::is_same_v<
+              boost::numeric::ublas::detail::indexed_tensor_t<indexed_type>,
+              tensor_type>>>
+BOOST_UBLAS_INLINE decltype(auto) operator*(
+    boost::numeric::ublas::detail::tensor_expression<
+        boost::yap::expr_kind::terminal,
+        boost::hana::tuple<
+            boost::numeric::ublas::detail::einstein_network<tensor_type>>> &lhs,
+    std::pair<indexed_type, tuple_type> rhs) {
+  return std::as_const(lhs) * std::move(rhs);
+}
+
 // Assign Operators
-template <class T, class F, class V, class Expr>
+template <class T, class F, class V, class E, class Expr>
 BOOST_UBLAS_INLINE decltype(auto) operator+=(
-    boost::numeric::ublas::tensor<T, V, F> &lhs, Expr &&e) {
+    boost::numeric::ublas::tensor<T, V, F, E> &lhs, Expr &&e) {
   decltype(auto) expr =
       boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
           std::forward<Expr>(e));
   auto shape = boost::yap::transform(
       expr, boost::numeric::ublas::detail::transforms::get_extents{});
-  if (shape != lhs.extents() && !shape.is_free_scalar()) {
+  if (!shape.is_free_scalar() &&
+      !boost::numeric::ublas::detail::transforms::broadcasts_to(
+          shape, lhs.extents())) {
     throw std::runtime_error("Cannot apply operator += with extents " +
                              lhs.extents().to_string() + " and " +
                              shape.to_string());
@@ -133,15 +208,17 @@ BOOST_UBLAS_INLINE decltype(auto) operator+=(
   return lhs;
 }
 
-template <class T, class F, class V, class Expr>
+template <class T, class F, class V, class E, class Expr>
 BOOST_UBLAS_INLINE decltype(auto) operator-=(
-    boost::numeric::ublas::tensor<T, V, F> &lhs, Expr &&e) {
+    boost::numeric::ublas::tensor<T, V, F, E> &lhs, Expr &&e) {
   decltype(auto) expr =
       boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
           std::forward<Expr>(e));
   auto shape = boost::yap::transform(
       expr, boost::numeric::ublas::detail::transforms::get_extents{});
-  if (shape != lhs.extents() && !shape.is_free_scalar()) {
+  if (!shape.is_free_scalar() &&
+      !boost::numeric::ublas::detail::transforms::broadcasts_to(
+          shape, lhs.extents())) {
     throw std::runtime_error("Cannot apply operator -= with extents " +
                              lhs.extents().to_string() + " and " +
                              shape.to_string());
@@ -150,15 +227,17 @@ BOOST_UBLAS_INLINE decltype(auto) operator-=(
   new_expr.eval_to(lhs);
   return lhs;
 }
-template <class T, class F, class V, class Expr>
+template <class T, class F, class V, class E, class Expr>
 BOOST_UBLAS_INLINE decltype(auto) operator*=(
-    boost::numeric::ublas::tensor<T, V, F> &lhs, Expr &&e) {
+    boost::numeric::ublas::tensor<T, V, F, E> &lhs, Expr &&e) {
   decltype(auto) expr =
       boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
           std::forward<Expr>(e));
   auto shape = boost::yap::transform(
       expr, boost::numeric::ublas::detail::transforms::get_extents{});
-  if (shape != lhs.extents() && !shape.is_free_scalar()) {
+  if (!shape.is_free_scalar() &&
+      !boost::numeric::ublas::detail::transforms::broadcasts_to(
+          shape, lhs.extents())) {
     throw std::runtime_error("Cannot apply operator *= with extents " +
                              lhs.extents().to_string() + " and " +
                              shape.to_string());
@@ -167,15 +246,17 @@ BOOST_UBLAS_INLINE decltype(auto) operator*=(
   new_expr.eval_to(lhs);
   return lhs;
 }
-template <class T, class F, class V, class Expr>
+template <class T, class F, class V, class E, class Expr>
 BOOST_UBLAS_INLINE decltype(auto) operator/=(
-    boost::numeric::ublas::tensor<T, V, F> &lhs, Expr &&e) {
+    boost::numeric::ublas::tensor<T, V, F, E> &lhs, Expr &&e) {
   decltype(auto) expr =
       boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
           std::forward<Expr>(e));
   auto shape = boost::yap::transform(
       expr, boost::numeric::ublas::detail::transforms::get_extents{});
-  if (shape != lhs.extents() && !shape.is_free_scalar()) {
+  if (!shape.is_free_scalar() &&
+      !boost::numeric::ublas::detail::transforms::broadcasts_to(
+          shape, lhs.extents())) {
     throw std::runtime_error("Cannot apply operator /= with extents " +
                              lhs.extents().to_string() + " and " +
                              shape.to_string());
@@ -185,6 +266,52 @@ BOOST_UBLAS_INLINE decltype(auto) operator/=(
   return lhs;
 }
 
+// Assign Operators of views and sub-tensors, e.g. A(r1,r2) += B. The view is
+// taken by value so that temporary sub-tensors can be updated.
+template <class T, class F, class Expr>
+BOOST_UBLAS_INLINE decltype(auto) operator+=(
+    boost::numeric::ublas::tensor_view<T, F> lhs, Expr &&e) {
+  decltype(auto) expr =
+      boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
+          std::forward<Expr>(e));
+  auto new_expr = lhs + expr;
+  new_expr.eval_to(lhs);
+  return lhs;
+}
+
+template <class T, class F, class Expr>
+BOOST_UBLAS_INLINE decltype(auto) operator-=(
+    boost::numeric::ublas::tensor_view<T, F> lhs, Expr &&e) {
+  decltype(auto) expr =
+      boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
+          std::forward<Expr>(e));
+  auto new_expr = lhs - expr;
+  new_expr.eval_to(lhs);
+  return lhs;
+}
+
+template <class T, class F, class Expr>
+BOOST_UBLAS_INLINE decltype(auto) operator*=(
+    boost::numeric::ublas::tensor_view<T, F> lhs, Expr &&e) {
+  decltype(auto) expr =
+      boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
+          std::forward<Expr>(e));
+  auto new_expr = lhs * expr;
+  new_expr.eval_to(lhs);
+  return lhs;
+}
+
+template <class T, class F, class Expr>
+BOOST_UBLAS_INLINE decltype(auto) operator/=(
+    boost::numeric::ublas::tensor_view<T, F> lhs, Expr &&e) {
+  decltype(auto) expr =
+      boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
+          std::forward<Expr>(e));
+  auto new_expr = lhs / expr;
+  new_expr.eval_to(lhs);
+  return lhs;
+}
+
 template <boost::yap::expr_kind K, typename Tuple>
 BOOST_UBLAS_INLINE bool operator!(
     boost::numeric::ublas::detail::tensor_expression<K, Tuple> &&expr) {
@@ -14,285 +14,734 @@
 
 #include <boost/numeric/ublas/detail/config.hpp>
 
+#include "expression_plan.hpp"
 #include "expression_transforms_traits.hpp"
-#include <boost/type_traits/has_multiplies.hpp>
 #include <boost/yap/yap.hpp>
+#include <cstddef>
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace boost::numeric::ublas::detail::transforms {
 
-// struct apply_scalar_rule {
-//  constexpr apply_scalar_rule() = default;
-//
-//  template <class Expr1, class Expr2>
-//  constexpr decltype(auto)
-//  operator()(boost::yap::expr_tag<boost::yap::expr_kind::plus>, Expr1 &&e1,
-//             Expr2 &&e2) {
-//
-//    using Expr1_t = decltype(
-//        boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
-//            e1));
-//    using Expr2_t = decltype(
-//        boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
-//            e2));
-//
-//    if constexpr (is_terminal<std::remove_reference_t<Expr1_t>>::value &&
-//                  is_terminal<std::remove_reference_t<Expr2_t>>::value) {
-//      usable = std::addressof(e1) == std::addressof(e2);
-//      return boost::yap::make_expression<
-//          boost::numeric::ublas::detail::tensor_expression,
-//          boost::yap::expr_kind::multiplies>(boost::yap::make_terminal(2),
-//          e2);
-//    } else {
-//#ifndef BOOST_UBLAS_NO_RECURSIVE_OPTIMIZATION
-//      constexpr std::remove_reference_t<decltype(*this)> a, b;
-//
-//      auto xa = boost::yap::transform(
-//          boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
-//              std::forward<Expr1>(e1)),
-//          a);
-//      auto xb = boost::yap::transform(
-//          boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
-//              std::forward<Expr2>(e2)),
-//          b);
-//      usable = a.usable && b.usable;
-//      static_assert ();
-//      //  return boost::yap::make_terminal(5);
-//      //else
-//        return boost::yap::make_expression<
-//            boost::numeric::ublas::detail::tensor_expression,
-//            boost::yap::expr_kind::plus>(xa, xb);
-//
-//#else
-//      usable = true;
-//      return boost::yap::make_expression<
-//          boost::numeric::ublas::detail::tensor_expression,
-//          boost::yap::expr_kind::plus>(std::forward<Expr1>(e1),
-//                                       std::forward<Expr2>(e2));
-//#endif
-//    }
-//  }
-//
-//  bool usable = false;
-//};
+/*
+ * The optimization pipeline rewrites an arithmetic tensor expression once per
+ * evaluation before it is lowered into an evaluation plan, see
+ * tensor_expression::eval_optimized. It runs in three steps:
+ *
+ * 1. fold_scalars replaces every sub-expression without tensors by a terminal
+ *    with its value, e.g. `(2*3)*a` becomes `6*a`, so that it is computed once
+ *    per evaluation instead of once per element.
+ *
+ * 2. simplify_expression applies algebraic simplifications to operations
+ *    whose operands refer to the same objects, e.g. `(a+b)+(a+b)` becomes
+ *    `2*(a+b)` and `a*b+a*c` becomes `a*(b+c)`. The operands are compared at
+ *    run time and every rewritten operation is selected by an if_else node,
+ *    which falls back to the original operation if they differ.
+ *
+ * The first two steps rebuild tensor, matrix and vector terminals as
+ * references to the terminals of the original expression, which must outlive
+ * the result.
+ *
+ * 3. visit_plan lowers the result into an evaluation plan in which the
+ *    largest sub-expressions that occur several times are computed once per
+ *    element, e.g. `(a-b)` of `(a-b)*((a-b)+c)`, see plan_let.
+ *
+ * The number of rewrites and of shared sub-expressions per expression is
+ * bounded, see simplify_expression::max_rewrites and max_shared_expressions,
+ * so that the evaluation plan grows linearly with the expression.
+ *
+ * The pipeline is disabled with BOOST_UBLAS_NO_EXPRESSION_OPTIMIZATION.
+ */
+
+/**
+ * @brief Returns true if an arithmetic expression has no tensor terminals,
+ * i.e. it has the same value for every element.
+ *
+ * @tparam Expr the type of expression to check.
+ */
+template <class Expr> constexpr bool is_scalar_expression() {
+  using namespace boost::hana::literals;
+  using boost::yap::expr_kind;
+  using E = std::remove_cv_t<std::remove_reference_t<Expr>>;
+  constexpr auto kind = E::kind;
+
+  if constexpr (kind == expr_kind::terminal) {
+    using V = std::remove_cv_t<std::remove_reference_t<decltype(
+        boost::yap::value(std::declval<E &>()))>>;
+    return std::is_arithmetic_v<V> || is_complex_scalar<V>::value;
+  } else if constexpr (kind == expr_kind::plus || kind == expr_kind::minus ||
+                       kind == expr_kind::multiplies ||
+                       kind == expr_kind::divides) {
+    return is_scalar_expression<decltype(
+               boost::yap::left(std::declval<E &>()))>() &&
+           is_scalar_expression<decltype(
+               boost::yap::right(std::declval<E &>()))>();
+  } else if constexpr (kind == expr_kind::negate ||
+                       kind == expr_kind::unary_plus) {
+    return is_scalar_expression<decltype(
+        boost::yap::get(std::declval<E &>(), 0_c))>();
+  } else if constexpr (kind == expr_kind::expr_ref) {
+    return is_scalar_expression<decltype(
+        boost::yap::deref(std::declval<E &>()))>();
+  } else {
+    return false;
+  }
+}
+
+/**
+ * @brief Returns the number of arithmetic operations and function calls that
+ * are computed for every element of an expression.
+ *
+ * @note if_else nodes count the operations of their first alternative, i.e.
+ * of the rewritten operation, see simplify_expression.
+ *
+ * @tparam Expr the type of expression to count.
+ */
+template <class Expr> constexpr std::size_t count_operations() {
+  using namespace boost::hana::literals;
+  using boost::yap::expr_kind;
+  using E = std::remove_cv_t<std::remove_reference_t<Expr>>;
+  constexpr auto kind = E::kind;
+
+  if constexpr (kind == expr_kind::plus || kind == expr_kind::minus ||
+                kind == expr_kind::multiplies || kind == expr_kind::divides) {
+    return 1u +
+           count_operations<decltype(boost::yap::left(std::declval<E &>()))>() +
+           count_operations<decltype(boost::yap::right(std::declval<E &>()))>();
+  } else if constexpr (kind == expr_kind::negate) {
+    return 1u + count_operations<decltype(
+                    boost::yap::get(std::declval<E &>(), 0_c))>();
+  } else if constexpr (kind == expr_kind::unary_plus) {
+    return count_operations<decltype(
+        boost::yap::get(std::declval<E &>(), 0_c))>();
+  } else if constexpr (kind == expr_kind::call) {
+    if constexpr (decltype(boost::hana::size(
+                      std::declval<E &>().elements))::value == 2u)
+      return 1u + count_operations<decltype(
+                      boost::yap::get(std::declval<E &>(), 1_c))>();
+    else
+      return 1u;
+  } else if constexpr (kind == expr_kind::if_else) {
+    return count_operations<decltype(
+        boost::yap::get(std::declval<E &>(), 1_c))>();
+  } else if constexpr (kind == expr_kind::expr_ref) {
+    return count_operations<decltype(
+        boost::yap::deref(std::declval<E &>()))>();
+  } else {
+    return 0u;
+  }
+}
+
+/**
+ * @brief Returns a terminal that refers to the tensor, matrix or vector of a
+ * terminal instead of copying it. Other terminals are copied.
+ */
+template <class Expr>
+BOOST_UBLAS_INLINE auto reference_terminal(Expr const &expr) {
+  using V = std::remove_cv_t<
+      std::remove_reference_t<decltype(boost::yap::value(expr))>>;
+  if constexpr (is_tensor_operand_v<V> || is_matrix_v<V> || is_vector_v<V>)
+    return boost::yap::make_terminal<
+        boost::numeric::ublas::detail::tensor_expression>(
+        boost::yap::value(expr));
+  else
+    return Expr(expr);
+}
+
+/**
+ * @brief Returns an expr_ref node that refers to an expression.
+ */
+template <class Expr>
+BOOST_UBLAS_INLINE auto reference_expression(Expr const &expr) {
+  using tuple_type = boost::hana::tuple<Expr const *>;
+  return boost::numeric::ublas::detail::tensor_expression<
+      boost::yap::expr_kind::expr_ref, tuple_type>{
+      tuple_type{std::addressof(expr)}};
+}
+
+/**
+ * @brief Replaces every sub-expression without tensor terminals by a terminal
+ * with its value.
+ *
+ * @note Only sub-expressions without tensors are folded, e.g. `a*2*3` is
+ * evaluated as `(a*2)*3` and not reassociated.
+ *
+ * @param expr the expression to fold
+ *
+ * @return an expression in which all scalar sub-expressions are terminals and
+ * which refers to the tensors and unsupported sub-expressions of expr
+ */
+template <class Expr>
+BOOST_UBLAS_INLINE auto fold_scalars(Expr const &expr) {
+  using namespace boost::hana::literals;
+  using boost::yap::expr_kind;
+  using E = std::remove_cv_t<std::remove_reference_t<Expr>>;
+  constexpr auto kind = E::kind;
+
+  if constexpr (kind != expr_kind::terminal && is_scalar_expression<E>()) {
+    return boost::yap::make_terminal<
+        boost::numeric::ublas::detail::tensor_expression>(
+        boost::yap::evaluate(expr));
+  } else if constexpr (kind == expr_kind::plus || kind == expr_kind::minus ||
+                       kind == expr_kind::multiplies ||
+                       kind == expr_kind::divides) {
+    return boost::yap::make_expression<
+        boost::numeric::ublas::detail::tensor_expression, kind>(
+        fold_scalars(boost::yap::left(expr)),
+        fold_scalars(boost::yap::right(expr)));
+  } else if constexpr (kind == expr_kind::negate ||
+                       kind == expr_kind::unary_plus) {
+    return boost::yap::make_expression<
+        boost::numeric::ublas::detail::tensor_expression, kind>(
+        fold_scalars(boost::yap::get(expr, 0_c)));
+  } else if constexpr (kind == expr_kind::call &&
+                       decltype(boost::hana::size(expr.elements))::value ==
+                           2u) {
+    auto f = boost::yap::get(expr, 0_c);
+    return boost::yap::make_expression<
+        boost::numeric::ublas::detail::tensor_expression, kind>(
+        std::move(f), fold_scalars(boost::yap::get(expr, 1_c)));
+  } else if constexpr (kind == expr_kind::expr_ref) {
+    return fold_scalars(boost::yap::deref(expr));
+  } else if constexpr (kind == expr_kind::terminal) {
+    return reference_terminal(expr);
+  } else {
+    return reference_expression(expr);
+  }
+}
+
+template <class Expr, std::size_t... I>
+bool is_same_operands(Expr const &, Expr const &, std::index_sequence<I...>);
 
 /**
- * @brief An transform that identifies all sub-expressions where distribution
- * can be applied and it also applies them if possible.
+ * @brief Returns true if two expressions of the same type compute the same
+ * elements.
+ *
+ * Terminals are the same if they hold equal scalars or function pointers or
+ * refer to the same object, e.g. the same tensor.
  */
-struct apply_distributive_law {
-  constexpr apply_distributive_law() = default;
-
-  template <class Expr1, class Expr2>
-  constexpr decltype(auto)
-  operator()(boost::yap::expr_tag<boost::yap::expr_kind::plus>, Expr1 &&e1,
-             Expr2 &&e2) {
-
-    if constexpr (is_multiply<std::remove_reference_t<Expr1>>::value &&
-                  is_multiply<std::remove_reference_t<Expr2>>::value) {
-
-      auto &operand1 = boost::yap::value(boost::yap::left(e1));
-      auto &operand2 = boost::yap::value(boost::yap::right(e1));
-      auto &operand3 = boost::yap::value(boost::yap::left(e2));
-      auto &operand4 = boost::yap::value(boost::yap::right(e2));
-
-      using Op_1_t = std::remove_reference_t<decltype(operand1)>;
-      using Op_2_t = std::remove_reference_t<decltype(operand2)>;
-      using Op_3_t = std::remove_reference_t<decltype(operand3)>;
-      using Op_4_t = std::remove_reference_t<decltype(operand4)>;
-
-      if constexpr (std::is_same_v<Op_1_t, Op_2_t> &&
-                    std::is_same_v<Op_2_t, Op_3_t> &&
-                    std::is_same_v<Op_3_t, Op_4_t>) {
-
-        bool eq_1_3 = std::addressof(operand1) == std::addressof(operand3);
-        bool eq_1_4 = std::addressof(operand1) == std::addressof(operand4);
-        bool eq_2_3 = std::addressof(operand2) == std::addressof(operand3);
-        bool eq_2_4 = std::addressof(operand2) == std::addressof(operand4);
-
-        usable = eq_1_3 || eq_1_4 || eq_2_3 || eq_2_4;
-
-        if (eq_1_3) {
-          auto inner_op = boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::plus>(operand2, operand4);
-          return boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::multiplies>(operand1, std::move(inner_op));
-        }
-        if (eq_1_4) {
-          auto inner_op = boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::plus>(operand2, operand3);
-          return boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::multiplies>(operand1, std::move(inner_op));
-        }
-        if (eq_2_3) {
-          auto inner_op = boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::plus>(operand1, operand4);
-          return boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::multiplies>(operand2, std::move(inner_op));
-        }
-        if (eq_2_4) {
-          auto inner_op = boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::plus>(operand1, operand3);
-          return boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::multiplies>(operand2, std::move(inner_op));
-        }
-        // This is just to suppress the warning of non-void return end.
-        // If this is returned the usable flag will be false and user should not
-        // use this returned expression.
-        auto inner_op = boost::yap::make_expression<
-            boost::numeric::ublas::detail::tensor_expression,
-            boost::yap::expr_kind::plus>(operand2, operand4);
-        return boost::yap::make_expression<
-            boost::numeric::ublas::detail::tensor_expression,
-            boost::yap::expr_kind::multiplies>(operand1, std::move(inner_op));
+template <class Expr>
+BOOST_UBLAS_INLINE bool is_same_expression(Expr const &l, Expr const &r) {
+  using boost::yap::expr_kind;
+  constexpr auto kind = Expr::kind;
 
+  if constexpr (kind == expr_kind::terminal) {
+    auto const &a = boost::yap::value(l);
+    auto const &b = boost::yap::value(r);
+    using V = std::remove_cv_t<std::remove_reference_t<decltype(a)>>;
+    if constexpr (std::is_arithmetic_v<V> || is_complex_scalar<V>::value ||
+                  std::is_pointer_v<V>)
+      return a == b;
+    else if constexpr (std::is_empty_v<V>)
+      return true;
+    else
+      return std::addressof(a) == std::addressof(b);
+  } else if constexpr (kind == expr_kind::expr_ref) {
+    return is_same_expression(boost::yap::deref(l), boost::yap::deref(r));
+  } else {
+    constexpr auto n = decltype(boost::hana::size(l.elements))::value;
+    return is_same_operands(l, r, std::make_index_sequence<n>{});
+  }
+}
+
+template <class Expr, std::size_t... I>
+bool is_same_operands(Expr const &l, Expr const &r,
+                      std::index_sequence<I...>) {
+  return (is_same_expression(boost::yap::get(l, boost::hana::llong_c<I>),
+                             boost::yap::get(r, boost::hana::llong_c<I>)) &&
+          ...);
+}
+
+/**
+ * @brief Returns the number of if_else nodes of an expression, i.e. of the
+ * operations that are rewritten by simplify_expression.
+ *
+ * @tparam Expr the type of expression to count.
+ */
+template <class Expr> constexpr std::size_t count_rewrites();
+
+template <class Expr, std::size_t... I>
+constexpr std::size_t count_operand_rewrites(std::index_sequence<I...>) {
+  return (0u + ... +
+          count_rewrites<std::remove_cv_t<std::remove_reference_t<decltype(
+              boost::yap::get(std::declval<Expr &>(),
+                              boost::hana::llong_c<I>))>>>());
+}
+
+template <class Expr> constexpr std::size_t count_rewrites() {
+  using boost::yap::expr_kind;
+  constexpr auto kind = Expr::kind;
+  if constexpr (kind == expr_kind::terminal || kind == expr_kind::expr_ref)
+    return 0u;
+  else
+    return (kind == expr_kind::if_else ? 1u : 0u) +
+           count_operand_rewrites<Expr>(
+               std::make_index_sequence<decltype(boost::hana::size(
+                   std::declval<Expr &>().elements))::value>{});
+}
+
+/**
+ * @brief A transform that applies algebraic simplifications to operations
+ * whose operands refer to the same objects.
+ *
+ * - `e+e` becomes `2*e` and `e*e` becomes the square of e if e is not a
+ *   terminal.
+ * - `a*b+a*c` becomes `a*(b+c)` and `a*b-a*c` becomes `a*(b-c)` for every
+ *   pair of factors of two products with the same type.
+ *
+ * The operands of every rewritten operation are compared at run time with
+ * is_same_expression. The rewritten operation is the first alternative of an
+ * if_else node whose second alternative is the original operation. The
+ * original operation is not simplified, so that nested rewrites do not copy
+ * their operands into both alternatives, i.e. an expression grows linearly
+ * with the number of rewrites.
+ *
+ * At most max_rewrites operations of an expression are rewritten, in the
+ * order in which the operands are visited, to bound the size of the
+ * evaluation plan and the compile time.
+ *
+ * @note scalar sub-expressions should be folded before, see fold_scalars.
+ */
+struct simplify_expression {
+  static constexpr std::size_t max_rewrites = 8u;
+
+  template <class Expr>
+  BOOST_UBLAS_INLINE auto operator()(Expr const &expr) const {
+    return simplify<max_rewrites>(expr);
+  }
+
+private:
+  // simplifies expr with at most Budget rewrites
+  template <std::size_t Budget, class Expr>
+  static BOOST_UBLAS_INLINE auto simplify(Expr const &expr) {
+    using namespace boost::hana::literals;
+    using boost::yap::expr_kind;
+    using E = std::remove_cv_t<std::remove_reference_t<Expr>>;
+    constexpr auto kind = E::kind;
+
+    if constexpr (kind == expr_kind::plus || kind == expr_kind::minus ||
+                  kind == expr_kind::multiplies ||
+                  kind == expr_kind::divides) {
+      auto const &l = boost::yap::left(expr);
+      auto const &r = boost::yap::right(expr);
+      using L = std::remove_cv_t<std::remove_reference_t<decltype(l)>>;
+      using R = std::remove_cv_t<std::remove_reference_t<decltype(r)>>;
+      constexpr auto repeated = Budget > 0u && std::is_same_v<L, R> &&
+                                L::kind != expr_kind::terminal;
+
+      if constexpr ((kind == expr_kind::plus || kind == expr_kind::minus) &&
+                    has_common_factor<L, R>(0u)) {
+        return distribute<kind, 0u, Budget>(expr, l, r);
+      } else if constexpr (kind == expr_kind::plus && repeated) {
+        using V = std::decay_t<decltype(std::declval<L &>()(0u))>;
+        using S = typename real_scalar<V>::type;
+        return select(is_same_expression(l, r),
+                      boost::yap::make_expression<
+                          boost::numeric::ublas::detail::tensor_expression,
+                          expr_kind::multiplies>(
+                          boost::yap::make_terminal<
+                              boost::numeric::ublas::detail::tensor_expression>(
+                              S(2)),
+                          simplify<Budget - 1u>(l)),
+                      E(expr));
+      } else if constexpr (kind == expr_kind::multiplies && repeated) {
+        return select(is_same_expression(l, r),
+                      boost::yap::make_expression<
+                          boost::numeric::ublas::detail::tensor_expression,
+                          expr_kind::call>(plan_square{},
+                                           simplify<Budget - 1u>(l)),
+                      E(expr));
       } else {
-        usable = true;
-        return boost::yap::make_expression<
-            boost::numeric::ublas::detail::tensor_expression,
-            boost::yap::expr_kind::plus>(std::forward<Expr1>(e1),
-                                         std::forward<Expr2>(e2));
+        return rebuild<kind, Budget>(l, r);
       }
-    } else {
-#ifndef BOOST_UBLAS_NO_RECURSIVE_OPTIMIZATION
-      std::remove_reference_t<decltype(*this)> a, b;
-
-      auto xa = boost::yap::transform(
-          boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
-              std::forward<Expr1>(e1)),
-          a);
-      auto xb = boost::yap::transform(
-          boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
-              std::forward<Expr2>(e2)),
-          b);
-      usable = a.usable && b.usable;
+    } else if constexpr (kind == expr_kind::negate ||
+                         kind == expr_kind::unary_plus) {
       return boost::yap::make_expression<
-          boost::numeric::ublas::detail::tensor_expression,
-          boost::yap::expr_kind::plus>(xa, xb);
-#else
-      usable = true;
+          boost::numeric::ublas::detail::tensor_expression, kind>(
+          simplify<Budget>(boost::yap::get(expr, 0_c)));
+    } else if constexpr (kind == expr_kind::call &&
+                         decltype(boost::hana::size(expr.elements))::value ==
+                             2u) {
+      auto f = boost::yap::get(expr, 0_c);
       return boost::yap::make_expression<
-          boost::numeric::ublas::detail::tensor_expression,
-          boost::yap::expr_kind::plus>(std::forward<Expr1>(e1),
-                                       std::forward<Expr2>(e2));
-#endif
+          boost::numeric::ublas::detail::tensor_expression, kind>(
+          std::move(f), simplify<Budget>(boost::yap::get(expr, 1_c)));
+    } else if constexpr (kind == expr_kind::expr_ref) {
+      return simplify<Budget>(boost::yap::deref(expr));
+    } else if constexpr (kind == expr_kind::terminal) {
+      return reference_terminal(expr);
+    } else {
+      return reference_expression(expr);
     }
   }
 
-  template <class Expr1, class Expr2>
-  constexpr decltype(auto)
-  operator()(boost::yap::expr_tag<boost::yap::expr_kind::minus>, Expr1 &&e1,
-             Expr2 &&e2) {
-
-    if constexpr (is_multiply<std::remove_reference_t<Expr1>>::value &&
-                  is_multiply<std::remove_reference_t<Expr2>>::value) {
-
-      auto &operand1 = boost::yap::value(boost::yap::left(e1));
-      auto &operand2 = boost::yap::value(boost::yap::right(e1));
-      auto &operand3 = boost::yap::value(boost::yap::left(e2));
-      auto &operand4 = boost::yap::value(boost::yap::right(e2));
-
-      using Op_1_t = std::remove_reference_t<decltype(operand1)>;
-      using Op_2_t = std::remove_reference_t<decltype(operand2)>;
-      using Op_3_t = std::remove_reference_t<decltype(operand3)>;
-      using Op_4_t = std::remove_reference_t<decltype(operand4)>;
-
-      if constexpr (std::is_same_v<Op_1_t, Op_2_t> &&
-                    std::is_same_v<Op_2_t, Op_3_t> &&
-                    std::is_same_v<Op_3_t, Op_4_t>) {
-
-        bool eq_1_3 = std::addressof(operand1) == std::addressof(operand3);
-        bool eq_1_4 = std::addressof(operand1) == std::addressof(operand4);
-        bool eq_2_3 = std::addressof(operand2) == std::addressof(operand3);
-        bool eq_2_4 = std::addressof(operand2) == std::addressof(operand4);
-
-        usable = eq_1_3 || eq_1_4 || eq_2_3 || eq_2_4;
-
-        if (eq_1_3) {
-          auto inner_op = boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::minus>(operand2, operand4);
-          return boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::multiplies>(operand1, std::move(inner_op));
-        }
-        if (eq_1_4) {
-          auto inner_op = boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::minus>(operand2, operand3);
-          return boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::multiplies>(operand1, std::move(inner_op));
-        }
-        if (eq_2_3) {
-          auto inner_op = boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::minus>(operand1, operand4);
-          return boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::multiplies>(operand2, std::move(inner_op));
-        }
-        if (eq_2_4) {
-          auto inner_op = boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::minus>(operand1, operand3);
-          return boost::yap::make_expression<
-              boost::numeric::ublas::detail::tensor_expression,
-              boost::yap::expr_kind::multiplies>(operand2, std::move(inner_op));
-        }
-        // This is just to suppress the warning of non-void return end.
-        // If this is returned the usable flag will be false and user should not
-        // use this returned expression.
-        auto inner_op = boost::yap::make_expression<
-            boost::numeric::ublas::detail::tensor_expression,
-            boost::yap::expr_kind::minus>(operand2, operand4);
-        return boost::yap::make_expression<
-            boost::numeric::ublas::detail::tensor_expression,
-            boost::yap::expr_kind::multiplies>(operand1, std::move(inner_op));
+  // if_else node that evaluates then if condition is true and otherwise else,
+  // Bool is bool
+  template <class Bool, class Then, class Else>
+  static BOOST_UBLAS_INLINE auto select(Bool condition, Then then,
+                                        Else otherwise) {
+    return boost::yap::make_expression<
+        boost::numeric::ublas::detail::tensor_expression,
+        boost::yap::expr_kind::if_else>(
+        boost::yap::make_terminal<
+            boost::numeric::ublas::detail::tensor_expression>(
+            std::move(condition)),
+        std::move(then), std::move(otherwise));
+  }
+
+  // l Kind r with simplified operands, r is simplified with the budget that
+  // the rewrites of l leave
+  template <boost::yap::expr_kind Kind, std::size_t Budget, class L, class R>
+  static BOOST_UBLAS_INLINE auto rebuild(L const &l, R const &r) {
+    auto left = simplify<Budget>(l);
+    auto right = simplify<Budget - count_rewrites<decltype(left)>()>(r);
+    return boost::yap::make_expression<
+        boost::numeric::ublas::detail::tensor_expression, Kind>(
+        std::move(left), std::move(right));
+  }
+
+  // f*(g Kind h) with simplified operands
+  template <boost::yap::expr_kind Kind, std::size_t Budget, class F, class G,
+            class H>
+  static BOOST_UBLAS_INLINE auto factor(F const &f, G const &g, H const &h) {
+    auto x = simplify<Budget>(f);
+    return boost::yap::make_expression<
+        boost::numeric::ublas::detail::tensor_expression,
+        boost::yap::expr_kind::multiplies>(
+        std::move(x),
+        rebuild<Kind, Budget - count_rewrites<decltype(x)>()>(g, h));
+  }
+
+  // true if L and R are products and the factor I/2 of L has the type of the
+  // factor I%2 of R for one of the candidates I, I+1, ..., see distribute
+  template <class L, class R>
+  static constexpr bool has_common_factor(std::size_t I) {
+    using namespace boost::hana::literals;
+    using boost::yap::expr_kind;
+    if constexpr (L::kind == expr_kind::multiplies &&
+                  R::kind == expr_kind::multiplies) {
+      using L0 = decltype(boost::yap::get(std::declval<L const &>(), 0_c));
+      using L1 = decltype(boost::yap::get(std::declval<L const &>(), 1_c));
+      using R0 = decltype(boost::yap::get(std::declval<R const &>(), 0_c));
+      using R1 = decltype(boost::yap::get(std::declval<R const &>(), 1_c));
+      bool const same[] = {std::is_same_v<L0, R0>, std::is_same_v<L0, R1>,
+                           std::is_same_v<L1, R0>, std::is_same_v<L1, R1>};
+      for (auto k = I; k < 4u; ++k)
+        if (same[k]) return true;
+    }
+    return false;
+  }
 
+  // selects the first of the candidates I, I+1, ... of l Kind r whose common
+  // factors are the same, or the original operation expr if there is none.
+  // The candidate I shares the factor I/2 of l with the factor I%2 of r.
+  template <boost::yap::expr_kind Kind, std::size_t I, std::size_t Budget,
+            class E, class L, class R>
+  static BOOST_UBLAS_INLINE auto distribute(E const &expr, L const &l,
+                                            R const &r) {
+    if constexpr (Budget == 0u || !has_common_factor<L, R>(I)) {
+      if constexpr (I == 0u)
+        return rebuild<Kind, Budget>(l, r);
+      else
+        return E(expr);
+    } else {
+      auto const &x = boost::yap::get(l, boost::hana::llong_c<I / 2u>);
+      auto const &u = boost::yap::get(l, boost::hana::llong_c<1u - I / 2u>);
+      auto const &y = boost::yap::get(r, boost::hana::llong_c<I % 2u>);
+      auto const &v = boost::yap::get(r, boost::hana::llong_c<1u - I % 2u>);
+      if constexpr (std::is_same_v<decltype(x), decltype(y)>) {
+        auto then = factor<Kind, Budget - 1u>(x, u, v);
+        return select(
+            is_same_expression(x, y), std::move(then),
+            distribute<Kind, I + 1u,
+                       Budget - 1u - count_rewrites<decltype(then)>()>(expr, l,
+                                                                       r));
       } else {
-        usable = true;
-        return boost::yap::make_expression<
-            boost::numeric::ublas::detail::tensor_expression,
-            boost::yap::expr_kind::minus>(std::forward<Expr1>(e1),
-                                          std::forward<Expr2>(e2));
+        return distribute<Kind, I + 1u, Budget>(expr, l, r);
       }
-    } else {
-#ifndef BOOST_UBLAS_NO_RECURSIVE_OPTIMIZATION
-      std::remove_reference_t<decltype(*this)> a, b;
-
-      auto xa = boost::yap::transform(
-          boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
-              std::forward<Expr1>(e1)),
-          a);
-      auto xb = boost::yap::transform(
-          boost::yap::as_expr<boost::numeric::ublas::detail::tensor_expression>(
-              std::forward<Expr2>(e2)),
-          b);
-      usable = a.usable && b.usable;
-      return boost::yap::make_expression<
-          boost::numeric::ublas::detail::tensor_expression,
-          boost::yap::expr_kind::minus>(xa, xb);
-#else
-      usable = true;
-      return boost::yap::make_expression<
-          boost::numeric::ublas::detail::tensor_expression,
-          boost::yap::expr_kind::minus>(std::forward<Expr1>(e1),
-                                        std::forward<Expr2>(e2));
-#endif
     }
   }
-
-  bool usable = false;
 };
+
+/**
+ * @brief A list of types
+ */
+template <class... T> struct type_list {};
+
+template <class T, class... U> constexpr bool is_one_of(type_list<U...>) {
+  return (std::is_same_v<T, U> || ...);
+}
+
+template <class... T, class... U>
+constexpr auto concat(type_list<T...>, type_list<U...>) {
+  return type_list<T..., U...>{};
+}
+
+/**
+ * @brief Returns the positions of the operands of an expression that are
+ * lowered into plan nodes, i.e. without the function of a call and the
+ * condition of an if_else node.
+ */
+template <class Expr> constexpr auto plan_operands() {
+  using boost::yap::expr_kind;
+  if constexpr (Expr::kind == expr_kind::terminal)
+    return std::index_sequence<>{};
+  else if constexpr (Expr::kind == expr_kind::call)
+    return std::index_sequence<1u>{};
+  else if constexpr (Expr::kind == expr_kind::if_else)
+    return std::index_sequence<1u, 2u>{};
+  else
+    return std::make_index_sequence<decltype(boost::hana::size(
+        std::declval<Expr &>().elements))::value>{};
+}
+
+template <class Expr, std::size_t I>
+using operand_t = std::remove_cv_t<std::remove_reference_t<decltype(
+    boost::yap::get(std::declval<Expr const &>(), boost::hana::llong_c<I>))>>;
+
+template <class Expr, std::size_t... I>
+constexpr std::size_t count_operand_nodes(std::index_sequence<I...>);
+
+/**
+ * @brief Returns the number of nodes of an expression that are lowered into
+ * plan nodes. An expression has more nodes than each of its sub-expressions.
+ */
+template <class Expr> constexpr std::size_t count_nodes() {
+  return 1u + count_operand_nodes<Expr>(plan_operands<Expr>());
+}
+
+template <class Expr, std::size_t... I>
+constexpr std::size_t count_operand_nodes(std::index_sequence<I...>) {
+  return (0u + ... + count_nodes<operand_t<Expr, I>>());
+}
+
+template <class T, class Opaque, class Expr, std::size_t... I>
+constexpr std::size_t count_operand_occurrences(std::index_sequence<I...>);
+
+/**
+ * @brief Returns how often the sub-expression type T occurs in an expression
+ * without counting the occurrences within the sub-expressions Opaque.
+ */
+template <class T, class Opaque, class Expr>
+constexpr std::size_t count_occurrences() {
+  if constexpr (std::is_same_v<Expr, T>)
+    return 1u;
+  else if constexpr (is_one_of<Expr>(Opaque{}))
+    return 0u;
+  else
+    return count_operand_occurrences<T, Opaque, Expr>(plan_operands<Expr>());
+}
+
+template <class T, class Opaque, class Expr, std::size_t... I>
+constexpr std::size_t count_operand_occurrences(std::index_sequence<I...>) {
+  return (0u + ... + count_occurrences<T, Opaque, operand_t<Expr, I>>());
+}
+
+/**
+ * @brief Returns how often the sub-expression type T is evaluated per element
+ * of Root if the sub-expressions Shared are evaluated once, see plan_let.
+ */
+template <class T, class Root, class... Shared>
+constexpr std::size_t count_evaluations(type_list<Shared...>) {
+  using opaque = type_list<Shared...>;
+  return count_occurrences<T, opaque, Root>() +
+         (0u + ... +
+          count_operand_occurrences<T, opaque, Shared>(
+              plan_operands<Shared>()));
+}
+
+template <class... L, class... R>
+constexpr auto larger_candidate(type_list<L...> l, type_list<R...> r) {
+  if constexpr (sizeof...(L) == 0u)
+    return r;
+  else if constexpr (sizeof...(R) == 0u)
+    return l;
+  else if constexpr ((count_nodes<R>() + ...) > (count_nodes<L>() + ...))
+    return r;
+  else
+    return l;
+}
+
+constexpr auto largest_candidate() { return type_list<>{}; }
+
+template <class L, class... Ls>
+constexpr auto largest_candidate(L l, Ls... ls) {
+  return larger_candidate(l, largest_candidate(ls...));
+}
+
+template <class Root, class Shared, class Expr, std::size_t... I>
+constexpr auto find_operand_candidate(std::index_sequence<I...>);
+
+/**
+ * @brief Returns a type_list with the largest sub-expression of Expr that is
+ * evaluated more than once per element of Root or an empty type_list.
+ *
+ * @tparam Shared sub-expressions that are evaluated once
+ */
+template <class Root, class Shared, class Expr>
+constexpr auto find_candidate() {
+  if constexpr (Expr::kind == boost::yap::expr_kind::terminal)
+    return type_list<>{};
+  else if constexpr (!is_one_of<Expr>(Shared{}) &&
+                     count_evaluations<Expr, Root>(Shared{}) > 1u)
+    return type_list<Expr>{};
+  else
+    return find_operand_candidate<Root, Shared, Expr>(plan_operands<Expr>());
+}
+
+template <class Root, class Shared, class Expr, std::size_t... I>
+constexpr auto find_operand_candidate(std::index_sequence<I...>) {
+  return largest_candidate(
+      find_candidate<Root, Shared, operand_t<Expr, I>>()...);
+}
+
+/**
+ * @brief The maximum number of sub-expressions of an expression that are
+ * shared, see visit_plan.
+ */
+constexpr std::size_t max_shared_expressions = 4u;
+
+/**
+ * @brief Returns a type_list with the sub-expressions of Root that are
+ * shared, i.e. the largest repeated sub-expressions by decreasing size.
+ *
+ * @tparam Shared the sub-expressions that are already shared
+ */
+template <class Root, class... Shared>
+constexpr auto find_shared(type_list<Shared...> shared) {
+  if constexpr (sizeof...(Shared) == max_shared_expressions) {
+    return shared;
+  } else {
+    using candidate =
+        decltype(find_candidate<Root, type_list<Shared...>, Root>());
+    if constexpr (std::is_same_v<candidate, type_list<>>)
+      return shared;
+    else
+      return find_shared<Root>(concat(shared, candidate{}));
+  }
+}
+
+template <class T, class Expr, class F>
+BOOST_UBLAS_INLINE void for_each_occurrence(Expr const &expr, F &f);
+
+template <class T, class Expr, class F, std::size_t... I>
+BOOST_UBLAS_INLINE void for_each_operand_occurrence(Expr const &expr, F &f,
+                                                    std::index_sequence<I...>) {
+  (for_each_occurrence<T>(boost::yap::get(expr, boost::hana::llong_c<I>), f),
+   ...);
+}
+
+/**
+ * @brief Calls f with every sub-expression of the type T in the order of the
+ * operands.
+ */
+template <class T, class Expr, class F>
+BOOST_UBLAS_INLINE void for_each_occurrence(Expr const &expr, F &f) {
+  if constexpr (std::is_same_v<Expr, T>)
+    f(expr);
+  else
+    for_each_operand_occurrence<T>(expr, f, plan_operands<Expr>());
+}
+
+/**
+ * @brief Lowers an expression into an evaluation plan in which the first K
+ * shared sub-expressions are computed by plan_let nodes.
+ *
+ * The sub-expressions are shared by decreasing size so that the shared
+ * sub-expression K can only contain the shared sub-expressions K+1, ...,
+ * which are computed by the enclosing plan_let nodes.
+ */
+template <class layout_type, bool broadcast, std::size_t K, class Root,
+          class... Shared>
+BOOST_UBLAS_INLINE auto
+lower_shared(Root const &root,
+             boost::hana::tuple<Shared const *...> const &shared) {
+  using bindings = plan_bindings<0u, Shared...>;
+  if constexpr (K == 0u) {
+    return make_plan<layout_type, broadcast, bindings>(root);
+  } else {
+    auto value = make_plan<layout_type, broadcast,
+                           typename bindings::template from<K>>(
+        *boost::hana::at_c<K - 1u>(shared));
+    auto body = lower_shared<layout_type, broadcast, K - 1u>(root, shared);
+    return plan_let<K - 1u, decltype(value), decltype(body)>{value, body};
+  }
+}
+
+/**
+ * @brief Returns the first sub-expression of the type T of an expression if
+ * all sub-expressions of the type T compute the same elements, or nullptr.
+ */
+template <class T, class Expr>
+BOOST_UBLAS_INLINE T const *same_occurrence(Expr const &expr) {
+  T const *first = nullptr;
+  auto same = true;
+  auto compare = [&first, &same](T const &t) {
+    if (first == nullptr)
+      first = std::addressof(t);
+    else
+      same = same && is_same_expression(*first, t);
+  };
+  for_each_occurrence<T>(expr, compare);
+  return same ? first : nullptr;
+}
+
+template <class layout_type, bool broadcast, class Root, class Visitor,
+          class... Shared>
+BOOST_UBLAS_INLINE void visit_shared_plan(Root const &root, Visitor &visitor,
+                                          type_list<Shared...>) {
+  if constexpr (sizeof...(Shared) == 0u) {
+    visitor(make_plan<layout_type, broadcast>(root));
+  } else {
+    auto const shared =
+        boost::hana::make_tuple(same_occurrence<Shared>(root)...);
+    auto const same = boost::hana::unpack(shared, [](auto const *...p) {
+      return ((p != nullptr) && ...);
+    });
+    if (same)
+      visitor(
+          lower_shared<layout_type, broadcast, sizeof...(Shared)>(root, shared));
+    else
+      visitor(make_plan<layout_type, broadcast>(root));
+  }
+}
+
+/**
+ * @brief Lowers an expression into an evaluation plan and calls a visitor
+ * with the plan.
+ *
+ * If shared is true, the sub-expressions that occur several times in the
+ * expression are computed once per element by plan_let nodes. They are chosen
+ * at compile time from the types of the sub-expressions, the largest first
+ * and at most max_shared_expressions. Their occurrences are compared once at
+ * run time with is_same_expression. If the occurrences of any of them differ,
+ * e.g. `(a-b)` and `(c-d)` of tensors of the same type, the plan without
+ * shared sub-expressions is visited instead. So the visitor is instantiated
+ * at most twice.
+ *
+ * @note The shared sub-expressions of if_else nodes are computed even if the
+ * alternative that contains them is not selected. The alternatives of
+ * simplify_expression contain every sub-expression of the original
+ * operation at least once.
+ *
+ * @tparam layout_type the layout of the target
+ * @tparam broadcast lowers all tensors into plan_broadcast_tensor nodes
+ * @tparam shared computes repeated sub-expressions once per element
+ *
+ * @param expr the expression to lower, requires is_plannable<Expr>()
+ * @param visitor a function object that is called with the plan
+ */
+template <class layout_type, bool broadcast, bool shared, class Expr,
+          class Visitor>
+BOOST_UBLAS_INLINE void visit_plan(Expr const &expr, Visitor &&visitor) {
+  if constexpr (shared)
+    visit_shared_plan<layout_type, broadcast>(
+        expr, visitor, find_shared<Expr>(type_list<>{}));
+  else
+    visitor(make_plan<layout_type, broadcast>(expr));
+}
+
 } // namespace boost::numeric::ublas::detail::transforms
 
 #endif // UBLAS_EXPRESSION_OPTIMIZATION_HPP
@@ -0,0 +1,958 @@
+//  Copyright (c) 2019-2020
+//  Mohammad Ashar Khan, ashar786khan@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Google in producing this work
+//  which started as a Google Summer of Code project.
+
+#ifndef BOOST_UBLAS_EXPRESSION_PLAN_HPP
+#define BOOST_UBLAS_EXPRESSION_PLAN_HPP
+
+#include <boost/numeric/ublas/detail/config.hpp>
+
+#include <boost/yap/yap.hpp>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "strides.hpp"
+#include "ublas_type_traits.hpp"
+
+/**
+ * An evaluation plan is a tree of small function objects that is created once
+ * per evaluation from a tensor expression. Tensor terminals are replaced by
+ * their data pointers and scalar terminals by their values so that evaluating
+ * the ith element does not need a YAP transform and inlines into a loop that
+ * the compiler can vectorize.
+ *
+ * If all nodes of a plan support packed registers of the value type R of the
+ * target, the plan is additionally evaluated with simd::pack<R> registers for
+ * real and simd::cpack<R> registers for complex elements. The instruction set
+ * is selected at compile time, see simd.hpp.
+ *
+ * Plans of expressions that mix first_order and last_order tensors are called
+ * with two indices, the offset of an element in the layout of the target and
+ * in the transposed layout, and are evaluated tile by tile so that the
+ * accesses of both layouts stay within the cache, see run_plan_tiled.
+ *
+ * Plans of expressions whose operands are broadcast read every tensor with its
+ * own strides and the stride zero in modes with the extent one. They are
+ * evaluated row by row along the contiguous mode of the target, see
+ * run_plan_broadcast.
+ *
+ * Sub-expressions that occur several times in an expression can be computed
+ * once per element by a plan_let node and read by plan_bound nodes, see
+ * transforms::visit_plan.
+ */
+
+namespace boost::numeric::ublas::detail {
+
+template <class T> struct is_complex_scalar : std::false_type {};
+template <class T> struct is_complex_scalar<std::complex<T>> : std::true_type {};
+
+template <class T> struct real_scalar { using type = T; };
+template <class T> struct real_scalar<std::complex<T>> { using type = T; };
+
+namespace plan_math {
+using std::exp;
+using std::sqrt;
+// finds std::sqrt and std::exp for scalars and the overloads of simd::pack
+// with argument dependent lookup, i.e. sqrt.
+template <class T>
+BOOST_UBLAS_INLINE auto sqrt_of(T const &t) -> decltype(sqrt(t)) {
+  return sqrt(t);
+}
+template <class T>
+BOOST_UBLAS_INLINE auto exp_of(T const &t) -> decltype(exp(t)) {
+  return exp(t);
+}
+}  // namespace plan_math
+
+/**
+ * @brief Function object for the square root of scalars and packed registers
+ */
+struct plan_sqrt {
+  template <class T>
+  BOOST_UBLAS_INLINE auto operator()(T const &t) const
+      -> decltype(plan_math::sqrt_of(t)) {
+    return plan_math::sqrt_of(t);
+  }
+};
+
+/**
+ * @brief Function object for the exponential function of scalars and packed
+ * registers
+ *
+ * @note Registers are evaluated with the polynomial approximation simd::exp.
+ * Split complex registers have no exponential function, so that complex
+ * plans with plan_exp are evaluated element by element.
+ */
+struct plan_exp {
+  template <class T>
+  BOOST_UBLAS_INLINE auto operator()(T const &t) const
+      -> decltype(plan_math::exp_of(t)) {
+    return plan_math::exp_of(t);
+  }
+};
+
+/**
+ * @brief Function object for the square of scalars and packed registers
+ *
+ * @note Repeated factors `e*e` are evaluated as the square of e, see
+ * transforms::simplify_expression.
+ */
+struct plan_square {
+  template <class T>
+  BOOST_UBLAS_INLINE auto operator()(T const &t) const -> decltype(t * t) {
+    return t * t;
+  }
+};
+
+/**
+ * @brief True for function objects that are passed to `ublas::apply` without
+ * conversion into a function pointer, e.g. because they can be applied on
+ * packed registers.
+ */
+template <class F> struct is_packet_function : std::false_type {};
+template <> struct is_packet_function<plan_sqrt> : std::true_type {};
+template <> struct is_packet_function<plan_exp> : std::true_type {};
+template <> struct is_packet_function<plan_square> : std::true_type {};
+
+/**
+ * @brief Function object for the unary plus operator.
+ */
+struct plan_identity {
+  template <class T>
+  BOOST_UBLAS_INLINE constexpr decltype(auto) operator()(T &&t) const {
+    using V = std::remove_cv_t<std::remove_reference_t<T>>;
+    if constexpr (std::is_arithmetic_v<V> || is_complex_scalar<V>::value)
+      return +std::forward<T>(t);
+    else
+      return V(std::forward<T>(t));
+  }
+};
+
+/**
+ * @brief The value of the shared sub-expression K for the element that is
+ * evaluated, see plan_let
+ */
+template <std::size_t K, class V> struct plan_value {
+  V value;
+};
+
+/**
+ * @brief The values of the shared sub-expressions for the element that is
+ * evaluated
+ *
+ * Plan nodes are called with the indices of an element followed by an
+ * environment if they are below a plan_let node, e.g. `plan(i, env)` or
+ * `plan.template packet<R>(i, env)`. Tensor and scalar nodes ignore it.
+ *
+ * @tparam Values plan_value types
+ */
+template <class... Values> struct plan_env : Values... {};
+
+template <class T> struct is_plan_env : std::false_type {};
+template <class... V> struct is_plan_env<plan_env<V...>> : std::true_type {};
+
+/**
+ * @brief Returns an environment with the values of env and the value v of the
+ * shared sub-expression K
+ */
+template <std::size_t K, class V, class... Values>
+BOOST_UBLAS_INLINE plan_env<Values..., plan_value<K, V>>
+plan_extend(plan_env<Values...> const &env, V const &v) {
+  return {static_cast<Values const &>(env)..., plan_value<K, V>{v}};
+}
+
+/**
+ * @brief Returns the packed register type of a plan with elements of type V
+ */
+template <class V>
+using plan_packet_t = std::conditional_t<
+    is_complex_scalar<V>::value,
+    simd::cpack<typename real_scalar<V>::type>,
+    simd::pack<typename real_scalar<V>::type>>;
+
+/**
+ * @brief Plan node that reads the ith element of a tensor with the layout of
+ * the target
+ */
+template <class T> struct plan_tensor {
+  static constexpr bool transposed = false;
+  static constexpr std::size_t operations = 0u;
+
+  T const *data;
+  template <class... J>
+  BOOST_UBLAS_INLINE T const &operator()(std::size_t i, J...) const {
+    return data[i];
+  }
+  BOOST_UBLAS_INLINE void seek(std::size_t, std::size_t const *, std::size_t) {}
+
+  template <class R> static constexpr bool packable() {
+    return std::is_same_v<T, R> || std::is_same_v<T, std::complex<R>>;
+  }
+  template <class R, class... E>
+  BOOST_UBLAS_INLINE auto packet(std::size_t i, E const &...) const {
+    if constexpr (std::is_same_v<T, R>)
+      return simd::pack<R>::load(data + i);
+    else
+      return simd::cpack<R>::load(data + i);
+  }
+};
+
+/**
+ * @brief Plan node that reads the jth element of a tensor with the transposed
+ * layout of the target
+ */
+template <class T> struct plan_transposed_tensor {
+  static constexpr bool transposed = true;
+  static constexpr std::size_t operations = 0u;
+
+  T const *data;
+  template <class... E>
+  BOOST_UBLAS_INLINE T const &operator()(std::size_t, std::size_t j,
+                                         E const &...) const {
+    return data[j];
+  }
+  BOOST_UBLAS_INLINE void seek(std::size_t, std::size_t const *, std::size_t) {}
+
+  template <class R> static constexpr bool packable() { return false; }
+};
+
+/**
+ * @brief Plan node that reads a tensor with broadcasting
+ *
+ * The node is moved to the first element i of a row of the target with seek.
+ * The elements of the row are then read with the stride of the tensor in the
+ * mode a of the row, which is zero if the tensor has the extent one in mode a.
+ *
+ * @tparam Stride std::size_t for tensors and std::ptrdiff_t for the signed
+ * strides of tensor_view
+ */
+template <class T, class Stride = std::size_t> struct plan_broadcast_tensor {
+  static constexpr bool transposed = false;
+  static constexpr std::size_t operations = 0u;
+
+  T const *data;
+  std::size_t rank;
+  std::size_t const *extents;
+  Stride const *strides;
+
+  T const *row = nullptr;
+  std::size_t first = 0u;
+  std::ptrdiff_t step = 0;
+
+  /**
+   * @brief Moves the node to the row that starts with the ith element
+   *
+   * @param i offset of the first element of the row in the target
+   * @param idx multi-index of the first element of the row
+   * @param a mode of the row
+   */
+  BOOST_UBLAS_INLINE void seek(std::size_t i, std::size_t const *idx,
+                               std::size_t a) {
+    auto j = std::ptrdiff_t{0};
+    for (auto r = 0ul; r < rank; ++r)
+      if (extents[r] > 1u)
+        j += std::ptrdiff_t(idx[r]) * std::ptrdiff_t(strides[r]);
+    row = data + j;
+    first = i;
+    step = a < rank && extents[a] > 1u ? std::ptrdiff_t(strides[a]) : 0;
+  }
+
+  template <class... J>
+  BOOST_UBLAS_INLINE T const &operator()(std::size_t i, J...) const {
+    return row[std::ptrdiff_t(i - first) * step];
+  }
+
+  template <class R> static constexpr bool packable() {
+    return std::is_same_v<T, R> || std::is_same_v<T, std::complex<R>>;
+  }
+  template <class R, class... E>
+  BOOST_UBLAS_INLINE auto packet(std::size_t i, E const &...) const {
+    using packet_type =
+        std::conditional_t<std::is_same_v<T, R>, simd::pack<R>, simd::cpack<R>>;
+    if (step == 1) return packet_type::load(row + (i - first));
+    if (step == 0) return packet_type::broadcast(*row);
+    T buffer[packet_type::width];
+    for (auto k = 0ul; k < packet_type::width; ++k)
+      buffer[k] = row[std::ptrdiff_t(i - first + k) * step];
+    return packet_type::load(buffer);
+  }
+};
+
+/**
+ * @brief Plan node that returns a scalar for every element
+ */
+template <class T> struct plan_scalar {
+  static constexpr bool transposed = false;
+  static constexpr std::size_t operations = 0u;
+
+  T value;
+  template <class... I>
+  BOOST_UBLAS_INLINE T const &operator()(I...) const {
+    return value;
+  }
+  BOOST_UBLAS_INLINE void seek(std::size_t, std::size_t const *, std::size_t) {}
+
+  // scalars of a wider type are not packed because the elementwise evaluation
+  // computes in the wider type.
+  template <class R> static constexpr bool packable() {
+    if constexpr (std::is_arithmetic_v<T>)
+      return std::is_same_v<std::common_type_t<T, R>, R>;
+    else
+      return std::is_same_v<T, std::complex<R>>;
+  }
+  template <class R, class... E>
+  BOOST_UBLAS_INLINE auto packet(std::size_t, E const &...) const {
+    if constexpr (std::is_arithmetic_v<T>)
+      return simd::pack<R>::broadcast(R(value));
+    else
+      return simd::cpack<R>::broadcast(value);
+  }
+};
+
+/**
+ * @brief Plan node that applies a unary function object to its operand
+ */
+template <class Op, class Operand> struct plan_unary {
+  static constexpr bool transposed = Operand::transposed;
+  static constexpr std::size_t operations =
+      (std::is_same_v<Op, plan_identity> ? 0u : 1u) + Operand::operations;
+
+  Op op;
+  Operand operand;
+  template <class... I>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(I... i) const {
+    return op(operand(i...));
+  }
+  BOOST_UBLAS_INLINE void seek(std::size_t i, std::size_t const *idx,
+                               std::size_t a) {
+    operand.seek(i, idx, a);
+  }
+
+  template <class R> static constexpr bool packable() {
+    if constexpr (Operand::template packable<R>())
+      return std::is_invocable_v<Op const &,
+                                 decltype(std::declval<Operand const &>()
+                                              .template packet<R>(0))>;
+    else
+      return false;
+  }
+  template <class R, class... E>
+  BOOST_UBLAS_INLINE auto packet(std::size_t i, E const &...env) const {
+    return op(operand.template packet<R>(i, env...));
+  }
+};
+
+/**
+ * @brief Plan node that applies a binary function object to its operands
+ */
+template <class Op, class Left, class Right> struct plan_binary {
+  static constexpr bool transposed = Left::transposed || Right::transposed;
+  static constexpr std::size_t operations =
+      1u + Left::operations + Right::operations;
+
+  Op op;
+  Left left;
+  Right right;
+  template <class... I>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(I... i) const {
+    return op(left(i...), right(i...));
+  }
+  BOOST_UBLAS_INLINE void seek(std::size_t i, std::size_t const *idx,
+                               std::size_t a) {
+    left.seek(i, idx, a);
+    right.seek(i, idx, a);
+  }
+
+  template <class R> static constexpr bool packable() {
+    if constexpr (Left::template packable<R>() && Right::template packable<R>())
+      return std::is_invocable_v<
+          Op const &,
+          decltype(std::declval<Left const &>().template packet<R>(0)),
+          decltype(std::declval<Right const &>().template packet<R>(0))>;
+    else
+      return false;
+  }
+  template <class R, class... E>
+  BOOST_UBLAS_INLINE auto packet(std::size_t i, E const &...env) const {
+    return op(left.template packet<R>(i, env...),
+              right.template packet<R>(i, env...));
+  }
+};
+
+/**
+ * @brief Plan node that evaluates one of two alternatives, which is chosen
+ * once for all elements
+ *
+ * @note if_else nodes are created by transforms::simplify_expression.
+ */
+template <class Then, class Else> struct plan_select {
+  static constexpr bool transposed = Then::transposed || Else::transposed;
+  // counts the operations of the first alternative, see
+  // transforms::count_operations
+  static constexpr std::size_t operations = Then::operations;
+
+  bool condition;
+  Then then;
+  Else otherwise;
+  template <class... I>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(I... i) const {
+    return condition ? then(i...) : otherwise(i...);
+  }
+  BOOST_UBLAS_INLINE void seek(std::size_t i, std::size_t const *idx,
+                               std::size_t a) {
+    then.seek(i, idx, a);
+    otherwise.seek(i, idx, a);
+  }
+
+  template <class R> static constexpr bool packable() {
+    if constexpr (Then::template packable<R>() && Else::template packable<R>())
+      return std::is_same_v<
+          decltype(std::declval<Then const &>().template packet<R>(0)),
+          decltype(std::declval<Else const &>().template packet<R>(0))>;
+    else
+      return false;
+  }
+  template <class R, class... E>
+  BOOST_UBLAS_INLINE auto packet(std::size_t i, E const &...env) const {
+    return condition ? then.template packet<R>(i, env...)
+                     : otherwise.template packet<R>(i, env...);
+  }
+};
+
+/**
+ * @brief Returns the type of the elements of an evaluation plan
+ */
+template <class Plan>
+using plan_value_t = std::remove_cv_t<std::remove_reference_t<decltype(
+    std::declval<Plan const &>()(std::size_t{}, std::size_t{}))>>;
+
+template <class A> BOOST_UBLAS_INLINE A const &plan_last(A const &a) {
+  return a;
+}
+template <class A, class B, class... C>
+BOOST_UBLAS_INLINE decltype(auto) plan_last(A const &, B const &b,
+                                            C const &...c) {
+  return plan_last(b, c...);
+}
+
+/**
+ * @brief Returns the environment of an element, i.e. the last argument of a
+ * plan node if it is an environment, or an empty environment
+ */
+template <class... A>
+BOOST_UBLAS_INLINE decltype(auto) plan_environment(A const &...args) {
+  if constexpr ((is_plan_env<A>::value || ...))
+    return plan_last(args...);
+  else
+    return plan_env<>{};
+}
+
+/**
+ * @brief Plan node that reads the value of the shared sub-expression K from
+ * the environment of an element, see plan_let
+ *
+ * @note Plans are only evaluated with an environment that holds the value K.
+ * Without it, e.g. when the type of a plan is computed with plan_value_t, a
+ * default value is returned.
+ */
+template <std::size_t K, class V> struct plan_bound {
+  static constexpr bool transposed = false;
+  static constexpr std::size_t operations = 0u;
+
+  template <class... A>
+  BOOST_UBLAS_INLINE V operator()(A const &...args) const {
+    return lookup<V>(plan_environment(args...));
+  }
+  BOOST_UBLAS_INLINE void seek(std::size_t, std::size_t const *, std::size_t) {}
+
+  template <class R> static constexpr bool packable() {
+    return std::is_same_v<V, R> || std::is_same_v<V, std::complex<R>>;
+  }
+  template <class R, class... E>
+  BOOST_UBLAS_INLINE auto packet(std::size_t, E const &...env) const {
+    return lookup<plan_packet_t<V>>(plan_environment(env...));
+  }
+
+private:
+  template <class X, class Env>
+  static BOOST_UBLAS_INLINE X lookup(Env const &env) {
+    if constexpr (std::is_base_of_v<plan_value<K, X>, Env>)
+      return static_cast<plan_value<K, X> const &>(env).value;
+    else
+      return X{};
+  }
+};
+
+/**
+ * @brief Plan node that evaluates a shared sub-expression once per element
+ * and then its body
+ *
+ * The body is called with an additional argument, the environment of the
+ * element with the value K, which the plan_bound nodes with the index K read,
+ * so that a sub-expression that occurs several times in an expression is
+ * computed once, see transforms::visit_plan. The environment is passed by
+ * value and is kept in registers after inlining.
+ */
+template <std::size_t K, class Shared, class Body> struct plan_let {
+  static constexpr bool transposed = Shared::transposed || Body::transposed;
+  static constexpr std::size_t operations =
+      Shared::operations + Body::operations;
+
+  Shared shared;
+  Body body;
+  template <class... A>
+  BOOST_UBLAS_INLINE auto operator()(A const &...args) const {
+    auto const value = plan_value_t<Shared>(shared(args...));
+    return body(args..., plan_extend<K>(plan_environment(args...), value));
+  }
+  BOOST_UBLAS_INLINE void seek(std::size_t i, std::size_t const *idx,
+                               std::size_t a) {
+    shared.seek(i, idx, a);
+    body.seek(i, idx, a);
+  }
+
+  template <class R> static constexpr bool packable() {
+    if constexpr (Shared::template packable<R>() &&
+                  Body::template packable<R>())
+      return std::is_same_v<
+          decltype(std::declval<Shared const &>().template packet<R>(0)),
+          plan_packet_t<plan_value_t<Shared>>>;
+    else
+      return false;
+  }
+  template <class R, class... E>
+  BOOST_UBLAS_INLINE auto packet(std::size_t i, E const &...env) const {
+    auto const value = shared.template packet<R>(i, env...);
+    return body.template packet<R>(
+        i, plan_extend<K>(plan_environment(env...), value));
+  }
+};
+
+/**
+ * @brief Returns the function object of an arithmetic expression kind.
+ */
+template <::boost::yap::expr_kind Kind> constexpr auto plan_operation() {
+  using ::boost::yap::expr_kind;
+  if constexpr (Kind == expr_kind::plus)
+    return std::plus<>{};
+  else if constexpr (Kind == expr_kind::minus)
+    return std::minus<>{};
+  else if constexpr (Kind == expr_kind::multiplies)
+    return std::multiplies<>{};
+  else if constexpr (Kind == expr_kind::divides)
+    return std::divides<>{};
+  else if constexpr (Kind == expr_kind::negate)
+    return std::negate<>{};
+  else
+    return plan_identity{};
+}
+
+/**
+ * @brief Returns true if an expression can be lowered into an evaluation plan.
+ *
+ * @note Expressions with terminals other than tensors, tensor views,
+ * arithmetic or complex scalars and with operators other than arithmetic operators and
+ * `ublas::apply` are evaluated element by element with YAP.
+ *
+ * @tparam Expr the type of expression to check.
+ */
+template <class Expr> constexpr bool is_plannable() {
+  using namespace ::boost::hana::literals;
+  using ::boost::yap::expr_kind;
+  using E = std::remove_cv_t<std::remove_reference_t<Expr>>;
+  constexpr auto kind = E::kind;
+
+  if constexpr (kind == expr_kind::terminal) {
+    using V = std::remove_cv_t<std::remove_reference_t<decltype(
+        ::boost::yap::value(std::declval<E &>()))>>;
+    return ::boost::numeric::ublas::is_tensor_v<V> ||
+           ::boost::numeric::ublas::is_tensor_view_v<V> ||
+           std::is_arithmetic_v<V> || is_complex_scalar<V>::value;
+  } else if constexpr (kind == expr_kind::plus || kind == expr_kind::minus ||
+                       kind == expr_kind::multiplies ||
+                       kind == expr_kind::divides) {
+    return is_plannable<decltype(::boost::yap::left(std::declval<E &>()))>() &&
+           is_plannable<decltype(::boost::yap::right(std::declval<E &>()))>();
+  } else if constexpr (kind == expr_kind::negate ||
+                       kind == expr_kind::unary_plus) {
+    return is_plannable<decltype(::boost::yap::get(std::declval<E &>(), 0_c))>();
+  } else if constexpr (kind == expr_kind::call) {
+    // ublas::apply(X, f) is represented as call(f, X)
+    if constexpr (decltype(::boost::hana::size(
+                      std::declval<E &>().elements))::value == 2u) {
+      using F = std::remove_cv_t<std::remove_reference_t<decltype(
+          ::boost::yap::value(::boost::yap::get(std::declval<E &>(), 0_c)))>>;
+      return ((std::is_pointer_v<F> &&
+               std::is_function_v<std::remove_pointer_t<F>>) ||
+              is_packet_function<F>::value) &&
+             is_plannable<decltype(::boost::yap::get(std::declval<E &>(), 1_c))>();
+    } else {
+      return false;
+    }
+  } else if constexpr (kind == expr_kind::if_else) {
+    using C = std::remove_cv_t<std::remove_reference_t<decltype(
+        ::boost::yap::get(std::declval<E &>(), 0_c))>>;
+    if constexpr (C::kind == expr_kind::terminal)
+      return std::is_same_v<bool, std::remove_cv_t<std::remove_reference_t<
+                                      decltype(::boost::yap::value(
+                                          std::declval<C &>()))>>> &&
+             is_plannable<decltype(
+                 ::boost::yap::get(std::declval<E &>(), 1_c))>() &&
+             is_plannable<decltype(
+                 ::boost::yap::get(std::declval<E &>(), 2_c))>();
+    else
+      return false;
+  } else {
+    return false;
+  }
+}
+
+/**
+ * @brief Returns true if all tensor views of an expression have the strides
+ * of the target.
+ *
+ * Such views are read like tensors with the layout of the target, see
+ * make_plan. Expressions with other views are evaluated with the strides of
+ * every view, see run_plan_broadcast.
+ *
+ * @param expr the expression to check
+ * @param p rank of the target
+ * @param w strides of the target
+ */
+template <class Expr>
+BOOST_UBLAS_INLINE bool has_target_strides(Expr const &expr, std::size_t p,
+                                           std::size_t const *w) {
+  using E = std::remove_cv_t<std::remove_reference_t<Expr>>;
+  if constexpr (E::kind == ::boost::yap::expr_kind::terminal) {
+    using V = std::remove_cv_t<std::remove_reference_t<decltype(
+        ::boost::yap::value(expr))>>;
+    if constexpr (::boost::numeric::ublas::is_tensor_view_v<V>) {
+      auto const &v = ::boost::yap::value(expr);
+      return v.rank() == p &&
+             std::equal(v.strides().begin(), v.strides().end(), w,
+                        [](std::ptrdiff_t a, std::size_t b) {
+                          return a == std::ptrdiff_t(b);
+                        });
+    } else {
+      return true;
+    }
+  } else {
+    return ::boost::hana::unpack(expr.elements, [p, w](auto const &...e) {
+      return (has_target_strides(e, p, w) && ...);
+    });
+  }
+}
+
+/**
+ * @brief The types of the shared sub-expressions that are lowered into
+ * plan_bound nodes, i.e. the sub-expressions K >= First.
+ */
+template <std::size_t First, class... Shared> struct plan_bindings {
+  static constexpr std::size_t size = sizeof...(Shared);
+  template <std::size_t L> using from = plan_bindings<L, Shared...>;
+
+  /**
+   * @brief Returns the index K >= First of the shared sub-expression with the
+   * type E or size if there is none.
+   */
+  template <class E> static constexpr std::size_t index() {
+    constexpr bool same[] = {false, std::is_same_v<E, Shared>...};
+    for (auto k = First; k < size; ++k)
+      if (same[k + 1u]) return k;
+    return size;
+  }
+};
+
+/**
+ * @brief Lowers an expression into an evaluation plan.
+ *
+ * @note requires is_plannable<Expr>() and that all tensors outlive the plan.
+ *
+ * @tparam layout_type the layout of the target
+ * @tparam broadcast lowers all tensors and views into plan_broadcast_tensor
+ * nodes. Otherwise views are lowered into plan_tensor nodes and must have the
+ * strides of the target, see has_target_strides.
+ * @tparam Bindings lowers the shared sub-expressions into plan_bound nodes,
+ * see plan_let
+ *
+ * @param expr the expression to lower
+ *
+ * @return a function object that returns the ith element of the expression.
+ * If the expression contains tensors with another layout than layout_type,
+ * i.e. transposed is true, it returns the element with the offset i in
+ * layout_type and the offset j in the transposed layout.
+ */
+template <class layout_type, bool broadcast = false,
+          class Bindings = plan_bindings<0u>, class Expr>
+BOOST_UBLAS_INLINE auto make_plan(Expr &expr) {
+  using namespace ::boost::hana::literals;
+  using ::boost::yap::expr_kind;
+  using E = std::remove_cv_t<std::remove_reference_t<Expr>>;
+  constexpr auto kind = E::kind;
+  constexpr auto k = Bindings::template index<E>();
+
+  if constexpr (k < Bindings::size) {
+    using shared_type = decltype(
+        make_plan<layout_type, broadcast,
+                  typename Bindings::template from<k + 1u>>(expr));
+    return plan_bound<k, plan_value_t<shared_type>>{};
+  } else if constexpr (kind == expr_kind::terminal) {
+    auto const &v = ::boost::yap::value(expr);
+    using V = std::remove_cv_t<std::remove_reference_t<decltype(v)>>;
+    if constexpr (::boost::numeric::ublas::is_tensor_v<V>) {
+      if constexpr (broadcast)
+        return plan_broadcast_tensor<typename V::value_type>{
+            v.data(), v.rank(), v.extents().data(), v.strides().data()};
+      else if constexpr (std::is_same_v<typename V::layout_type, layout_type>)
+        return plan_tensor<typename V::value_type>{v.data()};
+      else
+        return plan_transposed_tensor<typename V::value_type>{v.data()};
+    } else if constexpr (::boost::numeric::ublas::is_tensor_view_v<V>) {
+      if constexpr (broadcast)
+        return plan_broadcast_tensor<typename V::value_type, std::ptrdiff_t>{
+            v.data(), v.rank(), v.extents().data(), v.strides().data()};
+      else
+        return plan_tensor<typename V::value_type>{v.data()};
+    } else
+      return plan_scalar<V>{v};
+  } else if constexpr (kind == expr_kind::negate ||
+                       kind == expr_kind::unary_plus) {
+    auto operand = make_plan<layout_type, broadcast, Bindings>(
+        ::boost::yap::get(expr, 0_c));
+    using Op = decltype(plan_operation<kind>());
+    return plan_unary<Op, decltype(operand)>{Op{}, operand};
+  } else if constexpr (kind == expr_kind::call) {
+    auto f = ::boost::yap::value(::boost::yap::get(expr, 0_c));
+    auto operand = make_plan<layout_type, broadcast, Bindings>(
+        ::boost::yap::get(expr, 1_c));
+    return plan_unary<decltype(f), decltype(operand)>{f, operand};
+  } else if constexpr (kind == expr_kind::if_else) {
+    bool const condition =
+        ::boost::yap::value(::boost::yap::get(expr, 0_c));
+    auto then = make_plan<layout_type, broadcast, Bindings>(
+        ::boost::yap::get(expr, 1_c));
+    auto otherwise = make_plan<layout_type, broadcast, Bindings>(
+        ::boost::yap::get(expr, 2_c));
+    return plan_select<decltype(then), decltype(otherwise)>{condition, then,
+                                                            otherwise};
+  } else {
+    auto left =
+        make_plan<layout_type, broadcast, Bindings>(::boost::yap::left(expr));
+    auto right =
+        make_plan<layout_type, broadcast, Bindings>(::boost::yap::right(expr));
+    using Op = decltype(plan_operation<kind>());
+    return plan_binary<Op, decltype(left), decltype(right)>{Op{}, left, right};
+  }
+}
+
+/**
+ * @brief Returns true if a plan is evaluated with registers of type P that
+ * hold elements or real and imaginary parts of type R.
+ */
+template <class Plan, class R, class P> constexpr bool is_packed_plan() {
+  if constexpr (std::is_floating_point_v<R> && simd::pack<R>::width > 1u) {
+    if constexpr (Plan::template packable<R>())
+      return std::is_same_v<
+          decltype(std::declval<Plan const &>().template packet<R>(0)), P>;
+    else
+      return false;
+  } else {
+    return false;
+  }
+}
+
+/**
+ * @brief Writes the elements first,...,last-1 of an evaluation plan into a
+ * contiguous array.
+ *
+ * Packed plans evaluate the elements before the first aligned address and the
+ * remaining elements after the last full register one by one.
+ */
+template <class Plan, class T>
+BOOST_UBLAS_INLINE void run_plan_range(Plan const &plan, T *out,
+                                       std::size_t const first,
+                                       std::size_t const last) {
+  using R = typename real_scalar<T>::type;
+  using packet_type = std::conditional_t<is_complex_scalar<T>::value,
+                                         simd::cpack<R>, simd::pack<R>>;
+  if constexpr (is_packed_plan<Plan, R, packet_type>()) {
+    constexpr auto w = packet_type::width;
+    auto i = first;
+    for (; i < last &&
+           reinterpret_cast<std::uintptr_t>(out + i) % (w * sizeof(T)) != 0u;
+         ++i)
+      out[i] = plan(i);
+    for (; i + w <= last; i += w) plan.template packet<R>(i).store(out + i);
+    for (; i < last; ++i) out[i] = plan(i);
+  } else {
+    for (auto i = first; i < last; ++i) out[i] = plan(i);
+  }
+}
+
+/**
+ * @brief Writes the elements of an evaluation plan into a contiguous array.
+ *
+ * The elements are partitioned into contiguous blocks across the threads of an
+ * OpenMP team if the array is large enough, see ublas::set_parallel_threshold.
+ *
+ * @param plan evaluation plan returned by make_plan
+ * @param out pointer to the first element of the output array
+ * @param n number of elements
+ */
+template <class Plan, class T>
+BOOST_UBLAS_INLINE void run_plan(Plan const &plan, T *out, std::size_t n) {
+  parallel::for_each_range(n, n, [&plan, out](std::size_t first,
+                                               std::size_t last) {
+    run_plan_range(plan, out, first, last);
+  });
+}
+
+/**
+ * @brief Writes the elements of an evaluation plan with broadcast tensors
+ * into an array.
+ *
+ * The array is written row by row along its fastest mode a. Every thread
+ * moves its own copy of the plan to the first element of a row, see
+ * plan_broadcast_tensor::seek, so that the broadcast tensors are read with a
+ * constant stride within the row. The rows are partitioned across the threads
+ * of an OpenMP team if the array is large enough, see
+ * ublas::set_parallel_threshold.
+ *
+ * @param plan evaluation plan returned by make_plan with broadcast = true
+ * @param out pointer to the first element of the output array
+ * @param p rank of the output
+ * @param n pointer to the extents of the output
+ * @param wi pointer to the strides of the output
+ */
+template <class Plan, class T>
+void run_plan_broadcast(Plan const &plan, T *out, std::size_t const p,
+                        std::size_t const *n, std::size_t const *wi) {
+  // a is the fastest mode of the output with an extent greater than one so
+  // that its stride is one, the other modes are visited by increasing strides
+  auto a = std::size_t{0};
+  for (auto r = 0ul; r < p; ++r)
+    if (n[r] > 1u && (n[a] < 2u || wi[r] < wi[a])) a = r;
+  auto outer = std::vector<std::size_t>{};
+  for (auto r = 0ul; r < p; ++r)
+    if (r != a && n[r] > 1u) outer.push_back(r);
+  std::sort(outer.begin(), outer.end(),
+            [wi](auto l, auto r) { return wi[l] < wi[r]; });
+
+  auto const size = std::accumulate(n, n + p, std::size_t{1},
+                                    std::multiplies<std::size_t>{});
+  parallel::for_each_range(
+      size, size / n[a], [&](std::size_t first, std::size_t last) {
+        auto local = plan;
+        auto idx = std::vector<std::size_t>(p, 0u);
+        for (auto t = first; t < last; ++t) {
+          auto k = t, i = std::size_t{0};
+          for (auto r : outer) {
+            idx[r] = k % n[r];
+            i += idx[r] * wi[r];
+            k /= n[r];
+          }
+          local.seek(i, idx.data(), a);
+          run_plan_range(local, out, i, i + n[a]);
+        }
+      });
+}
+
+/**
+ * @brief Returns the layout of tensors that is not layout_type
+ */
+template <class layout_type>
+using transposed_layout_t =
+    std::conditional_t<std::is_same_v<layout_type, first_order>, last_order,
+                       first_order>;
+
+/**
+ * @brief Writes the elements of an evaluation plan with transposed tensors
+ * into an array.
+ *
+ * The elements are visited in tiles of the fastest modes of both layouts.
+ * Every tile is written contiguously into the output and reads a few cache
+ * lines of every transposed tensor. The tiles are partitioned across the
+ * threads of an OpenMP team if the array is large enough, see
+ * ublas::set_parallel_threshold.
+ *
+ * @param plan evaluation plan returned by make_plan with transposed tensors
+ * @param out pointer to the first element of the output array
+ * @param p rank of the output
+ * @param n pointer to the extents of the output
+ * @param wi pointer to the strides of the output
+ * @param wj pointer to the strides of the transposed layout
+ */
+template <class Plan, class T>
+void run_plan_tiled(Plan const &plan, T *out, std::size_t const p,
+                    std::size_t const *n, std::size_t const *wi,
+                    std::size_t const *wj) {
+  constexpr auto tile = std::size_t{64};
+
+  // a is the fastest mode of the output, b the fastest mode of the transposed
+  // layout, both ignoring modes with extent one.
+  auto a = p, b = p;
+  for (auto r = 0ul; r < p; ++r) {
+    if (n[r] < 2u) continue;
+    if (a == p || wi[r] < wi[a]) a = r;
+    if (b == p || wj[r] < wj[b]) b = r;
+  }
+
+  auto const size = std::accumulate(n, n + p, std::size_t{1},
+                                    std::multiplies<std::size_t>{});
+  if (a == b) {
+    // at most one extent is greater than one and both layouts coincide
+    for (auto i = 0ul; i < size; ++i) out[i] = plan(i, i);
+    return;
+  }
+
+  auto outer = std::vector<std::size_t>{};
+  for (auto r = 0ul; r < p; ++r)
+    if (r != a && r != b && n[r] > 1u) outer.push_back(r);
+
+  auto const tiles_b = (n[b] + tile - 1u) / tile;
+  auto const outer_size = size / (n[a] * n[b]);
+
+  parallel::for_each_range(
+      size, outer_size * tiles_b, [&](std::size_t first, std::size_t last) {
+        for (auto t = first; t < last; ++t) {
+          auto k = t / tiles_b;
+          auto oi = std::size_t{0}, oj = std::size_t{0};
+          for (auto r : outer) {
+            oi += (k % n[r]) * wi[r];
+            oj += (k % n[r]) * wj[r];
+            k /= n[r];
+          }
+          auto const b0 = (t % tiles_b) * tile;
+          auto const b1 = std::min(b0 + tile, n[b]);
+          for (auto a0 = 0ul; a0 < n[a]; a0 += tile) {
+            auto const a1 = std::min(a0 + tile, n[a]);
+            for (auto ib = b0; ib < b1; ++ib) {
+              auto const bi = oi + ib * wi[b], bj = oj + ib * wj[b];
+              for (auto ia = a0; ia < a1; ++ia) {
+                auto const i = bi + ia * wi[a];
+                out[i] = plan(i, bj + ia * wj[a]);
+              }
+            }
+          }
+        }
+      });
+}
+
+}  // namespace boost::numeric::ublas::detail
+
+#endif
@@ -23,29 +23,42 @@ template <::boost::yap::expr_kind K, typename A> struct tensor_expression;
 
 } // namespace boost::numeric::ublas::detail
 
+/*
+ * Relational operators build a tensor_expression which is evaluated by its
+ * conversion to bool, see tensor_expression::operator bool.
+ *
+ * == and != compare the extents of both sides first. Different extents make ==
+ * false and != true without comparing elements, also if the extents could be
+ * broadcast, e.g. {4,3} and {4,1}. <, <=, > and >= broadcast both sides like
+ * the arithmetic operators, see transforms::get_extents, and compare the
+ * elements at the multi-indices of the broadcast extents. They throw a
+ * std::runtime_error only if the extents cannot be broadcast, and no longer
+ * for all different extents.
+ */
+
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     less, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     less_equal, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     equal_to, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     not_equal_to, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     greater, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_UDT_ANY_BINARY_OPERATOR(
     greater_equal, boost::numeric::ublas::detail::tensor_expression,
-    boost::numeric::ublas::is_tensor)
+    boost::numeric::ublas::is_tensor_operand)
 
 BOOST_YAP_USER_BINARY_OPERATOR(equal_to,
                                boost::numeric::ublas::detail::tensor_expression,
@@ -16,8 +16,13 @@
 
 #include <boost/type_traits/has_multiplies.hpp>
 #include <boost/yap/yap.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include "expression_transforms_traits.hpp"
 #include "extents.hpp"
+#include "strides.hpp"
 #include "ublas_type_traits.hpp"
 
 namespace boost::numeric::ublas {
@@ -27,11 +32,17 @@ namespace detail {
 template <boost::yap::expr_kind Kind, typename Tuple>
 struct tensor_expression;
 
+template <class tensor_type>
+class einstein_network;
+
 }
 
-template <class T, class F, class A>
+template <class T, class F, class A, class E>
 class tensor;
 
+template <class T, class F>
+class tensor_view;
+
 template <class T, class F, class A>
 class matrix;
 
@@ -53,12 +64,18 @@ namespace boost::numeric::ublas::detail::transforms {
  *
  */
 struct at_index {
-  template <class T, class F, class A>
+  template <class T, class F, class A, class E>
   BOOST_UBLAS_INLINE decltype(auto) operator()(
       ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
-      ::boost::numeric::ublas::tensor<T, F, A> const &terminal) {
+      ::boost::numeric::ublas::tensor<T, F, A, E> const &terminal) {
     return ::boost::yap::make_terminal(terminal(index));
   }
+  template <class T, class F>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::tensor_view<T, F> const &terminal) {
+    return ::boost::yap::make_terminal(std::as_const(terminal(index)));
+  }
   template <class T, class F, class A>
   BOOST_UBLAS_INLINE decltype(auto) operator()(
       ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
@@ -83,9 +100,91 @@ struct at_index {
       ::boost::numeric::ublas::vector_expression<Expr> &terminal) {
     return ::boost::yap::make_terminal(terminal()(index));
   }
+  // the network is contracted by the first access only
+  template <class tensor_type>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::detail::einstein_network<tensor_type> const
+          &terminal) {
+    return ::boost::yap::make_terminal(terminal.at(index));
+  }
   size_t index;
 };
 
+/**
+ * @brief A transform that extracts the element at the offset index of
+ * layout_type from terminal types.
+ *
+ * @note Tensors with another layout return the element with the same
+ * multi-index, which is at another offset of their own data. All other
+ * terminals are transformed like with at_index.
+ *
+ * @tparam layout_type the layout in which index is given, i.e. the layout of
+ * the target of an evaluation.
+ */
+template <class layout_type> struct at_layout_index : at_index {
+  using at_index::operator();
+
+  template <class T, class A, class E>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::tensor<T, layout_type, A, E> const &terminal) {
+    return ::boost::yap::make_terminal(terminal(index));
+  }
+  template <class T, class F, class A, class E>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::tensor<T, F, A, E> const &terminal) {
+    // visits the modes from the largest to the smallest stride of layout_type
+    auto const p = terminal.rank();
+    auto const &w = terminal.strides();
+    auto r = index, j = std::size_t{0};
+    for (auto k = 0ul; k < p; ++k) {
+      auto const m = std::is_same_v<layout_type, first_order> ? p - 1 - k : k;
+      j += r / strides[m] * w[m];
+      r %= strides[m];
+    }
+    return ::boost::yap::make_terminal(terminal[j]);
+  }
+  template <class T, class F>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::tensor_view<T, F> const &terminal) {
+    auto const p = terminal.rank();
+    auto const &w = terminal.strides();
+    auto r = index;
+    auto j = std::ptrdiff_t{0};
+    for (auto k = 0ul; k < p; ++k) {
+      auto const m = std::is_same_v<layout_type, first_order> ? p - 1 - k : k;
+      j += std::ptrdiff_t(r / strides[m]) * w[m];
+      r %= strides[m];
+    }
+    return ::boost::yap::make_terminal(std::as_const(terminal.data()[j]));
+  }
+  // strides of the target in layout_type
+  std::size_t const *strides;
+};
+
+/**
+ * @brief Returns true if the extents from are broadcast to the extents to
+ *
+ * The shorter extents are padded with trailing ones, e.g. {4} and {4,1} are
+ * the same extents. Every mode of from must have the extent of the mode of to
+ * or the extent one.
+ */
+template <class FromExtents, class ToExtents>
+BOOST_UBLAS_INLINE bool broadcasts_to(FromExtents const &from,
+                                      ToExtents const &to) {
+  if (from.empty() || to.empty()) return from.empty() && to.empty();
+  auto const p = std::max(from.size(), to.size());
+  for (auto r = 0ul; r < p; ++r) {
+    auto const f = r < from.size() ? from[r] : 1u;
+    auto const t = r < to.size() ? to[r] : 1u;
+    if (f != t && f != 1u) return false;
+  }
+  return true;
+}
+
 /*
  * We assume that basic_extents<size_t>(1) is a scalar; Every Scalar operand
  * returns this value.
@@ -94,17 +193,40 @@ struct at_index {
 /**
  * @brief This transform returns the extent of the expression.
  *
+ * The extents of the operands of a binary operation are broadcast like in
+ * NumPy except that the shorter extents are padded with trailing ones: every
+ * pair of modes must have the same extent or one of them the extent one, e.g.
+ * {4,3,2} + {1,3} has the extents {4,3,2}.
+ *
+ * Unlike NumPy, which pads leading ones and aligns the last modes, the modes
+ * are aligned from the first one. This keeps the convention of the library
+ * that trailing modes with the extent one can be dropped, e.g. vectors have
+ * the extents {n,1}. For example {3,2} and {4,3,2} are not broadcast because
+ * they differ in the first mode, whereas NumPy yields {4,3,2}, and {4,3} and
+ * {4,3,2} yield {4,3,2} where NumPy throws.
+ *
+ * Operands with the extent one in a mode are read with the stride zero in this
+ * mode during the evaluation, see at_broadcast_index and
+ * detail::run_plan_broadcast.
+ *
  * @note If any extent inconsistency is found, this transform throws a runtime
  * exception. Also note that for vector the returned extent is `{vec.size, 1}`
  * and for matrix it is `{mat.size1, mat.size2}`.
+ *
+ * @note broadcasting is true after the transform if the extents of two
+ * operands differ.
  */
 
 struct get_extents {
-  template <class T, class F, class A>
+  template <class T, class F, class A, class E>
   constexpr decltype(auto) operator()(
       ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
-      ::boost::numeric::ublas::tensor<T, F, A> &terminal) {
-    return terminal.extents();
+      ::boost::numeric::ublas::tensor<T, F, A, E> &terminal) {
+    // static_extents and fixed_rank_extents are broadcast as shape
+    if constexpr (std::is_same_v<E, ::boost::numeric::ublas::shape>)
+      return terminal.extents();
+    else
+      return ::boost::numeric::ublas::shape(terminal.extents());
   }
   // This overload must be existing for const-refences
   // YAP takes everything by reference (non-const)
@@ -113,10 +235,43 @@ struct get_extents {
   // tensor-terminal. It is important to have this overload for it.
   // We can omit for other terminal types because we know only
   // contractions are defined for tensor terminals.
-  template <class T, class F, class A>
+  template <class T, class F, class A, class E>
+  constexpr decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::tensor<T, F, A, E> const &terminal) {
+    if constexpr (std::is_same_v<E, ::boost::numeric::ublas::shape>)
+      return terminal.extents();
+    else
+      return ::boost::numeric::ublas::shape(terminal.extents());
+  }
+
+  // Sub-tensors such as A(r1,r2) are stored by value in an expression and
+  // would match the overload of scalars below without this overload.
+  template <class T, class F>
+  constexpr decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::tensor_view<T, F> &terminal) {
+    return terminal.extents();
+  }
+  template <class T, class F>
   constexpr decltype(auto) operator()(
       ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
-      ::boost::numeric::ublas::tensor<T, F, A> const &terminal) {
+      ::boost::numeric::ublas::tensor_view<T, F> const &terminal) {
+    return terminal.extents();
+  }
+
+  template <class tensor_type>
+  constexpr decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::detail::einstein_network<tensor_type>
+          &terminal) {
+    return terminal.extents();
+  }
+  template <class tensor_type>
+  constexpr decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::detail::einstein_network<tensor_type> const
+          &terminal) {
     return terminal.extents();
   }
 
@@ -146,19 +301,7 @@ struct get_extents {
         ::boost::yap::as_expr<
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot Subtract Tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot Subtract Tensor of shapes ");
   }
 
   template <class LExpr, class RExpr>
@@ -173,19 +316,7 @@ struct get_extents {
         ::boost::yap::as_expr<
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot Multiply Tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot Multiply Tensor of shapes ");
   }
 
   template <class LExpr, class RExpr>
@@ -200,19 +331,7 @@ struct get_extents {
         ::boost::yap::as_expr<
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot Divide Tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot Divide Tensor of shapes ");
   }
 
   template <class LExpr, class RExpr>
@@ -228,19 +347,7 @@ struct get_extents {
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
 
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot Add Tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot Add Tensor of shapes ");
   }
 
   template <class Expr>
@@ -274,19 +381,7 @@ struct get_extents {
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
 
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot perform == on tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot perform == on tensor of shapes ");
   }
 
   template <class LExpr, class RExpr>
@@ -302,19 +397,7 @@ struct get_extents {
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
 
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot perform != on tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot perform != on tensor of shapes ");
   }
   template <class LExpr, class RExpr>
   constexpr decltype(auto) operator()(
@@ -329,19 +412,7 @@ struct get_extents {
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
 
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot perform < on tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot perform < on tensor of shapes ");
   }
   template <class LExpr, class RExpr>
   constexpr decltype(auto) operator()(
@@ -356,19 +427,7 @@ struct get_extents {
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
 
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot perform > on tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot perform > on tensor of shapes ");
   }
   template <class LExpr, class RExpr>
   constexpr decltype(auto) operator()(
@@ -383,19 +442,7 @@ struct get_extents {
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
 
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot perform >= on tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot perform >= on tensor of shapes ");
   }
   template <class LExpr, class RExpr>
   constexpr decltype(auto) operator()(
@@ -410,19 +457,7 @@ struct get_extents {
             ::boost::numeric::ublas::detail::tensor_expression>(rexpr),
         *this);
 
-    if (left.is_free_scalar() && right.is_free_scalar())
-      return basic_extents<size_t>{1};
-    else if (left.is_free_scalar())
-      return right;
-    else if (right.is_free_scalar())
-      return left;
-    else {
-      if (left != right)
-        throw std::runtime_error("Cannot perform <= on tensor of shapes " +
-                                 left.to_string() + " and " +
-                                 right.to_string());
-      return left;
-    }
+    return broadcast(left, right, "Cannot perform <= on tensor of shapes ");
   }
 
   template <class Func, class Arg>
@@ -452,6 +487,107 @@ struct get_extents {
     } else
       return basic_extents<size_t>{1};
   }
+
+  /**
+   * @brief Returns the broadcast extents of two operands
+   *
+   * @param error message of the exception if the extents are not compatible
+   */
+  template <class LExtents, class RExtents>
+  basic_extents<size_t> broadcast(LExtents const &left, RExtents const &right,
+                                  std::string const &error) {
+    if (left.is_free_scalar() && right.is_free_scalar())
+      return basic_extents<size_t>{1};
+    else if (left.is_free_scalar())
+      return right;
+    else if (right.is_free_scalar())
+      return left;
+    else if (left == right)
+      return left;
+
+    if (left.empty() || right.empty())
+      throw std::runtime_error(error + left.to_string() + " and " +
+                               right.to_string());
+
+    auto const p = std::max(left.size(), right.size());
+    auto n = typename basic_extents<size_t>::base_type(p, 1u);
+    for (auto r = 0ul; r < p; ++r) {
+      auto const nl = r < left.size() ? left[r] : 1u;
+      auto const nr = r < right.size() ? right[r] : 1u;
+      if (nl != nr && nl != 1u && nr != 1u)
+        throw std::runtime_error(error + left.to_string() + " and " +
+                                 right.to_string());
+      n[r] = std::max(nl, nr);
+    }
+    broadcasting = true;
+    return basic_extents<size_t>(std::move(n));
+  }
+
+  bool broadcasting = false;
+};
+
+/**
+ * @brief A transform that extracts the element of terminal types at the
+ * multi-index of the ith element of the target with broadcasting.
+ *
+ * Modes in which a terminal has the extent one and modes beyond its rank are
+ * read with the index zero, see get_extents. All other terminals are
+ * transformed like with at_index.
+ */
+struct at_broadcast_index : at_index {
+  using at_index::operator();
+
+  template <class T, class F, class A, class E>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::tensor<T, F, A, E> const &terminal) {
+    return ::boost::yap::make_terminal(terminal[std::size_t(offset(
+        terminal.rank(), terminal.extents().data(), terminal.strides().data()))]);
+  }
+  template <class T, class F>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::tensor_view<T, F> const &terminal) {
+    auto const j = offset(terminal.rank(), terminal.extents().data(),
+                          terminal.strides().data());
+    return ::boost::yap::make_terminal(std::as_const(terminal.data()[j]));
+  }
+  template <class T, class F, class A>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::matrix<T, F, A> const &terminal) {
+    return ::boost::yap::make_terminal(
+        terminal(terminal.size1() > 1u ? index_of(0u) : 0u,
+                 terminal.size2() > 1u && p > 1u ? index_of(1u) : 0u));
+  }
+  template <class T, class A>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::vector<T, A> const &terminal) {
+    return ::boost::yap::make_terminal(
+        terminal(terminal.size() > 1u ? index_of(0u) : 0u));
+  }
+
+  // index of mode r of the ith element of the target
+  BOOST_UBLAS_INLINE std::size_t index_of(std::size_t r) const {
+    return index / strides[r] % n[r];
+  }
+
+  // offset of the element of a terminal with the rank q, extents nt and
+  // signed or unsigned strides wt
+  template <class Stride>
+  BOOST_UBLAS_INLINE std::ptrdiff_t offset(std::size_t q, std::size_t const *nt,
+                                           Stride const *wt) const {
+    auto j = std::ptrdiff_t{0};
+    for (auto r = 0ul; r < std::min(p, q); ++r)
+      if (nt[r] > 1u) j += std::ptrdiff_t(index_of(r)) * std::ptrdiff_t(wt[r]);
+    return j;
+  }
+
+  // rank, extents and strides of the target
+  std::size_t p;
+  std::size_t const *n;
+  std::size_t const *strides;
 };
 
 /**
@@ -684,6 +820,28 @@ struct is_equality_or_non_equality_extent_same {
 
   bool status = false;
 };
+
+/**
+ * @brief A transform that contracts every lazy product of tensors in Einstein
+ * notation and replaces it by a terminal with the resulting tensor.
+ *
+ * @note The resulting tensors are temporaries of type
+ * einstein_network::buffer_type and are therefore taken from the current
+ * tensor_arena of the thread if there is one.
+ */
+struct materialize_einstein {
+  template <class tensor_type>
+  BOOST_UBLAS_INLINE decltype(auto) operator()(
+      ::boost::yap::expr_tag<::boost::yap::expr_kind::terminal>,
+      ::boost::numeric::ublas::detail::einstein_network<tensor_type> const
+          &terminal) {
+    using network_type =
+        ::boost::numeric::ublas::detail::einstein_network<tensor_type>;
+    return ::boost::yap::make_terminal<
+        ::boost::numeric::ublas::detail::tensor_expression>(
+        terminal.template evaluate<typename network_type::buffer_type>());
+  }
+};
 }  // namespace boost::numeric::ublas::detail::transforms
 
 #endif
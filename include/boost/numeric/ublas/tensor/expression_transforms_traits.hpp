@@ -28,6 +28,7 @@
 
 namespace boost::numeric::ublas::detail {
 template <::boost::yap::expr_kind, typename> struct tensor_expression;
+template <class> class einstein_network;
 }
 
 namespace boost::numeric::ublas::detail::transforms {
@@ -142,6 +143,126 @@ struct is_scalar_multiply<::boost::numeric::ublas::detail::tensor_expression<
   static constexpr bool value = first_scalar || second_scalar;
 };
 
+/**
+ * @brief A False type trait for finding if a type is a lazy product of tensors
+ * in Einstein notation
+ *
+ * @tparam T The type to check for.
+ */
+template <class T> struct is_einstein_network {
+  static constexpr bool value = false;
+};
+
+/**
+ * @brief A True type trait for finding if a type is a lazy product of tensors
+ * in Einstein notation
+ *
+ * @tparam T The type to check for.
+ */
+template <class T>
+struct is_einstein_network<::boost::numeric::ublas::detail::einstein_network<T>> {
+  static constexpr bool value = true;
+};
+
+/**
+ * @brief A False type trait for finding if a tensor expression has a terminal
+ * with a lazy product of tensors in Einstein notation
+ *
+ * @tparam T The type of expression to check for.
+ */
+template <class T> struct has_einstein_network {
+  static constexpr bool value = false;
+};
+
+/**
+ * @brief A type trait for finding if a tensor expression has a terminal with a
+ * lazy product of tensors in Einstein notation
+ *
+ * @note Sub-expressions that are held by reference are stored as pointers.
+ *
+ * @tparam Kind The Kind of Operation represented
+ * @tparam Ts The operands of the expression
+ */
+template <::boost::yap::expr_kind Kind, class... Ts>
+struct has_einstein_network<::boost::numeric::ublas::detail::tensor_expression<
+    Kind, ::boost::hana::tuple<Ts...>>> {
+  template <class T>
+  using bare_t = std::remove_cv_t<std::remove_pointer_t<std::remove_reference_t<T>>>;
+
+  static constexpr bool value =
+      Kind == ::boost::yap::expr_kind::terminal
+          ? (is_einstein_network<bare_t<Ts>>::value || ...)
+          : (has_einstein_network<bare_t<Ts>>::value || ...);
+};
+
+/**
+ * @brief A False type trait for finding if a type is a tensor with a layout
+ * other than layout_type
+ *
+ * @tparam layout_type The layout of the target
+ * @tparam T The type to check for.
+ */
+template <class layout_type, class T> struct is_transposed_tensor {
+  static constexpr bool value = false;
+};
+
+/**
+ * @brief A type trait for finding if a type is a tensor with a layout other
+ * than layout_type
+ *
+ * @tparam layout_type The layout of the target
+ * @tparam T The type to check for.
+ */
+template <class layout_type, class T, class F, class A, class E>
+struct is_transposed_tensor<layout_type,
+                            ::boost::numeric::ublas::tensor<T, F, A, E>> {
+  static constexpr bool value = !std::is_same_v<F, layout_type>;
+};
+
+/**
+ * @brief A True type trait for tensor views which are always read at the
+ * multi-index of the element in the target because of their arbitrary strides
+ *
+ * @tparam layout_type The layout of the target
+ */
+template <class layout_type, class T, class F>
+struct is_transposed_tensor<layout_type,
+                            ::boost::numeric::ublas::tensor_view<T, F>> {
+  static constexpr bool value = true;
+};
+
+/**
+ * @brief A False type trait for finding if a tensor expression has a tensor
+ * terminal with a layout other than layout_type
+ *
+ * @tparam layout_type The layout of the target
+ * @tparam T The type of expression to check for.
+ */
+template <class layout_type, class T> struct has_transposed_tensor {
+  static constexpr bool value = false;
+};
+
+/**
+ * @brief A type trait for finding if a tensor expression has a tensor terminal
+ * with a layout other than layout_type
+ *
+ * @tparam layout_type The layout of the target
+ * @tparam Kind The Kind of Operation represented
+ * @tparam Ts The operands of the expression
+ */
+template <class layout_type, ::boost::yap::expr_kind Kind, class... Ts>
+struct has_transposed_tensor<
+    layout_type, ::boost::numeric::ublas::detail::tensor_expression<
+                     Kind, ::boost::hana::tuple<Ts...>>> {
+  template <class T>
+  using bare_t = std::remove_cv_t<std::remove_pointer_t<std::remove_reference_t<T>>>;
+
+  static constexpr bool value =
+      Kind == ::boost::yap::expr_kind::terminal
+          ? (is_transposed_tensor<layout_type, bare_t<Ts>>::value || ...)
+          : (has_transposed_tensor<layout_type, bare_t<Ts>>::value || ...);
+};
+
 } // namespace boost::numeric::ublas::detail::transforms
 
 #endif // UBLAS_EXPRESSION_TRANSFORMS_TRAITS_HPP
@@ -101,11 +101,12 @@ template <class Expr> BOOST_UBLAS_INLINE decltype(auto) get_type(Expr &&e) {
   if constexpr (is_terminal_type_expr<std::remove_reference_t<Expr_t>>::value) {
     using type = typename is_terminal_type_expr<
         std::remove_reference_t<Expr_t>>::value_type;
-    if constexpr (::boost::numeric::ublas::is_tensor_v<type> ||
+    if constexpr (::boost::numeric::ublas::is_tensor_operand_v<type> ||
                   ::boost::numeric::ublas::is_vector_v<type> ||
                   ::boost::numeric::ublas::is_matrix_v<type> ||
                   ::boost::numeric::ublas::is_matrix_expression_v<type> ||
-                  ::boost::numeric::ublas::is_vector_expression_v<type>) {
+                  ::boost::numeric::ublas::is_vector_expression_v<type> ||
+                  transforms::is_einstein_network<type>::value) {
       typename type::value_type s{};
       return s;
     } else
@@ -127,9 +128,15 @@ template <class Expr> BOOST_UBLAS_INLINE decltype(auto) get_type(Expr &&e) {
           ::boost::yap::make_expression<Expr_t::kind>(left_t, right_t));
     }
   } else {
-    using ret_t = typename function_return<std::remove_reference_t<decltype(
-        ::boost::yap::value(::boost::yap::get(expr, 0_c)))>>::type;
-    return ret_t{};
+    using F = std::remove_cv_t<std::remove_reference_t<decltype(
+        ::boost::yap::value(::boost::yap::get(expr, 0_c)))>>;
+    if constexpr (is_packet_function<F>::value) {
+      auto arg = get_type(::boost::yap::get(expr, 1_c));
+      return F{}(arg);
+    } else {
+      using ret_t = typename function_return<F>::type;
+      return ret_t{};
+    }
   }
 }
 
@@ -170,6 +177,27 @@ template <class Expr> constexpr void assert_no_ublas_terminal(Expr &&e) {
   }
 }
 
+/**
+ * @brief Returns the callable that is stored in the expression of
+ * `ublas::apply`.
+ *
+ * @note Function objects for which is_packet_function is true are stored as
+ * they are, all others are converted into a function pointer.
+ *
+ * @tparam Arg The value type of the expression that the callable is applied to.
+ */
+template <class Arg, class Callable>
+constexpr auto apply_callable(Callable c) {
+  if constexpr (is_packet_function<Callable>::value) {
+    return c;
+  } else {
+    using ret_t =
+        std::remove_reference_t<decltype(c(std::declval<Arg const &>()))>;
+    ret_t (*func)(Arg const &) = c;
+    return func;
+  }
+}
+
 /**
  * @brief The end condition for terminating the varidiac `ublas::apply_impl`
  * calls
@@ -206,7 +234,7 @@ constexpr decltype(auto) apply_impl(Expr &&e, Callable c) {
       "generic "
       "lambda that takes only one argument by const-reference");
 
-  ret_t (*func)(arg_t) = c;
+  auto func = apply_callable<decltype(arg)>(c);
 
   return ::boost::yap::make_expression<tensor_expression,
                                        ::boost::yap::expr_kind::call>(
@@ -237,7 +265,7 @@ template <class Expr, class FirstCallable, class... others>
 constexpr decltype(auto) apply_impl(Expr &&e, FirstCallable c, others... x) {
   auto expr = ::boost::yap::as_expr<tensor_expression>(std::forward<Expr>(e));
 
-  assert_no_ublas_expression(expr);
+  assert_no_ublas_terminal(expr);
   auto arg = get_type(expr);
   using arg_t = decltype(arg) const &;
   using ret_t = std::remove_reference_t<decltype(c(arg))>;
@@ -255,7 +283,7 @@ constexpr decltype(auto) apply_impl(Expr &&e, FirstCallable c, others... x) {
       "generic "
       "lambda that takes only one argument by const-reference");
 
-  ret_t (*func)(arg_t) = c;
+  auto func = apply_callable<decltype(arg)>(c);
 
   auto intermediate_expr =
       ::boost::yap::make_expression<tensor_expression,
@@ -18,30 +18,32 @@
 #include <numeric>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <cassert>
 
+#include "small_vector.hpp"
+
 namespace boost {
 namespace numeric {
 namespace ublas {
 
 /** @brief Template class for storing tensor extents with runtime variable size.
  *
- * Proxy template class of std::vector<int_type>.
+ * Proxy template class of small_vector<int_type,N> which stores up to
+ * N = BOOST_UBLAS_TENSOR_INLINE_RANK extents without allocating memory.
  *
  */
 template <class int_type> class basic_extents {
-  static_assert(std::numeric_limits<
-                    typename std::vector<int_type>::value_type>::is_integer,
+  static_assert(std::numeric_limits<int_type>::is_integer,
                 "Static error in basic_layout: type must be of type integer.");
   static_assert(
-      !std::numeric_limits<
-          typename std::vector<int_type>::value_type>::is_signed,
+      !std::numeric_limits<int_type>::is_signed,
       "Static error in basic_layout: type must be of type unsigned integer.");
 
 public:
-  using base_type = std::vector<int_type>;
+  using base_type = small_vector<int_type, BOOST_UBLAS_TENSOR_INLINE_RANK>;
   using value_type = typename base_type::value_type;
   using const_reference = typename base_type::const_reference;
   using reference = typename base_type::reference;
@@ -57,11 +59,11 @@ public:
 
   /** @brief Copy constructs basic_extents from a one-dimensional container
    *
-   * @code auto ex = basic_extents<unsigned>(  std::vector<unsigned>(3u,3u) );
+   * @code auto ex = basic_extents<unsigned>(  small_vector<unsigned,8>(3u,3u) );
    *
    * @note checks if size > 1 and all elements > 0
    *
-   * @param b one-dimensional std::vector<int_type> container
+   * @param b one-dimensional base_type container
    */
   explicit basic_extents(base_type const &b) : _base(b) {
     if (!this->valid()) {
@@ -73,11 +75,11 @@ public:
 
   /** @brief Move constructs basic_extents from a one-dimensional container
    *
-   * @code auto ex = basic_extents<unsigned>(  std::vector<unsigned>(3u,3u) );
+   * @code auto ex = basic_extents<unsigned>(  small_vector<unsigned,8>(3u,3u) );
    *
    * @note checks if size > 1 and all elements > 0
    *
-   * @param b one-dimensional container of type std::vector<int_type>
+   * @param b one-dimensional container of type base_type
    */
   explicit basic_extents(base_type &&b) : _base(std::move(b)) {
     if (!this->valid()) {
@@ -87,6 +89,18 @@ public:
     }
   }
 
+  /** @brief Copy constructs basic_extents from a std::vector
+   *
+   * @code auto ex = basic_extents<unsigned>(  std::vector<unsigned>(3u,3u) );
+   *
+   * @note checks if size > 1 and all elements > 0
+   *
+   * @param b one-dimensional std::vector<int_type> container
+   */
+  template <class allocator_type>
+  explicit basic_extents(std::vector<int_type, allocator_type> const &b)
+      : basic_extents(base_type(b.begin(), b.end())) {}
+
   /** @brief Constructs basic_extents from an initializer list
    *
    * @code auto ex = basic_extents<unsigned>{3,2,4};
@@ -107,7 +121,9 @@ public:
    * @param first iterator pointing to the first element
    * @param last iterator pointing to the next position after the last element
    */
-  basic_extents(const_iterator first, const_iterator last)
+  template <class iterator_type,
+            class = std::enable_if_t<!std::is_integral_v<iterator_type>>>
+  basic_extents(iterator_type first, iterator_type last)
       : basic_extents(base_type(first, last)) {}
 
   /** @brief Copy constructs basic_extents */
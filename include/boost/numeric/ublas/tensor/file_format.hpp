@@ -0,0 +1,362 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+/// \file file_format.hpp Definition of the header of binary tensor files
+
+#ifndef BOOST_UBLAS_TENSOR_FILE_FORMAT_HPP
+#define BOOST_UBLAS_TENSOR_FILE_FORMAT_HPP
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "extents.hpp"
+#include "strides.hpp"
+
+namespace boost::numeric::ublas {
+
+/** @brief Element type codes of binary tensor files */
+enum class dtype : std::uint32_t {
+  unknown = 0,
+  int8 = 1,
+  int16 = 2,
+  int32 = 3,
+  int64 = 4,
+  uint8 = 5,
+  uint16 = 6,
+  uint32 = 7,
+  uint64 = 8,
+  float32 = 9,
+  float64 = 10,
+  complex64 = 11,
+  complex128 = 12
+};
+
+/** @brief Returns the type code of an element type or dtype::unknown
+ *
+ * Files with unknown element types can only be read with the same element
+ * type and element size with which they have been written.
+ */
+template <class T> constexpr dtype dtype_of() {
+  if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    switch (sizeof(T)) {
+    case 1: return dtype::int8;
+    case 2: return dtype::int16;
+    case 4: return dtype::int32;
+    case 8: return dtype::int64;
+    }
+  } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+    switch (sizeof(T)) {
+    case 1: return dtype::uint8;
+    case 2: return dtype::uint16;
+    case 4: return dtype::uint32;
+    case 8: return dtype::uint64;
+    }
+  } else if constexpr (std::is_same_v<T, float>) {
+    return dtype::float32;
+  } else if constexpr (std::is_same_v<T, double>) {
+    return dtype::float64;
+  } else if constexpr (std::is_same_v<T, std::complex<float>>) {
+    return dtype::complex64;
+  } else if constexpr (std::is_same_v<T, std::complex<double>>) {
+    return dtype::complex128;
+  }
+  return dtype::unknown;
+}
+
+/** @brief Incremental 64-bit checksum of the elements of a tensor file
+ *
+ * The elements are consumed as 64-bit words in the byte order of the
+ * machine so that the checksum can be computed at memory speed. Bytes can
+ * be added in chunks of any size.
+ */
+class file_checksum {
+public:
+  /** @brief Adds n bytes to the checksum */
+  void update(void const *data, std::size_t n) noexcept {
+    auto const *p = static_cast<char const *>(data);
+    size_ += n;
+    if (pending_ > 0u) {
+      auto const m = std::min(n, sizeof(buffer_) - pending_);
+      std::memcpy(buffer_ + pending_, p, m);
+      p += m, n -= m, pending_ += m;
+      if (pending_ < sizeof(buffer_)) return;
+      mix(load(buffer_));
+      pending_ = 0u;
+    }
+    for (; n >= sizeof(std::uint64_t); p += sizeof(std::uint64_t), n -= sizeof(std::uint64_t))
+      mix(load(p));
+    std::memcpy(buffer_, p, n);
+    pending_ = n;
+  }
+
+  /** @brief Returns the checksum of all bytes that have been added */
+  std::uint64_t value() const noexcept {
+    auto h = state_;
+    if (pending_ > 0u) {
+      char last[sizeof(std::uint64_t)] = {};
+      std::memcpy(last, buffer_, pending_);
+      h = step(h, load(last));
+    }
+    h ^= std::uint64_t(size_);
+    h ^= h >> 33u;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33u;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33u;
+    return h;
+  }
+
+private:
+  static std::uint64_t load(char const *p) noexcept {
+    auto w = std::uint64_t{};
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+  }
+
+  static std::uint64_t step(std::uint64_t h, std::uint64_t w) noexcept {
+    h ^= w * 0x87c37b91114253d5ull;
+    h = (h << 27u) | (h >> 37u);
+    return h * 0x4cf5ad432745937full + 0x52dce729u;
+  }
+
+  void mix(std::uint64_t w) noexcept { state_ = step(state_, w); }
+
+  std::uint64_t state_ = 0x9e3779b97f4a7c15ull;
+  std::size_t size_ = 0u;
+  std::size_t pending_ = 0u;
+  char buffer_[sizeof(std::uint64_t)] = {};
+};
+
+/** @brief Header of a binary tensor file
+ *
+ * A file starts with a header of fixed size followed by the extents and the
+ * strides of the tensor. The elements are stored with the strides after the
+ * header at data_offset which is a multiple of 64 so that memory-mapped
+ * elements are aligned. All numbers are stored in the byte order of the
+ * writing machine.
+ *
+ * | offset | size       | content                                   |
+ * |--------|------------|-------------------------------------------|
+ * | 0      | 8          | magic number "UBLASTNS"                   |
+ * | 8      | 4          | version                                   |
+ * | 12     | 4          | byte order mark 0x01020304                |
+ * | 16     | 4          | element type, see dtype                   |
+ * | 20     | 4          | element size in bytes                     |
+ * | 24     | 4          | layout, 1 for first_order, 2 for last_order |
+ * | 28     | 4          | flags, see has_checksum                   |
+ * | 32     | 8          | rank p                                    |
+ * | 40     | 8          | data offset                               |
+ * | 48     | 8          | data size in bytes                        |
+ * | 56     | 8          | checksum of the elements                  |
+ * | 64     | 8p         | extents                                   |
+ * | 64+8p  | 8p         | strides                                   |
+ */
+struct file_header {
+  static constexpr char magic[8] = {'U', 'B', 'L', 'A', 'S', 'T', 'N', 'S'};
+  static constexpr std::uint32_t current_version = 1u;
+  static constexpr std::uint32_t byte_order_mark = 0x01020304u;
+  static constexpr std::size_t fixed_size = 64u;
+  static constexpr std::size_t alignment = 64u;
+
+  /** @brief Largest rank of a tensor file, headers with a larger rank are
+   * rejected as corrupted */
+  static constexpr std::size_t max_rank = 4096u;
+
+  /** @brief Flag that is set if checksum holds the file_checksum of the
+   * elements */
+  static constexpr std::uint32_t has_checksum = 1u;
+
+  /** @brief Byte offset of the checksum in the header */
+  static constexpr std::size_t checksum_offset = 56u;
+
+  std::uint32_t version = current_version;
+  dtype type = dtype::unknown;
+  std::uint32_t element_size = 0u;
+  std::uint32_t layout = 0u;
+  std::uint32_t flags = 0u;
+  std::uint64_t data_offset = 0u;
+  std::uint64_t data_size = 0u;
+  std::uint64_t checksum = 0u;
+  shape extents = shape{};
+  std::vector<std::uint64_t> strides;
+
+  /** @brief Returns a header of a dense tensor with element type T and layout
+   * F */
+  template <class T, class F> static file_header make(shape const &e) {
+    auto h = file_header{};
+    h.type = dtype_of<T>();
+    h.element_size = std::uint32_t(sizeof(T));
+    h.layout = layout_code<F>();
+    h.extents = e;
+    auto const w = basic_strides<std::size_t, F>(e);
+    h.strides.assign(w.begin(), w.end());
+    h.data_offset = size_of(e.size());
+    h.data_size = std::uint64_t(e.product()) * sizeof(T);
+    return h;
+  }
+
+  /** @brief Returns the code of layout F */
+  template <class F> static constexpr std::uint32_t layout_code() {
+    return std::is_same_v<F, first_order> ? 1u : 2u;
+  }
+
+  /** @brief Returns the number of bytes of a header with rank p including the
+   * padding up to the elements */
+  static std::uint64_t size_of(std::size_t p) {
+    auto const n = unpadded_size_of(p);
+    return (n + alignment - 1u) / alignment * alignment;
+  }
+
+  /** @brief Throws if the header does not describe elements of type T with
+   * layout F */
+  template <class T, class F> void check() const {
+    if (type != dtype_of<T>() || element_size != sizeof(T))
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::file_header: element type of the "
+          "file does not match.");
+    if (layout != layout_code<F>())
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::file_header: layout of the file "
+          "does not match.");
+  }
+
+  /** @brief Returns the header as a sequence of data_offset bytes */
+  std::vector<char> encode() const {
+    auto const p = extents.size();
+    auto bytes = std::vector<char>(std::size_t(data_offset), char{0});
+    auto *out = bytes.data();
+    auto const put = [&out](auto const &v) {
+      std::memcpy(out, &v, sizeof(v));
+      out += sizeof(v);
+    };
+    std::memcpy(out, magic, sizeof(magic));
+    out += sizeof(magic);
+    put(version);
+    put(byte_order_mark);
+    put(std::uint32_t(type));
+    put(element_size);
+    put(layout);
+    put(flags);
+    put(std::uint64_t(p));
+    put(data_offset);
+    put(data_size);
+    put(checksum);
+    for (auto n : extents) put(std::uint64_t(n));
+    for (auto w : strides) put(std::uint64_t(w));
+    return bytes;
+  }
+
+  /** @brief Returns the number of bytes of a header with rank p without the
+   * padding up to the elements */
+  static std::size_t unpadded_size_of(std::size_t p) {
+    return fixed_size + 16u * p;
+  }
+
+  /** @brief Returns the rank of a header from its first fixed_size bytes
+   *
+   * @note throws std::runtime_error if the rank exceeds max_rank.
+   */
+  static std::size_t rank_of(char const *bytes) {
+    if (std::memcmp(bytes, magic, sizeof(magic)) != 0)
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::file_header: not a tensor file.");
+    auto bom = std::uint32_t{};
+    std::memcpy(&bom, bytes + 12, sizeof(bom));
+    if (bom != byte_order_mark)
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::file_header: byte order of the "
+          "file is not supported.");
+    auto p = std::uint64_t{};
+    std::memcpy(&p, bytes + 32, sizeof(p));
+    if (p > max_rank)
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::file_header: header is corrupted.");
+    return std::size_t(p);
+  }
+
+  /** @brief Decodes a header from its first unpadded_size_of(rank) bytes
+   *
+   * @note throws std::runtime_error if the header is corrupted, i.e. if n is
+   * smaller than the header, the data offset is not aligned or the data size
+   * does not match the extents.
+   *
+   * @param bytes the first bytes of a file
+   * @param n the number of bytes
+   */
+  static file_header decode(char const *bytes, std::size_t n) {
+    if (n < fixed_size)
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::file_header: header is corrupted.");
+    auto const p = rank_of(bytes);
+    if (n < unpadded_size_of(p))
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::file_header: header is corrupted.");
+    auto h = file_header{};
+    auto const *in = bytes + sizeof(magic);
+    auto const get = [&in](auto &v) {
+      std::memcpy(&v, in, sizeof(v));
+      in += sizeof(v);
+    };
+    auto type = std::uint32_t{}, bom = std::uint32_t{};
+    auto rank = std::uint64_t{};
+    get(h.version);
+    get(bom);
+    get(type);
+    get(h.element_size);
+    get(h.layout);
+    get(h.flags);
+    get(rank);
+    get(h.data_offset);
+    get(h.data_size);
+    get(h.checksum);
+    h.type = dtype(type);
+    if (h.version > current_version)
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::file_header: version " +
+          std::to_string(h.version) + " of the file is not supported.");
+    auto e = typename shape::base_type(p);
+    for (auto &n : e) {
+      auto v = std::uint64_t{};
+      get(v);
+      n = std::size_t(v);
+    }
+    h.strides.resize(p);
+    for (auto &w : h.strides) get(w);
+    // the number of elements and bytes must not overflow
+    constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+    auto size = std::uint64_t(h.element_size);
+    for (auto n : e) {
+      if (n != 0u && size > max / n)
+        throw std::runtime_error(
+            "Error in boost::numeric::ublas::file_header: header is "
+            "corrupted.");
+      size *= n;
+    }
+    if (h.data_offset < size_of(p) || h.data_offset % alignment != 0u ||
+        h.data_size != size || h.data_offset > max - h.data_size ||
+        h.data_offset + h.data_size > std::numeric_limits<std::size_t>::max())
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::file_header: header is corrupted.");
+    h.extents = shape(std::move(e));
+    return h;
+  }
+};
+
+} // namespace boost::numeric::ublas
+
+#endif
@@ -0,0 +1,363 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+
+#ifndef BOOST_UBLAS_TENSOR_FIXED_MULTIPLICATION_HPP
+#define BOOST_UBLAS_TENSOR_FIXED_MULTIPLICATION_HPP
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace numeric {
+namespace ublas {
+namespace detail {
+namespace fixed {
+
+/** @brief Maximum number of multiply-adds for which the unrolled kernels are used */
+constexpr std::size_t threshold = 4096u;
+
+/** @brief Maximum number of free modes of the unrolled kernels */
+constexpr std::size_t max_rank = 8u;
+
+
+/** @brief Calls f with std::integral_constant<std::size_t,n> if kernels are instantiated for the extent n
+ *
+ * The unrolled kernels are instantiated for the small extents 2, 3, 4 and 8.
+ *
+ * @returns false if n is not one of these extents.
+*/
+template<class F>
+bool dispatch(std::size_t const n, F&& f)
+{
+	switch(n){
+	case 2u: f(std::integral_constant<std::size_t,2u>{}); return true;
+	case 3u: f(std::integral_constant<std::size_t,3u>{}); return true;
+	case 4u: f(std::integral_constant<std::size_t,4u>{}); return true;
+	case 8u: f(std::integral_constant<std::size_t,8u>{}); return true;
+	default: return false;
+	}
+}
+
+
+/** @brief Returns true if kernels are instantiated for the extent n */
+inline bool supported(std::size_t const n)
+{
+	return dispatch(n, [](auto){});
+}
+
+
+/** @brief Extents and strides of the free modes of a contraction
+ *
+ * The modes are sorted by the strides of C so that the innermost loop
+ * traverses C with the smallest stride.
+*/
+struct free_modes
+{
+	std::size_t rank = 0u;
+	std::array<std::size_t,   max_rank> n  = {};
+	std::array<std::ptrdiff_t,max_rank> wc = {};
+	std::array<std::ptrdiff_t,max_rank> wa = {};
+	std::array<std::ptrdiff_t,max_rank> wb = {};
+
+	void push_back(std::size_t ni, std::ptrdiff_t wci, std::ptrdiff_t wai, std::ptrdiff_t wbi)
+	{
+		if(ni == 1u)
+			return;
+		auto i = rank++;
+		for(; i > 0u && wc[i-1] > wci; --i){
+			n[i] = n[i-1]; wc[i] = wc[i-1]; wa[i] = wa[i-1]; wb[i] = wb[i-1];
+		}
+		n[i] = ni; wc[i] = wci; wa[i] = wai; wb[i] = wbi;
+	}
+
+	std::size_t size() const
+	{
+		auto s = std::size_t(1);
+		for(auto i = 0u; i < rank; ++i)
+			s *= n[i];
+		return s;
+	}
+};
+
+
+/** @brief Calls kernel(c,a,b) for all multi-indices of the free modes up to mode r */
+template<class PointerOut, class PointerIn1, class PointerIn2, class Kernel>
+void for_each(std::size_t const r, free_modes const& f,
+              PointerOut c, PointerIn1 a, PointerIn2 b, Kernel const& kernel)
+{
+	if(r == 0u){
+		kernel(c, a, b);
+	}
+	else if(r == 1u){
+		for(auto i = 0u; i < f.n[0]; ++i, c += f.wc[0], a += f.wa[0], b += f.wb[0])
+			kernel(c, a, b);
+	}
+	else{
+		for(auto i = 0u; i < f.n[r-1]; ++i, c += f.wc[r-1], a += f.wa[r-1], b += f.wb[r-1])
+			for_each(r-1, f, c, a, b, kernel);
+	}
+}
+
+
+template<class value_type, std::size_t K1, std::size_t ... I, class PointerIn1, class PointerIn2>
+value_type dot(std::index_sequence<I...>,
+               PointerIn1 a, std::ptrdiff_t const wa1, std::ptrdiff_t const wa2,
+               PointerIn2 b, std::ptrdiff_t const wb1, std::ptrdiff_t const wb2)
+{
+	return ( value_type( a[std::ptrdiff_t(I%K1)*wa1 + std::ptrdiff_t(I/K1)*wa2] *
+	                     b[std::ptrdiff_t(I%K1)*wb1 + std::ptrdiff_t(I/K1)*wb2] ) + ... );
+}
+
+
+template<class value_type, std::size_t K, std::size_t ... I, class PointerIn1, class Array>
+value_type dot(std::index_sequence<I...>, PointerIn1 a, std::ptrdiff_t const wa, Array const& x, std::size_t const offset)
+{
+	return ( value_type( a[std::ptrdiff_t(I)*wa] * x[offset+I] ) + ... );
+}
+
+
+/** @brief Computes the tensor-times-tensor product for one or two contraction modes with small extents
+ *
+ * Implements C[i1,...,ir,j1,...,js] = sum( A[i1,...,ir+q] * B[j1,...,js+q]  )
+ *
+ * The sum over the contraction modes is fully unrolled for extents with an instantiated
+ * kernel, see dispatch. The free modes are traversed with loops.
+ *
+ * @note is used in function ttt, see detail::blocked::ttt for the parameters
+ *
+ * @returns false if more than two contraction extents are greater than one, if they have no kernel or if the product is too large. C is not modified in that case.
+*/
+template <class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+bool ttt(SizeType const r, SizeType const s, SizeType const q,
+         SizeType const*const phia, SizeType const*const phib,
+         PointerOut c, SizeType const*const nc, SizeType const*const wc,
+         PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, SizeType const*const /*unused*/, SizeType const*const wb,
+         bool const accumulate)
+{
+	using value_type = std::remove_cv_t<std::remove_pointer_t<PointerOut>>;
+
+	if(r+s > max_rank)
+		return false;
+
+	auto f = free_modes{};
+	for(auto i = 0u; i < r; ++i)
+		f.push_back(nc[i],   std::ptrdiff_t(wc[i]),   std::ptrdiff_t(wa[phia[i]-1]), 0);
+	for(auto i = 0u; i < s; ++i)
+		f.push_back(nc[r+i], std::ptrdiff_t(wc[r+i]), 0, std::ptrdiff_t(wb[phib[i]-1]));
+
+	// contraction modes with extent one do not contribute to the sum
+	auto k = std::array<std::size_t,2>{1u,1u};
+	auto wk = std::array<std::ptrdiff_t,4>{0,0,0,0};
+	auto qk = 0u;
+	for(auto i = 0u; i < q; ++i){
+		auto const n = std::size_t(na[phia[r+i]-1]);
+		if(n == 1u)
+			continue;
+		if(qk == 2u || !supported(n))
+			return false;
+		k[qk] = n;
+		wk[2*qk]   = std::ptrdiff_t(wa[phia[r+i]-1]);
+		wk[2*qk+1] = std::ptrdiff_t(wb[phib[s+i]-1]);
+		++qk;
+	}
+
+	auto const k1 = k[0], k2 = k[1];
+	auto const wa1 = wk[0], wb1 = wk[1], wa2 = wk[2], wb2 = wk[3];
+
+	if(qk == 0u || f.size()*k1*k2 > threshold)
+		return false;
+
+	auto const run = [&](auto K1, auto K2){
+		constexpr auto seq = std::make_index_sequence<decltype(K1)::value*decltype(K2)::value>{};
+		for_each(f.rank, f, c, a, b, [=](PointerOut ci, PointerIn1 ai, PointerIn2 bi){
+			auto const v = dot<value_type,decltype(K1)::value>(seq, ai, wa1, wa2, bi, wb1, wb2);
+			*ci = accumulate ? *ci + v : v;
+		});
+	};
+
+	if(k2 == 1u)
+		dispatch(k1, [&](auto K1){ run(K1, std::integral_constant<std::size_t,1u>{}); });
+	else
+		dispatch(k1, [&](auto K1){ dispatch(k2, [&](auto K2){ run(K1, K2); }); });
+	return true;
+}
+
+
+/** @brief Computes the tensor-times-matrix product for the compile-time extents J x K of B
+ *
+ * Implements C[i1,i2,...,im-1,j,im+1,...,ip] = sum(A[i1,i2,...,im,...,ip] * B[j,im])
+ *
+ * B is held in local memory and the J x K products of every fiber of A are fully unrolled.
+ * The extents of B must be equal to J and K, the size of the product is not limited.
+ *
+ * @note is used by prod with a compile-time shape hint and by the runtime ttm kernel
+ *
+ * @returns false if A has more than max_rank+1 modes. C is not modified in that case.
+*/
+template <std::size_t J, std::size_t K, class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+bool ttm(std::integral_constant<std::size_t,J>, std::integral_constant<std::size_t,K>,
+         SizeType const m, SizeType const p,
+         PointerOut c, SizeType const*const nc, SizeType const*const wc,
+         PointerIn1 a, SizeType const*const /*unused*/, SizeType const*const wa,
+         PointerIn2 b, SizeType const*const wb,
+         bool const accumulate)
+{
+	using value_type   = std::remove_cv_t<std::remove_pointer_t<PointerOut>>;
+	using value_type_b = std::remove_cv_t<std::remove_pointer_t<PointerIn2>>;
+
+	if(p > max_rank+1u)
+		return false;
+
+	auto f = free_modes{};
+	for(auto i = 0u; i < p; ++i)
+		if(i != m)
+			f.push_back(nc[i], std::ptrdiff_t(wc[i]), std::ptrdiff_t(wa[i]), 0);
+
+	auto const wcm = std::ptrdiff_t(wc[m]);
+	auto const wam = std::ptrdiff_t(wa[m]);
+
+	auto x = std::array<value_type_b,J*K>{};
+	for(auto j = 0u; j < J; ++j)
+		for(auto k = 0u; k < K; ++k)
+			x[j*K+k] = b[j*wb[0]+k*wb[1]];
+
+	for_each(f.rank, f, c, a, b, [=,&x](PointerOut ci, PointerIn1 ai, PointerIn2){
+		for(auto j = 0u; j < J; ++j){
+			auto const v = dot<value_type,K>(std::make_index_sequence<K>{}, ai, wam, x, j*K);
+			ci[std::ptrdiff_t(j)*wcm] = accumulate ? ci[std::ptrdiff_t(j)*wcm] + v : v;
+		}
+	});
+	return true;
+}
+
+
+/** @brief Computes the tensor-times-matrix product for small extents of the contraction mode and of B
+ *
+ * Implements C[i1,i2,...,im-1,j,im+1,...,ip] = sum(A[i1,i2,...,im,...,ip] * B[j,im])
+ *
+ * Selects the unrolled kernel for the extents of B at runtime, see dispatch.
+ *
+ * @note is used in function ttm, see detail::blocked::ttm for the parameters
+ *
+ * @returns false if the extents of B have no kernel or if the product is too large. C is not modified in that case.
+*/
+template <class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+bool ttm(SizeType const m, SizeType const p,
+         PointerOut c, SizeType const*const nc, SizeType const*const wc,
+         PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, SizeType const*const nb, SizeType const*const wb,
+         bool const accumulate)
+{
+	if(p > max_rank+1u)
+		return false;
+
+	auto const nj = std::size_t(nb[0]);
+	auto const nk = std::size_t(nb[1]);
+	auto size = nj*nk;
+	for(auto i = 0u; i < p; ++i)
+		if(i != m)
+			size *= std::size_t(nc[i]);
+
+	if(!supported(nj) || !supported(nk) || size > threshold)
+		return false;
+
+	dispatch(nj, [&](auto J){ dispatch(nk, [&](auto K){
+		ttm(J, K, m, p, c, nc, wc, a, na, wa, b, wb, accumulate);
+	}); });
+	return true;
+}
+
+
+/** @brief Computes the tensor-times-vector product for the compile-time extent K of the contraction mode
+ *
+ * Implements C[i1,i2,...,im-1,im+1,...,ip] = sum(A[i1,i2,...,im,...,ip] * b[im])
+ *
+ * b is held in local memory and the products of every fiber of A are fully unrolled.
+ * The extent of the contraction mode must be equal to K, the size of the product is not limited.
+ *
+ * @note is used by prod with a std::integral_constant shape hint and by the runtime ttv kernel
+ *
+ * @returns false if A has more than max_rank+1 modes. C is not modified in that case.
+*/
+template <std::size_t K, class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+bool ttv(std::integral_constant<std::size_t,K>,
+         SizeType const m, SizeType const p,
+         PointerOut c, SizeType const*const /*unused*/, SizeType const*const wc,
+         PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, bool const accumulate)
+{
+	using value_type   = std::remove_cv_t<std::remove_pointer_t<PointerOut>>;
+	using value_type_b = std::remove_cv_t<std::remove_pointer_t<PointerIn2>>;
+
+	if(p > max_rank+1u)
+		return false;
+
+	auto f = free_modes{};
+	for(auto i = 0u; i < p; ++i)
+		if(i != m)
+			f.push_back(na[i], std::ptrdiff_t(wc[i < m ? i : i-1]), std::ptrdiff_t(wa[i]), 0);
+
+	auto const wam = std::ptrdiff_t(wa[m]);
+
+	auto x = std::array<value_type_b,K>{};
+	for(auto k = 0u; k < K; ++k)
+		x[k] = b[k];
+
+	for_each(f.rank, f, c, a, b, [=,&x](PointerOut ci, PointerIn1 ai, PointerIn2){
+		auto const v = dot<value_type,K>(std::make_index_sequence<K>{}, ai, wam, x, 0u);
+		*ci = accumulate ? *ci + v : v;
+	});
+	return true;
+}
+
+
+/** @brief Computes the tensor-times-vector product for small extents of the contraction mode
+ *
+ * Implements C[i1,i2,...,im-1,im+1,...,ip] = sum(A[i1,i2,...,im,...,ip] * b[im])
+ *
+ * Selects the unrolled kernel for the extent of the contraction mode at runtime, see dispatch.
+ *
+ * @note is used in function ttv, see detail::blocked::ttv for the parameters
+ *
+ * @returns false if the extent of the contraction mode has no kernel or if the product is too large. C is not modified in that case.
+*/
+template <class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+bool ttv(SizeType const m, SizeType const p,
+         PointerOut c, SizeType const*const nc, SizeType const*const wc,
+         PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, bool const accumulate)
+{
+	if(p > max_rank+1u)
+		return false;
+
+	auto size = std::size_t(1);
+	for(auto i = 0u; i < p; ++i)
+		size *= std::size_t(na[i]);
+
+	if(size > threshold)
+		return false;
+
+	return dispatch(std::size_t(na[m]), [&](auto K){
+		ttv(K, m, p, c, nc, wc, a, na, wa, b, accumulate);
+	});
+}
+
+} // namespace fixed
+} // namespace detail
+} // namespace ublas
+} // namespace numeric
+} // namespace boost
+
+#endif
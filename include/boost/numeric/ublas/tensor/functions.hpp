@@ -15,18 +15,22 @@
 #include <algorithm>
 #include <numeric>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include <boost/numeric/ublas/detail/config.hpp>
 
 #include "algorithms.hpp"
 #include "multiplication.hpp"
+#include "reduction.hpp"
 #include "storage_traits.hpp"
+#include "summation.hpp"
 #include "tensor_expression.hpp"
+#include "tensor_view.hpp"
 
 namespace boost::numeric::ublas {
 
-template <class Value, class Format, class Allocator>
+template <class Value, class Format, class Allocator, class Extents>
 class tensor;
 
 template <class Value, class Format, class Allocator>
@@ -35,6 +39,27 @@ class matrix;
 template <class Value, class Allocator>
 class vector;
 
+template <class Value, class Format>
+class tensor_view;
+
+namespace detail {
+/** @brief Enables a function for a tensor or a tensor_view with elements of
+ * type V */
+template <class T, class V>
+using enable_if_tensor_operand_of_t = std::enable_if_t<
+    is_tensor_operand_v<T> &&
+    std::is_same_v<std::remove_const_t<typename T::value_type>, V>>;
+
+/** @brief Enables a function for two tensors or tensor views with the same
+ * element type and layout */
+template <class T1, class T2>
+using enable_if_tensor_operands_t = std::enable_if_t<
+    is_tensor_operand_v<T1> && is_tensor_operand_v<T2> &&
+    std::is_same_v<std::remove_const_t<typename T1::value_type>,
+                   std::remove_const_t<typename T2::value_type>> &&
+    std::is_same_v<typename T1::layout_type, typename T2::layout_type>>;
+}  // namespace detail
+
 /** @brief Computes the m-mode tensor-times-vector product
  *
  * Implements C[i1,...,im-1,im+1,...,ip] = A[i1,i2,...,ip] * b[im]
@@ -42,20 +67,19 @@ class vector;
  * @note calls ublas::ttv
  *
  * @param[in] m contraction dimension with 1 <= m <= p
- * @param[in] a tensor object A with order p
+ * @param[in] a tensor or tensor_view object A with order p
  * @param[in] b vector object B
  *
- * @returns tensor object C with order p-1, the same storage format and
- * allocator type as A
+ * @returns tensor object C with order p-1 of the tensor_temporary_type of A,
+ * i.e. with the storage format of A and storage that is not zero-filled
  */
-template <class V, class F, class A1, class A2>
-BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
-                                       vector<V, A2> const &b,
+template <class T, class V, class A2,
+          class = detail::enable_if_tensor_operand_of_t<T, V>>
+BOOST_UBLAS_INLINE decltype(auto) prod(T const &a, vector<V, A2> const &b,
                                        const std::size_t m) {
-  using tensor_type = tensor<V, F, A1>;
+  using tensor_type = typename T::tensor_temporary_type;
   using extents_type = typename tensor_type::extents_type;
   using ebase_type = typename extents_type::base_type;
-  using value_type = typename tensor_type::value_type;
   using size_type = typename extents_type::value_type;
 
   auto const p = std::size_t(a.rank());
@@ -86,12 +110,82 @@ BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
   for (auto i = 0u, j = 0u; i < p; ++i)
     if (i != m - 1) nc[j++] = a.extents().at(i);
 
-  auto c = tensor_type(extents_type(nc), value_type{});
+  auto c = tensor_type(extents_type(std::move(nc)), uninitialized);
+
+  auto bb = &(b(0));
+  auto const &ka = detail::kernel_operand(a);
+
+  ttv(m, p, c.data(), c.extents().data(), c.strides().data(), ka.data(),
+      ka.extents().data(), ka.strides().data(), bb, nb.data(), nb.data(), false);
+
+  return c;
+}
+
+/** @brief Computes the m-mode tensor-times-vector product for a contraction
+ * extent that is known at compile time
+ *
+ * Implements C[i1,...,im-1,im+1,...,ip] = A[i1,i2,...,ip] * b[im]
+ *
+ * The shape hint selects the unrolled kernel detail::fixed::ttv for the extent
+ * K at compile time, independent of the size of A.
+ *
+ * @code auto c = prod(a, b, 2, std::integral_constant<std::size_t,3>{});
+ * @endcode
+ *
+ * @note calls detail::fixed::ttv or ublas::ttv if A has more modes than
+ * detail::fixed::max_rank+1
+ *
+ * @param[in] a tensor or tensor_view object A with order p
+ * @param[in] b vector object B with K elements
+ * @param[in] m contraction dimension with 1 <= m <= p and extent K
+ *
+ * @returns tensor object C with order p-1, see prod(a,b,m)
+ */
+template <class T, class V, class A2, std::size_t K,
+          class = detail::enable_if_tensor_operand_of_t<T, V>>
+BOOST_UBLAS_INLINE decltype(auto) prod(T const &a, vector<V, A2> const &b,
+                                       const std::size_t m,
+                                       std::integral_constant<std::size_t, K> nk) {
+  using tensor_type = typename T::tensor_temporary_type;
+  using extents_type = typename tensor_type::extents_type;
+  using ebase_type = typename extents_type::base_type;
+  using size_type = typename extents_type::value_type;
+
+  auto const p = std::size_t(a.rank());
+
+  if (m == 0)
+    throw std::length_error(
+        "error in boost::numeric::ublas::prod(ttv): "
+        "contraction mode must be greater than zero.");
+
+  if (p < m)
+    throw std::length_error(
+        "error in boost::numeric::ublas::prod(ttv): rank of tensor must be "
+        "greater than or equal to the modus.");
+
+  if (a.extents().at(m - 1) != K || b.size() != K)
+    throw std::length_error(
+        "error in boost::numeric::ublas::prod(ttv): extent of the "
+        "contraction mode and size of the vector must be equal to the shape "
+        "hint.");
+
+  auto nc = ebase_type(std::max(p - 1, size_type(2)), size_type(1));
+  auto nb = ebase_type{b.size(), 1};
+
+  for (auto i = 0u, j = 0u; i < p; ++i)
+    if (i != m - 1) nc[j++] = a.extents().at(i);
+
+  auto c = tensor_type(extents_type(std::move(nc)), uninitialized);
 
   auto bb = &(b(0));
+  auto const &ka = detail::kernel_operand(a);
 
-  ttv(m, p, c.data(), c.extents().data(), c.strides().data(), a.data(),
-      a.extents().data(), a.strides().data(), bb, nb.data(), nb.data());
+  if (!detail::fixed::ttv(nk, m - 1, p, c.data(), c.extents().data(),
+                          c.strides().data(), ka.data(), ka.extents().data(),
+                          ka.strides().data(), bb, false))
+    ttv(m, p, c.data(), c.extents().data(), c.strides().data(), ka.data(),
+        ka.extents().data(), ka.strides().data(), bb, nb.data(), nb.data(),
+        false);
 
   return c;
 }
@@ -102,21 +196,21 @@ BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
  *
  * @note calls ublas::ttm
  *
- * @param[in] a tensor object A with order p
+ * @param[in] a tensor or tensor_view object A with order p
  * @param[in] b vector object B
  * @param[in] m contraction dimension with 1 <= m <= p
  *
- * @returns tensor object C with order p, the same storage format and allocator
- * type as A
+ * @returns tensor object C with order p of the tensor_temporary_type of A,
+ * i.e. with the storage format of A and storage that is not zero-filled
  */
-template <class V, class F, class A1, class A2>
-BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
-                                       matrix<V, F, A2> const &b,
+template <class T, class V, class F, class A2,
+          class = detail::enable_if_tensor_operand_of_t<T, V>,
+          class = std::enable_if_t<std::is_same_v<typename T::layout_type, F>>>
+BOOST_UBLAS_INLINE decltype(auto) prod(T const &a, matrix<V, F, A2> const &b,
                                        const std::size_t m) {
-  using tensor_type = tensor<V, F, A1>;
+  using tensor_type = typename T::tensor_temporary_type;
   using extents_type = typename tensor_type::extents_type;
   using strides_type = typename tensor_type::strides_type;
-  using value_type = typename tensor_type::value_type;
 
   auto const p = a.rank();
 
@@ -140,18 +234,96 @@ BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
         "error in boost::numeric::ublas::prod(ttm): second "
         "argument matrix should not be empty.");
 
-  auto nc = a.extents().base();
+  auto nc = typename extents_type::base_type(a.extents().begin(),
+                                             a.extents().end());
+  auto nb = extents_type{b.size1(), b.size2()};
+  auto wb = strides_type(nb);
+
+  nc[m - 1] = nb[0];
+
+  auto c = tensor_type(extents_type(std::move(nc)), uninitialized);
+
+  auto bb = &(b(0, 0));
+  auto const &ka = detail::kernel_operand(a);
+
+  ttm(m, p, c.data(), c.extents().data(), c.strides().data(), ka.data(),
+      ka.extents().data(), ka.strides().data(), bb, nb.data(), wb.data(), false);
+
+  return c;
+}
+
+/** @brief Computes the m-mode tensor-times-matrix product for a matrix shape
+ * that is known at compile time
+ *
+ * Implements C[i1,...,im-1,j,im+1,...,ip] = A[i1,i2,...,ip] * B[j,im]
+ *
+ * The shape hint selects the unrolled kernel detail::fixed::ttm for the J x K
+ * matrix B at compile time, independent of the size of A.
+ *
+ * @code
+ * using std::integral_constant;
+ * auto c = prod(a, b, 2, integral_constant<std::size_t,4>{},
+ *                        integral_constant<std::size_t,3>{});
+ * @endcode
+ *
+ * @note calls detail::fixed::ttm or ublas::ttm if A has more modes than
+ * detail::fixed::max_rank+1
+ *
+ * @param[in] a tensor or tensor_view object A with order p
+ * @param[in] b matrix object B with J rows and K columns
+ * @param[in] m contraction dimension with 1 <= m <= p and extent K
+ *
+ * @returns tensor object C with order p, see prod(a,b,m)
+ */
+template <class T, class V, class F, class A2, std::size_t J, std::size_t K,
+          class = detail::enable_if_tensor_operand_of_t<T, V>,
+          class = std::enable_if_t<std::is_same_v<typename T::layout_type, F>>>
+BOOST_UBLAS_INLINE decltype(auto) prod(T const &a, matrix<V, F, A2> const &b,
+                                       const std::size_t m,
+                                       std::integral_constant<std::size_t, J> /*nb1*/,
+                                       std::integral_constant<std::size_t, K> /*nb2*/) {
+  using tensor_type = typename T::tensor_temporary_type;
+  using extents_type = typename tensor_type::extents_type;
+  using strides_type = typename tensor_type::strides_type;
+
+  auto const p = a.rank();
+
+  if (m == 0)
+    throw std::length_error(
+        "error in boost::numeric::ublas::prod(ttm): "
+        "contraction mode must be greater than zero.");
+
+  if (p < m || m > a.extents().size())
+    throw std::length_error(
+        "error in boost::numeric::ublas::prod(ttm): rank "
+        "of the tensor must be greater equal the modus.");
+
+  if (a.extents().at(m - 1) != K || b.size1() != J || b.size2() != K)
+    throw std::length_error(
+        "error in boost::numeric::ublas::prod(ttm): extent of the "
+        "contraction mode and extents of the matrix must be equal to the "
+        "shape hint.");
+
+  auto nc = typename extents_type::base_type(a.extents().begin(),
+                                             a.extents().end());
   auto nb = extents_type{b.size1(), b.size2()};
   auto wb = strides_type(nb);
 
   nc[m - 1] = nb[0];
 
-  auto c = tensor_type(extents_type(nc), value_type{});
+  auto c = tensor_type(extents_type(std::move(nc)), uninitialized);
 
   auto bb = &(b(0, 0));
+  auto const &ka = detail::kernel_operand(a);
 
-  ttm(m, p, c.data(), c.extents().data(), c.strides().data(), a.data(),
-      a.extents().data(), a.strides().data(), bb, nb.data(), wb.data());
+  if (!detail::fixed::ttm(std::integral_constant<std::size_t, J>{},
+                          std::integral_constant<std::size_t, K>{}, m - 1, p,
+                          c.data(), c.extents().data(), c.strides().data(),
+                          ka.data(), ka.extents().data(), ka.strides().data(),
+                          bb, wb.data(), false))
+    ttm(m, p, c.data(), c.extents().data(), c.strides().data(), ka.data(),
+        ka.extents().data(), ka.strides().data(), bb, nb.data(), wb.data(),
+        false);
 
   return c;
 }
@@ -168,18 +340,18 @@ BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
  * input tensor a
  * @param[in]	 phib one-based permutation tuple of length q for the second
  * input tensor b
- * @param[in]  a  left-hand side tensor with order r+q
- * @param[in]  b  right-hand side tensor with order s+q
+ * @param[in]  a  left-hand side tensor or tensor_view with order r+q
+ * @param[in]  b  right-hand side tensor or tensor_view with order s+q
  * @result     tensor with order r+s
  */
-template <class V, class F, class A1, class A2>
-BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
-                                       tensor<V, F, A2> const &b,
+template <class TA, class TB,
+          class = detail::enable_if_tensor_operands_t<TA, TB>>
+BOOST_UBLAS_INLINE decltype(auto) prod(TA const &a, TB const &b,
                                        std::vector<std::size_t> const &phia,
                                        std::vector<std::size_t> const &phib) {
-  using tensor_type = tensor<V, F, A1>;
+  using tensor_type = typename TA::tensor_temporary_type;
   using extents_type = typename tensor_type::extents_type;
-  using value_type = typename tensor_type::value_type;
+  using ebase_type = typename extents_type::base_type;
   using size_type = typename extents_type::value_type;
 
   auto const pa = a.rank();
@@ -228,11 +400,11 @@ BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
   auto const r = pa - q;
   auto const s = pb - q;
 
-  std::vector<std::size_t> phia1(pa), phib1(pb);
+  auto phia1 = ebase_type(pa), phib1 = ebase_type(pb);
   std::iota(phia1.begin(), phia1.end(), 1ul);
   std::iota(phib1.begin(), phib1.end(), 1ul);
 
-  std::vector<std::size_t> nc(std::max(r + s, size_type(2)), size_type(1));
+  auto nc = ebase_type(std::max(r + s, size_type(2)), size_type(1));
 
   for (auto i = 0ul; i < phia.size(); ++i)
     *std::remove(phia1.begin(), phia1.end(), phia.at(i)) = phia.at(i);
@@ -258,11 +430,13 @@ BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
   // assert(phia1.size() == pa);
   // assert(phib1.size() == pb);
 
-  auto c = tensor_type(extents_type(nc), value_type{});
+  auto c = tensor_type(extents_type(std::move(nc)), uninitialized);
+  auto const &ka = detail::kernel_operand(a);
+  auto const &kb = detail::kernel_operand(b);
 
   ttt(pa, pb, q, phia1.data(), phib1.data(), c.data(), c.extents().data(),
-      c.strides().data(), a.data(), a.extents().data(), a.strides().data(),
-      b.data(), b.extents().data(), b.strides().data());
+      c.strides().data(), ka.data(), ka.extents().data(), ka.strides().data(),
+      kb.data(), kb.extents().data(), kb.strides().data(), false);
 
   return c;
 }
@@ -281,13 +455,13 @@ BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
  *
  * @param[in]	 phi one-based permutation tuple of length q for bot input
  * tensors
- * @param[in]  a  left-hand side tensor with order r+q
- * @param[in]  b  right-hand side tensor with order s+q
+ * @param[in]  a  left-hand side tensor or tensor_view with order r+q
+ * @param[in]  b  right-hand side tensor or tensor_view with order s+q
  * @result     tensor with order r+s
  */
-template <class V, class F, class A1, class A2>
-BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
-                                       tensor<V, F, A2> const &b,
+template <class TA, class TB,
+          class = detail::enable_if_tensor_operands_t<TA, TB>>
+BOOST_UBLAS_INLINE decltype(auto) prod(TA const &a, TB const &b,
                                        std::vector<std::size_t> const &phi) {
   return prod(a, b, phi, phi);
 }
@@ -296,17 +470,21 @@ BOOST_UBLAS_INLINE decltype(auto) prod(tensor<V, F, A1> const &a,
  *
  * Implements c = sum(A[i1,i2,...,ip] * B[i1,i2,...,jp])
  *
- * @note calls inner function
+ * @note calls inner function for naive_summation and integer elements
  *
- * @param[in] a tensor object A
- * @param[in] b tensor object B
+ * @param[in] a tensor or tensor_view object A
+ * @param[in] b tensor or tensor_view object B
+ * @param[in] policy naive_summation, pairwise_summation or
+ * compensated_summation
  *
  * @returns a value type.
  */
-template <class V, class F, class A1, class A2>
-BOOST_UBLAS_INLINE decltype(auto) inner_prod(tensor<V, F, A1> const &a,
-                                             tensor<V, F, A2> const &b) {
-  using value_type = typename tensor<V, F, A1>::value_type;
+template <class TA, class TB, class Policy = naive_summation,
+          class = detail::enable_if_tensor_operands_t<TA, TB>,
+          class = std::enable_if_t<is_summation_policy_v<Policy>>>
+BOOST_UBLAS_INLINE decltype(auto) inner_prod(TA const &a, TB const &b,
+                                             Policy policy = {}) {
+  using value_type = std::remove_const_t<typename TA::value_type>;
 
   if (a.rank() != b.rank())
     throw std::length_error(
@@ -323,8 +501,19 @@ BOOST_UBLAS_INLINE decltype(auto) inner_prod(tensor<V, F, A1> const &a,
         "error in boost::numeric::ublas::inner_prod: "
         "Tensor extents should be the same.");
 
-  return inner(a.rank(), a.extents().data(), a.data(), a.strides().data(),
-               b.data(), b.strides().data(), value_type{0});
+  auto const &ka = detail::kernel_operand(a);
+  auto const &kb = detail::kernel_operand(b);
+  if constexpr (std::is_same_v<Policy, naive_summation> ||
+                std::is_integral_v<value_type>) {
+    return inner(ka.rank(), ka.extents().data(), ka.data(),
+                 ka.strides().data(), kb.data(), kb.strides().data(),
+                 value_type{0});
+  } else {
+    return detail::sum_terms<value_type>(
+        policy, ka.rank(), ka.extents().data(),
+        detail::product_terms<value_type>{ka.data(), ka.strides().data(),
+                                          kb.data(), kb.strides().data()});
+  }
 }
 
 /** @brief Computes the outer product of two tensors
@@ -333,15 +522,16 @@ BOOST_UBLAS_INLINE decltype(auto) inner_prod(tensor<V, F, A1> const &a,
  *
  * @note calls outer function
  *
- * @param[in] a tensor object A
- * @param[in] b tensor object B
+ * @param[in] a tensor or tensor_view object A
+ * @param[in] b tensor or tensor_view object B
  *
- * @returns tensor object C with the same storage format F and allocator type A1
+ * @returns tensor object C of the tensor_temporary_type of A, i.e. with the
+ * storage format of A and storage that is not zero-filled
  */
-template <class V, class F, class A1, class A2>
-BOOST_UBLAS_INLINE decltype(auto) outer_prod(tensor<V, F, A1> const &a,
-                                             tensor<V, F, A2> const &b) {
-  using tensor_type = tensor<V, F, A1>;
+template <class TA, class TB,
+          class = detail::enable_if_tensor_operands_t<TA, TB>>
+BOOST_UBLAS_INLINE decltype(auto) outer_prod(TA const &a, TB const &b) {
+  using tensor_type = typename TA::tensor_temporary_type;
   using extents_type = typename tensor_type::extents_type;
 
   if (a.empty() || b.empty())
@@ -354,11 +544,13 @@ BOOST_UBLAS_INLINE decltype(auto) outer_prod(tensor<V, F, A1> const &a,
 
   for (auto i = 0u; i < b.rank(); ++i) nc.at(a.rank() + i) = b.extents().at(i);
 
-  auto c = tensor_type(extents_type(nc));
+  auto c = tensor_type(extents_type(std::move(nc)), uninitialized);
+  auto const &ka = detail::kernel_operand(a);
+  auto const &kb = detail::kernel_operand(b);
 
-  outer(c.data(), c.rank(), c.extents().data(), c.strides().data(), a.data(),
-        a.rank(), a.extents().data(), a.strides().data(), b.data(), b.rank(),
-        b.extents().data(), b.strides().data());
+  outer(c.data(), c.rank(), c.extents().data(), c.strides().data(), ka.data(),
+        ka.rank(), ka.extents().data(), ka.strides().data(), kb.data(),
+        kb.rank(), kb.extents().data(), kb.strides().data());
 
   return c;
 }
@@ -369,19 +561,19 @@ BOOST_UBLAS_INLINE decltype(auto) outer_prod(tensor<V, F, A1> const &a,
  *
  * @note calls trans function
  *
- * @param[in] a    tensor object of rank p
+ * @param[in] a    tensor or tensor_view object of rank p
  * @param[in] tau  one-based permutation tuple of length p
- * @returns        a transposed tensor object with the same storage format F and
- * allocator type A
+ * @returns        a transposed tensor object of the tensor_temporary_type of
+ * A, i.e. with the storage format of A and storage that is not zero-filled
  */
-template <class V, class F, class A>
-BOOST_UBLAS_INLINE decltype(auto) trans(tensor<V, F, A> const &a,
+template <class T, class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE decltype(auto) trans(T const &a,
                                         std::vector<std::size_t> const &tau) {
-  using tensor_type = tensor<V, F, A>;
+  using tensor_type = typename T::tensor_temporary_type;
   using extents_type = typename tensor_type::extents_type;
   //	using strides_type = typename tensor_type::strides_type;
 
-  if (a.empty()) return tensor<V, F, A>{};
+  if (a.empty()) return tensor_type{};
 
   auto const p = a.rank();
   auto const &na = a.extents();
@@ -391,10 +583,11 @@ BOOST_UBLAS_INLINE decltype(auto) trans(tensor<V, F, A> const &a,
 
   //	auto wc = strides_type(extents_type(nc));
 
-  auto c = tensor_type(extents_type(nc));
+  auto c = tensor_type(extents_type(std::move(nc)), uninitialized);
+  auto const &ka = detail::kernel_operand(a);
 
-  trans(a.rank(), a.extents().data(), tau.data(), c.data(), c.strides().data(),
-        a.data(), a.strides().data());
+  trans(ka.rank(), ka.extents().data(), tau.data(), c.data(),
+        c.strides().data(), ka.data(), ka.strides().data());
 
   //	auto wc_pi = typename strides_type::base_type (p);
   //	for(auto i = 0u; i < p; ++i)
@@ -407,23 +600,62 @@ BOOST_UBLAS_INLINE decltype(auto) trans(tensor<V, F, A> const &a,
 
   return c;
 }
+
+/** @brief Reverses the order of the elements of one mode of a tensor
+ *
+ * Implements C[i1,...,im,...,ip] = A[i1,...,nm-1-im,...,ip]
+ *
+ * @note no element is copied, the view points to the last element of the mode
+ * m and traverses it with the negated stride
+ *
+ * @code auto c = tensor<float>( reverse(a,1) ); @endcode
+ *
+ * @param[in] a tensor or tensor_view object of rank p
+ * @param[in] m reversed mode with 1 <= m <= p
+ * @returns     a tensor_view of the elements of a, read-only for tensors
+ */
+template <class T, class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE decltype(auto) reverse(T const &a, std::size_t const m) {
+  using view_type = std::conditional_t<
+      is_tensor_view_v<T>, T,
+      tensor_view<typename T::value_type const, typename T::layout_type>>;
+  using difference_type = typename view_type::difference_type;
+
+  if (m == 0 || m > a.rank())
+    throw std::length_error(
+        "error in boost::numeric::ublas::reverse: mode must be greater than "
+        "zero and less than or equal to the rank.");
+
+  if (a.empty()) return view_type{};
+
+  auto w = typename view_type::strides_type(a.strides().begin(),
+                                            a.strides().end());
+  auto const first = difference_type(a.extents()[m - 1] - 1) * w[m - 1];
+  w[m - 1] = -w[m - 1];
+
+  return view_type(a.data() + first, a.extents(), w);
+}
 /**
  *
  * @brief Computes the frobenius nor of a tensor
  *
- * @note Calls accumulate on the tensor.
+ * @note Calls detail::fold which sums up the squares with several vector
+ * registers and partitions the outermost mode across threads if OpenMP is
+ * enabled.
  *
  * implements
  * k = sqrt( sum_(i1,...,ip) A(i1,...,ip)^2 )
  *
- * @tparam V the data type of tensor
- * @tparam F the format of tensor storage
- * @tparam A the array_type of tensor
+ * @tparam T the type of tensor or tensor_view
  * @param a the tensor whose norm is expected of rank p.
+ * @param policy summation policy of the squares, e.g. pairwise_summation
  * @return the frobenius norm of a tensor.
  */
-template <class V, class F, class A>
-BOOST_UBLAS_INLINE decltype(auto) norm(tensor<V, F, A> const &a) {
+template <class T, class Policy = naive_summation,
+          class = std::enable_if_t<is_tensor_operand_v<T> &&
+                                   is_summation_policy_v<Policy>>>
+BOOST_UBLAS_INLINE decltype(auto) norm(T const &a, Policy policy = {}) {
+  using V = std::remove_const_t<typename T::value_type>;
   static_assert(std::is_default_constructible<V>::value,
                 "Value type of tensor must be default construct able in order "
                 "to call boost::numeric::ublas::norm");
@@ -431,11 +663,18 @@ BOOST_UBLAS_INLINE decltype(auto) norm(tensor<V, F, A> const &a) {
     throw std::runtime_error(
         "error in boost::numeric::ublas::norm: tensors should not be empty.");
   }
-  return std::sqrt(
-      accumulate(a.order(), a.extents().data(), a.data(), a.strides().data(),
-                 V{}, [](auto const &l, auto const &r) { return l + r * r; }));
-  // fixme: Why --^^ ?? Let's ask user to provide this maybe non-default
-  // constructed value.
+  auto const &ka = detail::kernel_operand(a);
+  if constexpr (std::is_same_v<Policy, naive_summation> ||
+                std::is_integral_v<V>) {
+    return std::sqrt(detail::fold(ka.rank(), ka.extents().data(), ka.data(),
+                                  ka.strides().data(), V{}, detail::simd::add{},
+                                  detail::simd::square{}));
+  } else {
+    return std::sqrt(detail::sum_terms<V>(
+        policy, ka.rank(), ka.extents().data(),
+        detail::unary_terms<V, detail::simd::square>{ka.data(),
+                                                     ka.strides().data(), {}}));
+  }
 }
 
 /** @brief Extract the real component of tensor elements within a tensor
@@ -0,0 +1,435 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+
+#ifndef BOOST_UBLAS_TENSOR_GEMM_HPP
+#define BOOST_UBLAS_TENSOR_GEMM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "allocator.hpp"
+#include "small_vector.hpp"
+
+namespace boost {
+namespace numeric {
+namespace ublas {
+namespace detail {
+namespace blocked {
+
+
+/** @brief Block sizes of the packed matrix-times-matrix kernel
+ *
+ * mr x nr is the register block computed by the micro-kernel,
+ * mc x kc is the panel of A that is packed and kept in the L2 cache,
+ * kc x nc is the panel of B that is packed and kept in the L3 cache.
+ *
+ * @tparam value_type type of the accumulated elements
+*/
+template<class value_type>
+struct gemm_block_sizes
+{
+	static constexpr std::size_t mr = sizeof(value_type) <= 4u ? 8u : 4u;
+	static constexpr std::size_t nr = 4u;
+	static constexpr std::size_t kc = 256u;
+	static constexpr std::size_t mc = 128u;
+	static constexpr std::size_t nc = 4096u;
+};
+
+
+/** @brief Packs a mc x kc block of a strided matrix A into row panels of height mr
+ *
+ * Panels are zero padded so that the micro-kernel always computes full mr x nr blocks.
+ *
+ * @param mc number of rows of the block
+ * @param kc number of columns of the block
+ * @param a  pointer to the first element of the block
+ * @param ra row stride of A
+ * @param ca column stride of A
+ * @param ap pointer to the packed buffer of size ceil(mc/mr)*mr*kc
+*/
+template<std::size_t mr, class PointerIn, class ValueType>
+void pack_a(std::size_t const mc, std::size_t const kc,
+            PointerIn a, std::ptrdiff_t const ra, std::ptrdiff_t const ca,
+            ValueType* ap)
+{
+	for(auto i = 0ul; i < mc; i += mr, a += std::ptrdiff_t(mr)*ra){
+		auto const m = std::min(mr, mc-i);
+		auto ak = a;
+		for(auto k = 0ul; k < kc; ++k, ak += ca, ap += mr){
+			auto ai = ak;
+			auto ii = 0ul;
+			for(; ii < m;  ++ii, ai += ra) ap[ii] = *ai;
+			for(; ii < mr; ++ii)           ap[ii] = ValueType{};
+		}
+	}
+}
+
+
+/** @brief Packs a kc x nc block of a strided matrix B into column panels of width nr
+ *
+ * Panels are zero padded so that the micro-kernel always computes full mr x nr blocks.
+ *
+ * @param kc number of rows of the block
+ * @param nc number of columns of the block
+ * @param b  pointer to the first element of the block
+ * @param rb row stride of B
+ * @param cb column stride of B
+ * @param bp pointer to the packed buffer of size ceil(nc/nr)*nr*kc
+*/
+template<std::size_t nr, class PointerIn, class ValueType>
+void pack_b(std::size_t const kc, std::size_t const nc,
+            PointerIn b, std::ptrdiff_t const rb, std::ptrdiff_t const cb,
+            ValueType* bp)
+{
+	for(auto j = 0ul; j < nc; j += nr, b += std::ptrdiff_t(nr)*cb){
+		auto const n = std::min(nr, nc-j);
+		auto bk = b;
+		for(auto k = 0ul; k < kc; ++k, bk += rb, bp += nr){
+			auto bj = bk;
+			auto jj = 0ul;
+			for(; jj < n;  ++jj, bj += cb) bp[jj] = *bj;
+			for(; jj < nr; ++jj)           bp[jj] = ValueType{};
+		}
+	}
+}
+
+
+/** @brief Computes a register block AB[mr,nr] = sum(Ap[mr,k] * Bp[k,nr]) with packed panels
+ *
+ * The loop bounds are compile-time constants so that the accumulator
+ * is kept in registers and the two inner loops are unrolled and vectorized.
+ *
+ * @param kc number of rank-1 updates
+ * @param ap pointer to a packed row panel of A
+ * @param bp pointer to a packed column panel of B
+ * @param ab pointer to the column-major mr x nr result block
+*/
+template<std::size_t mr, std::size_t nr, class ValueTypeA, class ValueTypeB, class ValueTypeC>
+inline void micro_kernel(std::size_t const kc,
+                         ValueTypeA const* ap, ValueTypeB const* bp,
+                         ValueTypeC* ab)
+{
+	ValueTypeC acc[mr*nr] = {};
+	for(auto k = 0ul; k < kc; ++k, ap += mr, bp += nr)
+		for(auto j = 0ul; j < nr; ++j){
+			auto const bj = bp[j];
+			for(auto i = 0ul; i < mr; ++i)
+				acc[j*mr+i] += ap[i] * bj;
+		}
+	for(auto i = 0ul; i < mr*nr; ++i)
+		ab[i] = acc[i];
+}
+
+
+/** @brief Returns the number of elements of a buffer for packed blocks of A
+ *
+ * @param m   number of rows of A
+ * @param k   number of columns of A
+ * @param all size for packing all blocks of A at once with pack_a_all if true, for a single block otherwise
+*/
+template<class value_type>
+std::size_t gemm_packed_size_a(std::size_t const m, std::size_t const k, bool const all)
+{
+	using sizes = gemm_block_sizes<value_type>;
+	auto const mp = (m+sizes::mr-1)/sizes::mr*sizes::mr;
+	return all ? mp*k : std::min(sizes::mc, mp) * std::min(sizes::kc, k);
+}
+
+/** @brief Returns the number of elements of a buffer for packed blocks of B
+ *
+ * @param k   number of rows of B
+ * @param n   number of columns of B
+ * @param all size for packing all blocks of B at once with pack_b_all if true, for a single block otherwise
+*/
+template<class value_type>
+std::size_t gemm_packed_size_b(std::size_t const k, std::size_t const n, bool const all)
+{
+	using sizes = gemm_block_sizes<value_type>;
+	auto const np = (n+sizes::nr-1)/sizes::nr*sizes::nr;
+	return all ? np*k : std::min(sizes::nc, np) * std::min(sizes::kc, k);
+}
+
+
+/** @brief Packs all mc x kc blocks of a strided m x k matrix A
+ *
+ * The block at row ic and column pc starts at ap + pc*ceil(m/mr)*mr + ic*kc
+ * so that gemm can use A without packing it again.
+ *
+ * @param ap pointer to the packed buffer of size gemm_packed_size_a(m,k,true)
+*/
+template<class value_type, class PointerIn, class ValueType>
+void pack_a_all(std::size_t const m, std::size_t const k,
+                PointerIn a, std::ptrdiff_t const ra, std::ptrdiff_t const ca,
+                ValueType* ap)
+{
+	using sizes = gemm_block_sizes<value_type>;
+	auto const mp = (m+sizes::mr-1)/sizes::mr*sizes::mr;
+	for(auto pc = 0ul; pc < k; pc += sizes::kc){
+		auto const kcb = std::min(sizes::kc, k-pc);
+		for(auto ic = 0ul; ic < m; ic += sizes::mc)
+			pack_a<sizes::mr>(std::min(sizes::mc, m-ic), kcb, a + std::ptrdiff_t(ic)*ra + std::ptrdiff_t(pc)*ca, ra, ca, ap + pc*mp + ic*kcb);
+	}
+}
+
+/** @brief Packs all kc x nc blocks of a strided k x n matrix B
+ *
+ * The block at row pc and column jc starts at bp + pc*ceil(n/nr)*nr + jc*kc
+ * so that gemm can use B without packing it again.
+ *
+ * @param bp pointer to the packed buffer of size gemm_packed_size_b(k,n,true)
+*/
+template<class value_type, class PointerIn, class ValueType>
+void pack_b_all(std::size_t const k, std::size_t const n,
+                PointerIn b, std::ptrdiff_t const rb, std::ptrdiff_t const cb,
+                ValueType* bp)
+{
+	using sizes = gemm_block_sizes<value_type>;
+	auto const np = (n+sizes::nr-1)/sizes::nr*sizes::nr;
+	for(auto pc = 0ul; pc < k; pc += sizes::kc){
+		auto const kcb = std::min(sizes::kc, k-pc);
+		for(auto jc = 0ul; jc < n; jc += sizes::nc)
+			pack_b<sizes::nr>(kcb, std::min(sizes::nc, n-jc), b + std::ptrdiff_t(pc)*rb + std::ptrdiff_t(jc)*cb, rb, cb, bp + pc*np + jc*kcb);
+	}
+}
+
+
+/** @brief Computes the strided matrix-times-matrix product with caller-provided packing buffers
+ *
+ * Implements C[i,j] = beta * C[i,j] + alpha * sum(A[i,k] * B[k,j])
+ *
+ * Allows to reuse the buffers and an operand that is packed once for a sequence of products,
+ * e.g. for the slices of a tensor-times-matrix product.
+ *
+ * @param ap       pointer to A packed with pack_a_all if a_packed is true, a buffer of size gemm_packed_size_a(m,k,false) otherwise
+ * @param a_packed A is not read if true
+ * @param bp       pointer to B packed with pack_b_all if b_packed is true, a buffer of size gemm_packed_size_b(k,n,false) otherwise
+ * @param b_packed B is not read if true
+ *
+ * @note all other parameters are the ones of gemm
+*/
+template<class PointerOut, class PointerIn1, class PointerIn2, class ValueType, class ValueTypeA, class ValueTypeB>
+void gemm(std::size_t const m, std::size_t const n, std::size_t const k,
+          ValueType const alpha,
+          PointerIn1 a, std::ptrdiff_t const ra, std::ptrdiff_t const ca,
+          PointerIn2 b, std::ptrdiff_t const rb, std::ptrdiff_t const cb,
+          ValueType const beta,
+          PointerOut c, std::ptrdiff_t const rc, std::ptrdiff_t const cc,
+          ValueTypeA* ap, bool const a_packed,
+          ValueTypeB* bp, bool const b_packed)
+{
+	static_assert( std::is_pointer<PointerOut>::value & std::is_pointer<PointerIn1>::value & std::is_pointer<PointerIn2>::value,
+	               "Static error in boost::numeric::ublas::detail::blocked::gemm: Argument types for pointers are not pointer types.");
+
+	using value_type_c = std::remove_cv_t<std::remove_pointer_t<PointerOut>>;
+	using sizes = gemm_block_sizes<value_type_c>;
+
+	constexpr auto mr = sizes::mr;
+	constexpr auto nr = sizes::nr;
+
+	if(m == 0u || n == 0u)
+		return;
+
+	if(k == 0u){
+		for(auto j = 0ul; j < n; ++j)
+			for(auto i = 0ul; i < m; ++i){
+				auto& cij = c[std::ptrdiff_t(i)*rc + std::ptrdiff_t(j)*cc];
+				cij = beta == ValueType{} ? value_type_c{} : value_type_c(beta * cij);
+			}
+		return;
+	}
+
+	auto const mp = (m+mr-1)/mr*mr;
+	auto const np = (n+nr-1)/nr*nr;
+	value_type_c ab[mr*nr];
+
+	for(auto jc = 0ul; jc < n; jc += sizes::nc){
+		auto const ncb = std::min(sizes::nc, n-jc);
+
+		for(auto pc = 0ul; pc < k; pc += sizes::kc){
+			auto const kcb = std::min(sizes::kc, k-pc);
+			auto const first = pc == 0u;
+
+			auto const bpc = b_packed ? bp + pc*np + jc*kcb : bp;
+			if(!b_packed)
+				pack_b<nr>(kcb, ncb, b + std::ptrdiff_t(pc)*rb + std::ptrdiff_t(jc)*cb, rb, cb, bp);
+
+			for(auto ic = 0ul; ic < m; ic += sizes::mc){
+				auto const mcb = std::min(sizes::mc, m-ic);
+
+				auto const apc = a_packed ? ap + pc*mp + ic*kcb : ap;
+				if(!a_packed)
+					pack_a<mr>(mcb, kcb, a + std::ptrdiff_t(ic)*ra + std::ptrdiff_t(pc)*ca, ra, ca, ap);
+
+				for(auto jr = 0ul; jr < ncb; jr += nr){
+					auto const nrb = std::min(nr, ncb-jr);
+
+					for(auto ir = 0ul; ir < mcb; ir += mr){
+						auto const mrb = std::min(mr, mcb-ir);
+
+						micro_kernel<mr,nr>(kcb, apc + ir*kcb, bpc + jr*kcb, ab);
+
+						auto cj = c + std::ptrdiff_t(ic+ir)*rc + std::ptrdiff_t(jc+jr)*cc;
+						for(auto j = 0ul; j < nrb; ++j, cj += cc){
+							auto ci = cj;
+							for(auto i = 0ul; i < mrb; ++i, ci += rc){
+								if(!first || beta == ValueType{1})
+									*ci += alpha * ab[j*mr+i];
+								else if(beta == ValueType{})
+									*ci  = alpha * ab[j*mr+i];
+								else
+									*ci  = beta * *ci + alpha * ab[j*mr+i];
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+
+/** @brief Computes the strided matrix-times-matrix product with packed and cache-blocked panels
+ *
+ * Implements C[i,j] = beta * C[i,j] + alpha * sum(A[i,k] * B[k,j])
+ *
+ * All matrices are described by a pointer and a row and column stride so that
+ * column-major, row-major and strided slices of tensors can be used without copying.
+ * If beta is zero, C is not read.
+ *
+ * @param m  number of rows of A and C
+ * @param n  number of columns of B and C
+ * @param k  number of columns of A and rows of B
+ * @param alpha scaling factor of the product
+ * @param a  pointer to A
+ * @param ra row stride of A
+ * @param ca column stride of A
+ * @param b  pointer to B
+ * @param rb row stride of B
+ * @param cb column stride of B
+ * @param beta scaling factor of C
+ * @param c  pointer to C
+ * @param rc row stride of C
+ * @param cc column stride of C
+*/
+template<class PointerOut, class PointerIn1, class PointerIn2, class ValueType>
+void gemm(std::size_t const m, std::size_t const n, std::size_t const k,
+          ValueType const alpha,
+          PointerIn1 a, std::ptrdiff_t const ra, std::ptrdiff_t const ca,
+          PointerIn2 b, std::ptrdiff_t const rb, std::ptrdiff_t const cb,
+          ValueType const beta,
+          PointerOut c, std::ptrdiff_t const rc, std::ptrdiff_t const cc)
+{
+	using value_type_a = std::remove_cv_t<std::remove_pointer_t<PointerIn1>>;
+	using value_type_b = std::remove_cv_t<std::remove_pointer_t<PointerIn2>>;
+	using value_type_c = std::remove_cv_t<std::remove_pointer_t<PointerOut>>;
+
+	if(m == 0u || n == 0u || k == 0u){
+		gemm(m, n, k, alpha, a, ra, ca, b, rb, cb, beta, c, rc, cc, (value_type_a*)nullptr, false, (value_type_b*)nullptr, false);
+		return;
+	}
+
+	auto ap = std::vector<value_type_a,aligned_allocator<value_type_a>>( gemm_packed_size_a<value_type_c>(m, k, false) );
+	auto bp = std::vector<value_type_b,aligned_allocator<value_type_b>>( gemm_packed_size_b<value_type_c>(k, n, false) );
+
+	gemm(m, n, k, alpha, a, ra, ca, b, rb, cb, beta, c, rc, cc, ap.data(), false, bp.data(), false);
+}
+
+
+/** @brief Result of collapsing a group of tensor modes into a single matrix index
+ *
+ * @note extent is the product of all extents of the group
+ * @note stride1 and stride2 are the strides of the fused index for two tensors
+ * @note fused1 and fused2 are true if the group is contiguous within the first or second tensor
+*/
+struct fused_modes
+{
+	std::size_t    extent  = 1u;
+	std::ptrdiff_t stride1 = 1;
+	std::ptrdiff_t stride2 = 1;
+	bool           fused1  = true;
+	bool           fused2  = true;
+};
+
+
+/** @brief Collapses a group of modes that is shared by two tensors into one index
+ *
+ * The modes are visited in the given order, i.e. the first mode is the fastest running one.
+ * Modes with extent one are skipped. The group is fused for a tensor if
+ * w[mode[i+1]] == w[mode[i]] * n[mode[i]] holds for all consecutive non-singleton modes.
+ *
+ * @param g   number of modes within the group
+ * @param n   pointer to the extents of the group of length g
+ * @param w1  pointer to the strides of the group with respect to the first tensor
+ * @param w2  pointer to the strides of the group with respect to the second tensor
+*/
+template<class SizeType>
+fused_modes fuse(std::size_t const g, SizeType const*const n, SizeType const*const w1, SizeType const*const w2)
+{
+	auto f = fused_modes{};
+	auto first = true;
+	auto last = std::size_t{};
+	for(auto i = 0ul; i < g; ++i){
+		if(n[i] == 1u)
+			continue;
+		if(first){
+			f.stride1 = std::ptrdiff_t(w1[i]);
+			f.stride2 = std::ptrdiff_t(w2[i]);
+			first = false;
+		}
+		else{
+			f.fused1 = f.fused1 && w1[i] == w1[last]*n[last];
+			f.fused2 = f.fused2 && w2[i] == w2[last]*n[last];
+		}
+		f.extent *= n[i];
+		last = i;
+	}
+	return f;
+}
+
+
+/** @brief Collapses the modes [first,last) of two tensors into one index
+ *
+ * The modes are ordered with respect to the strides of the first tensor before they are fused.
+ *
+ * @param first zero-based index of the first mode of the group
+ * @param last  zero-based index of the mode behind the last mode of the group
+ * @param n   pointer to the extents of both tensors
+ * @param w1  pointer to the strides of the first tensor
+ * @param w2  pointer to the strides of the second tensor
+*/
+template<class SizeType>
+fused_modes fuse(SizeType const first, SizeType const last, SizeType const*const n, SizeType const*const w1, SizeType const*const w2)
+{
+	using modes = small_vector<SizeType,BOOST_UBLAS_TENSOR_INLINE_RANK>;
+	auto const g = last > first ? last-first : SizeType(0);
+	auto o = modes(g);
+	for(auto i = 0ul; i < g; ++i)
+		o[i] = first + i;
+	std::stable_sort(o.begin(), o.end(), [w1](auto i, auto j){ return w1[i] < w1[j]; });
+	auto ng = modes(g), w1g = modes(g), w2g = modes(g);
+	for(auto i = 0ul; i < g; ++i){
+		ng [i] = n [o[i]];
+		w1g[i] = w1[o[i]];
+		w2g[i] = w2[o[i]];
+	}
+	return fuse(std::size_t(g), ng.data(), w1g.data(), w2g.data());
+}
+
+} // namespace blocked
+} // namespace detail
+} // namespace ublas
+} // namespace numeric
+} // namespace boost
+
+#endif
@@ -0,0 +1,443 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+/// \file mapped_storage.hpp Definition of the memory-mapped storage of tensors
+///
+/// The header requires a POSIX system and is not included by tensor.hpp.
+
+#ifndef BOOST_UBLAS_TENSOR_MAPPED_STORAGE_HPP
+#define BOOST_UBLAS_TENSOR_MAPPED_STORAGE_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !(defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__)))
+#error "boost/numeric/ublas/tensor/mapped_storage.hpp requires a POSIX system."
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_format.hpp"
+#include "storage_traits.hpp"
+#include "tensor.hpp"
+
+namespace boost::numeric::ublas {
+
+/** @brief Access rights of a memory-mapped file
+ *
+ * read_only maps the file without write permission so that writing elements
+ * is undefined behavior. read_write writes modified elements back to the
+ * file. copy_on_write keeps modified elements private to the process.
+ */
+enum class mapped_mode { read_only, read_write, copy_on_write };
+
+/** @brief Expected access pattern of memory-mapped elements */
+enum class mapped_access { normal, sequential, random };
+
+namespace detail {
+
+[[noreturn]] inline void throw_mapped_error(char const *what) {
+  throw std::system_error(errno, std::generic_category(),
+                          std::string("Error in boost::numeric::ublas::") +
+                              what);
+}
+
+/** @brief Closes a file descriptor at the end of a scope */
+struct mapped_file {
+  int fd = -1;
+
+  mapped_file(std::string const &path, int flags) {
+    fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (fd < 0) throw_mapped_error("mapped_array: cannot open file.");
+  }
+  mapped_file(mapped_file const &) = delete;
+  mapped_file &operator=(mapped_file const &) = delete;
+  ~mapped_file() { ::close(fd); }
+
+  void read(char *p, std::size_t n, std::size_t offset) const {
+    while (n > 0u) {
+      auto const r = ::pread(fd, p, n, off_t(offset));
+      if (r < 0 && errno == EINTR) continue;
+      if (r < 0) throw_mapped_error("mapped_array: cannot read file.");
+      if (r == 0)
+        throw std::runtime_error(
+            "Error in boost::numeric::ublas::mapped_array: file is too short.");
+      p += r, n -= std::size_t(r), offset += std::size_t(r);
+    }
+  }
+
+  void write(char const *p, std::size_t n, std::size_t offset) const {
+    while (n > 0u) {
+      auto const r = ::pwrite(fd, p, n, off_t(offset));
+      if (r < 0 && errno == EINTR) continue;
+      if (r < 0) throw_mapped_error("mapped_array: cannot write file.");
+      p += r, n -= std::size_t(r), offset += std::size_t(r);
+    }
+  }
+
+  std::size_t size() const {
+    struct stat s {};
+    if (::fstat(fd, &s) != 0)
+      throw_mapped_error("mapped_array: cannot query file size.");
+    return std::size_t(s.st_size);
+  }
+};
+
+inline file_header read_header(mapped_file const &file) {
+  char fixed[file_header::fixed_size];
+  file.read(fixed, sizeof(fixed), 0u);
+  auto const n = file_header::unpadded_size_of(file_header::rank_of(fixed));
+  if (n > file.size())
+    throw std::runtime_error(
+        "Error in boost::numeric::ublas::mapped_array: file is too short.");
+  auto bytes = std::vector<char>(n);
+  file.read(bytes.data(), bytes.size(), 0u);
+  return file_header::decode(bytes.data(), bytes.size());
+}
+
+} // namespace detail
+
+/** @brief A fixed-size array of elements in mapped memory
+ *
+ * The elements are either mapped from a file with mapped_array::map or
+ * stored in anonymous memory which is mapped on construction, so that
+ * temporaries of a mapped_tensor are not backed by a file. Pages are loaded
+ * by the operating system on first access and written back to a shared file
+ * on sync or when the array is destroyed.
+ *
+ * Arrays that are mapped from a file cannot be resized and are written in
+ * place by copy assignments of the same size.
+ *
+ * @tparam T trivially copyable element type
+ */
+template <class T> class mapped_array {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Static error in boost::numeric::ublas::mapped_array: element "
+                "type must be trivially copyable.");
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T &;
+  using const_reference = T const &;
+  using pointer = T *;
+  using const_pointer = T const *;
+  using iterator = T *;
+  using const_iterator = T const *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  mapped_array() = default;
+
+  /** @brief Maps anonymous memory for n elements with value v */
+  explicit mapped_array(size_type n, const_reference v = value_type{})
+      : mapped_array(anonymous(n)) {
+    if (!is_zero(v)) std::fill(begin(), end(), v);
+  }
+
+  /** @brief Maps anonymous memory with a copy of the elements of other */
+  mapped_array(mapped_array const &other) : mapped_array(anonymous(other.size_)) {
+    if (size_ > 0u) std::memcpy(data_, other.data_, size_ * sizeof(T));
+  }
+
+  mapped_array(mapped_array &&other) noexcept { swap(other); }
+
+  ~mapped_array() { unmap(); }
+
+  /** @brief Copies the elements of other into this array
+   *
+   * The elements are written in place if the sizes match. Otherwise this
+   * array is replaced by an anonymous copy unless it is mapped from a file.
+   */
+  mapped_array &operator=(mapped_array const &other) {
+    if (this == &other) return *this;
+    if (size_ == other.size_) {
+      if (size_ > 0u) std::memcpy(data_, other.data_, size_ * sizeof(T));
+      return *this;
+    }
+    if (file_)
+      throw std::length_error("Error in boost::numeric::ublas::mapped_array: "
+                              "size of a mapped file cannot be changed.");
+    auto copy = mapped_array(other);
+    swap(copy);
+    return *this;
+  }
+
+  mapped_array &operator=(mapped_array &&other) noexcept {
+    auto tmp = mapped_array(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  void swap(mapped_array &other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(base_, other.base_);
+    std::swap(length_, other.length_);
+    std::swap(file_, other.file_);
+  }
+
+  friend void swap(mapped_array &a, mapped_array &b) noexcept { a.swap(b); }
+
+  /** @brief Maps n elements of a file starting at offset bytes
+   *
+   * @param path path of the file that must hold offset + n*sizeof(T) bytes
+   * @param offset byte offset of the first element, a multiple of alignof(T)
+   * @param n number of elements
+   * @param mode access rights of the mapping
+   */
+  static mapped_array map(std::string const &path, std::size_t offset,
+                          size_type n, mapped_mode mode = mapped_mode::read_write) {
+    if (offset % alignof(T) != 0u)
+      throw std::invalid_argument("Error in boost::numeric::ublas::mapped_array: "
+                                  "offset is not aligned.");
+    auto const file = detail::mapped_file(
+        path, mode == mapped_mode::read_write ? O_RDWR : O_RDONLY);
+    auto const length = offset + n * sizeof(T);
+    if (file.size() < length)
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::mapped_array: file is too short.");
+
+    auto a = mapped_array{};
+    if (n == 0u) return a;
+    auto const prot = mode == mapped_mode::read_only ? PROT_READ
+                                                     : PROT_READ | PROT_WRITE;
+    auto const flags = mode == mapped_mode::copy_on_write ? MAP_PRIVATE : MAP_SHARED;
+    auto *base = ::mmap(nullptr, length, prot, flags, file.fd, 0);
+    if (base == MAP_FAILED) detail::throw_mapped_error("mapped_array: cannot map file.");
+    a.base_ = base;
+    a.length_ = length;
+    a.data_ = reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+    a.size_ = n;
+    a.file_ = true;
+    return a;
+  }
+
+  /** @brief Resizes an anonymous array and appends elements with value v
+   *
+   * @note throws std::length_error if the array is mapped from a file and n
+   * is not its size.
+   */
+  void resize(size_type n, const_reference v = value_type{}) {
+    if (n == size_) return;
+    if (file_)
+      throw std::length_error("Error in boost::numeric::ublas::mapped_array: "
+                              "size of a mapped file cannot be changed.");
+    auto a = anonymous(n);
+    auto const m = std::min(n, size_);
+    if (m > 0u) std::memcpy(a.data_, data_, m * sizeof(T));
+    if (n > m && !is_zero(v)) std::fill(a.data_ + m, a.data_ + n, v);
+    swap(a);
+  }
+
+  /** @brief Writes modified elements of a shared file mapping to the file */
+  void sync() const {
+    if (file_ && ::msync(base_, length_, MS_SYNC) != 0)
+      detail::throw_mapped_error("mapped_array: cannot synchronize file.");
+  }
+
+  /** @brief Tells the operating system how the elements will be accessed
+   *
+   * @note the advice is a hint and failures are ignored.
+   */
+  void advise(mapped_access access) const noexcept {
+    if (base_ == nullptr) return;
+    auto const advice = access == mapped_access::sequential ? MADV_SEQUENTIAL
+                        : access == mapped_access::random   ? MADV_RANDOM
+                                                            : MADV_NORMAL;
+    ::madvise(base_, length_, advice);
+  }
+
+  /** @brief Asks the operating system to load count elements starting at
+   * first before they are accessed
+   *
+   * @note the advice is a hint and failures are ignored.
+   */
+  void prefetch(size_type first, size_type count) const noexcept {
+    if (base_ == nullptr || first >= size_) return;
+    count = std::min(count, size_ - first);
+    auto const page = std::size_t(::sysconf(_SC_PAGESIZE));
+    auto const begin = reinterpret_cast<std::uintptr_t>(data_ + first) / page * page;
+    auto const end = reinterpret_cast<std::uintptr_t>(data_ + first + count);
+    ::madvise(reinterpret_cast<void *>(begin), end - begin, MADV_WILLNEED);
+  }
+
+  /** @brief Returns true if the elements are mapped from a file */
+  bool is_mapped_file() const noexcept { return file_; }
+
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0u; }
+
+  pointer data() noexcept { return data_; }
+  const_pointer data() const noexcept { return data_; }
+
+  reference operator[](size_type i) { return data_[i]; }
+  const_reference operator[](size_type i) const { return data_[i]; }
+
+  iterator begin() noexcept { return data_; }
+  iterator end() noexcept { return data_ + size_; }
+  const_iterator begin() const noexcept { return data_; }
+  const_iterator end() const noexcept { return data_ + size_; }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+private:
+  // anonymous pages are zero-filled by the operating system
+  static mapped_array anonymous(size_type n) {
+    auto a = mapped_array{};
+    if (n == 0u) return a;
+    if (n > std::size_t(-1) / sizeof(T)) throw std::bad_array_new_length();
+    auto const length = n * sizeof(T);
+    auto *base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) throw std::bad_alloc();
+    a.base_ = base;
+    a.length_ = length;
+    a.data_ = static_cast<T *>(base);
+    a.size_ = n;
+    return a;
+  }
+
+  static bool is_zero(const_reference v) noexcept {
+    auto const z = value_type{};
+    return std::memcmp(&v, &z, sizeof(T)) == 0;
+  }
+
+  void unmap() noexcept {
+    if (base_ != nullptr) ::munmap(base_, length_);
+    data_ = nullptr, size_ = 0u, base_ = nullptr, length_ = 0u, file_ = false;
+  }
+
+  T *data_ = nullptr;
+  size_type size_ = 0u;
+  void *base_ = nullptr;
+  std::size_t length_ = 0u;
+  bool file_ = false;
+};
+
+template <class V> struct storage_traits<mapped_array<V>> {
+  using array_type = mapped_array<V>;
+
+  using size_type = typename array_type::size_type;
+  using difference_type = typename array_type::difference_type;
+  using value_type = typename array_type::value_type;
+
+  using reference = typename array_type::reference;
+  using const_reference = typename array_type::const_reference;
+
+  using pointer = typename array_type::pointer;
+  using const_pointer = typename array_type::const_pointer;
+
+  using iterator = typename array_type::iterator;
+  using const_iterator = typename array_type::const_iterator;
+
+  using reverse_iterator = typename array_type::reverse_iterator;
+  using const_reverse_iterator = typename array_type::const_reverse_iterator;
+
+  template <class U> using rebind = mapped_array<U>;
+
+  // tensors copy elements into the mapping instead of replacing it
+  static constexpr bool assign_in_place = true;
+};
+
+/** @brief A tensor with elements in mapped memory
+ *
+ * @code
+ * auto a = create_mapped_tensor<float>("a.tensor", shape{1000,1000,100});
+ * auto b = open_mapped_tensor<float>("b.tensor", mapped_mode::read_only, mapped_access::sequential);
+ * a = 2*b;
+ * a.base().sync();
+ * @endcode
+ *
+ * @note assignments write the elements into the mapping, e.g. `a = b` copies
+ * the elements of b into the mapped file of a. The header of the file
+ * stores the extents of a, i.e. b must have the extents of a.
+ */
+template <class T, class F = first_order>
+using mapped_tensor = tensor<T, F, mapped_array<T>>;
+
+/** @brief Reads the header of a tensor file */
+inline file_header read_file_header(std::string const &path) {
+  auto const file = detail::mapped_file(path, O_RDONLY);
+  return detail::read_header(file);
+}
+
+/** @brief Creates a tensor file with zero elements and maps it with read and
+ * write access
+ *
+ * An existing file is overwritten.
+ *
+ * @param path path of the file
+ * @param e extents of the tensor
+ */
+template <class T, class F = first_order>
+mapped_tensor<T, F> create_mapped_tensor(std::string const &path, shape const &e) {
+  auto const h = file_header::make<T, F>(e);
+  {
+    auto const file = detail::mapped_file(path, O_RDWR | O_CREAT | O_TRUNC);
+    auto const bytes = h.encode();
+    file.write(bytes.data(), bytes.size(), 0u);
+    if (::ftruncate(file.fd, off_t(h.data_offset + h.data_size)) != 0)
+      detail::throw_mapped_error("create_mapped_tensor: cannot resize file.");
+  }
+  auto a = mapped_array<T>::map(path, h.data_offset, e.product(),
+                                mapped_mode::read_write);
+  return mapped_tensor<T, F>(e, std::move(a));
+}
+
+/** @brief Maps the elements of a tensor file
+ *
+ * @note throws std::runtime_error if element type or layout of the file do
+ * not match T and F.
+ *
+ * @param path path of the file
+ * @param mode access rights of the mapping
+ * @param access expected access pattern of the elements
+ */
+template <class T, class F = first_order>
+mapped_tensor<T, F> open_mapped_tensor(std::string const &path,
+                                       mapped_mode mode = mapped_mode::read_write,
+                                       mapped_access access = mapped_access::normal) {
+  auto const h = read_file_header(path);
+  h.check<T, F>();
+  auto const w = basic_strides<std::size_t, F>(h.extents);
+  if (!std::equal(w.begin(), w.end(), h.strides.begin(), h.strides.end()))
+    throw std::runtime_error("Error in boost::numeric::ublas::open_mapped_tensor: "
+                             "strides of the file are not supported.");
+  auto a = mapped_array<T>::map(path, h.data_offset, h.extents.product(), mode);
+  a.advise(access);
+  return mapped_tensor<T, F>(h.extents, std::move(a));
+}
+
+} // namespace boost::numeric::ublas
+
+#endif
@@ -14,6 +14,19 @@
 #define BOOST_UBLAS_TENSOR_MULTIPLICATION
 
 #include <cassert>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "algorithms.hpp"
+#include "allocator.hpp"
+#include "fixed_multiplication.hpp"
+#include "gemm.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "small_vector.hpp"
 
 namespace boost {
 namespace numeric {
@@ -563,6 +576,473 @@ void outer(SizeType const k,
 
 
 } // namespace recursive
+
+
+namespace blocked {
+
+/** @brief Minimum number of multiply-add operations for which ttt is mapped onto gemm */
+constexpr std::size_t ttt_threshold = 4096u;
+
+
+/** @brief Layout of a tensor-times-tensor product as a matrix-times-matrix product
+ *
+ * Holds the dimensions m, n and k of the product, the strides with which A, B and C are
+ * read as matrices and the strides of the contiguous copies of A and B if their modes
+ * cannot be fused. Computed by ttt_layout for fixed extents and strides of the operands.
+*/
+template <class SizeType>
+struct ttt_matrix_layout
+{
+	bool valid = false;
+	std::size_t m = 1u, n = 1u, k = 1u;
+	std::ptrdiff_t ra = 1, ca = 1, rb = 1, cb = 1, rc = 1, cc = 1;
+	bool copy_a = false, copy_b = false;
+	// strides of the copies of A and B, empty if the operand is not copied
+	small_vector<SizeType,BOOST_UBLAS_TENSOR_INLINE_RANK> wta, wtb;
+};
+
+
+/** @brief Maps a tensor-times-tensor product for q contraction modes onto a matrix-times-matrix product
+ *
+ * The free modes of A, the free modes of B and the contraction modes are fused into the
+ * three dimensions of a matrix-times-matrix product (TTGT). An operand is only copied into
+ * a contiguous buffer if its modes cannot be fused according to its strides. The order of
+ * the contraction modes is chosen such that the number of copied elements is minimal.
+ *
+ * @note is used in function ttt and by contraction_plan, see blocked::ttt for the parameters.
+ * The extents of B are not passed as they are given by nc and by the contraction extents of A.
+ *
+ * @returns a layout that is not valid if the shapes are degenerated, the product is too small or C cannot be viewed as a matrix.
+*/
+template <class SizeType>
+ttt_matrix_layout<SizeType> ttt_layout(SizeType const r, SizeType const s, SizeType const q,
+                                       SizeType const*const phia, SizeType const*const phib,
+                                       SizeType const*const nc, SizeType const*const wc,
+                                       SizeType const*const na, SizeType const*const wa,
+                                       SizeType const*const wb)
+{
+	auto l = ttt_matrix_layout<SizeType>{};
+
+	if(q == 0u || (r == 0u && s == 0u))
+		return l;
+
+	auto const pa = r+q;
+	auto const pb = s+q;
+
+	auto nk = [na,phia,r](SizeType i){ return na[phia[r+i]-1]; };
+
+	auto const m = std::accumulate(nc,   nc+r,   std::size_t(1), std::multiplies<>());
+	auto const n = std::accumulate(nc+r, nc+r+s, std::size_t(1), std::multiplies<>());
+	auto k = std::size_t(1);
+	for(auto i = SizeType(0); i < q; ++i)
+		k *= nk(i);
+
+	if(m*n*k < ttt_threshold)
+		return l;
+
+	using modes = small_vector<SizeType,BOOST_UBLAS_TENSOR_INLINE_RANK>;
+
+	// sorts the modes [first,first+g) of a group with respect to the strides w
+	auto order = [](SizeType const first, SizeType const g, auto const& w){
+		auto o = modes(g);
+		std::iota(o.begin(), o.end(), first);
+		std::stable_sort(o.begin(), o.end(), [&w](auto i, auto j){ return w(i) < w(j); });
+		return o;
+	};
+
+	auto group = [](modes const& o, auto const& n, auto const& w1, auto const& w2){
+		auto const g = o.size();
+		auto ng = modes(g), w1g = modes(g), w2g = modes(g);
+		for(auto i = 0ul; i < g; ++i){
+			ng[i]  = n (o[i]);
+			w1g[i] = w1(o[i]);
+			w2g[i] = w2(o[i]);
+		}
+		return fuse(g, ng.data(), w1g.data(), w2g.data());
+	};
+
+	auto nci = [nc](SizeType i){ return nc[i]; };
+	auto wci = [wc](SizeType i){ return wc[i]; };
+
+	// free modes of A and B in the order of C
+	auto waf = [wa,phia  ](SizeType i){ return wa[phia[i]-1];   };
+	auto wbf = [wb,phib,r](SizeType i){ return wb[phib[i-r]-1]; };
+	auto om = order(0u, r, wci);
+	auto on = order(r,  s, wci);
+	auto fm = group(om, nci, wci, waf);
+	auto fn = group(on, nci, wci, wbf);
+
+	if(!fm.fused1 || !fn.fused1)
+		return l;
+
+	// contraction modes either in the order of A or in the order of B
+	auto wak = [wa,phia,r](SizeType i){ return wa[phia[r+i]-1]; };
+	auto wbk = [wb,phib,s](SizeType i){ return wb[phib[s+i]-1]; };
+	auto oka = order(0u, q, wak);
+	auto okb = order(0u, q, wbk);
+	auto fka = group(oka, nk, wak, wbk);
+	auto fkb = group(okb, nk, wak, wbk);
+
+	auto copies = [m,n,k,&fm,&fn](fused_modes const& fk){
+		return std::size_t(!(fm.fused2 && fk.fused1))*m*k + std::size_t(!(fn.fused2 && fk.fused2))*k*n;
+	};
+
+	auto const use_a_order = copies(fka) <= copies(fkb);
+	auto const& ok = use_a_order ? oka : okb;
+	auto const& fk = use_a_order ? fka : fkb;
+
+	l.valid = true;
+	l.m = m, l.n = n, l.k = k;
+	l.rc = fm.stride1, l.cc = fn.stride1;
+	l.copy_a = !(fm.fused2 && fk.fused1);
+	l.copy_b = !(fn.fused2 && fk.fused2);
+
+	l.ra = fm.stride2, l.ca = fk.stride1;
+	if(l.copy_a){
+		// A is copied into a column-major m x k matrix
+		l.wta = modes(pa, SizeType(0));
+		auto w = SizeType(1);
+		for(auto i : om) { l.wta[phia[i]-1]   = w; w *= nc[i]; }
+		for(auto i : ok) { l.wta[phia[r+i]-1] = w; w *= nk(i); }
+		l.ra = 1; l.ca = std::ptrdiff_t(m);
+	}
+
+	l.rb = fk.stride2, l.cb = fn.stride2;
+	if(l.copy_b){
+		// B is copied into a column-major k x n matrix
+		l.wtb = modes(pb, SizeType(0));
+		auto w = SizeType(1);
+		for(auto i : ok) { l.wtb[phib[s+i]-1] = w; w *= nk(i); }
+		for(auto i : on) { l.wtb[phib[i-r]-1] = w; w *= nc[i]; }
+		l.rb = 1; l.cb = std::ptrdiff_t(k);
+	}
+
+	return l;
+}
+
+
+/** @brief Computes a tensor-times-tensor product with a layout computed by ttt_layout
+ *
+ * Copies A and B into contiguous buffers if the layout requires it and calls gemm.
+ *
+ * @param l  valid layout for the extents and strides of A, B and C
+ * @param c  pointer to the output tensor C
+ * @param a  pointer to the first input tensor A with rank pa
+ * @param pa rank of A
+ * @param na pointer to the extents of the first input tensor A
+ * @param wa pointer to the strides of the first input tensor A
+ * @param b  pointer to the second input tensor B with rank pb
+ * @param pb rank of B
+ * @param nb pointer to the extents of the second input tensor B
+ * @param wb pointer to the strides of the second input tensor B
+ * @param accumulate adds the product to C if true and overwrites C without reading it otherwise
+*/
+template <class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+void ttt(ttt_matrix_layout<SizeType> const& l, PointerOut c,
+         PointerIn1 a, SizeType const pa, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, SizeType const pb, SizeType const*const nb, SizeType const*const wb,
+         bool const accumulate)
+{
+	using value_type_a = std::remove_cv_t<std::remove_pointer_t<PointerIn1>>;
+	using value_type_b = std::remove_cv_t<std::remove_pointer_t<PointerIn2>>;
+	using value_type_c = std::remove_cv_t<std::remove_pointer_t<PointerOut>>;
+
+	assert(l.valid);
+
+	auto ta = std::vector<value_type_a,aligned_allocator<value_type_a>>(l.copy_a ? l.m*l.k : 0u);
+	auto tb = std::vector<value_type_b,aligned_allocator<value_type_b>>(l.copy_b ? l.k*l.n : 0u);
+
+	auto pa_ = a;
+	if(l.copy_a){
+		ublas::copy(pa, na, ta.data(), l.wta.data(), a, wa);
+		pa_ = ta.data();
+	}
+
+	auto pb_ = b;
+	if(l.copy_b){
+		ublas::copy(pb, nb, tb.data(), l.wtb.data(), b, wb);
+		pb_ = tb.data();
+	}
+
+	gemm(l.m, l.n, l.k, value_type_c(1), pa_, l.ra, l.ca, pb_, l.rb, l.cb, value_type_c(accumulate ? 1 : 0), c, l.rc, l.cc);
+}
+
+
+/** @brief Computes the tensor-times-tensor product for q contraction modes with a blocked matrix-times-matrix kernel
+ *
+ * Implements C[i1,...,ir,j1,...,js] = sum( A[i1,...,ir+q] * B[j1,...,js+q]  )
+ *
+ * The product is mapped onto gemm by ttt_layout.
+ *
+ * nc[x]         = na[phia[x]  ] for 1 <= x <= r
+ * nc[r+x]       = nb[phib[x]  ] for 1 <= x <= s
+ * na[phia[r+x]] = nb[phib[s+x]] for 1 <= x <= q
+ *
+ * @note is used in function ttt
+ *
+ * @param r  number of non-contraction indices of A
+ * @param s  number of non-contraction indices of B
+ * @param q  number of contraction indices with q > 0
+ * @param phia pointer to the permutation tuple of length q+r for A
+ * @param phib pointer to the permutation tuple of length q+s for B
+ * @param c  pointer to the output tensor C with rank(A)=r+s
+ * @param nc pointer to the extents of tensor C
+ * @param wc pointer to the strides of tensor C
+ * @param a  pointer to the first input tensor with rank(A)=r+q
+ * @param na pointer to the extents of the first input tensor A
+ * @param wa pointer to the strides of the first input tensor A
+ * @param b  pointer to the second input tensor B with rank(B)=s+q
+ * @param nb pointer to the extents of the second input tensor B
+ * @param wb pointer to the strides of the second input tensor B
+ * @param accumulate adds the product to C if true and overwrites C without reading it otherwise
+ *
+ * @returns false if the shapes are degenerated or C cannot be viewed as a matrix. C is not modified in that case.
+*/
+template <class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+bool ttt(SizeType const r, SizeType const s, SizeType const q,
+         SizeType const*const phia, SizeType const*const phib,
+         PointerOut c, SizeType const*const nc, SizeType const*const wc,
+         PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, SizeType const*const nb, SizeType const*const wb,
+         bool const accumulate)
+{
+	auto const l = ttt_layout(r, s, q, phia, phib, nc, wc, na, wa, wb);
+	if(!l.valid)
+		return false;
+
+	ttt(l, c, a, SizeType(r+q), na, wa, b, SizeType(s+q), nb, wb, accumulate);
+	return true;
+}
+
+
+
+/** @brief Minimum number of multiply-add operations for which ttm is mapped onto gemm */
+constexpr std::size_t ttm_threshold = 4096u;
+
+
+/** @brief Computes the tensor-times-matrix product with slice-wise calls of a blocked matrix-times-matrix kernel
+ *
+ * Implements C[i1,i2,...,im-1,j,im+1,...,ip] = sum(A[i1,i2,...,im,...,ip] * B[j,im])
+ *
+ * The modes in front of and behind the contraction mode are fused into a left and right index
+ * so that A and C are viewed as three-dimensional arrays without copying. If the left or
+ * right index is one, a single matrix-times-matrix product is computed. Otherwise the
+ * product is computed for every slice of the outer index. B is packed only once and the
+ * packing buffer of A is shared by all slices.
+ *
+ * @note is used in function ttm
+ *
+ * @param m  zero-based contraction mode with 0<=m<p
+ * @param p  number of dimensions (rank) of the first input tensor with p > 0
+ * @param c  pointer to the output tensor
+ * @param nc pointer to the extents of tensor c
+ * @param wc pointer to the strides of tensor c
+ * @param a  pointer to the first input tensor
+ * @param na pointer to the extents of input tensor a
+ * @param wa pointer to the strides of input tensor a
+ * @param b  pointer to the second input tensor
+ * @param nb pointer to the extents of input tensor b
+ * @param wb pointer to the strides of input tensor b
+ * @param accumulate adds the product to C if true and overwrites C without reading it otherwise
+ *
+ * @returns false if the modes of A or C cannot be fused or the product is too small. C is not modified in that case.
+*/
+template <class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+bool ttm(SizeType const m, SizeType const p,
+         PointerOut c, SizeType const*const nc, SizeType const*const wc,
+         PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, [[maybe_unused]] SizeType const*const nb, SizeType const*const wb,
+         bool const accumulate)
+{
+	using value_type_a = std::remove_cv_t<std::remove_pointer_t<PointerIn1>>;
+	using value_type_b = std::remove_cv_t<std::remove_pointer_t<PointerIn2>>;
+	using value_type_c = std::remove_cv_t<std::remove_pointer_t<PointerOut>>;
+
+	auto const fl = fuse(SizeType(0), m, na, wa, wc);
+	auto const fr = fuse(m+1,         p, na, wa, wc);
+
+	if(!fl.fused1 || !fl.fused2 || !fr.fused1 || !fr.fused2)
+		return false;
+
+	auto const nl = fl.extent;
+	auto const nr = fr.extent;
+	auto const nj = nc[m];
+	auto const nk = na[m];
+
+	assert(nb[0] == nj && nb[1] == nk);
+
+	if(nl*nr*nj*nk < ttm_threshold)
+		return false;
+
+	auto const wam = std::ptrdiff_t(wa[m]);
+	auto const wcm = std::ptrdiff_t(wc[m]);
+	auto const rb  = std::ptrdiff_t(wb[0]);
+	auto const cb  = std::ptrdiff_t(wb[1]);
+	auto const one = value_type_c(1);
+	auto const beta = value_type_c(accumulate ? 1 : 0);
+
+	// B is packed once for all slices, A is packed block by block into a reused buffer
+	if(nl == 1u || (nr != 1u && fr.stride1 < fl.stride1)){
+		// C[j,r] += B[j,k] * A[k,r] for every left index
+		auto bp = std::vector<value_type_b,aligned_allocator<value_type_b>>( gemm_packed_size_a<value_type_c>(nj, nk, true)  );
+		auto ap = std::vector<value_type_a,aligned_allocator<value_type_a>>( gemm_packed_size_b<value_type_c>(nk, nr, false) );
+		pack_a_all<value_type_c>(nj, nk, b, rb, cb, bp.data());
+		for(auto l = 0ul; l < nl; ++l, a += fl.stride1, c += fl.stride2)
+			gemm(nj, nr, nk, one, b, rb, cb, a, wam, fr.stride1, beta, c, wcm, fr.stride2, bp.data(), true, ap.data(), false);
+	}
+	else{
+		// C[l,j] += A[l,k] * B[j,k] for every right index
+		auto ap = std::vector<value_type_a,aligned_allocator<value_type_a>>( gemm_packed_size_a<value_type_c>(nl, nk, false) );
+		auto bp = std::vector<value_type_b,aligned_allocator<value_type_b>>( gemm_packed_size_b<value_type_c>(nk, nj, true)  );
+		pack_b_all<value_type_c>(nk, nj, b, cb, rb, bp.data());
+		for(auto r = 0ul; r < nr; ++r, a += fr.stride1, c += fr.stride2)
+			gemm(nl, nj, nk, one, a, fl.stride1, wam, b, cb, rb, beta, c, fl.stride2, wcm, ap.data(), false, bp.data(), true);
+	}
+
+	return true;
+}
+
+
+/** @brief Minimum number of multiply-adds nl*nk*nr for which the vectorized ttv is used */
+constexpr std::size_t ttv_threshold = 1024u;
+
+/** @brief Number of elements of C that are updated for all contracted elements before moving on */
+constexpr std::size_t ttv_block = 1024u;
+
+
+/** @brief Computes the tensor-times-vector product with vectorized inner loops
+ *
+ * Implements C[i1,...,im-1,im+1,...,ip] += sum(A[i1,...,im,...,ip] * b[im])
+ *
+ * The modes [0,m) and (m,p) of A and C are fused into a left index l and a right index r so that
+ * C[l,r] += sum(A[l,k,r] * b[k]). The innermost loop always runs over the unit-stride index of A:
+ * if the contraction mode is unit-stride, C[l,r] is the inner product of a contiguous row of A with b.
+ * Otherwise a block of contiguous elements of C is updated with scaled contiguous rows of A
+ * for all k so that the block stays in the L1 cache and A is streamed only once.
+ *
+ * @note b is expected to be contiguous
+ *
+ * @param m  zero-based contraction mode with 0<=m<p
+ * @param p  rank of A with p > 1
+ * @param c  pointer to the output tensor with rank p-1
+ * @param nc pointer to the extents of tensor c
+ * @param wc pointer to the strides of tensor c
+ * @param a  pointer to the first input tensor
+ * @param na pointer to the extents of input tensor a
+ * @param wa pointer to the strides of input tensor a
+ * @param b  pointer to the input vector
+ * @param accumulate adds the product to C if true and overwrites C without reading it otherwise
+ *
+ * @returns false if the value types differ, the modes of A or C cannot be fused or the product is too small. C is not modified in that case.
+*/
+template <class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+bool ttv(SizeType const m, SizeType const p,
+         PointerOut c, SizeType const*const  , SizeType const*const wc,
+         PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, bool const accumulate)
+{
+	using value_type_a = std::remove_cv_t<std::remove_pointer_t<PointerIn1>>;
+	using value_type_b = std::remove_cv_t<std::remove_pointer_t<PointerIn2>>;
+	using value_type_c = std::remove_cv_t<std::remove_pointer_t<PointerOut>>;
+
+	if constexpr(!std::is_same<value_type_a,value_type_c>::value || !std::is_same<value_type_b,value_type_c>::value){
+		return false;
+	}
+	else{
+		// strides of C with respect to the modes of A
+		auto wcm = small_vector<SizeType,BOOST_UBLAS_TENSOR_INLINE_RANK>(p);
+		for(auto i = 0u; i < p; ++i)
+			wcm[i] = i < m ? wc[i] : ( i > m ? wc[i-1] : SizeType(0) );
+
+		auto const fl = fuse(SizeType(0), m, na, wa, wcm.data());
+		auto const fr = fuse(m+1,         p, na, wa, wcm.data());
+
+		if(!fl.fused1 || !fl.fused2 || !fr.fused1 || !fr.fused2)
+			return false;
+
+		auto const nl  = fl.extent;
+		auto const nr  = fr.extent;
+		auto const nk  = std::size_t(na[m]);
+		auto const wam = std::ptrdiff_t(wa[m]);
+
+		if(nl*nr*nk < ttv_threshold)
+			return false;
+
+		// C[o,i] += sum(A[o,k,i] * b[k]) where i is unit-stride in A and C
+		auto const axpy_blocked = [nk,wam,a,b,c,accumulate](std::size_t no, std::ptrdiff_t woa, std::ptrdiff_t woc, std::size_t ni){
+			for(auto o = 0ul; o < no; ++o){
+				auto ao = a + std::ptrdiff_t(o)*woa;
+				auto co = c + std::ptrdiff_t(o)*woc;
+				for(auto i = 0ul; i < ni; i += ttv_block){
+					auto const bi = std::min(ttv_block, ni-i);
+					auto ak = ao + i;
+					for(auto k = 0ul; k < nk; ++k, ak += wam)
+						if(k == 0u && !accumulate)
+							simd::scal(bi, b[k], ak, co + i);
+						else
+							simd::axpy(bi, b[k], ak, co + i);
+				}
+			}
+		};
+
+		if(wam == 1){
+			// C[l,r] += A[l,:,r] * b for every left and right index
+			for(auto r = 0ul; r < nr; ++r){
+				auto ar = a + std::ptrdiff_t(r)*fr.stride1;
+				auto cr = c + std::ptrdiff_t(r)*fr.stride2;
+				for(auto l = 0ul; l < nl; ++l, ar += fl.stride1, cr += fl.stride2)
+					*cr = accumulate ? *cr + simd::dot(nk, ar, b) : simd::dot(nk, ar, b);
+			}
+		}
+		else if(nl > 1u && fl.stride1 == 1 && fl.stride2 == 1){
+			axpy_blocked(nr, fr.stride1, fr.stride2, nl);
+		}
+		else if(nr > 1u && fr.stride1 == 1 && fr.stride2 == 1){
+			axpy_blocked(nl, fl.stride1, fl.stride2, nr);
+		}
+		else{
+			return false;
+		}
+
+		return true;
+	}
+}
+
+} // namespace blocked
+
+
+namespace parallel {
+
+/** @brief Computes the inner product of two tensors with partial sums of the outermost mode
+ *
+ * Implements c = v + sum(A[i1,i2,...,ip] * B[i1,i2,...,ip])
+ *
+ * @param p  rank of both tensors with p > 0
+ * @param n  pointer to the extents of both tensors
+ * @param a  pointer to the first input tensor
+ * @param wa pointer to the strides of input tensor a
+ * @param b  pointer to the second input tensor
+ * @param wb pointer to the strides of input tensor b
+ * @param v  inital value
+*/
+template <class PointerIn1, class PointerIn2, class value_t, class SizeType>
+value_t inner(SizeType const p, SizeType const*const n,
+              PointerIn1 a, SizeType const*const wa,
+              PointerIn2 b, SizeType const*const wb,
+              value_t v)
+{
+	auto const o    = outermost(p, n, wa);
+	auto const work = std::accumulate(n, n+p, std::size_t(1), std::multiplies<>());
+	if(o == p || num_threads(work, n[o]) < 2u)
+		return recursive::inner(p-1, n, a, wa, b, wb, v);
+
+	return reduce_range(work, n[o], v, [&](std::size_t first, std::size_t last, value_t v){
+		auto const ns = slice(p, n, o, SizeType(last-first));
+		return recursive::inner(p-1, ns.data(), a + first*wa[o], wa, b + first*wb[o], wb, v);
+	});
+}
+
+} // namespace parallel
 } // namespace detail
 } // namespace ublas
 } // namespace numeric
@@ -594,7 +1074,8 @@ namespace ublas {
  *   C[i1,i2,...,im-1,im+1,...,ip] = sum(A[i1,i2,...,im,...,ip] * b[im]) for m>1 and
  *   C[i2,...,ip]                  = sum(A[i1,...,ip]           * b[i1]) for m=1
  *
- * @note calls detail::ttv, detail::ttv0 or detail::mtv
+ * @note calls detail::fixed::ttv, detail::blocked::ttv, detail::ttv, detail::ttv0 or detail::mtv
+ * @note the outermost mode of C is partitioned across threads if OpenMP is enabled
  *
  * @param[in]  m  contraction mode with 0 < m <= p
  * @param[in]  p  number of dimensions (rank) of the first input tensor with p > 0
@@ -607,12 +1088,14 @@ namespace ublas {
  * @param[in]  b  pointer to the second input tensor
  * @param[in]  nb pointer to the extents of input tensor b
  * @param[in]  wb pointer to the strides of input tensor b
+ * @param[in]  accumulate adds the product to C if true and overwrites C without reading it otherwise
 */
 template <class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
 void ttv(SizeType const m, SizeType const p,
          PointerOut c,       SizeType const*const nc, SizeType const*const wc,
          const PointerIn1 a, SizeType const*const na, SizeType const*const wa,
-         const PointerIn2 b, SizeType const*const nb, SizeType const*const wb)
+         const PointerIn2 b, SizeType const*const nb, SizeType const*const wb,
+         bool const accumulate)
 {
 	static_assert( std::is_pointer<PointerOut>::value & std::is_pointer<PointerIn1>::value & std::is_pointer<PointerIn2>::value,
 	               "Static error in boost::numeric::ublas::ttv: Argument types for pointers are not pointer types.");
@@ -642,19 +1125,66 @@ void ttv(SizeType const m, SizeType const p,
 		throw std::length_error("Error in boost::numeric::ublas::ttv: Extent of dimension mode of A and b must be equal.");
 
 
-	if((m != 1) && (p > 2))
-		detail::recursive::ttv(m-1, p-1, p-2, c, nc, wc,    a, na, wa,   b);
-	else if ((m == 1) && (p > 2))
-		detail::recursive::ttv0(p-1, c, nc, wc,  a, na, wa,   b);
-	else if( p == 2 )
-		detail::recursive::mtv(m-1, c, nc, wc,  a, na, wa,   b);
-	else /*if( p == 1 )*/{
-		auto v = std::remove_pointer_t<std::remove_cv_t<PointerOut>>{};
+	if( p == 1 ){
+		auto v = accumulate ? *c : std::remove_pointer_t<std::remove_cv_t<PointerOut>>{};
 		*c = detail::recursive::inner(SizeType(0), na, a, wa, b, wb, v);
+		return;
 	}
 
+	if(detail::fixed::ttv(m-1, p, c, nc, wc, a, na, wa, b, accumulate))
+		return;
+
+	auto const run = [m,p,wc,wa,b,accumulate](PointerOut c, SizeType const*const nc, PointerIn1 a, SizeType const*const na)
+	{
+		if(detail::blocked::ttv(m-1, p, c, nc, wc, a, na, wa, b, accumulate))
+			return;
+
+		// the recursive kernels accumulate into the slice of C
+		if(!accumulate)
+			ublas::fill(p-1, nc, c, wc, std::remove_pointer_t<std::remove_cv_t<PointerOut>>{});
+
+		if((m != 1) && (p > 2))
+			detail::recursive::ttv(m-1, p-1, p-2, c, nc, wc,    a, na, wa,   b);
+		else if ((m == 1) && (p > 2))
+			detail::recursive::ttv0(p-1, c, nc, wc,  a, na, wa,   b);
+		else /*if( p == 2 )*/
+			detail::recursive::mtv(m-1, c, nc, wc,  a, na, wa,   b);
+	};
+
+	// partitions the outermost free mode of C across threads
+	auto const pc   = p-1;
+	auto const o    = detail::parallel::outermost(pc, nc, wc);
+	auto const work = std::accumulate(na, na+p, std::size_t(1), std::multiplies<>());
+	if(o == pc || detail::parallel::num_threads(work, nc[o]) < 2u){
+		run(c, nc, a, na);
+		return;
+	}
+
+	auto const oa = o < m-1 ? o : o+1;
+	detail::parallel::for_each_range(work, nc[o], [&](std::size_t first, std::size_t last){
+		auto const ncs = detail::parallel::slice(pc, nc, o,  SizeType(last-first));
+		auto const nas = detail::parallel::slice(p,  na, oa, SizeType(last-first));
+		run(c + first*wc[o], ncs.data(), a + first*wa[oa], nas.data());
+	});
 }
 
+/** @brief Computes the tensor-times-vector product without an accumulate flag
+ *
+ * C is overwritten if p is one, i.e. for the inner product of two vectors.
+ * Otherwise the product is added to C.
+ *
+ * @note calls ttv with accumulate = p > 1
+*/
+template <class PointerOut, class PointerIn1, class PointerIn2, class SizeType>
+void ttv(SizeType const m, SizeType const p,
+         PointerOut c,       SizeType const*const nc, SizeType const*const wc,
+         const PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         const PointerIn2 b, SizeType const*const nb, SizeType const*const wb)
+{
+	ttv(m,p, c,nc,wc, a,na,wa, b,nb,wb, p > 1);
+}
+
+
 
 
 /** @brief Computes the tensor-times-matrix product
@@ -663,7 +1193,8 @@ void ttv(SizeType const m, SizeType const p,
  *   C[i1,i2,...,im-1,j,im+1,...,ip] = sum(A[i1,i2,...,im,...,ip] * B[j,im]) for m>1 and
  *   C[j,i2,...,ip]                  = sum(A[i1,i2,...,ip]        * B[j,i1]) for m=1
  *
- * @note calls detail::ttm or detail::ttm0
+ * @note calls detail::fixed::ttm, detail::blocked::ttm, detail::ttm or detail::ttm0
+ * @note the outermost mode of C is partitioned across threads if OpenMP is enabled
  *
  * @param[in]  m  contraction mode with 0 < m <= p
  * @param[in]  p  number of dimensions (rank) of the first input tensor with p > 0
@@ -676,13 +1207,15 @@ void ttv(SizeType const m, SizeType const p,
  * @param[in]  b  pointer to the second input tensor
  * @param[in]  nb pointer to the extents of input tensor b
  * @param[in]  wb pointer to the strides of input tensor b
+ * @param[in]  accumulate adds the product to C if true and overwrites C without reading it otherwise
 */
 
 template <class PointerIn1, class PointerIn2, class PointerOut, class SizeType>
 void ttm(SizeType const m, SizeType const p,
          PointerOut c,       SizeType const*const nc, SizeType const*const wc,
          const PointerIn1 a, SizeType const*const na, SizeType const*const wa,
-         const PointerIn2 b, SizeType const*const nb, SizeType const*const wb)
+         const PointerIn2 b, SizeType const*const nb, SizeType const*const wb,
+         bool const accumulate)
 {
 
 	static_assert( std::is_pointer<PointerOut>::value & std::is_pointer<PointerIn1>::value & std::is_pointer<PointerIn2>::value,
@@ -714,11 +1247,58 @@ void ttm(SizeType const m, SizeType const p,
 	if(nc[m-1] != nb[0])
 		throw std::length_error("Error in boost::numeric::ublas::ttm: 1nd Extent of B and M-th Extent of C must be the equal.");
 
-	if ( m != 1 )
-		detail::recursive::ttm (m-1, p-1, c, nc, wc,    a, na, wa,   b, nb, wb);
-	else /*if (m == 1 && p >  2)*/
-		detail::recursive::ttm0(     p-1, c, nc, wc,    a, na, wa,   b, nb, wb);
+	if(detail::fixed::ttm(m-1, p, c, nc, wc, a, na, wa, b, nb, wb, accumulate))
+		return;
 
+	auto const run = [m,p,wc,wa,b,nb,wb,accumulate](PointerOut c, SizeType const*const nc, PointerIn1 a, SizeType const*const na)
+	{
+		if ( detail::blocked::ttm(m-1, p, c, nc, wc,    a, na, wa,   b, nb, wb,   accumulate) )
+			return;
+
+		// the recursive kernels accumulate into the slice of C
+		if ( !accumulate )
+			ublas::fill(p, nc, c, wc, std::remove_pointer_t<std::remove_cv_t<PointerOut>>{});
+
+		if ( m != 1 )
+			detail::recursive::ttm (m-1, p-1, c, nc, wc,    a, na, wa,   b, nb, wb);
+		else /*if (m == 1 && p >  2)*/
+			detail::recursive::ttm0(     p-1, c, nc, wc,    a, na, wa,   b, nb, wb);
+	};
+
+	// partitions the outermost free mode of C across threads
+	auto const work = std::accumulate(nc, nc+p, std::size_t(na[m-1]), std::multiplies<>());
+	if(detail::parallel::num_threads(work, std::numeric_limits<std::size_t>::max()) < 2u){
+		run(c, nc, a, na);
+		return;
+	}
+
+	auto const ncf = detail::parallel::slice(p, nc, m-1, SizeType(1));
+	auto const o   = detail::parallel::outermost(p, ncf.data(), wc);
+	if(o == p || detail::parallel::num_threads(work, nc[o]) < 2u){
+		run(c, nc, a, na);
+		return;
+	}
+
+	detail::parallel::for_each_range(work, nc[o], [&](std::size_t first, std::size_t last){
+		auto const ncs = detail::parallel::slice(p, nc, o, SizeType(last-first));
+		auto const nas = detail::parallel::slice(p, na, o, SizeType(last-first));
+		run(c + first*wc[o], ncs.data(), a + first*wa[o], nas.data());
+	});
+}
+
+/** @brief Computes the tensor-times-matrix product without an accumulate flag
+ *
+ * The product is added to C.
+ *
+ * @note calls ttm with accumulate = true
+*/
+template <class PointerIn1, class PointerIn2, class PointerOut, class SizeType>
+void ttm(SizeType const m, SizeType const p,
+         PointerOut c,       SizeType const*const nc, SizeType const*const wc,
+         const PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         const PointerIn2 b, SizeType const*const nb, SizeType const*const wb)
+{
+	ttm(m,p, c,nc,wc, a,na,wa, b,nb,wb, true);
 }
 
 
@@ -726,7 +1306,8 @@ void ttm(SizeType const m, SizeType const p,
  *
  * Implements C[i1,...,ir,j1,...,js] = sum( A[i1,...,ir+q] * B[j1,...,js+q]  )
  *
- * @note calls detail::recursive::ttt or ttm or ttv or inner or outer
+ * @note calls detail::fixed::ttt, detail::blocked::ttt, detail::recursive::ttt or outer
+ * @note the outermost mode of C is partitioned across threads if OpenMP is enabled
  *
  * nc[x]         = na[phia[x]  ] for 1 <= x <= r
  * nc[r+x]       = nb[phib[x]  ] for 1 <= x <= s
@@ -746,6 +1327,9 @@ void ttm(SizeType const m, SizeType const p,
  * @param[in]  b  pointer to the second input tensor
  * @param[in]  nb pointer to the extents of input tensor b
  * @param[in]  wb pointer to the strides of input tensor b
+ * @param[in]  accumulate adds the product to C if true and overwrites C without reading it otherwise
+ *
+ * @note C is always overwritten if q is zero
 */
 
 template <class PointerIn1, class PointerIn2, class PointerOut, class SizeType>
@@ -753,7 +1337,8 @@ void ttt(SizeType const pa, SizeType const pb, SizeType const q,
          SizeType const*const phia, SizeType const*const phib,
          PointerOut c, SizeType const*const nc, SizeType const*const wc,
          PointerIn1 a, SizeType const*const na, SizeType const*const wa,
-         PointerIn2 b, SizeType const*const nb, SizeType const*const wb)
+         PointerIn2 b, SizeType const*const nb, SizeType const*const wb,
+         bool const accumulate)
 {
 	static_assert( std::is_pointer<PointerOut>::value & std::is_pointer<PointerIn1>::value & std::is_pointer<PointerIn2>::value,
 	               "Static error in boost::numeric::ublas::ttm: Argument types for pointers are not pointer types.");
@@ -784,10 +1369,66 @@ void ttt(SizeType const pa, SizeType const pb, SizeType const q,
 			throw std::length_error("Error in boost::numeric::ublas::ttt: dimensions of lhs and rhs not correct.");
 
 
-	if(q == 0ul)
-		detail::recursive::outer(SizeType{0},r,s,  phia,phib, c,nc,wc, a,na,wa, b,nb,wb);
-	else
-		detail::recursive::ttt(SizeType{0},r,s,q,  phia,phib, c,nc,wc, a,na,wa, b,nb,wb);
+	if(detail::fixed::ttt(r,s,q,  phia,phib, c,nc,wc, a,na,wa, b,nb,wb,  accumulate))
+		return;
+
+	auto const run = [r,s,q,phia,phib,wc,wa,wb,accumulate](PointerOut c, SizeType const*const nc, PointerIn1 a, SizeType const*const na, PointerIn2 b, SizeType const*const nb)
+	{
+		using value_type = std::remove_pointer_t<std::remove_cv_t<PointerOut>>;
+		if(q == 0ul)
+			detail::recursive::outer(SizeType{0},r,s,  phia,phib, c,nc,wc, a,na,wa, b,nb,wb);
+		else if(!detail::blocked::ttt(r,s,q,  phia,phib, c,nc,wc, a,na,wa, b,nb,wb,  accumulate)){
+			// the recursive kernel accumulates into the slice of C
+			if(!accumulate && r+s == 0ul)
+				*c = value_type{};
+			else if(!accumulate)
+				ublas::fill(r+s, nc, c, wc, value_type{});
+			detail::recursive::ttt(SizeType{0},r,s,q,  phia,phib, c,nc,wc, a,na,wa, b,nb,wb);
+		}
+	};
+
+	// partitions the outermost mode of C across threads
+	auto const pc = r+s;
+	auto const o  = detail::parallel::outermost(pc, nc, wc);
+	auto work = std::accumulate(nc, nc+pc, std::size_t(1), std::multiplies<>());
+	for(auto i = 0ul; i < q; ++i)
+		work *= na[phia[r+i]-1];
+
+	if(o == pc || detail::parallel::num_threads(work, nc[o]) < 2u){
+		run(c, nc, a, na, b, nb);
+		return;
+	}
+
+	detail::parallel::for_each_range(work, nc[o], [&](std::size_t first, std::size_t last){
+		auto const e   = SizeType(last-first);
+		auto const ncs = detail::parallel::slice(pc, nc, o, e);
+		if(o < r){
+			auto const oa  = phia[o]-1;
+			auto const nas = detail::parallel::slice(pa, na, oa, e);
+			run(c + first*wc[o], ncs.data(), a + first*wa[oa], nas.data(), b, nb);
+		}
+		else{
+			auto const ob  = phib[o-r]-1;
+			auto const nbs = detail::parallel::slice(pb, nb, ob, e);
+			run(c + first*wc[o], ncs.data(), a, na, b + first*wb[ob], nbs.data());
+		}
+	});
+}
+
+/** @brief Computes the tensor-times-tensor product without an accumulate flag
+ *
+ * The product is added to C, C is overwritten if q is zero.
+ *
+ * @note calls ttt with accumulate = true
+*/
+template <class PointerIn1, class PointerIn2, class PointerOut, class SizeType>
+void ttt(SizeType const pa, SizeType const pb, SizeType const q,
+         SizeType const*const phia, SizeType const*const phib,
+         PointerOut c, SizeType const*const nc, SizeType const*const wc,
+         PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, SizeType const*const nb, SizeType const*const wb)
+{
+	ttt(pa,pb,q, phia,phib, c,nc,wc, a,na,wa, b,nb,wb, true);
 }
 
 
@@ -796,7 +1437,7 @@ void ttt(SizeType const pa, SizeType const pb, SizeType const q,
  *
  * Implements C[i1,...,ir,j1,...,js] = sum( A[i1,...,ir+q] * B[j1,...,js+q]  )
  *
- * @note calls detail::recursive::ttt or ttm or ttv or inner or outer
+ * @note calls ttt with permutation tuples, detail::parallel::inner or detail::recursive::outer
  *
  * nc[x]   = na[x  ] for 1 <= x <= r
  * nc[r+x] = nb[x  ] for 1 <= x <= s
@@ -814,13 +1455,17 @@ void ttt(SizeType const pa, SizeType const pb, SizeType const q,
  * @param[in]  b  pointer to the second input tensor
  * @param[in]  nb pointer to the extents of input tensor b
  * @param[in]  wb pointer to the strides of input tensor b
+ * @param[in]  accumulate adds the product to C if true and overwrites C without reading it otherwise
+ *
+ * @note C is always overwritten if q is zero
 */
 
 template <class PointerIn1, class PointerIn2, class PointerOut, class SizeType>
 void ttt(SizeType const pa, SizeType const pb, SizeType const q,
          PointerOut c, SizeType const*const nc, SizeType const*const wc,
          PointerIn1 a, SizeType const*const na, SizeType const*const wa,
-         PointerIn2 b, SizeType const*const nb, SizeType const*const wb)
+         PointerIn2 b, SizeType const*const nb, SizeType const*const wb,
+         bool const accumulate)
 {
 	static_assert( std::is_pointer<PointerOut>::value & std::is_pointer<PointerIn1>::value & std::is_pointer<PointerIn2>::value,
 	               "Static error in boost::numeric::ublas::ttm: Argument types for pointers are not pointer types.");
@@ -858,17 +1503,39 @@ void ttt(SizeType const pa, SizeType const pb, SizeType const q,
 	if(q == 0ul)
 		detail::recursive::outer(pa, pc-1, c,nc,wc, pa-1, a,na,wa, pb-1, b,nb,wb);
 	else if(r == 0ul && s == 0ul)
-		*c = detail::recursive::inner(q-1, na, a,wa,  b,wb, value_type(0) );
-	else
-		detail::recursive::ttt(SizeType{0},r,s,q, c,nc,wc, a,na,wa, b,nb,wb);
+		*c = detail::parallel::inner(q, na, a,wa,  b,wb, accumulate ? *c : value_type(0) );
+	else {
+		auto phia = small_vector<SizeType,BOOST_UBLAS_TENSOR_INLINE_RANK>(pa);
+		auto phib = small_vector<SizeType,BOOST_UBLAS_TENSOR_INLINE_RANK>(pb);
+		std::iota(phia.begin(), phia.end(), SizeType(1));
+		std::iota(phib.begin(), phib.end(), SizeType(1));
+		ttt(pa,pb,q, phia.data(),phib.data(), c,nc,wc, a,na,wa, b,nb,wb, accumulate);
+	}
+}
+
+/** @brief Computes the tensor-times-tensor product without an accumulate flag
+ *
+ * C is overwritten if q is zero or if the product has no free modes, i.e. pa == pb == q.
+ * Otherwise the product is added to C.
+ *
+ * @note calls ttt with accumulate = pa+pb > 2q
+*/
+template <class PointerIn1, class PointerIn2, class PointerOut, class SizeType>
+void ttt(SizeType const pa, SizeType const pb, SizeType const q,
+         PointerOut c, SizeType const*const nc, SizeType const*const wc,
+         PointerIn1 a, SizeType const*const na, SizeType const*const wa,
+         PointerIn2 b, SizeType const*const nb, SizeType const*const wb)
+{
+	ttt(pa,pb,q, c,nc,wc, a,na,wa, b,nb,wb, pa+pb > 2*q);
 }
 
 
+
 /** @brief Computes the inner product of two tensors
  *
  * Implements c = sum(A[i1,i2,...,ip] * B[i1,i2,...,ip])
  *
- * @note calls detail::inner
+ * @note calls detail::parallel::inner which sums up partial results of threads if OpenMP is enabled
  *
  * @param[in] p  number of dimensions (rank) of the first input tensor with p > 0
  * @param[in] n  pointer to the extents of input or output tensor
@@ -893,7 +1560,7 @@ auto inner(const SizeType    p, SizeType const*const n,
 	if(a == nullptr || b == nullptr)
 		throw std::length_error("Error in boost::numeric::ublas::inner: Pointers shall not be null pointers.");
 
-	return detail::recursive::inner(p-1, n, a, wa, b, wb, v);
+	return detail::parallel::inner(p, n, a, wa, b, wb, v);
 
 }
 
@@ -903,6 +1570,7 @@ auto inner(const SizeType    p, SizeType const*const n,
  * Implements C[i1,...,ip,j1,...,jq] = A[i1,i2,...,ip] * B[j1,j2,...,jq]
  *
  * @note calls detail::outer
+ * @note the outermost mode of C is partitioned across threads if OpenMP is enabled
  *
  * @param[out] c  pointer to the output tensor
  * @param[in]  pc number of dimensions (rank) of the output tensor c with pc > 0
@@ -931,8 +1599,31 @@ void outer(PointerOut c,       SizeType const pc, SizeType const*const nc, SizeT
 	if(a == nullptr || b == nullptr || c == nullptr)
 		throw std::length_error("Error in boost::numeric::ublas::outer: pointers shall not be null pointers.");
 
-	detail::recursive::outer(pa, pc-1, c, nc, wc,   pa-1, a, na, wa,   pb-1, b, nb, wb);
+	auto const run = [pa,pc,wc,wa,pb,wb](PointerOut c, SizeType const*const nc, PointerIn1 a, SizeType const*const na, PointerIn2 b, SizeType const*const nb)
+	{
+		detail::recursive::outer(pa, pc-1, c, nc, wc,   pa-1, a, na, wa,   pb-1, b, nb, wb);
+	};
+
+	// partitions the outermost mode of C across threads
+	auto const o    = detail::parallel::outermost(pc, nc, wc);
+	auto const work = std::accumulate(nc, nc+pc, std::size_t(1), std::multiplies<>());
+	if(o == pc || detail::parallel::num_threads(work, nc[o]) < 2u){
+		run(c, nc, a, na, b, nb);
+		return;
+	}
 
+	detail::parallel::for_each_range(work, nc[o], [&](std::size_t first, std::size_t last){
+		auto const e   = SizeType(last-first);
+		auto const ncs = detail::parallel::slice(pc, nc, o, e);
+		if(o < pa){
+			auto const nas = detail::parallel::slice(pa, na, o, e);
+			run(c + first*wc[o], ncs.data(), a + first*wa[o], nas.data(), b, nb);
+		}
+		else{
+			auto const nbs = detail::parallel::slice(pb, nb, SizeType(o-pa), e);
+			run(c + first*wc[o], ncs.data(), a, na, b + first*wb[o-pa], nbs.data());
+		}
+	});
 }
 
 
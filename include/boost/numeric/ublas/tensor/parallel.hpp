@@ -0,0 +1,224 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+
+#ifndef BOOST_UBLAS_TENSOR_PARALLEL_HPP
+#define BOOST_UBLAS_TENSOR_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "small_vector.hpp"
+
+namespace boost {
+namespace numeric {
+namespace ublas {
+namespace detail {
+namespace parallel {
+
+
+/** @brief Settings of the multithreaded execution of the tensor multiplication kernels
+ *
+ * @note num_threads equal to zero selects the number of threads of the OpenMP runtime
+ * @note threshold is the minimum number of multiply-adds for which more than one thread is used
+*/
+struct settings
+{
+	std::atomic<std::size_t> num_threads {0u};
+	std::atomic<std::size_t> threshold   {1u<<15};
+};
+
+inline settings& global_settings()
+{
+	static settings s;
+	return s;
+}
+
+
+/** @brief Returns the number of threads that process a partitioned mode
+ *
+ * Returns one if OpenMP is not enabled, if the work is smaller than the threshold
+ * or if the caller is already executed within a parallel region.
+ *
+ * @param work   number of multiply-adds of the kernel
+ * @param extent extent of the partitioned mode
+*/
+inline std::size_t num_threads(std::size_t const work, std::size_t const extent)
+{
+#ifdef _OPENMP
+	auto const& s = global_settings();
+	if(extent < 2u || work < s.threshold.load(std::memory_order_relaxed) || omp_in_parallel())
+		return 1u;
+	auto const t = s.num_threads.load(std::memory_order_relaxed);
+	return std::min(extent, t != 0u ? t : std::size_t(omp_get_max_threads()));
+#else
+	(void)work; (void)extent;
+	return 1u;
+#endif
+}
+
+
+/** @brief Returns the mode with the largest stride and an extent greater than one
+ *
+ * Partitioning the outermost mode keeps the remaining modes of every partition contiguous.
+ *
+ * @param p number of modes
+ * @param n pointer to the extents
+ * @param w pointer to the strides
+ *
+ * @returns p if all extents are one
+*/
+template<class SizeType>
+SizeType outermost(SizeType const p, SizeType const*const n, SizeType const*const w)
+{
+	auto o = p;
+	for(auto i = SizeType(0); i < p; ++i)
+		if(n[i] > 1u && (o == p || w[i] > w[o]))
+			o = i;
+	return o;
+}
+
+
+/** @brief Returns a copy of p extents where the extent of mode o is replaced by e
+ *
+ * @note callers only slice if num_threads returns more than one thread
+*/
+template<class SizeType>
+small_vector<SizeType,BOOST_UBLAS_TENSOR_INLINE_RANK> slice(SizeType const p, SizeType const*const n, SizeType const o, SizeType const e)
+{
+	auto s = small_vector<SizeType,BOOST_UBLAS_TENSOR_INLINE_RANK>(n, n+p);
+	s[o] = e;
+	return s;
+}
+
+
+/** @brief Partitions the index range of one mode across the threads of an OpenMP team
+ *
+ * Calls kernel(first,last) with disjoint ranges that cover [0,extent).
+ *
+ * @param work   number of multiply-adds of the kernel
+ * @param extent extent of the partitioned mode
+ * @param kernel callable that processes the range [first,last)
+*/
+template<class Kernel>
+void for_each_range(std::size_t const work, std::size_t const extent, Kernel&& kernel)
+{
+	auto const nt = num_threads(work, extent);
+	if(nt < 2u){
+		kernel(std::size_t(0), extent);
+		return;
+	}
+#ifdef _OPENMP
+	#pragma omp parallel for num_threads(int(nt)) schedule(static)
+	for(long t = 0; t < long(nt); ++t)
+		kernel(extent*std::size_t(t)/nt, extent*std::size_t(t+1)/nt);
+#endif
+}
+
+
+/** @brief Partitions the index range of one mode across the threads of an OpenMP team and sums up partial results
+ *
+ * Calls kernel(first,last,v) with disjoint ranges that cover [0,extent). Partial results are
+ * added in the order of the ranges so that the result only depends on the number of threads.
+ *
+ * @param work   number of multiply-adds of the kernel
+ * @param extent extent of the partitioned mode
+ * @param v      initial value
+ * @param kernel callable that returns v plus the result for the range [first,last)
+*/
+template<class ValueType, class Kernel>
+ValueType reduce_range(std::size_t const work, std::size_t const extent, ValueType v, Kernel&& kernel)
+{
+	auto const nt = num_threads(work, extent);
+	if(nt < 2u)
+		return kernel(std::size_t(0), extent, v);
+#ifdef _OPENMP
+	auto partial = std::vector<ValueType>(nt, ValueType{});
+	#pragma omp parallel for num_threads(int(nt)) schedule(static)
+	for(long t = 0; t < long(nt); ++t)
+		partial[t] = kernel(extent*std::size_t(t)/nt, extent*std::size_t(t+1)/nt, ValueType{});
+	for(auto const& s : partial)
+		v += s;
+#endif
+	return v;
+}
+
+/** @brief Partitions the index range of one mode across the threads of an OpenMP team and combines partial results
+ *
+ * Calls kernel(first,last,v) with disjoint ranges that cover [0,extent). Partial results start
+ * with v and are combined with op in the order of the ranges so that v must be an identity of op
+ * or an idempotent value such as an element for minimum and maximum.
+ *
+ * @param work   number of operations of the kernel
+ * @param extent extent of the partitioned mode
+ * @param v      initial value
+ * @param kernel callable that returns the result for the range [first,last) starting with v
+ * @param op     associative operation that combines partial results
+*/
+template<class ValueType, class Kernel, class BinaryOp>
+ValueType reduce_range(std::size_t const work, std::size_t const extent, ValueType v, Kernel&& kernel, [[maybe_unused]] BinaryOp op)
+{
+	auto const nt = num_threads(work, extent);
+	if(nt < 2u)
+		return kernel(std::size_t(0), extent, v);
+#ifdef _OPENMP
+	auto partial = std::vector<ValueType>(nt, v);
+	#pragma omp parallel for num_threads(int(nt)) schedule(static)
+	for(long t = 0; t < long(nt); ++t)
+		partial[t] = kernel(extent*std::size_t(t)/nt, extent*std::size_t(t+1)/nt, v);
+	for(auto const& s : partial)
+		v = op(v, s);
+#endif
+	return v;
+}
+
+} // namespace parallel
+} // namespace detail
+
+
+/** @brief Sets the number of threads used by the tensor multiplication kernels
+ *
+ * @param n number of threads. Zero selects the number of threads of the OpenMP runtime.
+*/
+inline void set_num_threads(std::size_t const n)
+{
+	detail::parallel::global_settings().num_threads = n;
+}
+
+/** @brief Returns the number of threads used by the tensor multiplication kernels, zero if it is chosen by the OpenMP runtime */
+inline std::size_t get_num_threads()
+{
+	return detail::parallel::global_settings().num_threads;
+}
+
+/** @brief Sets the minimum number of multiply-adds for which the tensor multiplication kernels use more than one thread */
+inline void set_parallel_threshold(std::size_t const work)
+{
+	detail::parallel::global_settings().threshold = work;
+}
+
+/** @brief Returns the minimum number of multiply-adds for which the tensor multiplication kernels use more than one thread */
+inline std::size_t get_parallel_threshold()
+{
+	return detail::parallel::global_settings().threshold;
+}
+
+} // namespace ublas
+} // namespace numeric
+} // namespace boost
+
+#endif
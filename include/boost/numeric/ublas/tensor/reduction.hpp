@@ -0,0 +1,412 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+/// \file reduction.hpp Definition of full and mode-wise reductions of tensors
+
+#ifndef BOOST_UBLAS_TENSOR_REDUCTION_HPP
+#define BOOST_UBLAS_TENSOR_REDUCTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <boost/numeric/ublas/detail/config.hpp>
+
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "small_vector.hpp"
+#include "tensor_view.hpp"
+#include "ublas_type_traits.hpp"
+
+namespace boost::numeric::ublas {
+
+namespace detail {
+
+using mode_order = small_vector<std::size_t, BOOST_UBLAS_TENSOR_INLINE_RANK>;
+
+/** @brief Returns the modes with extents greater than one sorted by decreasing
+ * strides of w
+ *
+ * The last mode is the innermost mode of a loop nest that traverses the
+ * elements in storage order.
+ */
+inline mode_order modes_by_stride(std::size_t const p, std::size_t const *n,
+                                  std::size_t const *w) {
+  auto m = mode_order{};
+  for (auto i = 0u; i < p; ++i)
+    if (n[i] > 1u) m.push_back(i);
+  std::stable_sort(m.begin(), m.end(),
+                   [w](auto i, auto j) { return w[i] > w[j]; });
+  return m;
+}
+
+/** @brief Reduces the elements of the modes m[r],...,m[q-1] of a tensor */
+template <class T, class BinaryOp, class UnaryOp>
+T fold(std::size_t const r, std::size_t const q, std::size_t const *m,
+       std::size_t const *n, T const *a, std::size_t const *w, T v,
+       T const init, BinaryOp op, UnaryOp f) {
+  auto const i = m[r];
+  if (r + 1u < q) {
+    for (auto k = 0u; k < n[i]; ++k, a += w[i])
+      v = fold(r + 1u, q, m, n, a, w, v, init, op, f);
+    return v;
+  }
+  if (w[i] == 1u) return op(v, simd::fold(n[i], a, init, op, f));
+  for (auto k = 0u; k < n[i]; ++k, a += w[i]) v = op(v, f(*a));
+  return v;
+}
+
+/** @brief Reduces all elements of a tensor
+ *
+ * Implements v = op(init, f(A[i1,...,ip])) for all elements. The modes are
+ * traversed by decreasing strides so that the innermost loop runs over the
+ * contiguous mode with simd::fold. The outermost mode is partitioned across
+ * the threads of an OpenMP team and the partial results are combined with op.
+ *
+ * @param p    rank of the tensor
+ * @param n    pointer to the extents of the tensor
+ * @param a    pointer to the first element of the tensor
+ * @param w    pointer to the strides of the tensor
+ * @param init identity of op or an idempotent value, see simd::fold
+ * @param op   associative and commutative binary operation
+ * @param f    unary operation that is applied to every element
+ */
+template <class T, class BinaryOp, class UnaryOp = simd::identity>
+T fold(std::size_t const p, std::size_t const *n, T const *a,
+       std::size_t const *w, T const init, BinaryOp op, UnaryOp f = {}) {
+  auto const m = modes_by_stride(p, n, w);
+  auto const q = m.size();
+  if (q == 0u) return op(init, f(*a));
+
+  auto const o = m[0];
+  auto const work = std::size_t(std::accumulate(
+      n, n + p, std::size_t(1), std::multiplies<>()));
+  if (parallel::num_threads(work, n[o]) < 2u)
+    return fold(0u, q, m.data(), n, a, w, init, init, op, f);
+
+  return parallel::reduce_range(
+      work, n[o], init,
+      [&](std::size_t first, std::size_t last, T v) {
+        auto const ns = parallel::slice(p, n, o, last - first);
+        return fold(0u, q, m.data(), ns.data(), a + first * w[o], w, v, init,
+                    op, f);
+      },
+      op);
+}
+
+/** @brief Tests if pred is true for any element of a tensor
+ *
+ * The elements of every thread are tested until the first match.
+ */
+template <class T, class UnaryPredicate>
+bool any_of(std::size_t const p, std::size_t const *n, T const *a,
+            std::size_t const *w, UnaryPredicate pred) {
+  auto const m = modes_by_stride(p, n, w);
+  auto const q = m.size();
+  if (q == 0u) return bool(pred(*a));
+
+  auto const test = [&](auto const &self, std::size_t r, std::size_t const *ns,
+                        T const *a) -> bool {
+    auto const i = m[r];
+    for (auto k = 0u; k < ns[i]; ++k, a += w[i])
+      if (r + 1u < q ? self(self, r + 1u, ns, a) : bool(pred(*a))) return true;
+    return false;
+  };
+
+  auto const o = m[0];
+  auto const work = std::size_t(std::accumulate(
+      n, n + p, std::size_t(1), std::multiplies<>()));
+  if (parallel::num_threads(work, n[o]) < 2u)
+    return test(test, 0u, n, a);
+
+  // char instead of bool so that threads write distinct objects
+  return parallel::reduce_range(
+             work, n[o], char(0),
+             [&](std::size_t first, std::size_t last, char) {
+               auto const ns = parallel::slice(p, n, o, last - first);
+               return char(test(test, 0u, ns.data(), a + first * w[o]));
+             },
+             [](char l, char r) { return char(l | r); }) != 0;
+}
+
+/** @brief Reduces the elements of a tensor into the elements of another one
+ *
+ * Implements C[i1,...,ip] = op(C[i1,...,ip], A[i1,...,ip]) for all elements
+ * of A where the strides wc are zero for the modes that are reduced. The
+ * modes are traversed by decreasing strides of A. If the innermost mode is
+ * reduced, each element of C is reduced in a register. Otherwise the innermost
+ * loop combines a row of A with a row of C elementwise.
+ *
+ * @param p  rank of the tensors
+ * @param n  pointer to the extents of A
+ * @param c  pointer to the output tensor
+ * @param wc pointer to the strides of C with zeros for the reduced modes
+ * @param a  pointer to the input tensor
+ * @param wa pointer to the strides of A
+ * @param op binary operation
+ */
+template <class T, class BinaryOp>
+void reduce(std::size_t const r, std::size_t const q, std::size_t const *m,
+            std::size_t const *n, T *c, std::size_t const *wc, T const *a,
+            std::size_t const *wa, BinaryOp op) {
+  auto const i = m[r];
+  if (r + 1u < q) {
+    for (auto k = 0u; k < n[i]; ++k, a += wa[i], c += wc[i])
+      reduce(r + 1u, q, m, n, c, wc, a, wa, op);
+  } else if (wc[i] == 0u) {
+    auto v = *c;
+    for (auto k = 0u; k < n[i]; ++k, a += wa[i]) v = op(v, *a);
+    *c = v;
+  } else {
+    for (auto k = 0u; k < n[i]; ++k, a += wa[i], c += wc[i]) *c = op(*c, *a);
+  }
+}
+
+/** @brief Reduces the elements of a tensor into the elements of another one
+ *
+ * @note the outermost mode of C is partitioned across threads if OpenMP is
+ * enabled so that every thread writes distinct elements of C
+ */
+template <class T, class BinaryOp>
+void reduce(std::size_t const p, std::size_t const *n, T *c,
+            std::size_t const *wc, T const *a, std::size_t const *wa,
+            BinaryOp op) {
+  auto const m = modes_by_stride(p, n, wa);
+  auto const q = m.size();
+  if (q == 0u) {
+    *c = op(*c, *a);
+    return;
+  }
+
+  // the mode of C with the largest stride
+  auto o = p;
+  for (auto i = 0u; i < p; ++i)
+    if (n[i] > 1u && wc[i] != 0u && (o == p || wc[i] > wc[o])) o = i;
+
+  auto const work = std::size_t(std::accumulate(
+      n, n + p, std::size_t(1), std::multiplies<>()));
+  if (o == p || parallel::num_threads(work, n[o]) < 2u) {
+    reduce(0u, q, m.data(), n, c, wc, a, wa, op);
+    return;
+  }
+
+  parallel::for_each_range(work, n[o], [&](std::size_t first,
+                                           std::size_t last) {
+    auto const ns = parallel::slice(p, n, o, last - first);
+    reduce(0u, q, m.data(), ns.data(), c + first * wc[o], wc,
+           a + first * wa[o], wa, op);
+  });
+}
+
+} // namespace detail
+
+/** @brief Identity element of a binary operation of mode-wise reductions
+ *
+ * Specialized for std::plus and std::multiplies. Other operations require
+ * an initial value, see ublas::reduce.
+ */
+template <class BinaryOp, class T> struct reduction_identity;
+
+template <class T, class U> struct reduction_identity<std::plus<U>, T> {
+  static constexpr T value() { return T(0); }
+};
+
+template <class T, class U> struct reduction_identity<std::multiplies<U>, T> {
+  static constexpr T value() { return T(1); }
+};
+
+/** @brief Computes the sum of all elements of a tensor
+ *
+ * @note uses several vector registers for the contiguous mode and partitions
+ * the outermost mode across threads if OpenMP is enabled
+ *
+ * @param a tensor or tensor_view
+ * @returns zero if a is empty
+ */
+template <class T, class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE auto sum(T const &a) {
+  using value_type = std::remove_const_t<typename T::value_type>;
+  if (a.empty()) return value_type{};
+  auto const &ka = detail::kernel_operand(a);
+  return detail::fold(ka.rank(), ka.extents().data(), ka.data(),
+                      ka.strides().data(), value_type{}, detail::simd::add{});
+}
+
+/** @brief Returns the smallest element of a tensor
+ *
+ * @param a tensor or tensor_view that is not empty
+ */
+template <class T, class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE auto min(T const &a) {
+  if (a.empty())
+    throw std::runtime_error(
+        "error in boost::numeric::ublas::min: tensors should not be empty.");
+  auto const &ka = detail::kernel_operand(a);
+  return detail::fold(ka.rank(), ka.extents().data(), ka.data(),
+                      ka.strides().data(), *ka.data(), detail::simd::minimum{});
+}
+
+/** @brief Returns the largest element of a tensor
+ *
+ * @param a tensor or tensor_view that is not empty
+ */
+template <class T, class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE auto max(T const &a) {
+  if (a.empty())
+    throw std::runtime_error(
+        "error in boost::numeric::ublas::max: tensors should not be empty.");
+  auto const &ka = detail::kernel_operand(a);
+  return detail::fold(ka.rank(), ka.extents().data(), ka.data(),
+                      ka.strides().data(), *ka.data(), detail::simd::maximum{});
+}
+
+/** @brief Tests if pred is true for at least one element of a tensor
+ *
+ * @param a tensor or tensor_view
+ * @param pred unary predicate
+ * @returns false if a is empty
+ */
+template <class T, class UnaryPredicate,
+          class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE bool any(T const &a, UnaryPredicate pred) {
+  if (a.empty()) return false;
+  auto const &ka = detail::kernel_operand(a);
+  return detail::any_of(ka.rank(), ka.extents().data(), ka.data(),
+                        ka.strides().data(), pred);
+}
+
+/** @brief Tests if at least one element of a tensor is not zero */
+template <class T, class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE bool any(T const &a) {
+  using value_type = std::remove_const_t<typename T::value_type>;
+  return any(a, [](auto const &x) { return x != value_type{}; });
+}
+
+/** @brief Tests if pred is true for all elements of a tensor
+ *
+ * @param a tensor or tensor_view
+ * @param pred unary predicate
+ * @returns true if a is empty
+ */
+template <class T, class UnaryPredicate,
+          class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE bool all(T const &a, UnaryPredicate pred) {
+  return !any(a, [&pred](auto const &x) { return !pred(x); });
+}
+
+/** @brief Tests if all elements of a tensor are not zero */
+template <class T, class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE bool all(T const &a) {
+  using value_type = std::remove_const_t<typename T::value_type>;
+  return all(a, [](auto const &x) { return x != value_type{}; });
+}
+
+/** @brief Reduces the elements of a tensor along the given modes
+ *
+ * Implements C[i1,...,ip without the modes m] = op(init, A[i1,...,ip]) for
+ * all indices of the modes m, e.g. the sums over the second and fourth mode
+ * with
+ *
+ * @code auto c = reduce(a, {2,4}, std::plus<>{}); @endcode
+ *
+ * The remaining modes keep their order so that C has the same storage
+ * layout as A and the innermost loop runs over the contiguous mode of A.
+ *
+ * @note the outermost mode of C is partitioned across threads if OpenMP is
+ * enabled
+ *
+ * @param a     tensor or tensor_view with rank p
+ * @param modes one-based distinct modes of a that are reduced
+ * @param op    associative and commutative binary operation
+ * @param init  identity of op
+ * @returns tensor with rank max(p-k,2) where k is the number of reduced modes
+ * and extents one for the padded modes, see tensor_view::tensor_temporary_type
+ * for views
+ */
+template <class T, class BinaryOp,
+          class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE auto reduce(T const &a, std::vector<std::size_t> const &modes,
+                               BinaryOp op,
+                               std::remove_const_t<typename T::value_type> init) {
+  using tensor_type = typename T::tensor_temporary_type;
+  using extents_type = typename tensor_type::extents_type;
+  using size_type = typename extents_type::value_type;
+
+  auto const p = a.rank();
+  auto reduced = std::vector<bool>(p, false);
+  for (auto m : modes) {
+    if (m == 0u || m > p || reduced[m - 1])
+      throw std::runtime_error(
+          "error in boost::numeric::ublas::reduce: modes must be distinct "
+          "modes of the tensor.");
+    reduced[m - 1] = true;
+  }
+
+  auto nc = typename extents_type::base_type(
+      std::max(p - modes.size(), size_type(2)), size_type(1));
+  for (auto i = 0u, j = 0u; i < p; ++i)
+    if (!reduced[i]) nc[j++] = a.extents()[i];
+
+  auto c = tensor_type(extents_type(std::move(nc)), init);
+  if (a.empty()) return c;
+
+  // the strides of C are zero for the reduced modes of A
+  auto wc = std::vector<std::size_t>(p, 0u);
+  for (auto i = 0u, j = 0u; i < p; ++i)
+    if (!reduced[i]) wc[i] = c.strides()[j++];
+
+  auto const &ka = detail::kernel_operand(a);
+  detail::reduce(p, ka.extents().data(), c.data(), wc.data(), ka.data(),
+                 ka.strides().data(), op);
+  return c;
+}
+
+/** @brief Reduces the elements of a tensor along the given modes starting
+ * with reduction_identity<BinaryOp>
+ *
+ * @code auto c = reduce(a, {2,4}, std::plus<>{}); @endcode
+ */
+template <class T, class BinaryOp,
+          class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE auto reduce(T const &a, std::vector<std::size_t> const &modes,
+                               BinaryOp op) {
+  using value_type = std::remove_const_t<typename T::value_type>;
+  return reduce(a, modes, op,
+                reduction_identity<BinaryOp, value_type>::value());
+}
+
+// overloads for braced lists of modes that are preferred over std::reduce
+
+template <class T, class BinaryOp,
+          class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE auto reduce(T const &a,
+                               std::initializer_list<std::size_t> modes,
+                               BinaryOp op,
+                               std::remove_const_t<typename T::value_type> init) {
+  return reduce(a, std::vector<std::size_t>(modes), op, init);
+}
+
+template <class T, class BinaryOp,
+          class = std::enable_if_t<is_tensor_operand_v<T>>>
+BOOST_UBLAS_INLINE auto reduce(T const &a,
+                               std::initializer_list<std::size_t> modes,
+                               BinaryOp op) {
+  return reduce(a, std::vector<std::size_t>(modes), op);
+}
+
+} // namespace boost::numeric::ublas
+
+#endif
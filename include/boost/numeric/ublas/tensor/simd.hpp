@@ -0,0 +1,752 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+
+#ifndef BOOST_UBLAS_TENSOR_SIMD_HPP
+#define BOOST_UBLAS_TENSOR_SIMD_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(BOOST_UBLAS_NO_SIMD) && (defined(__SSE2__) || defined(__AVX__) || defined(__AVX512F__))
+#define BOOST_UBLAS_TENSOR_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace boost {
+namespace numeric {
+namespace ublas {
+namespace detail {
+namespace simd {
+
+
+/** @brief Register of elements that are processed with one instruction
+ *
+ * The primary template holds a single element and is used for all value types
+ * without a specialization, e.g. integers and complex numbers, or if
+ * BOOST_UBLAS_NO_SIMD is defined. The specializations for float and double
+ * map onto the widest instruction set (AVX-512, AVX or SSE2) that is enabled at compile time.
+ *
+ * Loads and stores do not require aligned memory.
+ *
+ * @tparam value_type type of the elements
+*/
+template<class value_type>
+struct pack
+{
+	static constexpr std::size_t width = 1u;
+
+	value_type v;
+
+	static pack load     (value_type const* p)  { return {*p}; }
+	static pack broadcast(value_type const& a)  { return {a}; }
+	static pack zero     ()                     { return {value_type{}}; }
+	void        store    (value_type* p) const  { *p = v; }
+
+	friend pack operator+(pack const& a, pack const& b) { return {a.v + b.v}; }
+	friend pack operator-(pack const& a, pack const& b) { return {a.v - b.v}; }
+	friend pack operator*(pack const& a, pack const& b) { return {a.v * b.v}; }
+	friend pack operator/(pack const& a, pack const& b) { return {a.v / b.v}; }
+	friend pack operator-(pack const& a)                { return {-a.v}; }
+	friend pack sqrt     (pack const& a)                { return {std::sqrt(a.v)}; }
+	friend pack min      (pack const& a, pack const& b) { return {b.v < a.v ? b.v : a.v}; }
+	friend pack max      (pack const& a, pack const& b) { return {a.v < b.v ? b.v : a.v}; }
+
+	/** @brief returns a*b+c */
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {a.v * b.v + c.v}; }
+
+	/** @brief returns the sum of all elements */
+	friend value_type reduce_add(pack const& a) { return a.v; }
+
+	/** @brief splits two registers with interleaved real and imaginary parts into real and imaginary parts
+	 *
+	 * Keeps the order of the elements so that the parts can be combined with packs loaded from real operands.
+	*/
+	static void deinterleave(pack&, pack&) {}
+	/** @brief inverse of deinterleave */
+	static void interleave  (pack&, pack&) {}
+};
+
+
+#ifdef BOOST_UBLAS_TENSOR_SIMD_X86
+
+#if defined(__AVX512F__)
+
+template<>
+struct pack<float>
+{
+	static constexpr std::size_t width = 16u;
+
+	__m512 v;
+
+	static pack load     (float const* p)  { return {_mm512_loadu_ps(p)}; }
+	static pack broadcast(float const& a)  { return {_mm512_set1_ps(a)}; }
+	static pack zero     ()                { return {_mm512_setzero_ps()}; }
+	void        store    (float* p) const  { _mm512_storeu_ps(p, v); }
+
+	friend pack operator+(pack const& a, pack const& b) { return {_mm512_add_ps(a.v, b.v)}; }
+	friend pack operator-(pack const& a, pack const& b) { return {_mm512_sub_ps(a.v, b.v)}; }
+	friend pack operator*(pack const& a, pack const& b) { return {_mm512_mul_ps(a.v, b.v)}; }
+	friend pack operator/(pack const& a, pack const& b) { return {_mm512_div_ps(a.v, b.v)}; }
+	friend pack operator-(pack const& a)                { return {_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.v), _mm512_set1_epi32(int(0x80000000u))))}; }
+	friend pack sqrt     (pack const& a)                { return {_mm512_sqrt_ps(a.v)}; }
+	friend pack min      (pack const& a, pack const& b) { return {_mm512_min_ps(a.v, b.v)}; }
+	friend pack max      (pack const& a, pack const& b) { return {_mm512_max_ps(a.v, b.v)}; }
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm512_fmadd_ps(a.v, b.v, c.v)}; }
+	friend float reduce_add(pack const& a) { return _mm512_reduce_add_ps(a.v); }
+	friend pack exp2i(pack const& t) { return {_mm512_castsi512_ps(_mm512_slli_epi32(_mm512_castps_si512(t.v), 23))}; }
+	static void deinterleave(pack& a, pack& b)
+	{
+		auto const r = _mm512_permutex2var_ps(a.v, _mm512_setr_epi32(0,2,4,6,8,10,12,14,16,18,20,22,24,26,28,30), b.v);
+		b.v          = _mm512_permutex2var_ps(a.v, _mm512_setr_epi32(1,3,5,7,9,11,13,15,17,19,21,23,25,27,29,31), b.v);
+		a.v = r;
+	}
+	static void interleave(pack& a, pack& b)
+	{
+		auto const l = _mm512_permutex2var_ps(a.v, _mm512_setr_epi32(0,16,1,17,2,18,3,19,4,20,5,21,6,22,7,23), b.v);
+		b.v          = _mm512_permutex2var_ps(a.v, _mm512_setr_epi32(8,24,9,25,10,26,11,27,12,28,13,29,14,30,15,31), b.v);
+		a.v = l;
+	}
+};
+
+template<>
+struct pack<double>
+{
+	static constexpr std::size_t width = 8u;
+
+	__m512d v;
+
+	static pack load     (double const* p)  { return {_mm512_loadu_pd(p)}; }
+	static pack broadcast(double const& a)  { return {_mm512_set1_pd(a)}; }
+	static pack zero     ()                 { return {_mm512_setzero_pd()}; }
+	void        store    (double* p) const  { _mm512_storeu_pd(p, v); }
+
+	friend pack operator+(pack const& a, pack const& b) { return {_mm512_add_pd(a.v, b.v)}; }
+	friend pack operator-(pack const& a, pack const& b) { return {_mm512_sub_pd(a.v, b.v)}; }
+	friend pack operator*(pack const& a, pack const& b) { return {_mm512_mul_pd(a.v, b.v)}; }
+	friend pack operator/(pack const& a, pack const& b) { return {_mm512_div_pd(a.v, b.v)}; }
+	friend pack operator-(pack const& a)                { return {_mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a.v), _mm512_set1_epi64(std::int64_t(0x8000000000000000ull))))}; }
+	friend pack sqrt     (pack const& a)                { return {_mm512_sqrt_pd(a.v)}; }
+	friend pack min      (pack const& a, pack const& b) { return {_mm512_min_pd(a.v, b.v)}; }
+	friend pack max      (pack const& a, pack const& b) { return {_mm512_max_pd(a.v, b.v)}; }
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm512_fmadd_pd(a.v, b.v, c.v)}; }
+	friend double reduce_add(pack const& a) { return _mm512_reduce_add_pd(a.v); }
+	friend pack exp2i(pack const& t) { return {_mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(t.v), 52))}; }
+	static void deinterleave(pack& a, pack& b)
+	{
+		auto const r = _mm512_permutex2var_pd(a.v, _mm512_setr_epi64(0,2,4,6,8,10,12,14), b.v);
+		b.v          = _mm512_permutex2var_pd(a.v, _mm512_setr_epi64(1,3,5,7,9,11,13,15), b.v);
+		a.v = r;
+	}
+	static void interleave(pack& a, pack& b)
+	{
+		auto const l = _mm512_permutex2var_pd(a.v, _mm512_setr_epi64(0,8,1,9,2,10,3,11), b.v);
+		b.v          = _mm512_permutex2var_pd(a.v, _mm512_setr_epi64(4,12,5,13,6,14,7,15), b.v);
+		a.v = l;
+	}
+};
+
+#elif defined(__AVX__)
+
+template<>
+struct pack<float>
+{
+	static constexpr std::size_t width = 8u;
+
+	__m256 v;
+
+	static pack load     (float const* p)  { return {_mm256_loadu_ps(p)}; }
+	static pack broadcast(float const& a)  { return {_mm256_set1_ps(a)}; }
+	static pack zero     ()                { return {_mm256_setzero_ps()}; }
+	void        store    (float* p) const  { _mm256_storeu_ps(p, v); }
+
+	friend pack operator+(pack const& a, pack const& b) { return {_mm256_add_ps(a.v, b.v)}; }
+	friend pack operator-(pack const& a, pack const& b) { return {_mm256_sub_ps(a.v, b.v)}; }
+	friend pack operator*(pack const& a, pack const& b) { return {_mm256_mul_ps(a.v, b.v)}; }
+	friend pack operator/(pack const& a, pack const& b) { return {_mm256_div_ps(a.v, b.v)}; }
+	friend pack operator-(pack const& a)                { return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))}; }
+	friend pack sqrt     (pack const& a)                { return {_mm256_sqrt_ps(a.v)}; }
+	friend pack min      (pack const& a, pack const& b) { return {_mm256_min_ps(a.v, b.v)}; }
+	friend pack max      (pack const& a, pack const& b) { return {_mm256_max_ps(a.v, b.v)}; }
+#ifdef __FMA__
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+#else
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v)}; }
+#endif
+	friend float reduce_add(pack const& a)
+	{
+		auto s = _mm_add_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+		s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+		s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+		return _mm_cvtss_f32(s);
+	}
+	// AVX has no 256-bit integer shifts, which are applied to both halves
+	friend pack exp2i(pack const& t)
+	{
+		auto const i = _mm256_castps_si256(t.v);
+		auto const l = _mm_slli_epi32(_mm256_castsi256_si128(i), 23);
+		auto const h = _mm_slli_epi32(_mm256_extractf128_si256(i, 1), 23);
+		return {_mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(l), h, 1))};
+	}
+	// shuffles only work within 128-bit lanes which are exchanged before and after them
+	static void deinterleave(pack& a, pack& b)
+	{
+		auto const l = _mm256_permute2f128_ps(a.v, b.v, 0x20);
+		auto const h = _mm256_permute2f128_ps(a.v, b.v, 0x31);
+		a.v = _mm256_shuffle_ps(l, h, 0x88);
+		b.v = _mm256_shuffle_ps(l, h, 0xDD);
+	}
+	static void interleave(pack& a, pack& b)
+	{
+		auto const l = _mm256_unpacklo_ps(a.v, b.v);
+		auto const h = _mm256_unpackhi_ps(a.v, b.v);
+		a.v = _mm256_permute2f128_ps(l, h, 0x20);
+		b.v = _mm256_permute2f128_ps(l, h, 0x31);
+	}
+};
+
+template<>
+struct pack<double>
+{
+	static constexpr std::size_t width = 4u;
+
+	__m256d v;
+
+	static pack load     (double const* p)  { return {_mm256_loadu_pd(p)}; }
+	static pack broadcast(double const& a)  { return {_mm256_set1_pd(a)}; }
+	static pack zero     ()                 { return {_mm256_setzero_pd()}; }
+	void        store    (double* p) const  { _mm256_storeu_pd(p, v); }
+
+	friend pack operator+(pack const& a, pack const& b) { return {_mm256_add_pd(a.v, b.v)}; }
+	friend pack operator-(pack const& a, pack const& b) { return {_mm256_sub_pd(a.v, b.v)}; }
+	friend pack operator*(pack const& a, pack const& b) { return {_mm256_mul_pd(a.v, b.v)}; }
+	friend pack operator/(pack const& a, pack const& b) { return {_mm256_div_pd(a.v, b.v)}; }
+	friend pack operator-(pack const& a)                { return {_mm256_xor_pd(a.v, _mm256_set1_pd(-0.0))}; }
+	friend pack sqrt     (pack const& a)                { return {_mm256_sqrt_pd(a.v)}; }
+	friend pack min      (pack const& a, pack const& b) { return {_mm256_min_pd(a.v, b.v)}; }
+	friend pack max      (pack const& a, pack const& b) { return {_mm256_max_pd(a.v, b.v)}; }
+#ifdef __FMA__
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm256_fmadd_pd(a.v, b.v, c.v)}; }
+#else
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm256_add_pd(_mm256_mul_pd(a.v, b.v), c.v)}; }
+#endif
+	friend double reduce_add(pack const& a)
+	{
+		auto s = _mm_add_pd(_mm256_castpd256_pd128(a.v), _mm256_extractf128_pd(a.v, 1));
+		s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+		return _mm_cvtsd_f64(s);
+	}
+	// AVX has no 256-bit integer shifts, which are applied to both halves
+	friend pack exp2i(pack const& t)
+	{
+		auto const i = _mm256_castpd_si256(t.v);
+		auto const l = _mm_slli_epi64(_mm256_castsi256_si128(i), 52);
+		auto const h = _mm_slli_epi64(_mm256_extractf128_si256(i, 1), 52);
+		return {_mm256_castsi256_pd(_mm256_insertf128_si256(_mm256_castsi128_si256(l), h, 1))};
+	}
+	// shuffles only work within 128-bit lanes which are exchanged before and after them
+	static void deinterleave(pack& a, pack& b)
+	{
+		auto const l = _mm256_permute2f128_pd(a.v, b.v, 0x20);
+		auto const h = _mm256_permute2f128_pd(a.v, b.v, 0x31);
+		a.v = _mm256_unpacklo_pd(l, h);
+		b.v = _mm256_unpackhi_pd(l, h);
+	}
+	static void interleave(pack& a, pack& b)
+	{
+		auto const l = _mm256_unpacklo_pd(a.v, b.v);
+		auto const h = _mm256_unpackhi_pd(a.v, b.v);
+		a.v = _mm256_permute2f128_pd(l, h, 0x20);
+		b.v = _mm256_permute2f128_pd(l, h, 0x31);
+	}
+};
+
+#else // __SSE2__
+
+template<>
+struct pack<float>
+{
+	static constexpr std::size_t width = 4u;
+
+	__m128 v;
+
+	static pack load     (float const* p)  { return {_mm_loadu_ps(p)}; }
+	static pack broadcast(float const& a)  { return {_mm_set1_ps(a)}; }
+	static pack zero     ()                { return {_mm_setzero_ps()}; }
+	void        store    (float* p) const  { _mm_storeu_ps(p, v); }
+
+	friend pack operator+(pack const& a, pack const& b) { return {_mm_add_ps(a.v, b.v)}; }
+	friend pack operator-(pack const& a, pack const& b) { return {_mm_sub_ps(a.v, b.v)}; }
+	friend pack operator*(pack const& a, pack const& b) { return {_mm_mul_ps(a.v, b.v)}; }
+	friend pack operator/(pack const& a, pack const& b) { return {_mm_div_ps(a.v, b.v)}; }
+	friend pack operator-(pack const& a)                { return {_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))}; }
+	friend pack sqrt     (pack const& a)                { return {_mm_sqrt_ps(a.v)}; }
+	friend pack min      (pack const& a, pack const& b) { return {_mm_min_ps(a.v, b.v)}; }
+	friend pack max      (pack const& a, pack const& b) { return {_mm_max_ps(a.v, b.v)}; }
+#ifdef __FMA__
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm_fmadd_ps(a.v, b.v, c.v)}; }
+#else
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)}; }
+#endif
+	friend float reduce_add(pack const& a)
+	{
+		auto s = _mm_add_ps(a.v, _mm_movehl_ps(a.v, a.v));
+		s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+		return _mm_cvtss_f32(s);
+	}
+	friend pack exp2i(pack const& t) { return {_mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(t.v), 23))}; }
+	static void deinterleave(pack& a, pack& b) { auto const r = _mm_shuffle_ps(a.v, b.v, 0x88); b.v = _mm_shuffle_ps(a.v, b.v, 0xDD); a.v = r; }
+	static void interleave  (pack& a, pack& b) { auto const l = _mm_unpacklo_ps(a.v, b.v);      b.v = _mm_unpackhi_ps(a.v, b.v);      a.v = l; }
+};
+
+template<>
+struct pack<double>
+{
+	static constexpr std::size_t width = 2u;
+
+	__m128d v;
+
+	static pack load     (double const* p)  { return {_mm_loadu_pd(p)}; }
+	static pack broadcast(double const& a)  { return {_mm_set1_pd(a)}; }
+	static pack zero     ()                 { return {_mm_setzero_pd()}; }
+	void        store    (double* p) const  { _mm_storeu_pd(p, v); }
+
+	friend pack operator+(pack const& a, pack const& b) { return {_mm_add_pd(a.v, b.v)}; }
+	friend pack operator-(pack const& a, pack const& b) { return {_mm_sub_pd(a.v, b.v)}; }
+	friend pack operator*(pack const& a, pack const& b) { return {_mm_mul_pd(a.v, b.v)}; }
+	friend pack operator/(pack const& a, pack const& b) { return {_mm_div_pd(a.v, b.v)}; }
+	friend pack operator-(pack const& a)                { return {_mm_xor_pd(a.v, _mm_set1_pd(-0.0))}; }
+	friend pack sqrt     (pack const& a)                { return {_mm_sqrt_pd(a.v)}; }
+	friend pack min      (pack const& a, pack const& b) { return {_mm_min_pd(a.v, b.v)}; }
+	friend pack max      (pack const& a, pack const& b) { return {_mm_max_pd(a.v, b.v)}; }
+#ifdef __FMA__
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm_fmadd_pd(a.v, b.v, c.v)}; }
+#else
+	friend pack fma(pack const& a, pack const& b, pack const& c) { return {_mm_add_pd(_mm_mul_pd(a.v, b.v), c.v)}; }
+#endif
+	friend double reduce_add(pack const& a)
+	{
+		return _mm_cvtsd_f64(_mm_add_sd(a.v, _mm_unpackhi_pd(a.v, a.v)));
+	}
+	friend pack exp2i(pack const& t) { return {_mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(t.v), 52))}; }
+	static void deinterleave(pack& a, pack& b) { auto const r = _mm_unpacklo_pd(a.v, b.v); b.v = _mm_unpackhi_pd(a.v, b.v); a.v = r; }
+	static void interleave  (pack& a, pack& b) { auto const l = _mm_unpacklo_pd(a.v, b.v); b.v = _mm_unpackhi_pd(a.v, b.v); a.v = l; }
+};
+
+#endif
+
+
+/** @brief Constants of the exponential function of packed registers
+ *
+ * \c shift rounds a value to an integer n when it is added and keeps
+ * n plus the exponent bias in the lowest bits of the mantissa, see exp2i.
+ * \c ln2_hi has trailing zero bits so that n*ln2_hi is exact.
+*/
+template<class value_type>
+struct exp_constants;
+
+template<>
+struct exp_constants<float>
+{
+	static constexpr float lo     = -104.0f;
+	static constexpr float hi     =   89.0f;
+	static constexpr float log2e  = 1.44269504088896341f;
+	static constexpr float ln2_hi = 0.693359375f;
+	static constexpr float ln2_lo = -2.12194440e-4f;
+	static constexpr float shift  = 12582912.0f + 127.0f; // 1.5*2^23 + bias
+	static constexpr std::size_t degree = 7u;
+};
+
+template<>
+struct exp_constants<double>
+{
+	static constexpr double lo     = -746.0;
+	static constexpr double hi     =  710.0;
+	static constexpr double log2e  = 1.44269504088896340736;
+	static constexpr double ln2_hi = 6.93145751953125e-1;
+	static constexpr double ln2_lo = 1.42860682030941723212e-6;
+	static constexpr double shift  = 6755399441055744.0 + 1023.0; // 1.5*2^52 + bias
+	static constexpr std::size_t degree = 13u;
+};
+
+
+/** @brief Returns the coefficients 1/k! of the Taylor polynomial of exp for k = 0,...,degree */
+template<class value_type, std::size_t degree>
+constexpr std::array<value_type, degree+1u> taylor_exp_coefficients()
+{
+	auto c = std::array<value_type, degree+1u>{};
+	auto factorial = 1.0;
+	for(auto k = 0u; k <= degree; ++k){
+		factorial *= k > 0u ? double(k) : 1.0;
+		c[k] = value_type(1.0 / factorial);
+	}
+	return c;
+}
+
+
+/** @brief Computes the exponential function of every element
+ *
+ * Reduces x = n*ln2 + r with an integer n and |r| <= ln2/2, approximates
+ * exp(r) with its Taylor polynomial and multiplies it with 2^n. The power of
+ * two is composed of two factors, so that results below the smallest normal
+ * number are rounded to subnormal numbers or zero and results above the largest
+ * number are infinite. NaN is propagated.
+ *
+ * @note exp2i(t) of a pack specialization returns 2^n for t = n + exp_constants::shift
+*/
+template<class value_type>
+pack<value_type> exp(pack<value_type> const& a)
+{
+	using pack_t = pack<value_type>;
+	using c = exp_constants<value_type>;
+
+	auto const shift = pack_t::broadcast(c::shift);
+	// max and min return their second operand if it is NaN
+	auto const x = min(pack_t::broadcast(c::hi), max(pack_t::broadcast(c::lo), a));
+
+	auto const t = fma(x, pack_t::broadcast(c::log2e), shift);
+	auto const n = t - shift;
+	auto const r = fma(n, pack_t::broadcast(-c::ln2_lo), fma(n, pack_t::broadcast(-c::ln2_hi), x));
+
+	// Horner scheme of sum r^k/k! for k = 0,...,degree
+	constexpr auto coefficients = taylor_exp_coefficients<value_type, c::degree>();
+	auto p = pack_t::broadcast(coefficients[c::degree]);
+	for(auto k = c::degree; k > 0u; --k)
+		p = fma(p, r, pack_t::broadcast(coefficients[k-1u]));
+
+	// 2^n = 2^h * 2^(n-h) with h = round(n/2)
+	auto const th = fma(n, pack_t::broadcast(value_type(0.5)), shift);
+	auto const h = th - shift;
+	return (p * exp2i(th)) * exp2i((n - h) + shift);
+}
+
+#endif // BOOST_UBLAS_TENSOR_SIMD_X86
+
+
+/** @brief Transposes a square block of elements in registers
+ *
+ * Implements c[i*ldc+j] = a[j*lda+i] for 0 <= i,j < size. The primary template
+ * has size one. The specializations for float and double transpose 8x8 and 4x4
+ * blocks with AVX or 4x4 and 2x2 blocks with SSE2.
+ *
+ * @tparam value_type type of the elements
+*/
+template<class value_type>
+struct block_transpose
+{
+	static constexpr std::size_t size = 1u;
+
+	static void apply(value_type const* a, std::size_t, value_type* c, std::size_t) { *c = *a; }
+};
+
+#ifdef BOOST_UBLAS_TENSOR_SIMD_X86
+
+#if defined(__AVX__)
+
+template<>
+struct block_transpose<float>
+{
+	static constexpr std::size_t size = 8u;
+
+	static void apply(float const* a, std::size_t const lda, float* c, std::size_t const ldc)
+	{
+		auto const r0 = _mm256_loadu_ps(a      ), r1 = _mm256_loadu_ps(a+  lda);
+		auto const r2 = _mm256_loadu_ps(a+2*lda), r3 = _mm256_loadu_ps(a+3*lda);
+		auto const r4 = _mm256_loadu_ps(a+4*lda), r5 = _mm256_loadu_ps(a+5*lda);
+		auto const r6 = _mm256_loadu_ps(a+6*lda), r7 = _mm256_loadu_ps(a+7*lda);
+
+		auto const t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+		auto const t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+		auto const t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+		auto const t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+
+		auto const u0 = _mm256_shuffle_ps(t0, t2, 0x44), u1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+		auto const u2 = _mm256_shuffle_ps(t1, t3, 0x44), u3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+		auto const u4 = _mm256_shuffle_ps(t4, t6, 0x44), u5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+		auto const u6 = _mm256_shuffle_ps(t5, t7, 0x44), u7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+		_mm256_storeu_ps(c      , _mm256_permute2f128_ps(u0, u4, 0x20));
+		_mm256_storeu_ps(c+  ldc, _mm256_permute2f128_ps(u1, u5, 0x20));
+		_mm256_storeu_ps(c+2*ldc, _mm256_permute2f128_ps(u2, u6, 0x20));
+		_mm256_storeu_ps(c+3*ldc, _mm256_permute2f128_ps(u3, u7, 0x20));
+		_mm256_storeu_ps(c+4*ldc, _mm256_permute2f128_ps(u0, u4, 0x31));
+		_mm256_storeu_ps(c+5*ldc, _mm256_permute2f128_ps(u1, u5, 0x31));
+		_mm256_storeu_ps(c+6*ldc, _mm256_permute2f128_ps(u2, u6, 0x31));
+		_mm256_storeu_ps(c+7*ldc, _mm256_permute2f128_ps(u3, u7, 0x31));
+	}
+};
+
+template<>
+struct block_transpose<double>
+{
+	static constexpr std::size_t size = 4u;
+
+	static void apply(double const* a, std::size_t const lda, double* c, std::size_t const ldc)
+	{
+		auto const r0 = _mm256_loadu_pd(a      ), r1 = _mm256_loadu_pd(a+  lda);
+		auto const r2 = _mm256_loadu_pd(a+2*lda), r3 = _mm256_loadu_pd(a+3*lda);
+
+		auto const t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+		auto const t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+
+		_mm256_storeu_pd(c      , _mm256_permute2f128_pd(t0, t2, 0x20));
+		_mm256_storeu_pd(c+  ldc, _mm256_permute2f128_pd(t1, t3, 0x20));
+		_mm256_storeu_pd(c+2*ldc, _mm256_permute2f128_pd(t0, t2, 0x31));
+		_mm256_storeu_pd(c+3*ldc, _mm256_permute2f128_pd(t1, t3, 0x31));
+	}
+};
+
+#else // __SSE2__
+
+template<>
+struct block_transpose<float>
+{
+	static constexpr std::size_t size = 4u;
+
+	static void apply(float const* a, std::size_t const lda, float* c, std::size_t const ldc)
+	{
+		auto r0 = _mm_loadu_ps(a), r1 = _mm_loadu_ps(a+lda), r2 = _mm_loadu_ps(a+2*lda), r3 = _mm_loadu_ps(a+3*lda);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(c, r0); _mm_storeu_ps(c+ldc, r1); _mm_storeu_ps(c+2*ldc, r2); _mm_storeu_ps(c+3*ldc, r3);
+	}
+};
+
+template<>
+struct block_transpose<double>
+{
+	static constexpr std::size_t size = 2u;
+
+	static void apply(double const* a, std::size_t const lda, double* c, std::size_t const ldc)
+	{
+		auto const r0 = _mm_loadu_pd(a), r1 = _mm_loadu_pd(a+lda);
+		_mm_storeu_pd(c    , _mm_unpacklo_pd(r0, r1));
+		_mm_storeu_pd(c+ldc, _mm_unpackhi_pd(r0, r1));
+	}
+};
+
+#endif
+
+#endif // BOOST_UBLAS_TENSOR_SIMD_X86
+
+
+/** @brief Registers of complex numbers with separate registers for the real and imaginary parts
+ *
+ * Loads split interleaved std::complex<value_type> elements into real and imaginary parts
+ * and stores interleave them again so that complex arithmetic only needs operations of pack.
+ *
+ * @tparam value_type type of the real and imaginary parts
+*/
+template<class value_type>
+struct cpack
+{
+	using real_pack = pack<value_type>;
+	static constexpr std::size_t width = real_pack::width;
+
+	real_pack re, im;
+
+	static cpack load(std::complex<value_type> const* p)
+	{
+		auto const q = reinterpret_cast<value_type const*>(p);
+		auto a = real_pack::load(q), b = real_pack::load(q+width);
+		real_pack::deinterleave(a, b);
+		return {a, b};
+	}
+	static cpack broadcast(std::complex<value_type> const& a)
+	{
+		return {real_pack::broadcast(a.real()), real_pack::broadcast(a.imag())};
+	}
+	void store(std::complex<value_type>* p) const
+	{
+		auto const q = reinterpret_cast<value_type*>(p);
+		auto a = re, b = im;
+		real_pack::interleave(a, b);
+		a.store(q);
+		b.store(q+width);
+	}
+
+	friend cpack operator+(cpack const& a, cpack const& b) { return {a.re + b.re, a.im + b.im}; }
+	friend cpack operator-(cpack const& a, cpack const& b) { return {a.re - b.re, a.im - b.im}; }
+	friend cpack operator*(cpack const& a, cpack const& b) { return {a.re*b.re - a.im*b.im, a.re*b.im + a.im*b.re}; }
+	friend cpack operator-(cpack const& a)                 { return {-a.re, -a.im}; }
+
+	friend cpack operator+(cpack const& a, real_pack const& b) { return {a.re + b, a.im}; }
+	friend cpack operator-(cpack const& a, real_pack const& b) { return {a.re - b, a.im}; }
+	friend cpack operator*(cpack const& a, real_pack const& b) { return {a.re * b, a.im * b}; }
+	friend cpack operator/(cpack const& a, real_pack const& b) { return {a.re / b, a.im / b}; }
+	friend cpack operator+(real_pack const& a, cpack const& b) { return {a + b.re, b.im}; }
+	friend cpack operator-(real_pack const& a, cpack const& b) { return {a - b.re, -b.im}; }
+	friend cpack operator*(real_pack const& a, cpack const& b) { return {a * b.re, a * b.im}; }
+};
+
+
+/** @brief Computes the inner product of two contiguous arrays
+ *
+ * Uses four independent accumulators to hide the latency of the fused multiply-add.
+ *
+ * @param n number of elements
+ * @param a pointer to the first array
+ * @param b pointer to the second array
+*/
+template<class ValueType>
+ValueType dot(std::size_t const n, ValueType const* a, ValueType const* b)
+{
+	using pack_t = pack<ValueType>;
+	constexpr auto w = pack_t::width;
+
+	auto s0 = pack_t::zero(), s1 = pack_t::zero(), s2 = pack_t::zero(), s3 = pack_t::zero();
+	auto i = 0ul;
+	for(; i+4*w <= n; i += 4*w){
+		s0 = fma(pack_t::load(a+i    ), pack_t::load(b+i    ), s0);
+		s1 = fma(pack_t::load(a+i+  w), pack_t::load(b+i+  w), s1);
+		s2 = fma(pack_t::load(a+i+2*w), pack_t::load(b+i+2*w), s2);
+		s3 = fma(pack_t::load(a+i+3*w), pack_t::load(b+i+3*w), s3);
+	}
+	for(; i+w <= n; i += w)
+		s0 = fma(pack_t::load(a+i), pack_t::load(b+i), s0);
+
+	auto s = reduce_add((s0+s1)+(s2+s3));
+	for(; i < n; ++i)
+		s += a[i] * b[i];
+	return s;
+}
+
+
+/** @brief Binary operations of reductions that are applied to registers and to elements */
+struct add
+{
+	template<class P> P operator()(P const& a, P const& b) const { return a + b; }
+};
+
+struct minimum
+{
+	template<class P> P operator()(P const& a, P const& b) const { using std::min; return min(a, b); }
+};
+
+struct maximum
+{
+	template<class P> P operator()(P const& a, P const& b) const { using std::max; return max(a, b); }
+};
+
+/** @brief Unary operations that are applied to registers and to elements before they are reduced */
+struct identity
+{
+	template<class P> P operator()(P const& a) const { return a; }
+};
+
+struct square
+{
+	template<class P> P operator()(P const& a) const { return a * a; }
+};
+
+
+/** @brief Reduces a contiguous array with a binary operation
+ *
+ * Implements s = op(...op(op(init, f(a[0])), f(a[1]))..., f(a[n-1])) with the elements in a
+ * different order. Uses four independent accumulators that are all initialized with
+ * init so that init must be an identity of op, e.g. zero for add, or an element of a
+ * for minimum and maximum.
+ *
+ * @param n number of elements
+ * @param a pointer to the array
+ * @param init identity of op or an element of the array
+ * @param op associative and commutative operation, e.g. add, minimum or maximum
+ * @param f unary operation that is applied to every element, e.g. identity or square
+*/
+template<class ValueType, class BinaryOp, class UnaryOp = identity>
+ValueType fold(std::size_t const n, ValueType const* a, ValueType const init, BinaryOp op, UnaryOp f = {})
+{
+	using pack_t = pack<ValueType>;
+	constexpr auto w = pack_t::width;
+
+	auto s0 = pack_t::broadcast(init), s1 = s0, s2 = s0, s3 = s0;
+	auto i = 0ul;
+	for(; i+4*w <= n; i += 4*w){
+		s0 = op(s0, f(pack_t::load(a+i    )));
+		s1 = op(s1, f(pack_t::load(a+i+  w)));
+		s2 = op(s2, f(pack_t::load(a+i+2*w)));
+		s3 = op(s3, f(pack_t::load(a+i+3*w)));
+	}
+	for(; i+w <= n; i += w)
+		s0 = op(s0, f(pack_t::load(a+i)));
+
+	ValueType buffer[w];
+	op(op(s0, s1), op(s2, s3)).store(buffer);
+	auto s = init;
+	for(auto j = 0ul; j < w; ++j)
+		s = op(s, buffer[j]);
+	for(; i < n; ++i)
+		s = op(s, f(a[i]));
+	return s;
+}
+
+
+/** @brief Adds a scaled contiguous array to another one
+ *
+ * Implements c[i] += alpha * a[i]
+ *
+ * @param n number of elements
+ * @param alpha scaling factor
+ * @param a pointer to the input array
+ * @param c pointer to the output array
+*/
+template<class ValueType>
+void axpy(std::size_t const n, ValueType const alpha, ValueType const* a, ValueType* c)
+{
+	using pack_t = pack<ValueType>;
+	constexpr auto w = pack_t::width;
+
+	auto const s = pack_t::broadcast(alpha);
+	auto i = 0ul;
+	for(; i+2*w <= n; i += 2*w){
+		fma(pack_t::load(a+i  ), s, pack_t::load(c+i  )).store(c+i  );
+		fma(pack_t::load(a+i+w), s, pack_t::load(c+i+w)).store(c+i+w);
+	}
+	for(; i+w <= n; i += w)
+		fma(pack_t::load(a+i), s, pack_t::load(c+i)).store(c+i);
+	for(; i < n; ++i)
+		c[i] += alpha * a[i];
+}
+
+
+/** @brief Scales a contiguous array into another one
+ *
+ * Implements c[i] = alpha * a[i] without reading c
+ *
+ * @param n number of elements
+ * @param alpha scaling factor
+ * @param a pointer to the input array
+ * @param c pointer to the output array
+*/
+template<class ValueType>
+void scal(std::size_t const n, ValueType const alpha, ValueType const* a, ValueType* c)
+{
+	using pack_t = pack<ValueType>;
+	constexpr auto w = pack_t::width;
+
+	auto const s = pack_t::broadcast(alpha);
+	auto i = 0ul;
+	for(; i+w <= n; i += w)
+		(pack_t::load(a+i) * s).store(c+i);
+	for(; i < n; ++i)
+		c[i] = alpha * a[i];
+}
+
+} // namespace simd
+} // namespace detail
+} // namespace ublas
+} // namespace numeric
+} // namespace boost
+
+#endif
@@ -0,0 +1,399 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+/// \file small_vector.hpp Definition for the small_vector template class
+
+
+#ifndef BOOST_UBLAS_TENSOR_SMALL_VECTOR_HPP
+#define BOOST_UBLAS_TENSOR_SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/** @brief Number of modes basic_extents and basic_strides store without allocating */
+#ifndef BOOST_UBLAS_TENSOR_INLINE_RANK
+#define BOOST_UBLAS_TENSOR_INLINE_RANK 8
+#endif
+
+namespace boost
+{
+namespace numeric
+{
+namespace ublas
+{
+
+/** @brief Sequence container with the interface of std::vector that stores up to N elements inline
+ *
+ * Elements are held in an internal buffer as long as the size does not exceed N.
+ * Only larger sizes allocate memory on the heap.
+ * Used as the storage of basic_extents and basic_strides so that shapes of common ranks do not allocate.
+ *
+ * @code auto v = small_vector<std::size_t,8>{4,2,3}; @endcode
+ *
+ * @tparam T trivially copyable element type
+ * @tparam N number of elements stored inline
+*/
+template<class T, std::size_t N>
+class small_vector
+{
+	static_assert( std::is_trivially_copyable<T>::value,
+	               "Static error in boost::numeric::ublas::small_vector: type must be trivially copyable." );
+	static_assert( N > 0u,
+	               "Static error in boost::numeric::ublas::small_vector: inline capacity must be greater than zero." );
+
+	template<class iterator>
+	using if_iterator = std::enable_if_t<std::is_convertible<
+	        typename std::iterator_traits<iterator>::iterator_category, std::input_iterator_tag>::value>;
+
+	template<class iterator>
+	using is_forward = std::is_convertible<
+	        typename std::iterator_traits<iterator>::iterator_category, std::forward_iterator_tag>;
+
+public:
+	using value_type             = T;
+	using size_type              = std::size_t;
+	using difference_type        = std::ptrdiff_t;
+	using reference              = value_type&;
+	using const_reference        = value_type const&;
+	using pointer                = value_type*;
+	using const_pointer          = value_type const*;
+	using iterator               = pointer;
+	using const_iterator         = const_pointer;
+	using reverse_iterator       = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	static constexpr size_type inline_capacity = N;
+
+	// the inline buffer is value-initialized so that compilers can see that copies into it are initialized
+	small_vector() noexcept
+		: _data(_buffer), _size(0u), _capacity(N), _buffer{}
+	{
+	}
+
+	explicit small_vector(size_type n)
+		: small_vector()
+	{
+		resize(n);
+	}
+
+	small_vector(size_type n, const_reference v)
+		: small_vector()
+	{
+		assign(n, v);
+	}
+
+	template<class InputIt, class = if_iterator<InputIt>>
+	small_vector(InputIt first, InputIt last)
+		: small_vector()
+	{
+		assign(first, last);
+	}
+
+	small_vector(std::initializer_list<value_type> l)
+		: small_vector()
+	{
+		assign(l.begin(), l.end());
+	}
+
+	small_vector(small_vector const& other)
+		: small_vector()
+	{
+		assign(other.begin(), other.end());
+	}
+
+	/** @note steals the heap buffer of other if it has spilled, copies at most N elements otherwise */
+	small_vector(small_vector&& other) noexcept
+		: small_vector()
+	{
+		steal(other);
+	}
+
+	~small_vector()
+	{
+		release();
+	}
+
+	small_vector& operator=(small_vector const& other)
+	{
+		if(this != &other)
+			assign(other.begin(), other.end());
+		return *this;
+	}
+
+	small_vector& operator=(small_vector&& other) noexcept
+	{
+		if(this != &other){
+			release();
+			_data = _buffer, _size = 0u, _capacity = N;
+			steal(other);
+		}
+		return *this;
+	}
+
+	small_vector& operator=(std::initializer_list<value_type> l)
+	{
+		assign(l.begin(), l.end());
+		return *this;
+	}
+
+	void assign(size_type n, const_reference v)
+	{
+		_size = 0u;
+		reserve(n);
+		std::fill_n(_data, n, v);
+		_size = n;
+	}
+
+	template<class InputIt, class = if_iterator<InputIt>>
+	void assign(InputIt first, InputIt last)
+	{
+		if constexpr(is_forward<InputIt>::value){
+			auto const n = size_type(std::distance(first, last));
+			_size = 0u;
+			reserve(n);
+			std::copy(first, last, _data);
+			_size = n;
+		}
+		else{
+			clear();
+			for(; first != last; ++first)
+				push_back(*first);
+		}
+	}
+
+	void swap(small_vector& other) noexcept
+	{
+		auto tmp = std::move(other);
+		other = std::move(*this);
+		*this = std::move(tmp);
+	}
+
+	friend void swap(small_vector& lhs, small_vector& rhs) noexcept
+	{
+		lhs.swap(rhs);
+	}
+
+	pointer       data()       noexcept { return _data; }
+	const_pointer data() const noexcept { return _data; }
+
+	size_type size()     const noexcept { return _size; }
+	size_type capacity() const noexcept { return _capacity; }
+	bool      empty()    const noexcept { return _size == 0u; }
+
+	/** @brief Returns true if the elements are stored in the inline buffer */
+	bool is_inline() const noexcept { return _data == _buffer; }
+
+	reference       operator[](size_type i)       { return _data[i]; }
+	const_reference operator[](size_type i) const { return _data[i]; }
+
+	reference at(size_type i)
+	{
+		if(i >= _size)
+			throw std::out_of_range("Error in boost::numeric::ublas::small_vector::at() : index is out of range.");
+		return _data[i];
+	}
+
+	const_reference at(size_type i) const
+	{
+		if(i >= _size)
+			throw std::out_of_range("Error in boost::numeric::ublas::small_vector::at() : index is out of range.");
+		return _data[i];
+	}
+
+	reference       front()       { return _data[0]; }
+	const_reference front() const { return _data[0]; }
+	reference       back()        { return _data[_size-1]; }
+	const_reference back()  const { return _data[_size-1]; }
+
+	iterator       begin()        noexcept { return _data; }
+	const_iterator begin()  const noexcept { return _data; }
+	const_iterator cbegin() const noexcept { return _data; }
+	iterator       end()          noexcept { return _data+_size; }
+	const_iterator end()    const noexcept { return _data+_size; }
+	const_iterator cend()   const noexcept { return _data+_size; }
+
+	reverse_iterator       rbegin()       noexcept { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+	reverse_iterator       rend()         noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator rend()   const noexcept { return const_reverse_iterator(begin()); }
+
+	/** @brief Makes room for at least n elements, allocates only if n exceeds the capacity */
+	void reserve(size_type n)
+	{
+		if(n <= _capacity)
+			return;
+		auto const c = std::max(n, 2u*_capacity);
+		auto p = std::make_unique<value_type[]>(c);
+		std::copy_n(_data, _size, p.get());
+		release();
+		_data = p.release();
+		_capacity = c;
+	}
+
+	void resize(size_type n)
+	{
+		resize(n, value_type{});
+	}
+
+	void resize(size_type n, const_reference v)
+	{
+		reserve(n);
+		if(n > _size)
+			std::fill(_data+_size, _data+n, v);
+		_size = n;
+	}
+
+	void clear() noexcept { _size = 0u; }
+
+	void push_back(const_reference v)
+	{
+		if(_size == _capacity){
+			auto const copy = v;
+			reserve(_size+1u);
+			_data[_size++] = copy;
+		}
+		else{
+			_data[_size++] = v;
+		}
+	}
+
+	template<class ... Args>
+	reference emplace_back(Args&& ... args)
+	{
+		push_back(value_type(std::forward<Args>(args)...));
+		return back();
+	}
+
+	void pop_back() { --_size; }
+
+	iterator insert(const_iterator pos, const_reference v)
+	{
+		return insert(pos, size_type(1), v);
+	}
+
+	iterator insert(const_iterator pos, size_type n, const_reference v)
+	{
+		auto const i = size_type(pos - _data);
+		auto const copy = v;
+		make_gap(i, n);
+		std::fill_n(_data+i, n, copy);
+		return _data+i;
+	}
+
+	template<class InputIt, class = if_iterator<InputIt>>
+	iterator insert(const_iterator pos, InputIt first, InputIt last)
+	{
+		auto const i = size_type(pos - _data);
+		// the range may point into this container
+		auto const tmp = small_vector(first, last);
+		make_gap(i, tmp.size());
+		std::copy(tmp.begin(), tmp.end(), _data+i);
+		return _data+i;
+	}
+
+	iterator insert(const_iterator pos, std::initializer_list<value_type> l)
+	{
+		return insert(pos, l.begin(), l.end());
+	}
+
+	iterator erase(const_iterator pos)
+	{
+		return erase(pos, pos+1);
+	}
+
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		auto const i = size_type(first - _data);
+		auto const j = size_type(last  - _data);
+		std::copy(_data+j, _data+_size, _data+i);
+		_size -= (j-i);
+		return _data+i;
+	}
+
+	friend bool operator==(small_vector const& lhs, small_vector const& rhs)
+	{
+		return lhs._size == rhs._size && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	friend bool operator!=(small_vector const& lhs, small_vector const& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	friend bool operator<(small_vector const& lhs, small_vector const& rhs)
+	{
+		return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+	}
+
+	template<class A>
+	friend bool operator==(small_vector const& lhs, std::vector<value_type,A> const& rhs)
+	{
+		return lhs._size == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template<class A>
+	friend bool operator!=(small_vector const& lhs, std::vector<value_type,A> const& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	/** @brief Converts into a std::vector with the same elements */
+	template<class A>
+	explicit operator std::vector<value_type,A>() const
+	{
+		return std::vector<value_type,A>(begin(), end());
+	}
+
+private:
+
+	// shifts [i,size) by n elements to the right
+	void make_gap(size_type i, size_type n)
+	{
+		reserve(_size+n);
+		std::copy_backward(_data+i, _data+_size, _data+_size+n);
+		_size += n;
+	}
+
+	void steal(small_vector& other) noexcept
+	{
+		if(other.is_inline()){
+			std::copy_n(other._buffer, other._size, _buffer);
+			_size = other._size;
+		}
+		else{
+			_data = other._data, _size = other._size, _capacity = other._capacity;
+			other._data = other._buffer, other._capacity = N;
+		}
+		other._size = 0u;
+	}
+
+	void release() noexcept
+	{
+		if(!is_inline())
+			delete[] _data;
+	}
+
+	pointer   _data;
+	size_type _size;
+	size_type _capacity;
+	value_type _buffer[N];
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,429 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+#ifndef BOOST_NUMERIC_UBLAS_TENSOR_STATIC_EXTENTS_HPP
+#define BOOST_NUMERIC_UBLAS_TENSOR_STATIC_EXTENTS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "extents.hpp"
+
+namespace boost {
+namespace numeric {
+namespace ublas {
+
+namespace detail::extents {
+
+/** @brief Returns true if (1,1,[1,...,1]), see basic_extents::is_scalar */
+template <class int_type, std::size_t N>
+constexpr bool is_scalar(std::array<int_type, N> const &e) {
+  if (N < 2)
+    return false;
+  for (auto a : e)
+    if (a != 1)
+      return false;
+  return true;
+}
+
+/** @brief Returns true if (1,n,[1,...,1]) or (n,1,[1,...,1]) with n > 1, see
+ * basic_extents::is_vector */
+template <class int_type, std::size_t N>
+constexpr bool is_vector(std::array<int_type, N> const &e) {
+  if constexpr (N == 0) {
+    return false;
+  } else if constexpr (N == 1) {
+    return e[0] > 1;
+  } else {
+    for (auto r = 2u; r < N; ++r)
+      if (e[r] != 1)
+        return false;
+    return (e[0] > 1 || e[1] > 1) && (e[0] == 1 || e[1] == 1);
+  }
+}
+
+/** @brief Returns true if (m,n,[1,...,1]) with m > 1 and n > 1, see
+ * basic_extents::is_matrix */
+template <class int_type, std::size_t N>
+constexpr bool is_matrix(std::array<int_type, N> const &e) {
+  if constexpr (N < 2) {
+    return false;
+  } else {
+    for (auto r = 2u; r < N; ++r)
+      if (e[r] != 1)
+        return false;
+    return e[0] > 1 && e[1] > 1;
+  }
+}
+
+/** @brief Returns true if one of the extents after the second is greater than
+ * one, see basic_extents::is_tensor */
+template <class int_type, std::size_t N>
+constexpr bool is_tensor(std::array<int_type, N> const &e) {
+  for (auto r = 2u; r < N; ++r)
+    if (e[r] > 1)
+      return true;
+  return false;
+}
+
+/** @brief Returns true if N > 1 and all elements > 0 or if N == 1 && e[0] == 1,
+ * see basic_extents::valid */
+template <class int_type, std::size_t N>
+constexpr bool valid(std::array<int_type, N> const &e) {
+  if (N == 1)
+    return e[0] == 1;
+  if (N == 0)
+    return false;
+  for (auto a : e)
+    if (a == 0)
+      return false;
+  return true;
+}
+
+/** @brief Returns the product of the extents or 0 if N == 0 */
+template <class int_type, std::size_t N>
+constexpr std::size_t product(std::array<int_type, N> const &e) {
+  if (N == 0)
+    return 0;
+  auto p = std::size_t(1);
+  for (auto a : e)
+    p *= a;
+  return p;
+}
+
+template <class int_type, std::size_t N>
+std::string to_string(std::array<int_type, N> const &e) {
+  if (N == 0)
+    return "{}";
+  std::string res = "{";
+  for (auto i = 0u; i < N - 1; i++)
+    res += (std::to_string(e[i]) + ", ");
+  res += std::to_string(e[N - 1]) + "}";
+  return res;
+}
+
+} // namespace detail::extents
+
+/** @brief Template class for storing tensor extents with a rank that is known
+ * at compile time.
+ *
+ * Proxy template class of std::array<int_type,N>. In contrast to basic_extents
+ * the extents are stored inline and do not allocate.
+ *
+ * @code auto ex = basic_fixed_rank_extents<unsigned,3>{4,2,3}; @endcode
+ */
+template <class int_type, std::size_t N> class basic_fixed_rank_extents {
+  static_assert(std::numeric_limits<int_type>::is_integer,
+                "Static error in basic_fixed_rank_extents: type must be of "
+                "type integer.");
+  static_assert(!std::numeric_limits<int_type>::is_signed,
+                "Static error in basic_fixed_rank_extents: type must be of "
+                "type unsigned integer.");
+
+public:
+  using base_type = std::array<int_type, N>;
+  using value_type = typename base_type::value_type;
+  using const_reference = typename base_type::const_reference;
+  using reference = typename base_type::reference;
+  using size_type = typename base_type::size_type;
+  using const_pointer = typename base_type::const_pointer;
+  using const_iterator = typename base_type::const_iterator;
+
+  /** @brief Default constructs basic_fixed_rank_extents with zero extents */
+  constexpr basic_fixed_rank_extents() : _base{} {}
+
+  /** @brief Constructs basic_fixed_rank_extents from an array
+   *
+   * @note checks if size > 1 and all elements > 0
+   */
+  constexpr explicit basic_fixed_rank_extents(base_type const &b) : _base(b) {
+    if (!this->valid()) {
+      throw std::length_error(
+          "Error in basic_fixed_rank_extents::basic_fixed_rank_extents() : "
+          "shape tuple is not a valid permutation: has zero elements.");
+    }
+  }
+
+  /** @brief Constructs basic_fixed_rank_extents from an initializer list
+   *
+   * @code auto ex = basic_fixed_rank_extents<unsigned,3>{3,2,4};
+   *
+   * @note checks if the list has N elements, if N > 1 and all elements > 0
+   */
+  constexpr basic_fixed_rank_extents(std::initializer_list<value_type> l)
+      : basic_fixed_rank_extents(make_base(l.begin(), l.end())) {}
+
+  /** @brief Constructs basic_fixed_rank_extents from basic_extents
+   *
+   * @note checks if e has N elements
+   */
+  template <class other_int_type>
+  explicit basic_fixed_rank_extents(basic_extents<other_int_type> const &e)
+      : basic_fixed_rank_extents(make_base(e.begin(), e.end())) {}
+
+  constexpr bool is_scalar() const { return detail::extents::is_scalar(_base); }
+  constexpr bool is_free_scalar() const { return N == 1 && _base[0] == 1; }
+  constexpr bool is_vector() const { return detail::extents::is_vector(_base); }
+  constexpr bool is_matrix() const { return detail::extents::is_matrix(_base); }
+  constexpr bool is_tensor() const { return detail::extents::is_tensor(_base); }
+  constexpr bool valid() const { return detail::extents::valid(_base); }
+
+  /** @brief Returns the number of elements a tensor holds with this */
+  constexpr size_type product() const {
+    return detail::extents::product(_base);
+  }
+
+  constexpr const_pointer data() const { return _base.data(); }
+
+  constexpr const_reference operator[](size_type p) const { return _base[p]; }
+
+  constexpr reference operator[](size_type p) { return _base[p]; }
+
+  constexpr const_reference at(size_type p) const { return _base.at(p); }
+
+  constexpr reference at(size_type p) { return _base.at(p); }
+
+  constexpr bool empty() const { return N == 0; }
+
+  static constexpr size_type size() { return N; }
+
+  constexpr const_iterator begin() const { return _base.begin(); }
+
+  constexpr const_iterator end() const { return _base.end(); }
+
+  constexpr base_type const &base() const { return _base; }
+
+  /** @brief Converts into extents with runtime variable size */
+  operator basic_extents<int_type>() const {
+    if (empty())
+      return basic_extents<int_type>{};
+    return basic_extents<int_type>(
+        typename basic_extents<int_type>::base_type(_base.begin(),
+                                                    _base.end()));
+  }
+
+  constexpr bool operator==(basic_fixed_rank_extents const &b) const {
+    for (auto r = 0u; r < N; ++r)
+      if (_base[r] != b._base[r])
+        return false;
+    return true;
+  }
+
+  constexpr bool operator!=(basic_fixed_rank_extents const &b) const {
+    return !(*this == b);
+  }
+
+  bool operator==(basic_extents<int_type> const &b) const {
+    return b.size() == N && std::equal(_base.begin(), _base.end(), b.begin());
+  }
+
+  bool operator!=(basic_extents<int_type> const &b) const {
+    return !(*this == b);
+  }
+
+  std::string to_string() const { return detail::extents::to_string(_base); }
+
+private:
+  template <class iterator>
+  static constexpr base_type make_base(iterator first, iterator last) {
+    if (size_type(last - first) != N)
+      throw std::length_error(
+          "Error in basic_fixed_rank_extents::basic_fixed_rank_extents() : "
+          "number of extents does not match the rank.");
+    auto b = base_type{};
+    for (auto r = 0u; r < N; ++r, ++first)
+      b[r] = *first;
+    return b;
+  }
+
+  base_type _base;
+};
+
+/** @brief Template class for tensor extents that are known at compile time.
+ *
+ * Stateless class with the interface of basic_fixed_rank_extents. The extents
+ * are validated at compile time.
+ *
+ * @code constexpr auto n = basic_static_extents<unsigned,4,2,3>{}.product();
+ * @endcode
+ */
+template <class int_type, int_type... E> class basic_static_extents {
+  static_assert(std::numeric_limits<int_type>::is_integer,
+                "Static error in basic_static_extents: type must be of type "
+                "integer.");
+  static_assert(!std::numeric_limits<int_type>::is_signed,
+                "Static error in basic_static_extents: type must be of type "
+                "unsigned integer.");
+  static_assert(sizeof...(E) != 1 || ((E == 1) && ...),
+                "Static error in basic_static_extents: a shape of rank one "
+                "must be {1}.");
+  static_assert(((E > 0) && ...),
+                "Static error in basic_static_extents: extents must be "
+                "greater than zero.");
+
+public:
+  using base_type = std::array<int_type, sizeof...(E)>;
+  using value_type = typename base_type::value_type;
+  using const_reference = typename base_type::const_reference;
+  using size_type = typename base_type::size_type;
+  using const_pointer = typename base_type::const_pointer;
+  using const_iterator = typename base_type::const_iterator;
+
+  constexpr basic_static_extents() = default;
+
+  /** @brief Constructs basic_static_extents from extents of another type
+   *
+   * @note checks if e is equal to the static extents
+   */
+  template <class extents_type,
+            class = std::enable_if_t<!std::is_integral_v<extents_type>>>
+  explicit basic_static_extents(extents_type const &e) {
+    if (e.size() != size() || !std::equal(begin(), end(), e.begin()))
+      throw std::length_error(
+          "Error in basic_static_extents::basic_static_extents() : extents "
+          "are not equal to the static extents.");
+  }
+
+  static constexpr bool is_scalar() { return detail::extents::is_scalar(_base); }
+  static constexpr bool is_free_scalar() {
+    return sizeof...(E) == 1 && _base[0] == 1;
+  }
+  static constexpr bool is_vector() { return detail::extents::is_vector(_base); }
+  static constexpr bool is_matrix() { return detail::extents::is_matrix(_base); }
+  static constexpr bool is_tensor() { return detail::extents::is_tensor(_base); }
+  static constexpr bool valid() { return detail::extents::valid(_base); }
+
+  /** @brief Returns the number of elements a tensor holds with this */
+  static constexpr size_type product() {
+    return detail::extents::product(_base);
+  }
+
+  static constexpr const_pointer data() { return _base.data(); }
+
+  constexpr const_reference operator[](size_type p) const { return _base[p]; }
+
+  static constexpr const_reference at(size_type p) { return _base.at(p); }
+
+  static constexpr bool empty() { return sizeof...(E) == 0; }
+
+  static constexpr size_type size() { return sizeof...(E); }
+
+  static constexpr const_iterator begin() { return _base.begin(); }
+
+  static constexpr const_iterator end() { return _base.end(); }
+
+  static constexpr base_type const &base() { return _base; }
+
+  /** @brief Converts into extents with a rank that is known at compile time */
+  constexpr operator basic_fixed_rank_extents<int_type, sizeof...(E)>() const {
+    return basic_fixed_rank_extents<int_type, sizeof...(E)>(_base);
+  }
+
+  /** @brief Converts into extents with runtime variable size */
+  operator basic_extents<int_type>() const {
+    if (empty())
+      return basic_extents<int_type>{};
+    return basic_extents<int_type>(
+        typename basic_extents<int_type>::base_type(_base.begin(),
+                                                    _base.end()));
+  }
+
+  template <int_type... F>
+  constexpr bool operator==(basic_static_extents<int_type, F...> const &) const {
+    return std::is_same_v<basic_static_extents,
+                          basic_static_extents<int_type, F...>>;
+  }
+
+  template <int_type... F>
+  constexpr bool operator!=(basic_static_extents<int_type, F...> const &b) const {
+    return !(*this == b);
+  }
+
+  bool operator==(basic_extents<int_type> const &b) const {
+    return b.size() == size() && std::equal(begin(), end(), b.begin());
+  }
+
+  bool operator!=(basic_extents<int_type> const &b) const {
+    return !(*this == b);
+  }
+
+  static std::string to_string() { return detail::extents::to_string(_base); }
+
+private:
+  static constexpr base_type _base = {E...};
+};
+
+/** @brief Returns true if the fixed-rank extents are equal to the static ones */
+template <class int_type, std::size_t N, int_type... E>
+constexpr bool operator==(basic_fixed_rank_extents<int_type, N> const &a,
+                          basic_static_extents<int_type, E...> const &b) {
+  if (N != b.size())
+    return false;
+  for (auto r = 0u; r < N; ++r)
+    if (a[r] != b[r])
+      return false;
+  return true;
+}
+
+template <class int_type, std::size_t N, int_type... E>
+constexpr bool operator==(basic_static_extents<int_type, E...> const &a,
+                          basic_fixed_rank_extents<int_type, N> const &b) {
+  return b == a;
+}
+
+template <class int_type, std::size_t N, int_type... E>
+constexpr bool operator!=(basic_fixed_rank_extents<int_type, N> const &a,
+                          basic_static_extents<int_type, E...> const &b) {
+  return !(a == b);
+}
+
+template <class int_type, std::size_t N, int_type... E>
+constexpr bool operator!=(basic_static_extents<int_type, E...> const &a,
+                          basic_fixed_rank_extents<int_type, N> const &b) {
+  return !(b == a);
+}
+
+template <std::size_t N>
+using fixed_rank_extents = basic_fixed_rank_extents<std::size_t, N>;
+
+template <std::size_t... E>
+using static_extents = basic_static_extents<std::size_t, E...>;
+
+/** @brief True for extents types with a rank that is known at compile time */
+template <class E> struct is_static_rank : std::false_type {};
+template <class int_type, std::size_t N>
+struct is_static_rank<basic_fixed_rank_extents<int_type, N>> : std::true_type {};
+template <class int_type, int_type... E>
+struct is_static_rank<basic_static_extents<int_type, E...>> : std::true_type {};
+
+template <class E>
+inline constexpr bool is_static_rank_v = is_static_rank<E>::value;
+
+/** @brief True for extents types whose extents are known at compile time */
+template <class E> struct is_static_extents : std::false_type {};
+template <class int_type, int_type... E>
+struct is_static_extents<basic_static_extents<int_type, E...>>
+    : std::true_type {};
+
+template <class E>
+inline constexpr bool is_static_extents_v = is_static_extents<E>::value;
+
+} // namespace ublas
+} // namespace numeric
+} // namespace boost
+
+#endif
@@ -0,0 +1,398 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+/// \file static_strides.hpp Definition for the basic_fixed_rank_strides and basic_static_strides template classes
+
+
+#ifndef BOOST_UBLAS_TENSOR_STATIC_STRIDES_HPP
+#define BOOST_UBLAS_TENSOR_STATIC_STRIDES_HPP
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "static_extents.hpp"
+#include "strides.hpp"
+
+namespace boost
+{
+namespace numeric
+{
+namespace ublas
+{
+
+namespace detail
+{
+
+/** @brief Computes the strides of extents with a rank that is known at compile time
+ *
+ * Returns the same strides as basic_strides for the first- and last-order storage formats.
+*/
+template<class layout_type, class int_type, std::size_t N>
+constexpr std::array<int_type,N> compute_strides ( std::array<int_type,N> const& s )
+{
+    static_assert ( std::is_same<layout_type,first_order>::value || std::is_same<layout_type,last_order>::value,
+                    "Static error in boost::numeric::ublas::detail::compute_strides: layout type must either first or last order" );
+
+    auto w = std::array<int_type,N>{};
+    for ( auto& a : w )
+        a = int_type(1);
+
+    if constexpr ( N == 0 ) {
+        return w;
+    } else {
+        if ( !extents::valid ( s ) )
+            throw std::runtime_error ( "Error in boost::numeric::ublas::basic_fixed_rank_strides() : shape is not valid." );
+
+        if ( extents::is_vector ( s ) || extents::is_scalar ( s ) )
+            return w;
+
+        if ( N < 2 )
+            throw std::runtime_error ( "Error in boost::numeric::ublas::basic_fixed_rank_strides() : size of strides must be greater or equal 2." );
+
+        if constexpr ( std::is_same<layout_type,first_order>::value ) {
+            for ( auto k = std::size_t(1); k < N; ++k )
+                w[k] = w[k-1] * s[k-1];
+        } else {
+            for ( auto k = N-1; k > 0; --k )
+                w[k-1] = w[k] * s[k];
+        }
+        return w;
+    }
+}
+
+/** @brief Returns the relative memory index of the multi-index (i_r,...) with unrolled multiply-adds */
+template<std::size_t r, class strides_type, std::size_t ... k, class ... size_types>
+constexpr std::size_t access_unrolled ( strides_type const& w, std::index_sequence<k...>, size_types ... is )
+{
+    static_assert ( r + sizeof... ( is ) <= strides_type::size(),
+                    "Static error in boost::numeric::ublas::detail::access: multi-index is longer than the rank." );
+    return ( std::size_t ( 0 ) + ... + ( std::size_t ( is ) * w[r+k] ) );
+}
+
+} // namespace detail
+
+
+/** @brief Template class for storing tensor strides with a rank that is known at compile time.
+ *
+ * Proxy template class of std::array<int_type,N>. The strides are stored inline and
+ * computed from basic_fixed_rank_extents or basic_static_extents with a constant expression.
+ *
+ * @code constexpr auto w = basic_fixed_rank_strides<std::size_t,3,first_order>( static_extents<4,2,3>{} ); @endcode
+ */
+template<class __int_type, std::size_t N, class __layout>
+class basic_fixed_rank_strides
+{
+public:
+
+    using base_type = std::array<__int_type,N>;
+
+    static_assert ( std::numeric_limits<typename base_type::value_type>::is_integer,
+                    "Static error in boost::numeric::ublas::basic_fixed_rank_strides: type must be of type integer." );
+    static_assert ( !std::numeric_limits<typename base_type::value_type>::is_signed,
+                    "Static error in boost::numeric::ublas::basic_fixed_rank_strides: type must be of type unsigned integer." );
+
+    using layout_type = __layout;
+    using value_type = typename base_type::value_type;
+    using const_reference = typename base_type::const_reference;
+    using size_type = typename base_type::size_type;
+    using const_pointer = typename base_type::const_pointer;
+    using const_iterator = typename base_type::const_iterator;
+
+
+    /** @brief Default constructs basic_fixed_rank_strides with unit strides */
+    constexpr basic_fixed_rank_strides()
+        : _base{}
+    {
+        for ( auto& a : _base )
+            a = value_type(1);
+    }
+
+    /** @brief Constructs basic_fixed_rank_strides from extents with a rank of N
+     *
+     * @code auto strides = basic_fixed_rank_strides<std::size_t,3,first_order>( fixed_rank_extents<3>{2,3,4} );
+     */
+    template<class extents_type, class = std::enable_if_t<is_static_rank_v<extents_type>>>
+    constexpr explicit basic_fixed_rank_strides ( extents_type const& s )
+        : _base ( detail::compute_strides<layout_type> ( base_type ( s.base() ) ) )
+    {
+        static_assert ( extents_type::size() == N,
+                        "Static error in boost::numeric::ublas::basic_fixed_rank_strides: rank of extents and strides must be equal." );
+    }
+
+    constexpr const_reference operator[] ( size_type p ) const
+    {
+        return _base[p];
+    }
+
+    constexpr const_pointer data() const
+    {
+        return _base.data();
+    }
+
+    constexpr const_reference at ( size_type p ) const
+    {
+        return _base.at ( p );
+    }
+
+    static constexpr bool empty()
+    {
+        return N == 0;
+    }
+
+    static constexpr size_type size()
+    {
+        return N;
+    }
+
+    /** @brief Returns the relative memory index of a multi-index of length N */
+    template<class ... size_types>
+    constexpr size_type offset ( size_types ... is ) const
+    {
+        static_assert ( sizeof... ( is ) == N,
+                        "Static error in boost::numeric::ublas::basic_fixed_rank_strides: length of the multi-index must be equal to the rank." );
+        return detail::access_unrolled<0> ( *this, std::index_sequence_for<size_types...>{}, is... );
+    }
+
+    /** @brief Converts into strides with runtime variable size */
+    operator basic_strides<value_type,layout_type>() const
+    {
+        return basic_strides<value_type,layout_type> ( typename basic_strides<value_type,layout_type>::base_type ( _base.begin(), _base.end() ) );
+    }
+
+    constexpr bool operator == ( basic_fixed_rank_strides const& b ) const
+    {
+        for ( auto r = std::size_t(0); r < N; ++r )
+            if ( _base[r] != b._base[r] )
+                return false;
+        return true;
+    }
+
+    constexpr bool operator != ( basic_fixed_rank_strides const& b ) const
+    {
+        return !( *this == b );
+    }
+
+    template<class other_layout>
+    bool operator == ( basic_strides<value_type, other_layout> const& b ) const
+    {
+        return b.size() == N && std::equal ( _base.begin(), _base.end(), b.begin() );
+    }
+
+    template<class other_layout>
+    bool operator != ( basic_strides<value_type, other_layout> const& b ) const
+    {
+        return !( *this == b );
+    }
+
+    constexpr const_iterator begin() const
+    {
+        return _base.begin();
+    }
+
+    constexpr const_iterator end() const
+    {
+        return _base.end();
+    }
+
+    constexpr base_type const& base() const
+    {
+        return this->_base;
+    }
+
+private:
+    base_type _base;
+};
+
+
+/** @brief Template class for tensor strides of basic_static_extents
+ *
+ * Stateless class with the interface of basic_fixed_rank_strides whose strides are computed at compile time.
+ *
+ * @code static_assert( static_strides<static_extents<4,2,3>,first_order>{}[2] == 8 ); @endcode
+ */
+template<class __extents_type, class __layout>
+class basic_static_strides;
+
+template<class __int_type, __int_type ... E, class __layout>
+class basic_static_strides<basic_static_extents<__int_type,E...>, __layout>
+{
+public:
+
+    using extents_type = basic_static_extents<__int_type,E...>;
+    using base_type = std::array<__int_type,sizeof... ( E )>;
+    using layout_type = __layout;
+    using value_type = typename base_type::value_type;
+    using const_reference = typename base_type::const_reference;
+    using size_type = typename base_type::size_type;
+    using const_pointer = typename base_type::const_pointer;
+    using const_iterator = typename base_type::const_iterator;
+
+    constexpr basic_static_strides() = default;
+
+    constexpr explicit basic_static_strides ( extents_type const& )
+    {
+    }
+
+    constexpr const_reference operator[] ( size_type p ) const
+    {
+        return _base[p];
+    }
+
+    static constexpr const_pointer data()
+    {
+        return _base.data();
+    }
+
+    static constexpr const_reference at ( size_type p )
+    {
+        return _base.at ( p );
+    }
+
+    static constexpr bool empty()
+    {
+        return sizeof... ( E ) == 0;
+    }
+
+    static constexpr size_type size()
+    {
+        return sizeof... ( E );
+    }
+
+    /** @brief Returns the relative memory index of a multi-index of length size() */
+    template<class ... size_types>
+    constexpr size_type offset ( size_types ... is ) const
+    {
+        static_assert ( sizeof... ( is ) == sizeof... ( E ),
+                        "Static error in boost::numeric::ublas::basic_static_strides: length of the multi-index must be equal to the rank." );
+        return detail::access_unrolled<0> ( *this, std::index_sequence_for<size_types...>{}, is... );
+    }
+
+    /** @brief Converts into strides with a rank that is known at compile time */
+    constexpr operator basic_fixed_rank_strides<value_type,sizeof... ( E ),layout_type>() const
+    {
+        return basic_fixed_rank_strides<value_type,sizeof... ( E ),layout_type> ( extents_type{} );
+    }
+
+    /** @brief Converts into strides with runtime variable size */
+    operator basic_strides<value_type,layout_type>() const
+    {
+        return basic_strides<value_type,layout_type> ( typename basic_strides<value_type,layout_type>::base_type ( _base.begin(), _base.end() ) );
+    }
+
+    template<class other_layout>
+    bool operator == ( basic_strides<value_type, other_layout> const& b ) const
+    {
+        return b.size() == size() && std::equal ( _base.begin(), _base.end(), b.begin() );
+    }
+
+    template<class other_layout>
+    bool operator != ( basic_strides<value_type, other_layout> const& b ) const
+    {
+        return !( *this == b );
+    }
+
+    static constexpr const_iterator begin()
+    {
+        return _base.begin();
+    }
+
+    static constexpr const_iterator end()
+    {
+        return _base.end();
+    }
+
+    static constexpr base_type const& base()
+    {
+        return _base;
+    }
+
+private:
+    static constexpr base_type _base = detail::compute_strides<layout_type> ( extents_type::base() );
+};
+
+template<std::size_t N, class layout_type>
+using fixed_rank_strides = basic_fixed_rank_strides<std::size_t, N, layout_type>;
+
+template<class extents_type, class layout_type>
+using static_strides = basic_static_strides<extents_type, layout_type>;
+
+namespace detail
+{
+
+/** @brief Selects the strides type of a tensor with extents of type extents_type */
+template<class extents_type, class layout_type>
+struct strides_of
+{
+    using type = basic_strides<typename extents_type::value_type, layout_type>;
+};
+
+template<class int_type, std::size_t N, class layout_type>
+struct strides_of<basic_fixed_rank_extents<int_type,N>, layout_type>
+{
+    using type = basic_fixed_rank_strides<int_type, N, layout_type>;
+};
+
+template<class int_type, int_type ... E, class layout_type>
+struct strides_of<basic_static_extents<int_type,E...>, layout_type>
+{
+    using type = basic_static_strides<basic_static_extents<int_type,E...>, layout_type>;
+};
+
+template<class extents_type, class layout_type>
+using strides_of_t = typename strides_of<extents_type, layout_type>::type;
+
+} // namespace detail
+
+namespace detail
+{
+
+/** @brief Returns relative memory index with respect to a multi-index
+ *
+ * @code auto j = access<0>(0, fixed_rank_strides<3,first_order>{fixed_rank_extents<3>{4,2,3}}, 2,1,2); @endcode
+ *
+ * The multiply-adds are unrolled and evaluated at compile time for constant arguments.
+*/
+template<std::size_t r, class layout_type, std::size_t N, class ... size_types>
+constexpr std::size_t access ( std::size_t sum, basic_fixed_rank_strides<std::size_t,N,layout_type> const& w, std::size_t i, size_types ... is )
+{
+    return sum + access_unrolled<r> ( w, std::make_index_sequence<sizeof... ( is ) + 1>{}, i, is... );
+}
+
+/** @brief Returns relative memory index with respect to a multi-index
+ *
+ * @code constexpr auto j = access<0>(0, static_strides<static_extents<4,2,3>,first_order>{}, 2,1,2); @endcode
+*/
+template<std::size_t r, class extents_type, class layout_type, class ... size_types>
+constexpr std::size_t access ( std::size_t sum, basic_static_strides<extents_type,layout_type> const& w, std::size_t i, size_types ... is )
+{
+    return sum + access_unrolled<r> ( w, std::make_index_sequence<sizeof... ( is ) + 1>{}, i, is... );
+}
+
+/** @brief Returns relative memory index with respect to a multi-index of length N */
+template<class size_type, std::size_t N, class layout_type>
+constexpr size_type access ( std::array<size_type,N> const& i, basic_fixed_rank_strides<size_type,N,layout_type> const& w )
+{
+    auto sum = size_type(0);
+    for ( auto r = std::size_t(0); r < N; ++r )
+        sum += i[r]*w[r];
+    return sum;
+}
+
+} // namespace detail
+
+}
+}
+}
+
+#endif
@@ -15,6 +15,8 @@
 
 #include <vector>
 #include <array>
+#include <type_traits>
+#include <utility>
 
 namespace boost
 {
@@ -50,6 +52,9 @@ struct storage_traits<std::vector<V,A>> {
 
     template<class U>
     using rebind = std::vector<U, typename std::allocator_traits<A>::template rebind_alloc<U>>;
+
+    // tensors replace their array on copy assignment
+    static constexpr bool assign_in_place = false;
 };
 
 
@@ -75,8 +80,48 @@ struct storage_traits<std::array<V,N>> {
 
     template<class U>
     using rebind = std::array<U,N>;
+
+    static constexpr bool assign_in_place = false;
 };
 
+namespace detail {
+
+/** @brief True if tensors assign the elements of their array in place instead
+ * of replacing the array, see storage_traits<A>::assign_in_place
+ *
+ * @note false for arrays without storage_traits
+ */
+template <class A, class = void>
+struct assigns_in_place : std::false_type {};
+
+template <class A>
+struct assigns_in_place<A, std::void_t<decltype(storage_traits<A>::assign_in_place)>>
+    : std::bool_constant<storage_traits<A>::assign_in_place> {};
+
+template <class A, class = void>
+struct has_is_mapped_file : std::false_type {};
+
+template <class A>
+struct has_is_mapped_file<A, std::void_t<decltype(std::declval<A const &>().is_mapped_file())>>
+    : std::true_type {};
+
+/** @brief Returns true if the elements of a are mapped from a file
+ *
+ * The header of the file stores the extents of the elements, so tensors with
+ * such an array cannot change their extents.
+ *
+ * @note false for arrays without a member is_mapped_file
+ */
+template <class A>
+bool is_mapped_file(A const &a) noexcept {
+    if constexpr (has_is_mapped_file<A>::value)
+        return a.is_mapped_file();
+    else
+        return false;
+}
+
+} // namespace detail
+
 } // ublas
 } // numeric
 } // boost
@@ -24,6 +24,8 @@
 
 #include <boost/numeric/ublas/functional.hpp>
 
+#include "small_vector.hpp"
+
 namespace boost
 {
 namespace numeric
@@ -40,7 +42,8 @@ class basic_extents;
 
 /** @brief Template class for storing tensor strides for iteration with runtime variable size.
  *
- * Proxy template class of std::vector<int_type>.
+ * Proxy template class of small_vector<int_type,N> which stores up to
+ * N = BOOST_UBLAS_TENSOR_INLINE_RANK strides without allocating memory.
  *
  */
 template<class __int_type, class __layout>
@@ -48,7 +51,7 @@ class basic_strides
 {
 public:
 
-    using base_type = std::vector<__int_type>;
+    using base_type = small_vector<__int_type, BOOST_UBLAS_TENSOR_INLINE_RANK>;
 
     static_assert ( std::numeric_limits<typename base_type::value_type>::is_integer,
                     "Static error in boost::numeric::ublas::basic_strides: type must be of type integer." );
@@ -126,6 +129,11 @@ public:
         : _base ( std::move ( l ) )
     {}
 
+    template<class allocator_type>
+    basic_strides ( std::vector<__int_type, allocator_type> const& l )
+        : _base ( l.begin(), l.end() )
+    {}
+
     ~basic_strides() = default;
 
 
@@ -0,0 +1,304 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+/// \file summation.hpp Definition of the summation policies of sum, norm and
+/// inner_prod
+
+#ifndef BOOST_UBLAS_TENSOR_SUMMATION_HPP
+#define BOOST_UBLAS_TENSOR_SUMMATION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+
+#include <boost/numeric/ublas/detail/config.hpp>
+
+#include "parallel.hpp"
+#include "reduction.hpp"
+#include "simd.hpp"
+#include "ublas_type_traits.hpp"
+
+/** @brief Number of elements of a contiguous mode that are summed up in
+ * registers before the partial sums are added pairwise */
+#ifndef BOOST_UBLAS_TENSOR_PAIRWISE_BLOCK
+#define BOOST_UBLAS_TENSOR_PAIRWISE_BLOCK 256u
+#endif
+
+namespace boost::numeric::ublas {
+
+/** @brief Adds up the elements in storage order with several vector
+ * registers
+ *
+ * The rounding error grows linearly with the number of elements. This is the
+ * default policy.
+ */
+struct naive_summation {};
+
+/** @brief Adds up blocks of elements with several vector registers and adds
+ * the sums of the blocks pairwise
+ *
+ * The rounding error grows with the logarithm of the number of elements while
+ * the number of operations is the same as for naive_summation.
+ */
+struct pairwise_summation {};
+
+/** @brief Adds up the elements with Kahan compensation in every lane of the
+ * vector registers
+ *
+ * The rounding error does not depend on the number of elements. Needs four
+ * operations per element instead of one.
+ *
+ * @note the compensation is removed by the compiler if floating-point
+ * operations may be reassociated, e.g. with -ffast-math
+ */
+struct compensated_summation {};
+
+template <class P> struct is_summation_policy : std::false_type {};
+template <> struct is_summation_policy<naive_summation> : std::true_type {};
+template <> struct is_summation_policy<pairwise_summation> : std::true_type {};
+template <> struct is_summation_policy<compensated_summation> : std::true_type {};
+
+template <class P>
+inline constexpr bool is_summation_policy_v = is_summation_policy<P>::value;
+
+namespace detail {
+
+/** @brief Terms f(A[i1,...,ip]) of a sum */
+template <class T, class UnaryOp> struct unary_terms {
+  T const *a;
+  std::size_t const *wa;
+  UnaryOp f;
+
+  std::size_t const *strides() const { return wa; }
+  unary_terms next(std::size_t i, std::size_t k) const {
+    return {a + k * wa[i], wa, f};
+  }
+  bool contiguous(std::size_t i) const { return wa[i] == 1u; }
+  template <class P> P load(std::size_t k) const { return f(P::load(a + k)); }
+  T get(std::size_t i, std::size_t k) const { return f(a[k * wa[i]]); }
+};
+
+/** @brief Terms A[i1,...,ip] * B[i1,...,ip] of a sum */
+template <class T> struct product_terms {
+  T const *a;
+  std::size_t const *wa;
+  T const *b;
+  std::size_t const *wb;
+
+  std::size_t const *strides() const { return wa; }
+  product_terms next(std::size_t i, std::size_t k) const {
+    return {a + k * wa[i], wa, b + k * wb[i], wb};
+  }
+  bool contiguous(std::size_t i) const { return wa[i] == 1u && wb[i] == 1u; }
+  template <class P> P load(std::size_t k) const {
+    return P::load(a + k) * P::load(b + k);
+  }
+  T get(std::size_t i, std::size_t k) const { return a[k * wa[i]] * b[k * wb[i]]; }
+};
+
+/** @brief Adds x to the sum s with the compensation c of the lost low-order
+ * bits, works for elements and registers */
+template <class P> inline void kahan_add(P const &x, P &s, P &c) {
+  auto const y = x - c;
+  auto const t = s + y;
+  c = (t - s) - y;
+  s = t;
+}
+
+/** @brief Sums up the terms k = first,...,last-1 of mode i
+ *
+ * Rows with more than BOOST_UBLAS_TENSOR_PAIRWISE_BLOCK terms are halved
+ * recursively. Shorter contiguous rows are summed up with four registers.
+ */
+template <class T, class Terms>
+T pairwise_row(Terms const &t, std::size_t const i, std::size_t const first,
+               std::size_t const last) {
+  using pack_t = simd::pack<T>;
+  constexpr auto w = pack_t::width;
+  constexpr auto block = std::size_t(BOOST_UBLAS_TENSOR_PAIRWISE_BLOCK);
+
+  auto const n = last - first;
+  if (n > block) {
+    // halves are multiples of four registers so that only the last one has a tail
+    auto const h = std::max((n / 2u) / (4u * w) * (4u * w), std::size_t(1));
+    return pairwise_row<T>(t, i, first, first + h) +
+           pairwise_row<T>(t, i, first + h, last);
+  }
+
+  if (!t.contiguous(i)) {
+    auto s = T{};
+    for (auto k = first; k < last; ++k) s = s + t.get(i, k);
+    return s;
+  }
+
+  auto const u = t.next(i, first);
+  auto s0 = pack_t::zero(), s1 = s0, s2 = s0, s3 = s0;
+  auto k = std::size_t(0);
+  for (; k + 4u * w <= n; k += 4u * w) {
+    s0 = s0 + u.template load<pack_t>(k);
+    s1 = s1 + u.template load<pack_t>(k + w);
+    s2 = s2 + u.template load<pack_t>(k + 2u * w);
+    s3 = s3 + u.template load<pack_t>(k + 3u * w);
+  }
+  for (; k + w <= n; k += w) s0 = s0 + u.template load<pack_t>(k);
+
+  auto s = T(reduce_add((s0 + s1) + (s2 + s3)));
+  for (; k < n; ++k) s = s + u.get(i, k);
+  return s;
+}
+
+/** @brief Sums up the terms of the modes m[r],...,m[q-1] where mode m[r] is
+ * restricted to first,...,last-1, halving the outer modes recursively */
+template <class T, class Terms>
+T pairwise_sum(std::size_t const r, std::size_t const q, std::size_t const *m,
+               std::size_t const *n, Terms const &t, std::size_t const first,
+               std::size_t const last) {
+  auto const i = m[r];
+  if (r + 1u == q) return pairwise_row<T>(t, i, first, last);
+  if (last - first > 1u) {
+    auto const h = first + (last - first) / 2u;
+    return pairwise_sum<T>(r, q, m, n, t, first, h) +
+           pairwise_sum<T>(r, q, m, n, t, h, last);
+  }
+  return pairwise_sum<T>(r + 1u, q, m, n, t.next(i, first), 0u, n[m[r + 1u]]);
+}
+
+/** @brief Adds the terms k = first,...,last-1 of mode i to the compensated
+ * sum (s,c)
+ *
+ * Every lane of the registers holds its own compensated sum. The lanes are
+ * added to (s,c) at the end of the row.
+ */
+template <class T, class Terms>
+void compensated_row(Terms const &t, std::size_t const i,
+                     std::size_t const first, std::size_t const last, T &s,
+                     T &c) {
+  using pack_t = simd::pack<T>;
+  constexpr auto w = pack_t::width;
+
+  auto const n = last - first;
+  if (!t.contiguous(i) || n < 2u * w) {
+    for (auto k = first; k < last; ++k) kahan_add(t.get(i, k), s, c);
+    return;
+  }
+
+  auto const u = t.next(i, first);
+  auto s0 = pack_t::zero(), c0 = s0, s1 = s0, c1 = s0;
+  auto k = std::size_t(0);
+  for (; k + 2u * w <= n; k += 2u * w) {
+    kahan_add(u.template load<pack_t>(k), s0, c0);
+    kahan_add(u.template load<pack_t>(k + w), s1, c1);
+  }
+
+  T ss[2u * w], cc[2u * w];
+  s0.store(ss);
+  s1.store(ss + w);
+  c0.store(cc);
+  c1.store(cc + w);
+  for (auto j = 0u; j < 2u * w; ++j) {
+    kahan_add(ss[j], s, c);
+    kahan_add(-cc[j], s, c);
+  }
+  for (; k < n; ++k) kahan_add(u.get(i, k), s, c);
+}
+
+/** @brief Adds the terms of the modes m[r],...,m[q-1] where mode m[r] is
+ * restricted to first,...,last-1 to the compensated sum (s,c) */
+template <class T, class Terms>
+void compensated_sum(std::size_t const r, std::size_t const q,
+                     std::size_t const *m, std::size_t const *n,
+                     Terms const &t, std::size_t const first,
+                     std::size_t const last, T &s, T &c) {
+  auto const i = m[r];
+  if (r + 1u == q) {
+    compensated_row(t, i, first, last, s, c);
+    return;
+  }
+  for (auto k = first; k < last; ++k)
+    compensated_sum(r + 1u, q, m, n, t.next(i, k), 0u, n[m[r + 1u]], s, c);
+}
+
+/** @brief Sums up all terms of a tensor with pairwise or compensated
+ * summation
+ *
+ * The modes are traversed by decreasing strides of A so that the innermost
+ * mode is the contiguous one. The outermost mode is partitioned across the
+ * threads of an OpenMP team and the partial sums of the threads are added.
+ *
+ * @param policy pairwise_summation or compensated_summation
+ * @param p      rank of the tensors
+ * @param n      pointer to the extents of the tensors
+ * @param t      terms of the sum, e.g. unary_terms or product_terms
+ */
+template <class T, class Policy, class Terms>
+T sum_terms(Policy, std::size_t const p, std::size_t const *n, Terms const &t) {
+  static_assert(std::is_same_v<Policy, pairwise_summation> ||
+                    std::is_same_v<Policy, compensated_summation>,
+                "Static error in boost::numeric::ublas::detail::sum_terms: "
+                "naive summation is implemented by fold and inner.");
+
+  auto const m = modes_by_stride(p, n, t.strides());
+  auto const q = m.size();
+  if (q == 0u) return t.get(0u, 0u);
+
+  auto const o = m[0];
+  auto const work = std::size_t(
+      std::accumulate(n, n + p, std::size_t(1), std::multiplies<>()));
+  return parallel::reduce_range(
+      work, n[o], T{},
+      [&](std::size_t first, std::size_t last, T v) {
+        if constexpr (std::is_same_v<Policy, pairwise_summation>) {
+          return v + pairwise_sum<T>(0u, q, m.data(), n, t, first, last);
+        } else {
+          auto s = T{}, c = T{};
+          compensated_sum(0u, q, m.data(), n, t, first, last, s, c);
+          return v + (s - c);
+        }
+      },
+      std::plus<>());
+}
+
+} // namespace detail
+
+/** @brief Computes the sum of all elements of a tensor with a summation
+ * policy
+ *
+ * @code auto s = sum(a, pairwise_summation{}); @endcode
+ *
+ * @note integer elements are always added up with naive_summation
+ *
+ * @param a      tensor or tensor_view
+ * @param policy naive_summation, pairwise_summation or compensated_summation
+ * @returns zero if a is empty
+ */
+template <class T, class Policy,
+          class = std::enable_if_t<is_tensor_operand_v<T> &&
+                                   is_summation_policy_v<Policy>>>
+BOOST_UBLAS_INLINE auto sum(T const &a, Policy policy) {
+  using value_type = std::remove_const_t<typename T::value_type>;
+  if constexpr (std::is_same_v<Policy, naive_summation> ||
+                std::is_integral_v<value_type>) {
+    return sum(a);
+  } else {
+    if (a.empty()) return value_type{};
+    auto const &ka = detail::kernel_operand(a);
+    return detail::sum_terms<value_type>(
+        policy, ka.rank(), ka.extents().data(),
+        detail::unary_terms<value_type, detail::simd::identity>{
+            ka.data(), ka.strides().data(), {}});
+  }
+}
+
+} // namespace boost::numeric::ublas
+
+#endif
@@ -21,14 +21,19 @@
 #include <initializer_list>
 
 #include "algorithms.hpp"
+#include "allocator.hpp"
 #include "extents.hpp"
 #include "index.hpp"
+#include "static_extents.hpp"
+#include "static_strides.hpp"
+#include "storage_traits.hpp"
 #include "strides.hpp"
 #include "tensor_expression.hpp"
+#include "tensor_view.hpp"
 
 namespace boost::numeric::ublas {
 
-template <class T, class F, class A> class tensor;
+template <class T, class F, class A, class E> class tensor;
 
 template <class T, class F, class A> class matrix;
 
@@ -38,17 +43,24 @@ template <class T, class A> class vector;
  *
  * For a \f$n\f$-dimensional tensor \f$v\f$ and \f$0\leq i < n\f$ every element
  * \f$v_i\f$ is mapped to the \f$i\f$-th element of the container. A storage
- * type \c A can be specified which defaults to \c unbounded_array. Elements are
- * constructed by \c A, which need not initialise their value.
+ * type \c A can be specified which defaults to \c std::vector<T>. Storage
+ * with a \c default_init_allocator does not write the elements for
+ * constructors with the \c uninitialized tag.
  *
  * @tparam T type of the objects stored in the tensor (like int, double,
  * complex,...)
  * @tparam A The type of the storage array of the tensor. Default is \c
- * unbounded_array<T>. \c <bounded_array<T> and \c std::vector<T> can also be
- * used
+ * std::vector<T>. \c std::vector<T,default_init_allocator<std::allocator<T>>>
+ * can also be used
+ * @tparam E The type of the extents. Default is \c shape. With
+ * \c fixed_rank_extents<N> the rank and with \c static_extents<E...> all
+ * extents are known at compile time, the strides are then computed at compile
+ * time and multi-indices are mapped without loops.
+ *
+ * @code tensor<float, first_order, std::vector<float>, static_extents<4,2,3>> A; @endcode
  */
 template <class T, class F = first_order,
-          class A = std::vector<T, std::allocator<T>>>
+          class A = std::vector<T, std::allocator<T>>, class E = shape>
 class tensor {
 
   static_assert(std::is_same<F, first_order>::value ||
@@ -56,7 +68,7 @@ class tensor {
                 "boost::numeric::tensor template class only supports first- or "
                 "last-order storage formats.");
 
-  using self_type = tensor<T, F, A>;
+  using self_type = tensor<T, F, A, E>;
 
 public:
   template <class derived_type>
@@ -84,23 +96,33 @@ public:
   using reverse_iterator = typename array_type::reverse_iterator;
   using const_reverse_iterator = typename array_type::const_reverse_iterator;
 
-  using tensor_temporary_type = self_type;
+  /** @brief Type of results, e.g. of prod, that are written by a kernel
+   *
+   * std::vector storage gets a default_init_allocator so that results are
+   * not zero-filled before they are written. Results have a runtime shape
+   * and convert to self_type.
+   */
+  using tensor_temporary_type =
+      tensor<T, F, detail::uninitialized_array_t<A>>;
   using storage_category = dense_tag;
 
-  using strides_type = basic_strides<std::size_t, layout_type>;
-  using extents_type = shape;
+  using extents_type = E;
+  using strides_type = detail::strides_of_t<extents_type, layout_type>;
 
   using matrix_type = matrix<value_type, layout_type, array_type>;
   using vector_type = vector<value_type, array_type>;
 
   /** @brief Constructs a tensor.
    *
-   * @note the tensor is empty.
+   * @note the tensor is empty unless its extents are static_extents, whose
+   * elements are initialized to 0.
    * @note the tensor needs to reshaped for further use.
    *
    */
   BOOST_UBLAS_INLINE
   constexpr tensor() { // NOLINT(hicpp-use-equals-default,modernize-use-equals-default)
+    if constexpr (is_static_extents_v<extents_type>)
+      data_.resize(extents_.product(), value_type{});
   }
 
   /** @brief Constructs a tensor with an initializer list
@@ -114,7 +136,8 @@ public:
   explicit BOOST_UBLAS_INLINE
   tensor( // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
       std::initializer_list<size_type> l)
-      : extents_{std::move(l)}, strides_{extents_}, data_(extents_.product()) {}
+      : extents_{std::move(l)}, strides_{extents_},
+        data_(extents_.product(), value_type{}) {}
 
   /** @brief Constructs a tensor with a \c shape
    *
@@ -126,6 +149,23 @@ public:
    */
   explicit BOOST_UBLAS_INLINE
   tensor(extents_type const &s) // NOLINT(modernize-pass-by-value)
+      : extents_{s}, strides_{extents_},
+        data_(extents_.product(), value_type{}) {}
+
+  /** @brief Constructs a tensor with a \c shape without assigning values
+   *
+   * The elements are constructed by the allocator of \c A without arguments.
+   * With a \c default_init_allocator, elements of trivial types are not
+   * written and hold indeterminate values until they are assigned.
+   * \c std::allocator zero-initializes them.
+   *
+   * @code tensor<float> A{extents{4,2,3}, uninitialized}; @endcode
+   *
+   * @param s initial tensor dimension extents
+   */
+  BOOST_UBLAS_INLINE
+  tensor(extents_type const &s, // NOLINT(modernize-pass-by-value)
+         uninitialized_t)
       : extents_{s}, strides_{extents_}, data_(extents_.product()) {}
 
   /** @brief Constructs a tensor with a \c shape and initiates it with
@@ -149,6 +189,26 @@ public:
           "specified extents do not match.");
   }
 
+  /** @brief Constructs a tensor with a \c shape and takes over
+   * one-dimensional data
+   *
+   * @code tensor<float> A{extents{4,2,3}, std::move(array) }; @endcode
+   *
+   *  @param s initial tensor dimension extents
+   *  @param a container of \c array_type that is moved according to the
+   * storage layout
+   */
+  BOOST_UBLAS_INLINE
+  tensor(extents_type const &s, // NOLINT(modernize-pass-by-value)
+         array_type &&a)
+      : extents_{s}, strides_{extents_}, data_(std::move(a)) {
+
+    if (extents_.product() != data_.size())
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::tensor: size of provided data and "
+          "specified extents do not match.");
+  }
+
   /** @brief Constructs a tensor using a shape tuple and initiates it with a
    * value.
    *
@@ -249,17 +309,66 @@ public:
    * @param other tensor with a different layout to be copied.
    */
   BOOST_UBLAS_INLINE
-  template <class other_layout>
+  template <class other_layout,
+            class = std::enable_if_t<!std::is_same_v<other_layout, layout_type>>>
   tensor(const tensor<
          value_type, // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
          other_layout> &other)
-      : extents_{other.extents()}, strides_{strides_type{other.extents()}},
+      : extents_{other.extents()}, strides_{extents_},
         data_(extents_.product()) {
 
     copy(this->rank(), extents_.data(), data_.data(), strides_.data(),
          other.data(), other.strides().data());
   }
 
+  /** @brief Constructs a tensor with the elements of a tensor with another
+   * array or extents type
+   *
+   * @code tensor<float> C = prod(A, B, {2}, {1}); @endcode
+   *
+   * @note throws std::length_error if this has static_extents or
+   * fixed_rank_extents that differ from the extents of other.
+   *
+   * @param other tensor with the layout of this tensor, e.g. a result of type
+   * tensor_temporary_type, to be copied.
+   */
+  BOOST_UBLAS_INLINE
+  template <class other_array, class other_extents,
+            class = std::enable_if_t<
+                !std::is_same_v<tensor<value_type, layout_type, other_array,
+                                       other_extents>,
+                                tensor> &&
+                std::is_same_v<typename other_array::value_type, value_type> &&
+                std::is_constructible_v<array_type,
+                                        typename other_array::const_iterator,
+                                        typename other_array::const_iterator> &&
+                std::is_constructible_v<extents_type, other_extents const &>>>
+  tensor( // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+      const tensor<value_type, layout_type, other_array, other_extents> &other)
+      : extents_(other.extents()), strides_{extents_},
+        data_(other.begin(), other.end()) {}
+
+  /** @brief Constructs a tensor with the elements of a tensor view
+   *
+   * @code tensor<float> A = tensor_view<float>(p, shape{4,2,3}, {6,3,1}); @endcode
+   *
+   * @param view tensor view with arbitrary strides to be copied.
+   */
+  BOOST_UBLAS_INLINE
+  template <class U, class other_layout,
+            class = std::enable_if_t<std::is_same_v<std::remove_const_t<U>,
+                                                    value_type>>>
+  tensor( // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+      const tensor_view<U, other_layout> &view)
+      : extents_{view.extents()}, strides_{extents_},
+        data_(extents_.product()) {
+
+    if (!view.empty())
+      detail::copy_strided(this->rank() - 1u, extents_.data(), data_.data(),
+                           strides_.data(), view.data(),
+                           view.strides().data());
+  }
+
   /** @brief Constructs a tensor with an tensor expression
    *
    * @code tensor<float> A = B + 3 * C; @endcode
@@ -332,8 +441,47 @@ public:
     return *this;
   }
 
-  tensor &operator=(tensor other) {
-    swap(*this, other);
+  /** @brief Copies the extents and elements of other
+   *
+   * @note the array is replaced by a copy of the array of other unless
+   * detail::assigns_in_place is true for it, e.g. for mapped_array, whose
+   * elements are written in place.
+   */
+  tensor &operator=(tensor const &other) {
+    if constexpr (detail::assigns_in_place<array_type>::value) {
+      assign(other);
+    } else {
+      auto copy = tensor(other);
+      swap(*this, copy);
+    }
+    return *this;
+  }
+
+  /** @brief Copies the extents and elements of a tensor with another array
+   * or extents type, e.g. a result of type tensor_temporary_type
+   */
+  template <class other_array, class other_extents,
+            class = std::enable_if_t<std::is_constructible_v<
+                tensor, tensor<value_type, layout_type, other_array,
+                               other_extents> const &>>>
+  tensor &operator=(
+      tensor<value_type, layout_type, other_array, other_extents> const &other) {
+    auto copy = tensor(other);
+    swap(*this, copy);
+    return *this;
+  }
+
+  /** @brief Moves the extents and elements of other into this tensor
+   *
+   * @note arrays for which detail::assigns_in_place is true are copied
+   * element by element instead, only swapping the arrays does not throw.
+   */
+  tensor &operator=(tensor &&other) noexcept(
+      !detail::assigns_in_place<array_type>::value) {
+    if constexpr (detail::assigns_in_place<array_type>::value)
+      assign(other);
+    else
+      swap(*this, other);
     return *this;
   }
 
@@ -378,6 +526,17 @@ public:
   BOOST_UBLAS_INLINE
   pointer data() { return data_.data(); }
 
+  /** @brief Returns a \c const reference to the storage array. */
+  BOOST_UBLAS_INLINE
+  array_type const &base() const { return data_; }
+
+  /** @brief Returns a reference to the storage array.
+   *
+   * @note the size of the array must not be changed.
+   */
+  BOOST_UBLAS_INLINE
+  array_type &base() { return data_; }
+
   /** @brief Element access using a single index.
    *
    *  @code auto a = A[i]; @endcode
@@ -461,21 +620,73 @@ public:
    *
    *  @code auto Ai = A(_i,_j,k); @endcode
    *
+   *  @note tensors whose extents are not of type \c shape are copied into a
+   *  tensor with a \c shape, which is contracted instead.
+   *
    *  @param i placeholder
    *  @param is zero-based indices where 0 <= is[r] < this->size(r) where  0 < r
    * < this->rank()
    */
   BOOST_UBLAS_INLINE
   template <std::size_t I, class... index_types>
-  decltype(auto) operator()(index::index_type<I> p, index_types... ps) const {
+  decltype(auto) operator()(index::index_type<I> p, index_types... ps) const & {
     constexpr auto N = sizeof...(ps) + 1;
     if (N != this->rank())
       throw std::runtime_error(
           "Error in boost::numeric::ublas::operator(): size of provided "
           "index_types does not match with the rank.");
 
-    return std::make_pair(std::cref(*this),
-                          std::make_tuple(p, std::forward<index_types>(ps)...));
+    if constexpr (std::is_same_v<extents_type, shape>)
+      return std::make_pair(std::cref(*this),
+                            std::make_tuple(p, std::forward<index_types>(ps)...));
+    else
+      return std::make_pair(tensor<T, F, A>(*this),
+                            std::make_tuple(p, std::forward<index_types>(ps)...));
+  }
+
+  /** @brief Generates a tensor index of a temporary tensor
+   *
+   *  @code auto e = make()(_i,_j) * B(_j,_k); @endcode
+   *
+   *  @note the tensor is moved into the returned pair so that lazy
+   *  contractions own it instead of referencing a destroyed temporary
+   */
+  BOOST_UBLAS_INLINE
+  template <std::size_t I, class... index_types>
+  decltype(auto) operator()(index::index_type<I> p, index_types... ps) && {
+    constexpr auto N = sizeof...(ps) + 1;
+    if (N != this->rank())
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::operator(): size of provided "
+          "index_types does not match with the rank.");
+
+    if constexpr (std::is_same_v<extents_type, shape>)
+      return std::make_pair(std::move(*this),
+                            std::make_tuple(p, std::forward<index_types>(ps)...));
+    else
+      return std::make_pair(tensor<T, F, A>(*this),
+                            std::make_tuple(p, std::forward<index_types>(ps)...));
+  }
+
+  /** @brief Returns a view of a sub-tensor without copying its elements
+   *
+   *  @code auto B = A(range(0,10), range::all(), slice(0,2,64)); @endcode
+   *  @code A(range(0,2), range(1,3)) = C + D; @endcode
+   *
+   *  @param s one ublas::range or ublas::slice per mode
+   */
+  template <class... spans, class = detail::enable_if_tensor_spans_t<spans...>>
+  BOOST_UBLAS_INLINE tensor_view<value_type, layout_type>
+  operator()(spans const &... s) {
+    return detail::make_subtensor<layout_type>(data_.data(), extents_,
+                                               strides_, s...);
+  }
+
+  template <class... spans, class = detail::enable_if_tensor_spans_t<spans...>>
+  BOOST_UBLAS_INLINE tensor_view<value_type const, layout_type>
+  operator()(spans const &... s) const {
+    return detail::make_subtensor<layout_type>(data_.data(), extents_,
+                                               strides_, s...);
   }
 
   /** @brief Reshapes the tensor
@@ -488,12 +699,15 @@ public:
    * default constructed (1) or specified (2) value is appended.
    *
    * @note rank of the tensor might also change.
+   * @note throws std::length_error if the elements are mapped from a file
+   * and e differs from the extents stored in the file.
    *
    * @param e extents with which the tensor is reshaped.
    * @param v value which is appended if the tensor is enlarged.
    */
   BOOST_UBLAS_INLINE
   void reshape(extents_type const &e, value_type v = value_type{}) {
+    check_mapped_extents(e);
     extents_ = e;
     strides_ = strides_type(extents_);
 
@@ -501,6 +715,24 @@ public:
       data_.resize(extents_.product(), v);
   }
 
+private:
+  // copies elements into the array, which throws if it cannot be resized
+  void assign(tensor const &other) {
+    if (this == &other) return;
+    check_mapped_extents(other.extents_);
+    data_ = other.data_;
+    extents_ = other.extents_;
+    strides_ = other.strides_;
+  }
+
+  // the header of a mapped file keeps the extents of its elements
+  void check_mapped_extents(extents_type const &e) const {
+    if (e != extents_ && detail::is_mapped_file(data_))
+      throw std::length_error("Error in boost::numeric::ublas::tensor: "
+                              "extents of a mapped file cannot be changed.");
+  }
+
+public:
   friend void swap(tensor &lhs, tensor &rhs) {
     std::swap(lhs.data_, rhs.data_);
     std::swap(lhs.extents_, rhs.extents_);
@@ -20,7 +20,7 @@
 #include <vector>
 
 namespace boost::numeric::ublas {
-template <class T, class F, class A> class tensor;
+template <class T, class F, class A, class E> class tensor;
 }
 
 /**
@@ -34,7 +34,8 @@ template <class T, class F, class A> class tensor;
       return e;                                                                \
     tensor<new_type, typename Tensor::layout_type,                             \
            typename storage_traits<                                            \
-               typename Tensor::array_type>::template rebind<new_type>>        \
+               typename Tensor::array_type>::template rebind<new_type>,        \
+           typename Tensor::extents_type>                                      \
         result;                                                                \
     result.data_.resize(e.extents().product());                                \
     result.strides_ = e.strides();                                             \
@@ -48,7 +49,8 @@ template <class T, class F, class A> class tensor;
       return std::forward<Tensor>(e);                                                                \
     tensor<new_type, typename Tensor::layout_type,                             \
            typename storage_traits<                                            \
-               typename Tensor::array_type>::template rebind<new_type>>        \
+               typename Tensor::array_type>::template rebind<new_type>,        \
+           typename Tensor::extents_type>                                      \
         result;                                                                \
     result.data_.resize(e.extents().product());                                \
     result.strides_ = std::move(e.strides());                                  \
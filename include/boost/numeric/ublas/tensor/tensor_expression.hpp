@@ -16,7 +16,14 @@
 
 #include <boost/yap/print.hpp>
 #include <boost/yap/yap.hpp>
+#include <algorithm>
+#include <vector>
+#include "algorithms.hpp"
+#include "allocator.hpp"
+#include "expression_aliasing.hpp"
+#include "expression_fusion.hpp"
 #include "expression_optimization.hpp"
+#include "expression_plan.hpp"
 #include "expression_transforms.hpp"
 #include "expression_utils.hpp"
 #include "extents.hpp"
@@ -47,8 +54,13 @@ struct tensor_expression {
    * @param i the Index to evaluate
    *
    * @return the Evaluated Value of the expression at ith index.
+   *
+   * @note The value is returned by copy as terminals of the transformed
+   * expression may hold values, e.g. the element of an einstein_network.
+   * Networks are contracted by the first access only, see
+   * einstein_network::at.
    */
-  BOOST_UBLAS_INLINE decltype(auto) operator()(size_t i) {
+  BOOST_UBLAS_INLINE auto operator()(size_t i) {
     auto nth = ::boost::yap::transform(*this, transforms::at_index{i});
     return ::boost::yap::evaluate(nth);
   }
@@ -61,39 +73,32 @@ struct tensor_expression {
    *
    * @tparam F the storage format to use for resulting tensor.
    *
-   * @tparam A the array type to use for resulting tensor.
+   * @tparam A the array type to use for resulting tensor. The default
+   * std::vector with a default_init_allocator is not zero-filled before the
+   * elements are evaluated into it.
    *
    * @return The tensor which contains the values of evaluated expresssion.
    */
   template <class T = deduced, class F = ::boost::numeric::ublas::first_order,
-            class A = std::vector<T, std::allocator<T>>>
+            class A = std::vector<T, default_init_allocator<std::allocator<T>>>>
   BOOST_UBLAS_INLINE auto eval() {
-    using value_type = std::conditional_t<std::is_same_v<T, deduced>,
-                                          decltype(this->operator()(0)), T>;
-    ::boost::numeric::ublas::tensor<value_type, F, A> result;
-    auto shape_expr = ::boost::yap::transform(*this, transforms::get_extents{});
-    result.extents_ = shape_expr;
-    result.strides_ = basic_strides<std::size_t, F>{shape_expr};
-    result.data_.resize(shape_expr.product());
-
-    // #ifndef BOOST_UBLAS_NO_EXPRESSION_OPTIMIZATION
-
-    //     auto distributive_transform = transforms::apply_distributive_law{};
-    //     auto optimized_expr =
-    //         ::boost::yap::transform(*this, distributive_transform);
-
-    // #pragma omp parallel for
-    //     for (auto i = 0u; i < shape_expr.product(); i++)
-    //       result.data_[i] = distributive_transform.usable ? optimized_expr(i)
-    //                                                       :
-    //                                                       this->operator()(i);
-    // #else
-
-#pragma omp parallel for
-    for (auto i = 0u; i < shape_expr.product(); i++)
-      result.data_[i] = this->operator()(i);
-    // #endif
-    return std::move(result);
+    if constexpr (transforms::has_einstein_network<tensor_expression>::value) {
+      auto expr =
+          ::boost::yap::transform(*this, transforms::materialize_einstein{});
+      return expr.template eval<T, F, A>();
+    } else {
+      using value_type = std::conditional_t<std::is_same_v<T, deduced>,
+                                            decltype(this->operator()(0)), T>;
+      ::boost::numeric::ublas::tensor<value_type, F, A, shape> result;
+      auto extents = transforms::get_extents{};
+      auto shape_expr = ::boost::yap::transform(*this, extents);
+      result.extents_ = shape_expr;
+      result.strides_ = basic_strides<std::size_t, F>{shape_expr};
+      result.data_.resize(shape_expr.product());
+      eval_optimized(result.data_.data(), shape_expr, result.strides_,
+                     extents.broadcasting);
+      return std::move(result);
+    }
   }
   /**
    * @brief Completely evaluates this expression and fills values into target.
@@ -105,34 +110,236 @@ struct tensor_expression {
    * @tparam A the  array type of target tensor (deduced)
    *
    * @param[out] target the resulting tensor.
+   *
+   * @note Lazy products in Einstein notation are contracted before the
+   * elementwise evaluation. A product that is scaled, added to an expression or
+   * passed to ublas::apply is contracted directly into target, see
+   * detail::eval_fused.
+   *
+   * @note Arithmetic expressions of tensors and scalars are lowered once into
+   * an evaluation plan that is run in a flat loop, see detail::make_plan.
+   *
+   * @note Tensors with another layout than F are read at the multi-index of
+   * the element in target.
+   *
+   * @note Operands with the extent one in a mode are broadcast without
+   * copies, see transforms::get_extents.
+   *
+   * @note The expression is optimized once before the evaluation, see
+   * eval_optimized.
+   *
+   * @note The expression is evaluated directly into target if its terminals
+   * read target only at the multi-index that is written, e.g. `A = A*2 + B`.
+   * Otherwise, e.g. if a shifted view of target is read or target is resized,
+   * it is evaluated into a temporary first, see get_expression_aliasing. The
+   * temporary is allocated with aligned_allocator, i.e. it is only reused
+   * from a tensor_arena inside an arena_scope and allocated on the heap
+   * otherwise.
    */
 
-  template <class T, class F, class A>
+  template <class T, class F, class A, class E>
   BOOST_UBLAS_INLINE void eval_to(
-      ::boost::numeric::ublas::tensor<T, F, A> &target) {
-    auto shape_expr = ::boost::yap::transform(*this, transforms::get_extents{});
-    target.data_.resize(shape_expr.product());
-    target.extents_ = shape_expr;
-    target.strides_ =
-        ::boost::numeric::ublas::basic_strides<std::size_t, F>{shape_expr};
-
-    // #ifndef BOOST_UBLAS_NO_EXPRESSION_OPTIMIZATION
-
-    //     auto distributive_transform = transforms::apply_distributive_law{};
-    //     auto optimized_expr =
-    //         ::boost::yap::transform(*this, distributive_transform);
-
-    // #pragma omp parallel for
-    //     for (auto i = 0u; i < shape_expr.product(); i++)
-    //       target.data_[i] = distributive_transform.usable ? optimized_expr(i)
-    //                                                       :
-    //                                                       this->operator()(i);
-    //#else
+      ::boost::numeric::ublas::tensor<T, F, A, E> &target) {
+    if constexpr (transforms::has_einstein_network<tensor_expression>::value) {
+      if (eval_fused(*this, target)) return;
+      auto expr =
+          ::boost::yap::transform(*this, transforms::materialize_einstein{});
+      expr.eval_to(target);
+    } else {
+      auto extents = transforms::get_extents{};
+      auto shape_expr = ::boost::yap::transform(*this, extents);
+      // throws for static_extents that differ from the expression
+      auto target_extents = E(shape_expr);
+      target.check_mapped_extents(target_extents);
+      auto const strides =
+          ::boost::numeric::ublas::basic_strides<std::size_t, F>{shape_expr};
+      if (get_expression_aliasing(*this, target, shape_expr) ==
+          aliasing::unsafe) {
+        using buffer_type =
+            std::vector<T, default_init_allocator<aligned_allocator<T>>>;
+        auto temp = buffer_type(shape_expr.product());
+        eval_optimized(temp.data(), shape_expr, strides, extents.broadcasting);
+        target.data_.resize(temp.size());
+        std::copy(temp.begin(), temp.end(), target.data_.begin());
+      } else {
+        target.data_.resize(shape_expr.product());
+        eval_optimized(target.data_.data(), shape_expr, strides,
+                       extents.broadcasting);
+      }
+      target.strides_ =
+          typename ::boost::numeric::ublas::tensor<T, F, A, E>::strides_type(
+              target_extents);
+      target.extents_ = std::move(target_extents);
+    }
+  }
 
+  /**
+   * @brief Completely evaluates this expression into the elements of a view.
+   *
+   * @tparam T the element type of target view (deduced)
+   *
+   * @tparam F the format-type of target view (deduced)
+   *
+   * @param[out] target the view whose elements are overwritten.
+   *
+   * @note The extents of the expression must be equal to the extents of
+   * target. Views with the strides of a tensor with layout F are written like
+   * a tensor, other views element by element at their multi-index with their
+   * signed strides.
+   *
+   * @note The expression is evaluated into a temporary first if its terminals
+   * read the elements of target at other multi-indices, e.g.
+   * `A(range(0,3)) = A(range(1,4)) + 1`, see get_expression_aliasing. The
+   * temporary is allocated like for eval_to of a tensor.
+   */
+  template <class T, class F>
+  BOOST_UBLAS_INLINE void eval_to(
+      ::boost::numeric::ublas::tensor_view<T, F> &target) {
+    if constexpr (transforms::has_einstein_network<tensor_expression>::value) {
+      auto expr =
+          ::boost::yap::transform(*this, transforms::materialize_einstein{});
+      expr.eval_to(target);
+    } else {
+      auto extents = transforms::get_extents{};
+      auto shape_expr = ::boost::yap::transform(*this, extents);
+      if (shape_expr != target.extents())
+        throw std::runtime_error(
+            "Cannot assign an expression with extents " +
+            shape_expr.to_string() + " to a tensor_view with extents " +
+            target.extents().to_string());
+      auto const strides =
+          ::boost::numeric::ublas::basic_strides<std::size_t, F>{shape_expr};
+      if (get_expression_aliasing(*this, target, shape_expr) ==
+          aliasing::unsafe) {
+        using value_type = std::remove_const_t<T>;
+        using buffer_type = std::vector<
+            value_type, default_init_allocator<aligned_allocator<value_type>>>;
+        auto temp = buffer_type(shape_expr.product());
+        eval_optimized(temp.data(), shape_expr, strides, extents.broadcasting);
+        ::boost::numeric::ublas::detail::copy_strided(
+            target.rank() - 1u, shape_expr.data(), target.data(),
+            target.strides().data(), temp.data(), strides.data());
+        return;
+      }
+      if (target.is_contiguous()) {
+        eval_optimized(target.data(), shape_expr, strides,
+                       extents.broadcasting);
+        return;
+      }
+      auto const size = shape_expr.product();
+      if (extents.broadcasting) {
 #pragma omp parallel for
-    for (auto i = 0u; i < shape_expr.product(); i++)
-      target.data_[i] = this->operator()(i);
-    //#endif
+        for (auto i = 0u; i < size; i++)
+          target(i) = ::boost::yap::evaluate(::boost::yap::transform(
+              *this, transforms::at_broadcast_index{
+                         {i}, shape_expr.size(), shape_expr.data(),
+                         strides.data()}));
+        return;
+      }
+#pragma omp parallel for
+      for (auto i = 0u; i < size; i++)
+        target(i) = ::boost::yap::evaluate(::boost::yap::transform(
+            *this, transforms::at_layout_index<F>{{i}, strides.data()}));
+    }
+  }
+
+  /**
+   * @brief Writes the elements of this expression into an array with the
+   * layout F after optimizing the expression.
+   *
+   * Scalar sub-expressions are computed once, see transforms::fold_scalars.
+   * Operations whose operands refer to the same objects are rewritten by
+   * algebraic simplification, see transforms::simplify_expression. Repeated
+   * sub-expressions are computed once per element, see transforms::visit_plan.
+   *
+   * @note The optimization is disabled with
+   * BOOST_UBLAS_NO_EXPRESSION_OPTIMIZATION.
+   *
+   * @param out pointer to the first element of the array
+   * @param shape the extents of this expression
+   * @param strides the strides of the array in the layout F
+   * @param broadcast true if the extents of the operands differ, see
+   * transforms::get_extents
+   */
+  template <class T, class Extents, class F>
+  BOOST_UBLAS_INLINE void eval_optimized(
+      T *out, Extents const &shape,
+      ::boost::numeric::ublas::basic_strides<std::size_t, F> const &strides,
+      bool broadcast = false) {
+#ifndef BOOST_UBLAS_NO_EXPRESSION_OPTIMIZATION
+    auto const folded = transforms::fold_scalars(*this);
+    auto simplified = transforms::simplify_expression{}(folded);
+    simplified.template eval_elements<true>(out, shape, strides, broadcast);
+#else
+    eval_elements(out, shape, strides, broadcast);
+#endif
+  }
+
+  /**
+   * @brief Writes the elements of this expression into an array with the
+   * layout F.
+   *
+   * Tensor views with the strides of the array are read like tensors. An
+   * expression with other views is evaluated row by row with the signed
+   * strides of every view like an expression with broadcast operands, see
+   * detail::has_target_strides.
+   *
+   * @tparam shared computes repeated sub-expressions once per element, see
+   * transforms::visit_plan
+   *
+   * @param out pointer to the first element of the array
+   * @param shape the extents of this expression
+   * @param strides the strides of the array in the layout F
+   * @param broadcast true if the extents of the operands differ, see
+   * transforms::get_extents
+   */
+  template <bool shared = false, class T, class Extents, class F>
+  BOOST_UBLAS_INLINE void eval_elements(
+      T *out, Extents const &shape,
+      ::boost::numeric::ublas::basic_strides<std::size_t, F> const &strides,
+      bool broadcast = false) {
+    auto const size = shape.product();
+    if constexpr (is_plannable<tensor_expression>())
+      broadcast = broadcast ||
+                  !has_target_strides(*this, shape.size(), strides.data());
+    if (broadcast) {
+      if constexpr (is_plannable<tensor_expression>()) {
+        transforms::visit_plan<F, true, shared>(*this, [&](auto const &plan) {
+          run_plan_broadcast(plan, out, shape.size(), shape.data(),
+                             strides.data());
+        });
+      } else {
+#pragma omp parallel for
+        for (auto i = 0u; i < size; i++)
+          out[i] = ::boost::yap::evaluate(::boost::yap::transform(
+              *this, transforms::at_broadcast_index{
+                         {i}, shape.size(), shape.data(), strides.data()}));
+      }
+      return;
+    }
+    if constexpr (is_plannable<tensor_expression>()) {
+      transforms::visit_plan<F, false, shared>(*this, [&](auto const &plan) {
+        if constexpr (std::decay_t<decltype(plan)>::transposed) {
+          auto const transposed =
+              ::boost::numeric::ublas::basic_strides<std::size_t,
+                                                     transposed_layout_t<F>>{
+                  shape};
+          run_plan_tiled(plan, out, shape.size(), shape.data(),
+                         strides.data(), transposed.data());
+        } else {
+          run_plan(plan, out, size);
+        }
+      });
+    } else if constexpr (transforms::has_transposed_tensor<
+                             F, tensor_expression>::value) {
+#pragma omp parallel for
+      for (auto i = 0u; i < size; i++)
+        out[i] = ::boost::yap::evaluate(::boost::yap::transform(
+            *this, transforms::at_layout_index<F>{{i}, strides.data()}));
+    } else {
+#pragma omp parallel for
+      for (auto i = 0u; i < size; i++) out[i] = this->operator()(i);
+    }
   }
 
   /**
@@ -142,11 +349,22 @@ struct tensor_expression {
    * contain any relational operator. It returns true if tensor on both side are
    * empty.
    *
+   * @note == and != return false and true if both sides have different
+   * extents, even if they could be broadcast like {4,3} and {4,1}; operands
+   * within each side are broadcast. <, <=, > and >= broadcast both sides and
+   * compare the elements at the broadcast multi-index, they only throw if the
+   * extents cannot be broadcast.
+   *
    * @todo(coder3101): Maybe check for relational operator could be made to give
    * static_assert instead of a std::runtime_error.
    */
   BOOST_UBLAS_INLINE
   operator bool() {  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+    if constexpr (transforms::has_einstein_network<tensor_expression>::value) {
+      auto expr =
+          ::boost::yap::transform(*this, transforms::materialize_einstein{});
+      return bool(expr);
+    }
     auto meta_transform = transforms::expr_count_relational_operator{};
 
     std::size_t count = ::boost::yap::transform(*this, meta_transform);
@@ -162,7 +380,37 @@ struct tensor_expression {
       if (!e.status && meta_transform.not_equal_to_found) return true;
     }
 
-    auto shape_expr = ::boost::yap::transform(*this, transforms::get_extents{});
+    auto extents = transforms::get_extents{};
+    auto shape_expr = ::boost::yap::transform(*this, extents);
+    if (extents.broadcasting) {
+      // compares the elements at the multi-index of the broadcast extents
+      auto const strides =
+          ::boost::numeric::ublas::basic_strides<
+              std::size_t, ::boost::numeric::ublas::first_order>{shape_expr};
+      for (auto i = 0u; i < shape_expr.product(); i++)
+        if (!::boost::yap::evaluate(::boost::yap::transform(
+                *this, transforms::at_broadcast_index{{i},
+                                                      shape_expr.size(),
+                                                      shape_expr.data(),
+                                                      strides.data()})))
+          return false;
+      return true;
+    }
+    if constexpr (transforms::has_transposed_tensor<
+                      ::boost::numeric::ublas::first_order,
+                      tensor_expression>::value) {
+      // compares the elements with the same multi-index
+      auto const strides =
+          ::boost::numeric::ublas::basic_strides<
+              std::size_t, ::boost::numeric::ublas::first_order>{shape_expr};
+      for (auto i = 0u; i < shape_expr.product(); i++)
+        if (!::boost::yap::evaluate(::boost::yap::transform(
+                *this, transforms::at_layout_index<
+                           ::boost::numeric::ublas::first_order>{
+                           {i}, strides.data()})))
+          return false;
+      return true;
+    }
     for (auto i = 0u; i < shape_expr.product(); i++)
       if (!(this->operator()(i))) return false;
     return true;
@@ -195,6 +443,16 @@ BOOST_UBLAS_INLINE constexpr decltype(auto) apply(Expr &&e, Callable... c) {
   return detail::apply_impl(std::forward<Expr>(e), c...);
 }
 
+/**
+ * @brief Function objects for `ublas::apply` that are inlined into evaluation
+ * plans, e.g. `tensor<float> b = apply(a + 1.f, elementwise::sqrt);`. They
+ * are evaluated with packed registers if the instruction set supports them.
+ */
+namespace elementwise {
+inline constexpr detail::plan_sqrt sqrt{};
+inline constexpr detail::plan_exp exp{};
+}  // namespace elementwise
+
 }  // namespace boost::numeric::ublas
 
 #endif
@@ -0,0 +1,524 @@
+//  Copyright (c) 2018-2019
+//  Cem Bassoy
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer and Google in producing this work
+//  which started as a Google Summer of Code project.
+//
+
+/// \file tensor_view.hpp Definition for the tensor_view template class
+
+#ifndef BOOST_UBLAS_TENSOR_VIEW_HPP
+#define BOOST_UBLAS_TENSOR_VIEW_HPP
+
+#include <boost/config.hpp>
+#include <boost/yap/yap.hpp>
+
+#include <boost/numeric/ublas/fwd.hpp>
+#include <boost/numeric/ublas/storage.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "algorithms.hpp"
+#include "allocator.hpp"
+#include "extents.hpp"
+#include "small_vector.hpp"
+#include "strides.hpp"
+#include "tensor_expression.hpp"
+#include "ublas_type_traits.hpp"
+
+namespace boost::numeric::ublas {
+
+template <class T, class F, class A, class E> class tensor;
+template <class T, class F> class tensor_view;
+
+namespace detail {
+
+/** @brief True for ublas::basic_range and ublas::basic_slice which select the
+ * elements of one mode of a sub-tensor */
+template <class T> struct is_tensor_span : std::false_type {};
+template <class Z, class D>
+struct is_tensor_span<basic_range<Z, D>> : std::true_type {};
+template <class Z, class D>
+struct is_tensor_span<basic_slice<Z, D>> : std::true_type {};
+
+template <class... spans>
+using enable_if_tensor_spans_t = std::enable_if_t<
+    sizeof...(spans) != 0 && (is_tensor_span<spans>::value && ...)>;
+
+/** @brief Returns the start, the stride and the size of a span within a mode
+ * with extent n, range::all() and slice::all() select the whole mode */
+template <class Z, class D>
+auto span_of(basic_range<Z, D> const &r, std::size_t n) {
+  auto const p = r.preprocess(Z(n));
+  return std::make_tuple(std::size_t(p.start()), std::ptrdiff_t(1),
+                         std::size_t(p.size()));
+}
+template <class Z, class D>
+auto span_of(basic_slice<Z, D> const &s, std::size_t n) {
+  auto const p = s.preprocess(Z(n));
+  return std::make_tuple(std::size_t(p.start()), std::ptrdiff_t(p.stride()),
+                         std::size_t(p.size()));
+}
+
+/** @brief Creates a view of the sub-tensor that is selected by one span per
+ * mode
+ *
+ * The pointer is moved to the first selected element and every stride is
+ * multiplied with the stride of its span. Slices with a negative stride select
+ * the elements of a mode in reverse order. No element is copied.
+ *
+ * @param data pointer to the element with the multi-index (0,...,0)
+ * @param n extents of the tensor or view
+ * @param w strides of the tensor or view
+ * @param s spans, i.e. ranges or slices, one per mode
+ */
+template <class F, class T, class strides_type, class... spans>
+tensor_view<T, F> make_subtensor(T *data, shape const &n,
+                                 strides_type const &w, spans const &... s) {
+  constexpr auto p = sizeof...(spans);
+  if (n.size() != p)
+    throw std::length_error(
+        "Error in boost::numeric::ublas::subtensor: number of ranges or "
+        "slices must be equal to the rank.");
+
+  auto ns = std::array<std::size_t, p>{};
+  auto ws = std::array<std::ptrdiff_t, p>{};
+  auto offset = std::ptrdiff_t{0};
+  auto r = std::size_t{0};
+
+  auto select = [&](auto const &span) {
+    auto const [start, stride, size] = span_of(span, n[r]);
+    auto const last = std::ptrdiff_t(start) + std::ptrdiff_t(size - 1) * stride;
+    if (size == 0u || start >= n[r] || last < 0 ||
+        std::size_t(last) >= n[r])
+      throw std::out_of_range(
+          "Error in boost::numeric::ublas::subtensor: span of mode " +
+          std::to_string(r + 1) + " exceeds the extent " +
+          std::to_string(n[r]) + ".");
+    offset += std::ptrdiff_t(start) * std::ptrdiff_t(w[r]);
+    ns[r] = size;
+    ws[r] = std::ptrdiff_t(w[r]) * stride;
+    ++r;
+  };
+  (select(s), ...);
+
+  return tensor_view<T, F>(data + offset, shape(ns.begin(), ns.end()), ws);
+}
+
+} // namespace detail
+
+/** @brief A non-owning view of a tensor of values of type \c T in external
+ * memory.
+ *
+ * A tensor_view holds a pointer to the element with the multi-index
+ * (0,...,0), the extents and one signed stride per mode, i.e. the elements
+ * need not be contiguous. The element with the multi-index (i1,...,ip) is
+ * stored at data()[i1*w1+...+ip*wp]. A negative stride traverses a mode
+ * backwards, e.g. ublas::reverse returns a view with the negated stride of
+ * one mode and data() moved to the last element of the mode.
+ *
+ * Views take part in tensor expressions, can be assigned a tensor expression
+ * and can be passed to the multiplication kernels and the algorithms. The
+ * kernels add unsigned strides to pointers, they receive views with
+ * non-negative strides without copying and a copy of views with a negative
+ * stride, see detail::kernel_operand.
+ *
+ * Sub-tensors of tensors and views are views, see operator()(spans...).
+ * Like matrix_range, assigning to a view overwrites the viewed elements.
+ *
+ * @code
+ * float* p = ...; // memory of a 4x2x3 tensor in last-order
+ * auto a = tensor_view<float>(p, shape{4,2,3}, {6,3,1});
+ * tensor<float> b = 2*a + 1;
+ * @endcode
+ *
+ * @tparam T type of the elements, const-qualified for read-only views
+ * @tparam F layout in which single indices of the view are interpreted
+ */
+template <class T, class F = first_order> class tensor_view {
+
+  static_assert(std::is_same<F, first_order>::value ||
+                    std::is_same<F, last_order>::value,
+                "boost::numeric::tensor_view template class only supports "
+                "first- or last-order storage formats.");
+
+  using self_type = tensor_view<T, F>;
+
+public:
+  using layout_type = F;
+  using element_type = T;
+  using value_type = std::remove_const_t<T>;
+
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  using reference = T &;
+  using const_reference = value_type const &;
+
+  using pointer = T *;
+  using const_pointer = value_type const *;
+
+  using strides_type = small_vector<difference_type, BOOST_UBLAS_TENSOR_INLINE_RANK>;
+  using extents_type = shape;
+
+  using tensor_temporary_type =
+      tensor<value_type, layout_type,
+             std::vector<value_type,
+                         default_init_allocator<std::allocator<value_type>>>,
+             shape>;
+
+  /** @brief Constructs an empty view */
+  BOOST_UBLAS_INLINE
+  tensor_view() = default;
+
+  /** @brief Constructs a view of contiguous memory in the layout F
+   *
+   * @code auto a = tensor_view<float>(p, shape{4,2,3}); @endcode
+   *
+   * @param data pointer to the first element
+   * @param e extents of the view
+   */
+  BOOST_UBLAS_INLINE
+  tensor_view(pointer data, extents_type const &e)
+      : data_{data}, extents_{e}, strides_{contiguous_strides(extents_)} {}
+
+  /** @brief Constructs a view of memory with arbitrary strides
+   *
+   * @code auto a = tensor_view<float>(p, shape{4,2,3}, {1,4,16}); @endcode
+   *
+   * @param data pointer to the element with the multi-index (0,...,0)
+   * @param e extents of the view
+   * @param w strides of the view, one per mode
+   */
+  BOOST_UBLAS_INLINE
+  tensor_view(pointer data, extents_type const &e,
+              std::initializer_list<difference_type> w)
+      : tensor_view(data, e, w.begin(), w.end()) {}
+
+  /** @brief Constructs a view of memory with arbitrary strides
+   *
+   * @param data pointer to the element with the multi-index (0,...,0)
+   * @param e extents of the view
+   * @param w container with one signed or unsigned stride per mode
+   */
+  template <class strides_container,
+            class = decltype(std::begin(std::declval<strides_container const &>()))>
+  BOOST_UBLAS_INLINE tensor_view(pointer data, extents_type const &e,
+                                 strides_container const &w)
+      : tensor_view(data, e, std::begin(w), std::end(w)) {}
+
+  /** @brief Constructs a view of all elements of a tensor
+   *
+   * @note the view has the strides of the tensor, single indices are
+   * interpreted in the layout F
+   */
+  template <class U, class L, class A, class E,
+            class = std::enable_if_t<std::is_same_v<std::remove_const_t<U>,
+                                                    value_type>>>
+  BOOST_UBLAS_INLINE tensor_view(tensor<U, L, A, E> &t)
+      : data_{t.data()}, extents_{t.extents()},
+        strides_(t.strides().begin(), t.strides().end()) {}
+
+  template <class U, class L, class A, class E,
+            class = std::enable_if_t<std::is_same_v<U, value_type> &&
+                                     std::is_const_v<T>>>
+  BOOST_UBLAS_INLINE tensor_view(tensor<U, L, A, E> const &t)
+      : data_{t.data()}, extents_{t.extents()},
+        strides_(t.strides().begin(), t.strides().end()) {}
+
+  /** @brief Converts a view of mutable elements into a read-only view */
+  template <class U, class = std::enable_if_t<std::is_const_v<T> &&
+                                              std::is_same_v<U, value_type>>>
+  BOOST_UBLAS_INLINE tensor_view(tensor_view<U, F> const &v)
+      : data_{v.data()}, extents_{v.extents()}, strides_{v.strides()} {}
+
+  tensor_view(tensor_view const &) = default;
+  tensor_view(tensor_view &&) noexcept = default;
+
+  /** @brief Copies the elements of another view into the elements of this view
+   *
+   * @code A(range(0,2), range::all()) = B(range(2,4), range::all()); @endcode
+   *
+   * @note the extents of both views must be equal and their elements must not
+   * overlap.
+   */
+  BOOST_UBLAS_INLINE
+  tensor_view &operator=(tensor_view const &other) {
+    return assign(other);
+  }
+
+  BOOST_UBLAS_INLINE
+  template <class U, class L>
+  tensor_view &operator=(tensor_view<U, L> const &other) {
+    return assign(other);
+  }
+
+  /** @brief Copies the elements of a tensor into the elements of this view */
+  BOOST_UBLAS_INLINE
+  template <class U, class L, class A, class E>
+  tensor_view &operator=(tensor<U, L, A, E> const &other) {
+    return assign(other);
+  }
+
+  /** @brief Evaluates the tensor_expression into the elements of the view
+   *
+   * @code a = b + 2*c; @endcode
+   *
+   * @note the extents of the expression must be equal to the extents of the
+   * view, the view is not reshaped.
+   */
+  BOOST_UBLAS_INLINE
+  template <boost::yap::expr_kind Kind, typename Tuple>
+  tensor_view &operator=(detail::tensor_expression<Kind, Tuple> &&expr) {
+    expr.eval_to(*this);
+    return *this;
+  }
+
+  BOOST_UBLAS_INLINE
+  template <boost::yap::expr_kind Kind, typename Tuple>
+  tensor_view &operator=(detail::tensor_expression<Kind, Tuple> &expr) {
+    expr.eval_to(*this);
+    return *this;
+  }
+
+  /** @brief Assigns v to all elements of the view */
+  BOOST_UBLAS_INLINE
+  tensor_view &operator=(const_reference v) {
+    for (auto i = size_type(0); i < size(); ++i)
+      (*this)(i) = v;
+    return *this;
+  }
+
+  /** @brief Returns a view of a sub-tensor without copying its elements
+   *
+   * @code auto b = A(range(0,10), range::all(), slice(0,2,64)); @endcode
+   *
+   * @param s one ublas::range or ublas::slice per mode, slices with a
+   * negative stride select the elements of a mode in reverse order
+   */
+  template <class... spans, class = detail::enable_if_tensor_spans_t<spans...>>
+  BOOST_UBLAS_INLINE tensor_view operator()(spans const &... s) const {
+    return detail::make_subtensor<F>(data_, extents_, strides_, s...);
+  }
+
+  /** @brief Returns true if the view has no elements */
+  BOOST_UBLAS_INLINE
+  bool empty() const { return data_ == nullptr || extents_.empty(); }
+
+  /** @brief Returns the number of elements of the view */
+  BOOST_UBLAS_INLINE
+  size_type size() const { return empty() ? 0u : extents_.product(); }
+
+  /** @brief Returns the extent of the mode r */
+  BOOST_UBLAS_INLINE
+  size_type size(size_type r) const { return extents_.at(r); }
+
+  /** @brief Returns the number of dimensions/modes of the view */
+  BOOST_UBLAS_INLINE
+  size_type rank() const { return extents_.size(); }
+
+  /** @brief Returns the number of dimensions/modes of the view */
+  BOOST_UBLAS_INLINE
+  size_type order() const { return extents_.size(); }
+
+  /** @brief Returns the strides of the view */
+  BOOST_UBLAS_INLINE
+  strides_type const &strides() const { return strides_; }
+
+  /** @brief Returns the stride of the mode r */
+  BOOST_UBLAS_INLINE
+  difference_type stride(size_type r) const { return strides_.at(r); }
+
+  /** @brief Returns the extents of the view */
+  BOOST_UBLAS_INLINE
+  extents_type const &extents() const { return extents_; }
+
+  /** @brief Returns a pointer to the element with the multi-index (0,...,0) */
+  BOOST_UBLAS_INLINE
+  pointer data() const { return data_; }
+
+  /** @brief Returns true if the view has the strides of a tensor with the
+   * layout F */
+  BOOST_UBLAS_INLINE
+  bool is_contiguous() const {
+    return strides_ == contiguous_strides(extents_);
+  }
+
+  /** @brief Element access using a single index.
+   *
+   *  @code auto a = A[i]; @endcode
+   *
+   *  @param i zero-based position of the element in the layout F where
+   *  0 <= i < this->size()
+   */
+  BOOST_UBLAS_INLINE
+  reference operator[](size_type i) const { return data_[offset(i)]; }
+
+  /** @brief Element access using a single index.
+   *
+   *  @code A(i) = a; @endcode
+   *
+   *  @param i zero-based position of the element in the layout F where
+   *  0 <= i < this->size()
+   */
+  BOOST_UBLAS_INLINE
+  reference operator()(size_type i) const { return data_[offset(i)]; }
+
+  /** @brief Element access using a multi-index or single-index.
+   *
+   *  @code auto a = A.at(i,j,k); @endcode or
+   *  @code auto a = A.at(i);     @endcode
+   *
+   *  @param i zero-based index where 0 <= i < this->size() if sizeof...(is) ==
+   * 0, else 0<= i < this->size(0)
+   *  @param is zero-based indices where 0 <= is[r] < this->size(r) where  0 < r
+   * < this->rank()
+   */
+  BOOST_UBLAS_INLINE
+  template <class... size_types>
+  reference at(size_type i, size_types... is) const {
+    if constexpr (sizeof...(is) == 0)
+      return data_[offset(i)];
+    else {
+      auto const j = std::array<size_type, sizeof...(is) + 1>{
+          i, size_type(is)...};
+      auto k = difference_type(0);
+      for (auto r = 0ul; r < j.size(); ++r)
+        k += difference_type(j[r]) * strides_[r];
+      return data_[k];
+    }
+  }
+
+private:
+  template <class other_type> tensor_view &assign(other_type const &other) {
+    if (other.extents() != extents_)
+      throw std::runtime_error(
+          "Error in boost::numeric::ublas::tensor_view: cannot assign "
+          "elements with extents " +
+          other.extents().to_string() + " to a view with extents " +
+          extents_.to_string() + ".");
+    if (!empty())
+      detail::copy_strided(rank() - 1u, extents_.data(), data_,
+                           strides_.data(), other.data(),
+                           other.strides().data());
+    return *this;
+  }
+
+  // strides of a tensor with the extents e and the layout F
+  static strides_type contiguous_strides(extents_type const &e) {
+    auto const w = basic_strides<std::size_t, layout_type>(e);
+    return strides_type(w.begin(), w.end());
+  }
+
+  template <class iterator>
+  tensor_view(pointer data, extents_type const &e, iterator first,
+              iterator last)
+      : data_{data}, extents_{e} {
+    for (; first != last; ++first)
+      strides_.push_back(difference_type(*first));
+    if (strides_.size() != extents_.size())
+      throw std::length_error(
+          "Error in boost::numeric::ublas::tensor_view: number of strides and "
+          "extents do not match.");
+  }
+
+  // relative memory index of the ith element in the layout F
+  difference_type offset(size_type i) const {
+    auto const p = extents_.size();
+    auto j = difference_type(0);
+    for (auto k = 0ul; k < p; ++k) {
+      auto const r = std::is_same_v<F, first_order> ? k : p - 1 - k;
+      j += difference_type(i % extents_[r]) * strides_[r];
+      i /= extents_[r];
+    }
+    return j;
+  }
+
+  pointer data_ = nullptr;
+  extents_type extents_;
+  strides_type strides_;
+};
+
+namespace detail {
+
+/** @brief Read-only operand of the multiplication kernels and the algorithms
+ * for a tensor_view
+ *
+ * The kernels add unsigned strides to pointers. The elements of a view with
+ * non-negative strides are not copied, a view with a negative stride is copied
+ * into a buffer with the strides of a tensor with the layout F.
+ */
+template <class T, class F> class kernel_view {
+public:
+  using layout_type = F;
+  using value_type = std::remove_const_t<T>;
+  using size_type = std::size_t;
+  using extents_type = shape;
+  using strides_type = basic_strides<std::size_t, layout_type>;
+  using tensor_temporary_type =
+      typename tensor_view<T, F>::tensor_temporary_type;
+
+  explicit kernel_view(tensor_view<T, F> const &v)
+      : data_{v.data()}, extents_{&v.extents()} {
+    auto const &w = v.strides();
+    if (std::all_of(w.begin(), w.end(), [](auto s) { return s >= 0; })) {
+      strides_ = strides_type(
+          typename strides_type::base_type(w.begin(), w.end()));
+      return;
+    }
+    strides_ = strides_type(v.extents());
+    buffer_.resize(v.size());
+    if (!v.empty())
+      copy_strided(v.rank() - 1u, v.extents().data(), buffer_.data(),
+                   strides_.data(), v.data(), w.data());
+    data_ = buffer_.data();
+  }
+
+  kernel_view(kernel_view const &) = delete;
+  kernel_view &operator=(kernel_view const &) = delete;
+
+  bool empty() const { return data_ == nullptr || extents_->empty(); }
+  size_type size() const { return empty() ? 0u : extents_->product(); }
+  size_type rank() const { return extents_->size(); }
+  value_type const *data() const { return data_; }
+  extents_type const &extents() const { return *extents_; }
+  strides_type const &strides() const { return strides_; }
+
+private:
+  value_type const *data_;
+  extents_type const *extents_;
+  strides_type strides_;
+  std::vector<value_type> buffer_;
+};
+
+/** @brief Returns a tensor as it is and a tensor_view as a kernel_view whose
+ * data, extents and strides can be passed to the kernels
+ *
+ * @code auto const &ka = detail::kernel_operand(a); @endcode
+ */
+template <class T> BOOST_UBLAS_INLINE decltype(auto) kernel_operand(T const &t) {
+  if constexpr (is_tensor_view_v<T>)
+    return kernel_view<typename T::element_type, typename T::layout_type>(t);
+  else
+    return t;
+}
+
+} // namespace detail
+
+} // namespace boost::numeric::ublas
+
+#endif
@@ -0,0 +1,211 @@
+//
+//  Copyright (c) 2018-2019, Cem Bassoy, cem.bassoy@gmail.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer IOSB, Ettlingen, Germany
+//
+
+
+#ifndef BOOST_UBLAS_TENSOR_TRANSPOSE_HPP
+#define BOOST_UBLAS_TENSOR_TRANSPOSE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "small_vector.hpp"
+
+namespace boost {
+namespace numeric {
+namespace ublas {
+namespace detail {
+namespace blocked {
+
+
+/** @brief Edge length of the square tiles of the blocked transposition
+ *
+ * A tile of the input and a tile of the output of complex double precision
+ * numbers occupy 32 KiB and fit into the L1 cache.
+*/
+constexpr std::size_t transpose_tile_size = 32u;
+
+
+/** @brief Unary operation of the transposition that copies an element */
+struct copy_element
+{
+	template<class T>
+	T const& operator()(T const& t) const { return t; }
+};
+
+
+/** @brief Returns true if a tile can be transposed with simd::block_transpose
+ *
+ * Requires the same floating point type for input and output and an operation that copies elements.
+*/
+template<class PointerOut, class PointerIn, class UnaryOp>
+constexpr bool is_block_transposable()
+{
+	using value_out = std::remove_pointer_t<PointerOut>;
+	using value_in  = std::remove_const_t<std::remove_pointer_t<PointerIn>>;
+	return std::is_same<value_out,value_in>::value && std::is_same<UnaryOp,copy_element>::value &&
+	       simd::block_transpose<value_in>::size > 1u;
+}
+
+
+/** @brief Transposes an m x n tile
+ *
+ * Implements c[i*sci+j*scj] = op(a[i*sai+j*saj]) for 0 <= i < m and 0 <= j < n.
+ * The tile is transposed in square blocks with simd::block_transpose if
+ * the input is contiguous in i and the output is contiguous in j.
+ *
+ * @param m number of rows of the tile
+ * @param n number of columns of the tile
+ * @param c pointer to the first element of the output tile
+ * @param a pointer to the first element of the input tile
+*/
+template<class PointerOut, class PointerIn, class UnaryOp>
+void transpose_tile(std::size_t const m, std::size_t const n,
+                    PointerOut c, std::size_t const sci, std::size_t const scj,
+                    PointerIn  a, std::size_t const sai, std::size_t const saj,
+                    UnaryOp op)
+{
+	auto i0 = 0ul, j0 = 0ul;
+
+	if constexpr(is_block_transposable<PointerOut,PointerIn,UnaryOp>()){
+		using block = simd::block_transpose<std::remove_pointer_t<PointerOut>>;
+		constexpr auto s = block::size;
+		if(sai == 1u && scj == 1u){
+			i0 = m - m % s;
+			j0 = n - n % s;
+			for(auto i = 0ul; i < i0; i += s)
+				for(auto j = 0ul; j < j0; j += s)
+					block::apply(a + i + j*saj, saj, c + i*sci + j, sci);
+		}
+	}
+
+	// remaining columns of the first i0 rows and all columns of the remaining rows
+	for(auto i = 0ul; i < m; ++i)
+		for(auto j = i < i0 ? j0 : 0ul; j < n; ++j)
+			c[i*sci+j*scj] = op(a[i*sai+j*saj]);
+}
+
+
+/** @brief Transposes a tensor in tiles
+ *
+ * Implements C[tau[i1],tau[i2],...,tau[ip]] = op(A[i1,i2,...,ip])
+ *
+ * If the permutation moves the mode with the smallest stride, the modes with the smallest
+ * input and output stride are traversed in tiles that fit into the L1 cache. Otherwise
+ * the elements are copied along the mode with the smallest stride.
+ * Tiles and outer modes are partitioned across the threads of an OpenMP team if
+ * the tensor is large enough, see ublas::set_parallel_threshold.
+ *
+ * @param[in]  p rank of input and output tensor
+ * @param[in] na pointer to the extents of the input tensor a of length p
+ * @param[in] pi pointer to a one-based permutation tuple of length p
+ * @param[out] c pointer to the output tensor
+ * @param[in] wc pointer to the strides of output tensor c
+ * @param[in]  a pointer to the input tensor
+ * @param[in] wa pointer to the strides of input tensor a
+ * @param[in] op unary operation that is applied on every element
+*/
+template<class PointerOut, class PointerIn, class SizeType, class UnaryOp>
+void transpose(SizeType const p, SizeType const*const na, SizeType const*const pi,
+               PointerOut c, SizeType const*const wc,
+               PointerIn  a, SizeType const*const wa,
+               UnaryOp op)
+{
+	using modes = small_vector<std::size_t,BOOST_UBLAS_TENSOR_INLINE_RANK>;
+
+	// modes with an extent greater than one, strides of the output are permuted
+	auto n = modes{}, sa = n, sc = n;
+	for(auto r = SizeType(0); r < p; ++r){
+		if(na[r] < 2u) continue;
+		n .push_back(na[r]);
+		sa.push_back(wa[r]);
+		sc.push_back(wc[pi[r]-1]);
+	}
+
+	auto const q = n.size();
+	if(q == 0u){
+		*c = op(*a);
+		return;
+	}
+
+	auto ia = 0ul, ic = 0ul;
+	for(auto r = 1ul; r < q; ++r){
+		if(sa[r] < sa[ia]) ia = r;
+		if(sc[r] < sc[ic]) ic = r;
+	}
+
+	auto outer = modes{};
+	for(auto r = 0ul; r < q; ++r)
+		if(r != ia && r != ic)
+			outer.push_back(r);
+
+	auto const size = std::accumulate(n.begin(), n.end(), std::size_t(1), std::multiplies<>{});
+
+	// offsets of the kth element of the outer modes
+	auto const offsets = [&outer,&n,&sa,&sc](std::size_t k){
+		auto oa = std::size_t(0), oc = std::size_t(0);
+		for(auto r : outer){
+			oa += (k % n[r]) * sa[r];
+			oc += (k % n[r]) * sc[r];
+			k /= n[r];
+		}
+		return std::make_pair(oa,oc);
+	};
+
+	if(ia == ic){
+		auto const m = n[ia], sai = sa[ia], sci = sc[ia];
+		parallel::for_each_range(size, size/m, [&](std::size_t first, std::size_t last){
+			for(auto k = first; k < last; ++k){
+				auto const o = offsets(k);
+				auto ak = a + o.first;
+				auto ck = c + o.second;
+				if(sai == 1u && sci == 1u)
+					for(auto i = 0ul; i < m; ++i)
+						ck[i] = op(ak[i]);
+				else
+					for(auto i = 0ul; i < m; ++i)
+						ck[i*sci] = op(ak[i*sai]);
+			}
+		});
+		return;
+	}
+
+	constexpr auto b = transpose_tile_size;
+	auto const m = n[ia], l = n[ic];
+	auto const tiles_i = (m + b - 1u) / b;
+	auto const tiles_j = (l + b - 1u) / b;
+	auto const tiles   = tiles_i * tiles_j;
+
+	parallel::for_each_range(size, size/(m*l)*tiles, [&](std::size_t first, std::size_t last){
+		for(auto t = first; t < last; ++t){
+			auto const o  = offsets(t / tiles);
+			auto const i  = (t % tiles_i) * b;
+			auto const j  = (t % tiles / tiles_i) * b;
+			transpose_tile(std::min(b, m-i), std::min(b, l-j),
+			               c + o.second + i*sc[ia] + j*sc[ic], sc[ia], sc[ic],
+			               a + o.first  + i*sa[ia] + j*sa[ic], sa[ia], sa[ic],
+			               op);
+		}
+	});
+}
+
+} // namespace blocked
+} // namespace detail
+} // namespace ublas
+} // namespace numeric
+} // namespace boost
+
+#endif
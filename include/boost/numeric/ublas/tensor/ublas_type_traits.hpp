@@ -21,7 +21,8 @@
 namespace boost::numeric::ublas {
 
 // Forward declare classes
-template <class T, class F, class A> class tensor;
+template <class T, class F, class A, class E> class tensor;
+template <class T, class F> class tensor_view;
 template <class T, class F, class A> class matrix;
 template <class T, class A> class vector;
 template <class derived_type> class matrix_expression;
@@ -37,7 +38,21 @@ template <boost::yap::expr_kind K, typename Tuple> struct tensor_expression;
  * @tparam T the type to check for if its tensor or not.
  */
 template <class T> struct is_tensor { static constexpr bool value = false; };
-template <class T, class F, class A> struct is_tensor<tensor<T, F, A>> {
+template <class T, class F, class A, class E>
+struct is_tensor<tensor<T, F, A, E>> {
+  static constexpr bool value = true;
+};
+
+/**
+ * @brief static constexpr `value` is resolved to true if template type is a
+ * tensor_view.
+ *
+ * @tparam T the type to check for if its tensor_view or not.
+ */
+template <class T> struct is_tensor_view {
+  static constexpr bool value = false;
+};
+template <class T, class F> struct is_tensor_view<tensor_view<T, F>> {
   static constexpr bool value = true;
 };
 
@@ -104,6 +119,32 @@ template <class T> struct is_vector_expression {
  */
 template <class T> constexpr bool is_tensor_v = is_tensor<T>::value;
 
+/**
+ * @brief true is T type is a tensor_view
+ *
+ * @tparam T the type to test
+ */
+template <class T> constexpr bool is_tensor_view_v = is_tensor_view<T>::value;
+
+/**
+ * @brief static constexpr `value` is resolved to true if template type is a
+ * tensor or a tensor_view, i.e. a terminal of a tensor_expression whose
+ * elements are read from memory.
+ *
+ * @tparam T the type to check
+ */
+template <class T> struct is_tensor_operand {
+  static constexpr bool value = is_tensor_v<T> || is_tensor_view_v<T>;
+};
+
+/**
+ * @brief true is T type is a tensor or a tensor_view
+ *
+ * @tparam T the type to test
+ */
+template <class T>
+constexpr bool is_tensor_operand_v = is_tensor_operand<T>::value;
+
 /**
  * @brief true is T type is a matrix
  *
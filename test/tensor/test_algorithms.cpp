@@ -13,6 +13,7 @@
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <numeric>
 #include <boost/numeric/ublas/tensor/algorithms.hpp>
 #include <boost/numeric/ublas/tensor/extents.hpp>
 #include <boost/numeric/ublas/tensor/strides.hpp>
@@ -328,4 +329,73 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_algorithms_trans, value,  test_typ
 }
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_algorithms_trans_blocked, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using vector_type  = std::vector<value_type>;
+	using strides_type = ublas::strides<layout_type>;
+	using extents_type = ublas::shape;
+	using size_type = typename extents_type::value_type;
+	using permutation_type = std::vector<size_type>;
+
+	// extents that are not multiples of the tile and register block sizes
+	auto const extents = std::vector<extents_type>{
+	    extents_type{67,45}, extents_type{33,1,70}, extents_type{9,37,41}, extents_type{5,3,17,34} };
+
+	auto const threshold = ublas::get_parallel_threshold();
+
+	for(auto work : {threshold, size_type(0)}) {
+
+		ublas::set_parallel_threshold(work);
+
+		for(auto const& n : extents) {
+
+			auto const p = n.size();
+			auto const s = n.product();
+
+			auto a  = vector_type(s);
+			init(a);
+			auto const ac = a;
+			auto const wa = strides_type(n);
+
+			auto pi = permutation_type(p);
+			std::iota(pi.begin(), pi.end(), size_type(1));
+
+			do {
+				auto nc = typename extents_type::base_type (p);
+				for(auto i = 0u; i < p; ++i)
+					nc[pi[i]-1] = n[i];
+
+				// strides of the output for the modes of the input
+				auto const wc = strides_type(extents_type(nc));
+				auto wc_pi = typename strides_type::base_type (p);
+				for(auto i = 0u; i < p; ++i)
+					wc_pi[i] = wc[pi[i]-1];
+
+				auto c1 = vector_type(s);
+				auto c2 = vector_type(s);
+
+				ublas::copy ( p, n.data(),            c1.data(), wc_pi.data(), ac.data(), wa.data());
+				ublas::trans( p, n.data(), pi.data(), c2.data(), wc.data(),    ac.data(), wa.data());
+
+				BOOST_CHECK( c1 == c2 );
+
+				// the overload for non-const complex input conjugates
+				if constexpr(std::is_compound_v<value_type>){
+					ublas::trans( p, n.data(), pi.data(), c2.data(), wc.data(), a.data(), wa.data());
+					for(auto& v : c1)
+						v = std::conj(v);
+					BOOST_CHECK( c1 == c2 );
+				}
+			}
+			while(std::next_permutation(pi.begin(), pi.end()));
+		}
+	}
+
+	ublas::set_parallel_threshold(threshold);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -118,5 +118,302 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( test_einstein_multiplication, value,  test_types
 	}
 }
 
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_einstein_network, value,  test_types )
+{
+	using namespace boost::numeric::ublas;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using tensor_type  = tensor<value_type,layout_type>;
+	using namespace boost::numeric::ublas::index;
+
+	auto init = [](tensor_type& t){
+		for(auto i = 0u; i < t.size(); ++i)
+			t[i] = value_type(i%5+1);
+	};
+
+	auto A = tensor_type{3,4};
+	auto B = tensor_type{4,5};
+	auto C = tensor_type{5,6};
+	auto D = tensor_type{6,2};
+	auto E = tensor_type{5,3};
+	init(A); init(B); init(C); init(D); init(E);
+
+	auto const AB   = prod(A,   B, std::vector<std::size_t>{2}, std::vector<std::size_t>{1});
+	auto const ABC  = prod(AB,  C, std::vector<std::size_t>{2}, std::vector<std::size_t>{1});
+	auto const ABCD = prod(ABC, D, std::vector<std::size_t>{2}, std::vector<std::size_t>{1});
+
+	{
+		tensor_type R = A(_i,_j) * B(_j,_k) * C(_k,_l) * D(_l,_m);
+		BOOST_CHECK( R.extents() == ABCD.extents() );
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], ABCD[i] );
+	}
+
+	{
+		tensor_type R = A(_,_j) * B(_j,_k) * C(_k,_);
+		BOOST_CHECK( R.extents() == ABC.extents() );
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], ABC[i] );
+	}
+
+	{
+		tensor_type R = C(_k,_l) * B(_j,_k) * A(_i,_j);
+		BOOST_CHECK( R.extents() == (shape{6,3}) );
+		for(auto j = 0u; j < R.extents().at(1); ++j)
+			for(auto i = 0u; i < R.extents().at(0); ++i)
+				BOOST_CHECK_EQUAL( R.at(i,j), ABC.at(j,i) );
+	}
+
+	{
+		auto F = tensor_type{3,6};
+		init(F);
+		tensor_type R = A(_i,_j) * B(_j,_k) * C(_k,_l) + F;
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], ABC[i] + F[i] );
+	}
+
+	{
+		auto const ABE = prod(AB, E, std::vector<std::size_t>{2,1}, std::vector<std::size_t>{1,2});
+		tensor_type R = A(_i,_j) * B(_j,_k) * E(_k,_i);
+		BOOST_CHECK( R.extents() == (shape{1,1}) );
+		BOOST_CHECK_EQUAL( R[0], ABE[0] );
+	}
+
+	{
+		// temporaries are owned by the lazy contraction
+		auto copy = [](tensor_type const& t){ return tensor_type(t); };
+		auto e = copy(A)(_i,_j) * copy(B)(_j,_k) * C(_k,_l);
+		auto F = tensor_type{3,6};
+		init(F);
+		tensor_type R = e + F;
+		BOOST_CHECK( R.extents() == ABC.extents() );
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], ABC[i] + F[i] );
+
+		auto o = copy(A)(_i,_j) * copy(A)(_k,_l);
+		tensor_type O = o;
+		BOOST_CHECK( O.extents() == A.extents() );
+		for(auto i = 0u; i < O.size(); ++i)
+			BOOST_CHECK_EQUAL( O[i], A[i]*A[i] );
+	}
+
+	BOOST_CHECK_THROW( tensor_type( A(_i,_j) * B(_j,_k) * C(_j,_l) ), std::runtime_error );
+	BOOST_CHECK_THROW( tensor_type( A(_i,_j) * B(_j,_k) * D(_k,_l) ), std::runtime_error );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_einstein_network_cache, value,  test_types )
+{
+	using namespace boost::numeric::ublas;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using tensor_type  = tensor<value_type,layout_type>;
+	using namespace boost::numeric::ublas::index;
+
+	auto init = [](tensor_type& t){
+		for(auto i = 0u; i < t.size(); ++i)
+			t[i] = value_type(i%5+1);
+	};
+
+	auto A = tensor_type{3,4};
+	auto B = tensor_type{4,5};
+	auto C = tensor_type{5,6};
+	init(A); init(B); init(C);
+
+	auto const product = [&]{
+		auto const AB = prod(A, B, std::vector<std::size_t>{2}, std::vector<std::size_t>{1});
+		return prod(AB, C, std::vector<std::size_t>{2}, std::vector<std::size_t>{1});
+	};
+
+	auto e = A(_i,_j) * B(_j,_k) * C(_k,_l);
+	auto const& network = boost::yap::value(e);
+
+	// the contraction order is planned once
+	auto const plan = network.plan();
+	BOOST_CHECK_EQUAL( plan->size(), 2u );
+	tensor_type R = e;
+	tensor_type S = e;
+	BOOST_CHECK( network.plan() == plan );
+	BOOST_CHECK( (bool)(R == product()) );
+	BOOST_CHECK( (bool)(S == product()) );
+
+	// every evaluation reads the current elements of the operands
+	A = tensor_type(A.extents(), value_type{2});
+	A[0] = value_type{10};
+	BOOST_CHECK( (bool)(network.evaluate() == product()) );
+	BOOST_CHECK( network.plan() == plan );
+
+	// and the order is planned again if the extents have changed
+	C = tensor_type{5,2};
+	init(C);
+	BOOST_CHECK( network.evaluate().extents() == (shape{3,2}) );
+	BOOST_CHECK( (bool)(network.evaluate() == product()) );
+	BOOST_CHECK( network.plan() != plan );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_einstein_network_element_access, value,  test_types )
+{
+	using namespace boost::numeric::ublas;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using tensor_type  = tensor<value_type,layout_type>;
+	using namespace boost::numeric::ublas::index;
+
+	auto A = tensor_type{2,2};
+	auto B = tensor_type{2,2};
+	A = tensor_type(A.extents(), value_type{1});
+	B = tensor_type(B.extents(), value_type{1});
+
+	auto e = A(_i,_j) * B(_j,_k);
+	for(auto i = 0u; i < 4u; ++i)
+		BOOST_CHECK_EQUAL( e(i), value_type{2} );
+
+	// element accesses reuse the result of the first access
+	A[0] = value_type{10};
+	for(auto i = 0u; i < 4u; ++i)
+		BOOST_CHECK_EQUAL( e(i), value_type{2} );
+
+	// evaluations contract the operands again
+	tensor_type C = e;
+	BOOST_CHECK_EQUAL( C[0], value_type{11} );
+	BOOST_CHECK_EQUAL( C[3], value_type{2} );
+
+	// the result is contracted again if the extents of an operand change
+	A.reshape(shape{2,1});
+	B.reshape(shape{1,3}, value_type{3});
+	tensor_type D = e;
+	BOOST_REQUIRE( D.extents() == (shape{2,3}) );
+	for(auto i = 0u; i < D.size(); ++i)
+		BOOST_CHECK_EQUAL( e(i), D[i] );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_einstein_static_extents, value,  test_types )
+{
+	using namespace boost::numeric::ublas;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using array_type   = std::vector<value_type>;
+	using tensor_type  = tensor<value_type,layout_type>;
+	using namespace boost::numeric::ublas::index;
+
+	auto A = tensor<value_type,layout_type,array_type,static_extents<3,4>>{};
+	auto B = tensor<value_type,layout_type,array_type,fixed_rank_extents<2>>{fixed_rank_extents<2>{4,5}};
+	for(auto i = 0u; i < A.size(); ++i) A[i] = value_type(i%5+1);
+	for(auto i = 0u; i < B.size(); ++i) B[i] = value_type(i%3+1);
+
+	auto const AB = prod(tensor_type(A), tensor_type(B), std::vector<std::size_t>{2}, std::vector<std::size_t>{1});
+
+	// operands with static extents are contracted as tensors with a shape
+	tensor<value_type,layout_type,array_type,static_extents<3,5>> C = A(_i,_j) * B(_j,_k);
+	tensor_type D = A(_i,_j) * B(_j,_k) * value_type{2};
+	BOOST_CHECK( D.extents() == AB.extents() );
+	for(auto i = 0u; i < AB.size(); ++i){
+		BOOST_CHECK_EQUAL( C[i], AB[i] );
+		BOOST_CHECK_EQUAL( D[i], value_type{2}*AB[i] );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_einstein_network_planner )
+{
+	using namespace boost::numeric::ublas::detail;
+
+	// A(i,j) * B(j,k) * v(k,_)
+	auto s = network_shape{};
+	s.labels  = {{0,1},{1,2},{2,3}};
+	s.extents = {100,100,100,1};
+	s.free    = {true,false,false,true};
+
+	auto const optimal = plan_contraction_optimal(s);
+	auto const greedy  = plan_contraction_greedy(s);
+	auto const source  = std::vector<contraction_step>{{0,1},{3,2}};
+
+	BOOST_REQUIRE_EQUAL( optimal.size(), 2u );
+	BOOST_CHECK_EQUAL( optimal[0].lhs, 1u );
+	BOOST_CHECK_EQUAL( optimal[0].rhs, 2u );
+	BOOST_CHECK_EQUAL( contraction_cost(s,optimal), 2e4 );
+	BOOST_CHECK_LE( contraction_cost(s,optimal), contraction_cost(s,greedy) );
+	BOOST_CHECK_EQUAL( contraction_cost(s,source), 1e6 + 1e4 );
+
+	// ring of n operands with alternating extents
+	for(auto n : {4u, 8u, 12u, 16u}){
+		auto r = network_shape{};
+		for(auto i = 0u; i < n; ++i){
+			r.labels.push_back({i, (i+1)%n});
+			r.extents.push_back(i%2 ? 2u : 9u);
+			r.free.push_back(false);
+		}
+		auto const plan = plan_contraction(r);
+		BOOST_CHECK_EQUAL( plan.size(), n-1 );
+		if(n <= einstein_optimal_max_operands)
+			BOOST_CHECK_LE( contraction_cost(r,plan), contraction_cost(r,plan_contraction_greedy(r)) );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_einstein_network_fused, value,  test_types )
+{
+	using namespace boost::numeric::ublas;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using tensor_type  = tensor<value_type,layout_type>;
+	using namespace boost::numeric::ublas::index;
+
+	auto init = [](tensor_type& t){
+		for(auto i = 0u; i < t.size(); ++i)
+			t[i] = value_type(i%5+1);
+	};
+
+	auto A = tensor_type{3,4};
+	auto B = tensor_type{4,5};
+	auto C = tensor_type{3,5};
+	init(A); init(B); init(C);
+
+	auto const AB = prod(A, B, std::vector<std::size_t>{2}, std::vector<std::size_t>{1});
+	auto const two = value_type(2), three = value_type(3);
+
+	{
+		tensor_type R = two * (A(_i,_j) * B(_j,_k)) + C;
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], two*AB[i] + C[i] );
+	}
+
+	{
+		tensor_type R = C - A(_i,_j) * B(_j,_k);
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], C[i] - AB[i] );
+	}
+
+	{
+		tensor_type R = -(A(_i,_j) * B(_j,_k));
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], -AB[i] );
+	}
+
+	{
+		auto R = C;
+		R = A(_i,_j) * B(_j,_k) * three + R * two;
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], three*AB[i] + two*C[i] );
+	}
+
+	{
+		tensor_type R = boost::numeric::ublas::apply( A(_i,_j) * B(_j,_k) + C, [](auto const& x){ return x+x; } );
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], two*(AB[i] + C[i]) );
+	}
+
+	{
+		// operands that alias the target are not fused
+		auto R = tensor_type{3,4};
+		init(R);
+		R = R(_i,_j) * B(_j,_k) + C;
+		for(auto i = 0u; i < R.size(); ++i)
+			BOOST_CHECK_EQUAL( R[i], AB[i] + C[i] );
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -111,7 +111,14 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_binary_arithmetic_operations, valu
 
 	// BOOST_CHECK_NO_THROW ( tensor_type t = tensor_type(extents.at(0)) + tensor_type(extents.at(0))  );
 	BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents.at(0)) + tensor_type(extents.at(2)), std::runtime_error  );
-	BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents.at(1)) + tensor_type(extents.at(2)), std::runtime_error  );
+	BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents_type{2,3}) + tensor_type(extents_type{4,2,3}), std::runtime_error  );
+	BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents_type{2,1}) + tensor_type(extents_type{4,2,3}), std::runtime_error  );
+
+	// operands with the extent one in a mode are broadcast
+	tensor_type t = tensor_type(extents_type{1,1}, value_type{2}) + tensor_type(extents_type{4,2,3}, value_type{1});
+	BOOST_CHECK( t.extents() == (extents_type{4,2,3}) );
+	for(auto i = 0ul; i < t.size(); ++i)
+		BOOST_CHECK_EQUAL ( t(i), 3 );
 
 
 }
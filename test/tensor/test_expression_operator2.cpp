@@ -100,9 +100,10 @@ BOOST_AUTO_TEST_SUITE(test_expression_operator2, * boost::unit_test::depends_on(
 
         // BOOST_CHECK_NO_THROW ( tensor_type t = tensor_type(extents.at(0)) + 2 + tensor_type(extents.at(0))  );
         BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents.at(0)) + 2 + tensor_type(extents.at(2)), std::runtime_error  );
-        BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents.at(1)) + 2 + tensor_type(extents.at(2)), std::runtime_error  );
-        BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents.at(2)) + 2 + tensor_type(extents.at(2)) + tensor_type(extents.at(1)), std::runtime_error  );
-        BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents.at(2)) + 2 + tensor_type(extents.at(2)) + 2 + tensor_type(extents.at(1)), std::runtime_error  );
+        BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents_type{2,3}) + 2 + tensor_type(extents_type{4,2,3}), std::runtime_error  );
+        BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents_type{4,2,3}) + 2 + tensor_type(extents_type{4,2,3}) + tensor_type(extents_type{2,3}), std::runtime_error  );
+        BOOST_CHECK_THROW    ( tensor_type t = tensor_type(extents_type{4,2,3}) + 2 + tensor_type(extents_type{4,2,3}) + 2 + tensor_type(extents_type{2,3}), std::runtime_error  );
+        BOOST_CHECK_NO_THROW ( tensor_type t = tensor_type(extents_type{1,2}) + 2 + tensor_type(extents_type{1,2}) + tensor_type(extents_type{1,1}) );
     }
 
 
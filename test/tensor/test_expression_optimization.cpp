@@ -18,6 +18,7 @@
 #include "utility.hpp"
 
 #include <functional>
+#include <utility>
 
 using test_types = zip<int, long, float, double, std::complex<float>>::with_t<
         boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
@@ -48,9 +49,60 @@ struct fixture {
 template <boost::yap::expr_kind A, typename B>
 using expr_t = typename boost::numeric::ublas::detail::tensor_expression<A, B>;
 
+// number of operations per element of the alternatives that are selected
+// by the if_else nodes of a simplified expression
+template <class Expr> std::size_t selected_operations(Expr const &expr) {
+    using namespace boost::hana::literals;
+    using boost::yap::expr_kind;
+    constexpr auto kind = Expr::kind;
+    if constexpr (kind == expr_kind::if_else) {
+        if (boost::yap::value(boost::yap::get(expr, 0_c)))
+            return selected_operations(boost::yap::get(expr, 1_c));
+        else
+            return selected_operations(boost::yap::get(expr, 2_c));
+    } else if constexpr (kind == expr_kind::plus || kind == expr_kind::minus ||
+                         kind == expr_kind::multiplies ||
+                         kind == expr_kind::divides) {
+        return 1u + selected_operations(boost::yap::left(expr)) +
+               selected_operations(boost::yap::right(expr));
+    } else if constexpr (kind == expr_kind::call) {
+        return 1u + selected_operations(boost::yap::get(expr, 1_c));
+    } else if constexpr (kind == expr_kind::negate) {
+        return 1u + selected_operations(boost::yap::get(expr, 0_c));
+    } else {
+        return 0u;
+    }
+}
+
+// evaluates a simplified expression with an evaluation plan and element by
+// element with YAP and checks both against the original expression
+template <class tensor_type, class Expr, class Simplified>
+void check_simplified(Expr &expr, Simplified &simplified) {
+    using namespace boost::numeric;
+    tensor_type k = expr;
+    auto t = tensor_type(k.extents());
+    simplified.eval_elements(t.data(), t.extents(), t.strides());
+    BOOST_CHECK((bool)(t == k));
+    for (auto i = 0u; i < k.size(); ++i)
+        BOOST_CHECK_EQUAL(boost::yap::evaluate(boost::yap::transform(
+                              simplified, ublas::detail::transforms::at_index{i})),
+                          k[i]);
+}
+
+// number of operations per element of the evaluation plan in which repeated
+// sub-expressions are computed once
+template <class layout_type, class Expr>
+std::size_t shared_operations(Expr const &expr) {
+    auto n = std::size_t{0};
+    boost::numeric::ublas::detail::transforms::visit_plan<layout_type, false, true>(
+        expr, [&n](auto const &plan) { n = std::decay_t<decltype(plan)>::operations; });
+    return n;
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(test_tensor_expression_optimizer_distributive, value,
                                  test_types, fixture) {
     using namespace boost::numeric;
+    using boost::numeric::ublas::detail::transforms::simplify_expression;
     using value_type = typename value::first_type;
     using layout_type = typename value::second_type;
     using tensor_type = ublas::tensor<value_type, layout_type>;
@@ -79,101 +131,234 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(test_tensor_expression_optimizer_distributive,
         auto expr7 = a * b - a * c;
         auto expr8 = a * c - b * c;
 
-        auto optimizer1 = boost::numeric::ublas::detail::transforms::apply_distributive_law{};
-        auto optimizer2 = boost::numeric::ublas::detail::transforms::apply_distributive_law{};
-        auto optimizer3 = boost::numeric::ublas::detail::transforms::apply_distributive_law{};
-        auto optimizer4 = boost::numeric::ublas::detail::transforms::apply_distributive_law{};
-        auto optimizer5 = boost::numeric::ublas::detail::transforms::apply_distributive_law{};
-        auto optimizer6 = boost::numeric::ublas::detail::transforms::apply_distributive_law{};
-        auto optimizer7 = boost::numeric::ublas::detail::transforms::apply_distributive_law{};
-        auto optimizer8 = boost::numeric::ublas::detail::transforms::apply_distributive_law{};
-
-        BOOST_CHECK(!optimizer1.usable);
-        BOOST_CHECK(!optimizer2.usable);
-        BOOST_CHECK(!optimizer3.usable);
-        BOOST_CHECK(!optimizer4.usable);
-        BOOST_CHECK(!optimizer5.usable);
-        BOOST_CHECK(!optimizer6.usable);
-        BOOST_CHECK(!optimizer7.usable);
-        BOOST_CHECK(!optimizer8.usable);
-
-        auto optimized1 = boost::yap::transform(expr1, optimizer1);
-        auto optimized2 = boost::yap::transform(expr2, optimizer2);
-        auto optimized3 = boost::yap::transform(expr3, optimizer3);
-        auto optimized4 = boost::yap::transform(expr4, optimizer4);
-        auto optimized5 = boost::yap::transform(expr5, optimizer5);
-        auto optimized6 = boost::yap::transform(expr6, optimizer6);
-        auto optimized7 = boost::yap::transform(expr7, optimizer7);
-        auto optimized8 = boost::yap::transform(expr8, optimizer8);
-
-
-        BOOST_CHECK(optimizer1.usable);
-        BOOST_CHECK(optimizer2.usable);
-        BOOST_CHECK(optimizer3.usable);
-        BOOST_CHECK(optimizer4.usable);
-        BOOST_CHECK(optimizer5.usable);
-        BOOST_CHECK(optimizer6.usable);
-        BOOST_CHECK(optimizer7.usable);
-        BOOST_CHECK(optimizer8.usable);
-
-
-        tensor_type t1 = optimized1;
-        tensor_type k1 = expr1;
-
-
-        tensor_type t2 = optimized2;
-        tensor_type k2 = expr2;
-
-
-        tensor_type t3 = optimized3;
-        tensor_type k3 = expr3;
-
-
-        tensor_type t4 = optimized4;
-        tensor_type k4 = expr4;
-
-
-        tensor_type t5 = optimized5;
-        tensor_type k5 = expr5;
-
+        auto const simplify = simplify_expression{};
+        auto optimized1 = simplify(expr1);
+        auto optimized2 = simplify(expr2);
+        auto optimized3 = simplify(expr3);
+        auto optimized4 = simplify(expr4);
+        auto optimized5 = simplify(expr5);
+        auto optimized6 = simplify(expr6);
+        auto optimized7 = simplify(expr7);
+        auto optimized8 = simplify(expr8);
+
+        // the common factor is taken out of both products
+        BOOST_CHECK_EQUAL(selected_operations(optimized1), 2u);
+        BOOST_CHECK_EQUAL(selected_operations(optimized2), 2u);
+        BOOST_CHECK_EQUAL(selected_operations(optimized3), 2u);
+        BOOST_CHECK_EQUAL(selected_operations(optimized4), 2u);
+        BOOST_CHECK_EQUAL(selected_operations(optimized5), 2u);
+        BOOST_CHECK_EQUAL(selected_operations(optimized6), 2u);
+        BOOST_CHECK_EQUAL(selected_operations(optimized7), 2u);
+        BOOST_CHECK_EQUAL(selected_operations(optimized8), 2u);
+
+        static_assert(ublas::detail::is_plannable<decltype(optimized1)>());
+        check_simplified<tensor_type>(expr1, optimized1);
+        check_simplified<tensor_type>(expr2, optimized2);
+        check_simplified<tensor_type>(expr3, optimized3);
+        check_simplified<tensor_type>(expr4, optimized4);
+        check_simplified<tensor_type>(expr5, optimized5);
+        check_simplified<tensor_type>(expr6, optimized6);
+        check_simplified<tensor_type>(expr7, optimized7);
+        check_simplified<tensor_type>(expr8, optimized8);
+
+        // the first alternative of a*b+a*c is a*(b+c)
+        using term_t = expr_t<boost::yap::expr_kind::terminal, boost::hana::tuple<tensor_type &>>;
+        using inner_add_op_t = expr_t<boost::yap::expr_kind::plus, boost::hana::tuple<term_t, term_t>>;
+        using optimized_plus_t = expr_t<boost::yap::expr_kind::multiplies, boost::hana::tuple<term_t, inner_add_op_t>>;
+        static_assert(std::is_same_v<std::remove_cv_t<std::remove_reference_t<decltype(
+                          boost::yap::get(optimized3, boost::hana::llong_c<1>))>>,
+                      optimized_plus_t>);
+        BOOST_CHECK(boost::yap::value(boost::yap::get(optimized3, boost::hana::llong_c<0>)));
 
-        tensor_type t6 = optimized6;
-        tensor_type k6 = expr6;
+    }
+}
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(test_tensor_expression_optimizer_pipeline, value,
+                                 test_types, fixture) {
+    using namespace boost::numeric;
+    using namespace boost::numeric::ublas::detail::transforms;
+    using value_type = typename value::first_type;
+    using layout_type = typename value::second_type;
+    using tensor_type = ublas::tensor<value_type, layout_type>;
+    using namespace boost::hana::literals;
 
-        tensor_type t7 = optimized7;
-        tensor_type k7 = expr7;
+    for (auto const &e : extents) {
 
+        auto a = tensor_type(e);
+        auto b = tensor_type(e);
+        auto c = tensor_type(e);
+        for (auto i = 0u; i < a.size(); ++i) {
+            a[i] = value_type(i + 1);
+            b[i] = value_type(2 * i + 3);
+            c[i] = value_type(7 - int(i));
+        }
 
-        tensor_type t8 = optimized8;
-        tensor_type k8 = expr8;
+        // scalar sub-expressions are computed once
+        auto two = boost::yap::make_terminal<ublas::detail::tensor_expression>(value_type{2});
+        auto expr1 = a * (two * value_type{3}) + b;
+        auto folded1 = fold_scalars(expr1);
+        static_assert(count_operations<decltype(expr1)>() == 3u);
+        static_assert(count_operations<decltype(folded1)>() == 2u);
+        tensor_type t1 = expr1;
+        for (auto i = 0u; i < a.size(); ++i)
+            BOOST_CHECK_EQUAL(t1[i], a[i] * value_type{6} + b[i]);
+
+        // operations whose operands refer to the same objects are simplified
+        auto expr2 = (a + b) + (a + b);
+        auto expr3 = (a - c) * (a - c);
+        auto expr4 = a * b + c * a;
+        auto expr5 = a * c - b * c;
+
+        auto const simplify = simplify_expression{};
+        auto simplified2 = simplify(expr2);
+        auto simplified3 = simplify(expr3);
+        auto simplified4 = simplify(expr4);
+        auto simplified5 = simplify(expr5);
+
+        BOOST_CHECK(boost::yap::value(boost::yap::get(simplified2, 0_c)));
+        BOOST_CHECK(boost::yap::value(boost::yap::get(simplified3, 0_c)));
+        BOOST_CHECK_EQUAL(selected_operations(simplified4), 2u);
+        BOOST_CHECK_EQUAL(selected_operations(simplified5), 2u);
+        static_assert(count_operations<decltype(expr2)>() == 3u);
+        static_assert(count_operations<decltype(simplified2)>() == 2u);
+        static_assert(count_operations<decltype(expr3)>() == 3u);
+        static_assert(count_operations<decltype(simplified3)>() == 2u);
+        static_assert(count_operations<decltype(expr4)>() == 3u);
+        static_assert(count_operations<decltype(simplified4)>() == 2u);
+        static_assert(count_operations<decltype(simplified5)>() == 2u);
+        check_simplified<tensor_type>(expr2, simplified2);
+        check_simplified<tensor_type>(expr3, simplified3);
+
+        tensor_type t2 = expr2;
+        tensor_type t3 = expr3;
+        tensor_type t4 = expr4;
+        tensor_type t5 = expr5;
+        for (auto i = 0u; i < a.size(); ++i) {
+            BOOST_CHECK_EQUAL(t2[i], (a[i] + b[i]) + (a[i] + b[i]));
+            BOOST_CHECK_EQUAL(t3[i], (a[i] - c[i]) * (a[i] - c[i]));
+            BOOST_CHECK_EQUAL(t4[i], a[i] * b[i] + c[i] * a[i]);
+            BOOST_CHECK_EQUAL(t5[i], a[i] * c[i] - b[i] * c[i]);
+        }
 
-        BOOST_CHECK((bool)(t1 == k1));
-        BOOST_CHECK((bool)(t2 == k2));
-        BOOST_CHECK((bool)(t3 == k3));
-        BOOST_CHECK((bool)(t4 == k4));
-        BOOST_CHECK((bool)(t5 == k5));
-        BOOST_CHECK((bool)(t6 == k6));
-        BOOST_CHECK((bool)(t7 == k7));
-        BOOST_CHECK((bool)(t8 == k8));
+        // operations whose operands differ fall back to the original
+        // operation without preventing other simplifications
+        auto expr6 = (a + b) + (a + c);
+        auto expr7 = a * b + c * c;
+        auto expr8 = ((a + b) + (a + c)) * ((a + b) + (a + c));
+        auto simplified6 = simplify(expr6);
+        auto simplified7 = simplify(expr7);
+        auto simplified8 = simplify(expr8);
+        BOOST_CHECK(!boost::yap::value(boost::yap::get(simplified6, 0_c)));
+        BOOST_CHECK_EQUAL(selected_operations(simplified6), 3u);
+        BOOST_CHECK_EQUAL(selected_operations(simplified7), 3u);
+        BOOST_CHECK_EQUAL(selected_operations(simplified8), 4u);
+        check_simplified<tensor_type>(expr6, simplified6);
+        check_simplified<tensor_type>(expr7, simplified7);
+        check_simplified<tensor_type>(expr8, simplified8);
+
+        // the second alternative is the original operation, so that nested
+        // rewrites are not copied into both alternatives
+        static_assert(std::is_same_v<std::remove_cv_t<std::remove_reference_t<decltype(
+                          boost::yap::get(simplified8, 2_c))>>, decltype(expr8)>);
+        static_assert(count_rewrites<decltype(simplified8)>() == 2u);
+
+        // at most max_rewrites operations are rewritten
+        auto q = (a + b) * (a + b);
+        auto expr10 = q - (q - (q - (q - (q - (q - (q - (q - (q - q))))))));
+        auto simplified10 = simplify(expr10);
+        static_assert(count_rewrites<decltype(simplified10)>() ==
+                      simplify_expression::max_rewrites);
+        check_simplified<tensor_type>(expr10, simplified10);
+
+        // tensors are referenced instead of copied
+        auto expr9 = boost::yap::make_terminal<ublas::detail::tensor_expression>(tensor_type(a)) + b;
+        auto simplified9 = simplify(fold_scalars(expr9));
+        BOOST_CHECK_EQUAL(boost::yap::value(boost::yap::left(simplified9)).data(),
+                          boost::yap::value(boost::yap::left(expr9)).data());
+
+        tensor_type t6 = expr6;
+        tensor_type t7 = expr7;
+        for (auto i = 0u; i < a.size(); ++i) {
+            BOOST_CHECK_EQUAL(t6[i], (a[i] + b[i]) + (a[i] + c[i]));
+            BOOST_CHECK_EQUAL(t7[i], a[i] * b[i] + c[i] * c[i]);
+        }
+    }
+}
 
-        using term_t = expr_t<boost::yap::expr_kind::terminal, boost::hana::tuple<tensor_type &>>;
-        using inner_add_op_t = expr_t<boost::yap::expr_kind::plus, boost::hana::tuple<term_t, term_t>>;
-        using inner_sub_op_t = expr_t<boost::yap::expr_kind::minus, boost::hana::tuple<term_t, term_t>>;
-        using optimized_plus_t = expr_t<boost::yap::expr_kind::multiplies, boost::hana::tuple<term_t, inner_add_op_t>>;
-        using optimized_minus_t = expr_t<boost::yap::expr_kind::multiplies, boost::hana::tuple<term_t, inner_sub_op_t>>;
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(test_tensor_expression_optimizer_shared, value,
+                                 test_types, fixture) {
+    using namespace boost::numeric;
+    using namespace boost::numeric::ublas::detail::transforms;
+    using value_type = typename value::first_type;
+    using layout_type = typename value::second_type;
+    using tensor_type = ublas::tensor<value_type, layout_type>;
 
-        static_assert(std::is_same_v<std::remove_reference_t<decltype(optimized1)>, optimized_plus_t>);
-        static_assert(std::is_same_v<std::remove_reference_t<decltype(optimized2)>, optimized_plus_t>);
-        static_assert(std::is_same_v<std::remove_reference_t<decltype(optimized3)>, optimized_plus_t>);
-        static_assert(std::is_same_v<std::remove_reference_t<decltype(optimized4)>, optimized_plus_t>);
+    for (auto const &e : extents) {
 
-        static_assert(std::is_same_v<std::remove_reference_t<decltype(optimized5)>, optimized_minus_t>);
-        static_assert(std::is_same_v<std::remove_reference_t<decltype(optimized6)>, optimized_minus_t>);
-        static_assert(std::is_same_v<std::remove_reference_t<decltype(optimized7)>, optimized_minus_t>);
-        static_assert(std::is_same_v<std::remove_reference_t<decltype(optimized8)>, optimized_minus_t>);
+        auto a = tensor_type(e);
+        auto b = tensor_type(e);
+        auto c = tensor_type(e);
+        for (auto i = 0u; i < a.size(); ++i) {
+            a[i] = value_type(i + 1);
+            b[i] = value_type(2 * i + 3);
+            c[i] = value_type(7 - int(i));
+        }
 
+        // a sub-expression that occurs several times is computed once
+        auto expr1 = (a + b) * c - (a + b);
+        static_assert(count_operations<decltype(expr1)>() == 4u);
+        BOOST_CHECK_EQUAL(shared_operations<layout_type>(expr1), 3u);
+
+        // the largest repeated sub-expression is shared first, a+b is then
+        // only computed within (a+b)*c
+        auto expr2 = ((a + b) * c - b) + ((a + b) * c + c);
+        static_assert(count_operations<decltype(expr2)>() == 7u);
+        BOOST_CHECK_EQUAL(shared_operations<layout_type>(expr2), 5u);
+
+        // several sub-expressions are shared
+        auto expr3 = (a + b) * (a - c) + (a + b) * b - (a - c);
+        static_assert(count_operations<decltype(expr3)>() == 8u);
+        BOOST_CHECK_EQUAL(shared_operations<layout_type>(expr3), 6u);
+
+        // sub-expressions of the same type that refer to other objects are
+        // computed separately
+        auto expr4 = (a + b) * c - (a + c);
+        BOOST_CHECK_EQUAL(shared_operations<layout_type>(expr4), 4u);
+
+        // the shared sub-expression of the simplified alternative
+        auto expr5 = (a - b) * (a - b) + (a - b) * c;
+        auto simplified5 = simplify_expression{}(fold_scalars(expr5));
+        static_assert(count_operations<decltype(simplified5)>() == 4u);
+        BOOST_CHECK_EQUAL(shared_operations<layout_type>(simplified5), 3u);
+
+        auto const check = [&](auto &expr, auto const &f) {
+            auto t = tensor_type(e);
+            expr.template eval_elements<true>(t.data(), t.extents(), t.strides());
+            tensor_type u = expr;
+            for (auto i = 0u; i < t.size(); ++i) {
+                BOOST_CHECK_EQUAL(t[i], f(i));
+                BOOST_CHECK_EQUAL(u[i], f(i));
+            }
+        };
+        check(expr1, [&](auto i) { return (a[i] + b[i]) * c[i] - (a[i] + b[i]); });
+        check(expr2, [&](auto i) {
+            return ((a[i] + b[i]) * c[i] - b[i]) + ((a[i] + b[i]) * c[i] + c[i]);
+        });
+        check(expr3, [&](auto i) {
+            return (a[i] + b[i]) * (a[i] - c[i]) + (a[i] + b[i]) * b[i] - (a[i] - c[i]);
+        });
+        check(expr4, [&](auto i) { return (a[i] + b[i]) * c[i] - (a[i] + c[i]); });
+        check(expr5, [&](auto i) {
+            return (a[i] - b[i]) * (a[i] - b[i]) + (a[i] - b[i]) * c[i];
+        });
+
+        // plans with shared sub-expressions are evaluated with packed
+        // registers
+        auto const &sum = std::as_const(boost::yap::left(boost::yap::left(expr1)));
+        auto const plan = lower_shared<layout_type, false, 1u>(expr1, boost::hana::make_tuple(&sum));
+        if constexpr (std::is_floating_point_v<value_type>)
+            static_assert(decltype(plan)::template packable<value_type>());
+        for (auto i = 0u; i < a.size(); ++i)
+            BOOST_CHECK_EQUAL(plan(i), (a[i] + b[i]) * c[i] - (a[i] + b[i]));
     }
 }
-
-
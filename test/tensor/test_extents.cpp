@@ -5,6 +5,7 @@
 //  http://www.boost.org/LICENSE_1_0.txt)
 
 #include <boost/numeric/ublas/tensor/extents.hpp>
+#include <boost/numeric/ublas/tensor/static_extents.hpp>
 #include <boost/test/unit_test.hpp>
 #include <vector>
 
@@ -504,4 +505,103 @@ BOOST_FIXTURE_TEST_CASE(test_extents_to_string, fixture,
   BOOST_CHECK_EQUAL(e13, "{1}");
 }
 
+BOOST_AUTO_TEST_CASE(test_extents_small_buffer) {
+  using namespace boost::numeric;
+  using extents = ublas::basic_extents<unsigned>;
+  using base_type = extents::base_type;
+  constexpr auto n = base_type::inline_capacity;
+
+  auto e0 = extents{4, 2, 3};
+  BOOST_CHECK(e0.base().is_inline());
+  BOOST_CHECK(extents(e0).base().is_inline());
+  BOOST_CHECK(e0.squeeze().base().is_inline());
+
+  auto b = base_type(n, 2u);
+  BOOST_CHECK(b.is_inline());
+  b.push_back(3u);
+  BOOST_CHECK(!b.is_inline());
+  BOOST_CHECK_EQUAL(b.size(), n + 1);
+  BOOST_CHECK_EQUAL(b.back(), 3u);
+
+  auto e1 = extents(b);
+  BOOST_CHECK(!e1.base().is_inline());
+  BOOST_CHECK_EQUAL(e1.product(), 3u << n);
+  BOOST_CHECK_EQUAL(e1.at(n), 3u);
+  BOOST_CHECK_THROW(e1.at(n + 1), std::out_of_range);
+
+  auto e2 = std::move(e1);
+  BOOST_CHECK_EQUAL(e2.size(), n + 1);
+  BOOST_CHECK(e2 == extents(b));
+
+  b.erase(b.begin() + 1, b.end() - 1);
+  b.insert(b.begin(), b.begin(), b.end());
+  BOOST_CHECK(b == (base_type{2u, 3u, 2u, 3u}));
+
+  auto const v = std::vector<unsigned>{1, 2, 3};
+  BOOST_CHECK(extents(v) == (extents{1, 2, 3}));
+  BOOST_CHECK(extents(v.begin(), v.end()) == (extents{1, 2, 3}));
+  BOOST_CHECK(extents(v).base() == v);
+
+  // two integers are not an iterator range
+  static_assert(!std::is_constructible_v<extents, unsigned, unsigned>);
+  BOOST_CHECK(extents(v.data(), v.data() + 2) == (extents{1, 2}));
+}
+
+BOOST_AUTO_TEST_CASE(test_fixed_rank_extents) {
+  using namespace boost::numeric;
+  using extents = ublas::basic_extents<unsigned>;
+  using extents3 = ublas::basic_fixed_rank_extents<unsigned, 3>;
+
+  constexpr auto e0 = extents3{4, 2, 3};
+  static_assert(e0.size() == 3);
+  static_assert(e0.product() == 24);
+  static_assert(e0.is_tensor() || e0.is_matrix());
+  static_assert(e0[0] == 4 && e0[1] == 2 && e0[2] == 3);
+
+  auto fixed = std::vector<extents3>{{1, 1, 1}, {1, 2, 1}, {2, 1, 1},
+                                     {2, 3, 1}, {1, 2, 3}, {4, 2, 3}};
+  for (auto const &e : fixed) {
+    auto const d = extents{e[0], e[1], e[2]};
+    BOOST_CHECK(e == d);
+    BOOST_CHECK(extents(e) == d);
+    BOOST_CHECK(extents3(d) == e);
+    BOOST_CHECK_EQUAL(e.product(), d.product());
+    BOOST_CHECK_EQUAL(e.is_scalar(), d.is_scalar());
+    BOOST_CHECK_EQUAL(e.is_vector(), d.is_vector());
+    BOOST_CHECK_EQUAL(e.is_matrix(), d.is_matrix());
+    BOOST_CHECK_EQUAL(e.is_tensor(), d.is_tensor());
+    BOOST_CHECK_EQUAL(e.valid(), d.valid());
+    BOOST_CHECK_EQUAL(e.to_string(), d.to_string());
+  }
+
+  BOOST_CHECK((extents3{4, 2, 3} != extents{4, 2}));
+  BOOST_CHECK_THROW(extents3({1, 0, 2}), std::length_error);
+  BOOST_CHECK_THROW(extents3({1, 2}), std::length_error);
+  BOOST_CHECK_THROW(extents3(extents{1, 2, 3, 4}), std::length_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_static_extents) {
+  using namespace boost::numeric;
+  using extents = ublas::basic_extents<unsigned>;
+
+  using e1 = ublas::basic_static_extents<unsigned, 1>;
+  using e2 = ublas::basic_static_extents<unsigned, 1, 4>;
+  using e3 = ublas::basic_static_extents<unsigned, 4, 2, 1>;
+  using e4 = ublas::basic_static_extents<unsigned, 4, 2, 3>;
+
+  static_assert(e1::is_free_scalar() && e1::size() == 1 && e1::product() == 1);
+  static_assert(e2::is_vector() && !e2::is_matrix() && e2::product() == 4);
+  static_assert(e3::is_matrix() && !e3::is_tensor() && e3::product() == 8);
+  static_assert(e4::is_tensor() && e4::valid() && e4::product() == 24);
+  static_assert(e4{} == e4{} && e4{} != e3{});
+  static_assert(ublas::basic_fixed_rank_extents<unsigned, 3>(e4{}) ==
+                ublas::basic_fixed_rank_extents<unsigned, 3>{4, 2, 3});
+  static_assert(ublas::static_extents<4, 2, 3>{}[2] == 3);
+
+  BOOST_CHECK(e4{} == (extents{4, 2, 3}));
+  BOOST_CHECK(e4{} != (extents{4, 2, 1}));
+  BOOST_CHECK(extents(e3{}) == (extents{4, 2, 1}));
+  BOOST_CHECK_EQUAL(e4::to_string(), "{4, 2, 3}");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
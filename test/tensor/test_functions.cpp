@@ -132,6 +132,116 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_prod_matrix, value,  test_types, f
 
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_prod_static_shape, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using tensor_type  = ublas::tensor<value_type,layout_type>;
+	using vector_type  = typename tensor_type::vector_type;
+	using matrix_type  = typename tensor_type::matrix_type;
+
+	// small, above detail::fixed::threshold and above detail::fixed::max_rank
+	auto const extents = std::vector<ublas::shape>{
+	      ublas::shape{4,5,3},
+	      ublas::shape{64,70,3},
+	      ublas::shape{2,1,1,1,1,1,1,1,1,3}};
+
+	for(auto const& n : extents){
+
+		auto a = tensor_type(n);
+		auto v = value_type{};
+		for(auto& x : a){ x = v; v += value_type{1}; }
+
+		auto const m = n.size();
+
+		auto b = vector_type(3);
+		for(auto i = 0u; i < b.size(); ++i) b(i) = value_type(i+1);
+
+		auto c = ublas::prod(a, b, m, std::integral_constant<std::size_t,3>{});
+		auto r = ublas::prod(a, b, m);
+		BOOST_CHECK( c.extents() == r.extents() );
+		BOOST_CHECK( std::equal(c.begin(), c.end(), r.begin()) );
+
+		auto B = matrix_type(2,3);
+		for(auto i = 0u; i < B.size1(); ++i)
+			for(auto j = 0u; j < B.size2(); ++j)
+				B(i,j) = value_type(i+2*j+1);
+
+		auto C = ublas::prod(a, B, m, std::integral_constant<std::size_t,2>{}, std::integral_constant<std::size_t,3>{});
+		auto R = ublas::prod(a, B, m);
+		BOOST_CHECK( C.extents() == R.extents() );
+		BOOST_CHECK( std::equal(C.begin(), C.end(), R.begin()) );
+	}
+
+	// extents that are not dispatched at runtime
+	auto a = tensor_type(ublas::shape{4,5,3}, value_type{2});
+	auto b = vector_type(5, value_type{1});
+	auto c = ublas::prod(a, b, 2, std::integral_constant<std::size_t,5>{});
+	BOOST_CHECK( c.extents() == (ublas::shape{4,3}) );
+	for(auto const& x : c)
+		BOOST_CHECK_EQUAL( x, value_type{10} );
+
+	auto B = matrix_type(7, 5, value_type{1});
+	auto C = ublas::prod(a, B, 2, std::integral_constant<std::size_t,7>{}, std::integral_constant<std::size_t,5>{});
+	BOOST_CHECK( C.extents() == (ublas::shape{4,7,3}) );
+	for(auto const& x : C)
+		BOOST_CHECK_EQUAL( x, value_type{10} );
+
+	BOOST_CHECK_THROW( ublas::prod(a, b, 1, std::integral_constant<std::size_t,5>{}), std::length_error );
+	BOOST_CHECK_THROW( ublas::prod(a, b, 2, std::integral_constant<std::size_t,4>{}), std::length_error );
+	BOOST_CHECK_THROW( ublas::prod(a, b, 0, std::integral_constant<std::size_t,5>{}), std::length_error );
+	BOOST_CHECK_THROW( ublas::prod(a, B, 2, std::integral_constant<std::size_t,5>{}, std::integral_constant<std::size_t,5>{}), std::length_error );
+	BOOST_CHECK_THROW( ublas::prod(a, B, 3, std::integral_constant<std::size_t,7>{}, std::integral_constant<std::size_t,5>{}), std::length_error );
+}
+
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_functions_static_extents, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using array_type   = std::vector<value_type>;
+	using tensor_type  = ublas::tensor<value_type,layout_type>;
+	using static_type  = ublas::tensor<value_type,layout_type,array_type,ublas::static_extents<4,2,3>>;
+	using fixed_type   = ublas::tensor<value_type,layout_type,array_type,ublas::fixed_rank_extents<3>>;
+	using vector_type  = typename tensor_type::vector_type;
+	using matrix_type  = typename tensor_type::matrix_type;
+
+	auto a = static_type{};
+	auto v = value_type{};
+	for(auto& x : a){ x = v; v += value_type{1}; }
+	auto const d = tensor_type(a);
+	auto const f = fixed_type(a);
+
+	auto const equal = [](auto const& c, auto const& r){
+		BOOST_CHECK( c.extents() == r.extents() );
+		BOOST_CHECK( std::equal(c.begin(), c.end(), r.begin()) );
+	};
+
+	auto b = vector_type(2, value_type{2});
+	equal( ublas::prod(a, b, 2), ublas::prod(d, b, 2) );
+	equal( ublas::prod(f, b, 2), ublas::prod(d, b, 2) );
+
+	auto B = matrix_type(5, 3, value_type{1});
+	equal( ublas::prod(a, B, 3), ublas::prod(d, B, 3) );
+
+	equal( ublas::prod(a, f, {2,3}), ublas::prod(d, d, {2,3}) );
+	equal( ublas::outer_prod(a, d), ublas::outer_prod(d, d) );
+	equal( ublas::trans(a, {3,1,2}), ublas::trans(d, {3,1,2}) );
+	BOOST_CHECK_EQUAL( ublas::inner_prod(a, f), ublas::inner_prod(d, d) );
+	BOOST_CHECK_EQUAL( ublas::norm(a), ublas::norm(d) );
+
+	// results have a runtime shape and convert to tensors with static extents
+	using result_type = ublas::tensor<value_type,layout_type,array_type,ublas::static_extents<2,3,4>>;
+	result_type c = ublas::trans(a, {3,1,2});
+	equal( c, ublas::trans(d, {3,1,2}) );
+	BOOST_CHECK_THROW( result_type(ublas::trans(a, {1,2,3})), std::length_error );
+}
+
+
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_prod_tensor_1, value,  test_types, fixture )
 {
 	using namespace boost::numeric;
@@ -487,5 +487,541 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_outer, value,  test_types, fixture
 }
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_gemm_blocked, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using vector_type  = std::vector<value_type>;
+
+	// sizes are chosen such that all partial register and cache blocks are visited
+	for(auto const m : {1ul, 7ul, 131ul})
+	for(auto const n : {1ul, 5ul, 37ul})
+	for(auto const k : {1ul, 3ul, 300ul})
+	for(auto const row_major : {false, true})
+	{
+		auto a = vector_type(m*k);
+		auto b = vector_type(k*n);
+		for(auto i = 0ul; i < a.size(); ++i) a[i] = value_type( i%5 + 1);
+		for(auto i = 0ul; i < b.size(); ++i) b[i] = value_type( i%3 + 1);
+
+		auto ra = row_major ? std::ptrdiff_t(k) : 1, ca = row_major ? 1 : std::ptrdiff_t(m);
+		auto rb = row_major ? std::ptrdiff_t(n) : 1, cb = row_major ? 1 : std::ptrdiff_t(k);
+		auto rc = row_major ? std::ptrdiff_t(n) : 1, cc = row_major ? 1 : std::ptrdiff_t(m);
+
+		auto c    = vector_type(m*n, value_type{2});
+		auto cref = c;
+
+		ublas::detail::blocked::gemm(m, n, k, value_type{2}, a.data(), ra, ca, b.data(), rb, cb, value_type{3}, c.data(), rc, cc);
+
+		for(auto i = 0ul; i < m; ++i)
+			for(auto j = 0ul; j < n; ++j){
+				auto sum = value_type{};
+				for(auto l = 0ul; l < k; ++l)
+					sum += a[i*ra+l*ca] * b[l*rb+j*cb];
+				cref[i*rc+j*cc] = value_type{3}*cref[i*rc+j*cc] + value_type{2}*sum;
+			}
+
+		BOOST_CHECK( c == cref );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_ttt_blocked, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using strides_type = ublas::strides<layout_type>;
+	using vector_type  = std::vector<value_type>;
+	using extents_type = ublas::shape;
+	using size_type    = typename strides_type::value_type;
+
+	// extents are large enough such that ttt is mapped onto gemm
+	auto const na = extents_type{8,6,5,7};
+	auto const wa = strides_type(na);
+	auto const pa = na.size();
+
+	auto a = vector_type(na.product());
+	for(auto i = 0ul; i < a.size(); ++i) a[i] = value_type( i%5 + 1);
+
+	auto phia = std::vector<size_type>(pa);
+	std::iota(phia.begin(), phia.end(), 1ul);
+
+	do {
+		for(auto q = size_type(1); q < pa; ++q) {
+
+			auto const r = pa - q;
+			auto const s = size_type(2);
+			auto const pb = s + q;
+
+			// free modes of B are placed in front of the contracted modes
+			// which are reversed with respect to A
+			auto nb_base = std::vector<size_type>(pb);
+			auto phib    = std::vector<size_type>(pb);
+			nb_base[0] = 3; nb_base[1] = 4;
+			phib[0] = 1; phib[1] = 2;
+			for(auto i = 0ul; i < q; ++i){
+				nb_base[s+i]   = na[phia[r+i]-1];
+				phib[s+q-1-i]  = s+i+1;
+			}
+			std::reverse(nb_base.begin()+s, nb_base.end());
+
+			auto const nb = extents_type(nb_base);
+			auto const wb = strides_type(nb);
+			auto b = vector_type(nb.product());
+			for(auto i = 0ul; i < b.size(); ++i) b[i] = value_type( i%3 + 1);
+
+			auto nc_base = std::vector<size_type>(r+s);
+			for(auto i = 0ul; i < r; ++i) nc_base[i]   = na[phia[i]-1];
+			for(auto i = 0ul; i < s; ++i) nc_base[r+i] = nb[phib[i]-1];
+
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+			auto c    = vector_type(nc.product(), value_type{1});
+			auto cref = c;
+
+			ublas::ttt(pa,pb,q,
+			           phia.data(), phib.data(),
+			           c.data(), nc.data(), wc.data(),
+			           a.data(), na.data(), wa.data(),
+			           b.data(), nb.data(), wb.data());
+
+			ublas::detail::recursive::ttt(size_type(0), r, s, q,
+			           phia.data(), phib.data(),
+			           cref.data(), nc.data(), wc.data(),
+			           a.data(), na.data(), wa.data(),
+			           b.data(), nb.data(), wb.data());
+
+			BOOST_CHECK( c == cref );
+		}
+	}
+	while(std::next_permutation(phia.begin(), phia.end()));
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_ttm_blocked, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using strides_type = ublas::strides<layout_type>;
+	using vector_type  = std::vector<value_type>;
+	using extents_type = ublas::shape;
+	using size_type    = typename strides_type::value_type;
+
+	// extents are large enough such that ttm is mapped onto gemm
+	for(auto const& na : {extents_type{8,6,5,7}, extents_type{1,64,70}, extents_type{64,70,1}}) {
+
+		auto const wa = strides_type(na);
+		auto const p  = na.size();
+
+		auto a = vector_type(na.product());
+		for(auto i = 0ul; i < a.size(); ++i) a[i] = value_type( i%5 + 1);
+
+		for(auto m = 0ul; m < p; ++m) {
+
+			auto const nb = extents_type{9, na[m]};
+			auto const wb = strides_type(nb);
+			auto b = vector_type(nb.product());
+			for(auto i = 0ul; i < b.size(); ++i) b[i] = value_type( i%3 + 1);
+
+			auto nc_base = na.base();
+			nc_base[m] = nb[0];
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			auto c    = vector_type(nc.product(), value_type{1});
+			auto cref = c;
+
+			ublas::ttm(size_type(m+1), p,
+			           c.data(), nc.data(), wc.data(),
+			           a.data(), na.data(), wa.data(),
+			           b.data(), nb.data(), wb.data());
+
+			if(m == 0)
+				ublas::detail::recursive::ttm0(p-1,
+				           cref.data(), nc.data(), wc.data(),
+				           a.data(), na.data(), wa.data(),
+				           b.data(), nb.data(), wb.data());
+			else
+				ublas::detail::recursive::ttm(size_type(m), p-1,
+				           cref.data(), nc.data(), wc.data(),
+				           a.data(), na.data(), wa.data(),
+				           b.data(), nb.data(), wb.data());
+
+			BOOST_CHECK( c == cref );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_ttv_blocked, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using strides_type = ublas::strides<layout_type>;
+	using vector_type  = std::vector<value_type>;
+	using extents_type = ublas::shape;
+	using size_type    = typename strides_type::value_type;
+
+	// extents are large enough such that ttv is vectorized
+	for(auto const& na : {extents_type{8,6,5,7}, extents_type{1,64,70}, extents_type{64,70,1}, extents_type{300,9}, extents_type{3,5,301}}) {
+
+		auto const wa = strides_type(na);
+		auto const p  = na.size();
+
+		auto a = vector_type(na.product());
+		for(auto i = 0ul; i < a.size(); ++i) a[i] = value_type( i%5 + 1);
+
+		for(auto m = 0ul; m < p; ++m) {
+
+			auto const nb = extents_type{na[m],1};
+			auto b = vector_type(nb.product());
+			for(auto i = 0ul; i < b.size(); ++i) b[i] = value_type( i%3 + 1);
+
+			auto nc_base = na.base();
+			nc_base.erase(nc_base.begin()+m);
+			if(nc_base.size() == 1u) nc_base.push_back(1);
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			auto c    = vector_type(nc.product(), value_type{1});
+			auto cref = c;
+
+			ublas::ttv(size_type(m+1), p,
+			           c.data(), nc.data(), wc.data(),
+			           a.data(), na.data(), wa.data(),
+			           b.data(), nb.data(), nb.data());
+
+			if(p == 2)
+				ublas::detail::recursive::mtv(size_type(m),
+				           cref.data(), nc.data(), wc.data(),
+				           a.data(), na.data(), wa.data(),
+				           b.data());
+			else if(m == 0)
+				ublas::detail::recursive::ttv0(p-1,
+				           cref.data(), nc.data(), wc.data(),
+				           a.data(), na.data(), wa.data(),
+				           b.data());
+			else
+				ublas::detail::recursive::ttv(size_type(m), p-1, p-2,
+				           cref.data(), nc.data(), wc.data(),
+				           a.data(), na.data(), wa.data(),
+				           b.data());
+
+			BOOST_CHECK( c == cref );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_multiplication_overwrite, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using strides_type = ublas::strides<layout_type>;
+	using vector_type  = std::vector<value_type>;
+	using extents_type = ublas::shape;
+	using size_type    = typename strides_type::value_type;
+
+	// computes f with C = 0 and accumulation, with C = 7 and without and with C = 1 and accumulation
+	auto const check = [](std::size_t n, auto const& f){
+		auto ref = vector_type(n, value_type{0});
+		f(ref, true);
+		auto c = vector_type(n, value_type{7});
+		f(c, false);
+		BOOST_CHECK( c == ref );
+		std::fill(c.begin(), c.end(), value_type{1});
+		f(c, true);
+		for(auto i = 0ul; i < n; ++i)
+			BOOST_CHECK_EQUAL( c[i], ref[i] + value_type{1} );
+	};
+
+	// small extents use the recursive kernels, large extents the blocked ones
+	for(auto const& na : {extents_type{4,5,6}, extents_type{7,3,2,5}, extents_type{40,30,20}, extents_type{1,9,1}}) {
+
+		auto const wa = strides_type(na);
+		auto const p  = na.size();
+
+		auto a = vector_type(na.product());
+		for(auto i = 0ul; i < a.size(); ++i) a[i] = value_type( i%5 + 1);
+
+		for(auto m = 0ul; m < p; ++m) {
+			auto const nb = extents_type{na[m],1};
+			auto b = vector_type(nb.product(), value_type{2});
+
+			auto nc_base = na.base();
+			nc_base.erase(nc_base.begin()+m);
+			if(nc_base.size() == 1u) nc_base.push_back(1);
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			check(nc.product(), [&](vector_type& c, bool accumulate){
+				ublas::ttv(size_type(m+1), p, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), nb.data(), accumulate);
+			});
+		}
+
+		for(auto m = 0ul; m < p; ++m) {
+			auto const nb = extents_type{4, na[m]};
+			auto const wb = strides_type(nb);
+			auto b = vector_type(nb.product(), value_type{3});
+
+			auto nc_base = na.base();
+			nc_base[m] = nb[0];
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			check(nc.product(), [&](vector_type& c, bool accumulate){
+				ublas::ttm(size_type(m+1), p, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data(), accumulate);
+			});
+		}
+
+		for(auto q = 1ul; q <= p; ++q) {
+			auto const r = p-q;
+			auto nb_base = typename extents_type::base_type{3};
+			nb_base.insert(nb_base.end(), na.begin()+r, na.end());
+			auto const nb = extents_type(nb_base);
+			auto const wb = strides_type(nb);
+			auto b = vector_type(nb.product(), value_type{2});
+
+			auto const s  = nb.size()-q;
+			auto nc_base = typename extents_type::base_type(na.begin(), na.begin()+r);
+			nc_base.insert(nc_base.end(), nb.begin(), nb.begin()+s);
+			if(nc_base.size() == 1u) nc_base.push_back(1);
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			check(nc.product(), [&](vector_type& c, bool accumulate){
+				ublas::ttt(p, nb.size(), q, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data(), accumulate);
+			});
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_multiplication_default, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using strides_type = ublas::strides<layout_type>;
+	using vector_type  = std::vector<value_type>;
+	using extents_type = ublas::shape;
+	using size_type    = typename strides_type::value_type;
+
+	auto const na = extents_type{2,3};
+	auto const wa = strides_type(na);
+	auto const a  = vector_type(na.product(), value_type{2});
+
+	// without the accumulate flag ttv overwrites C if p is one
+	{
+		auto const nb = extents_type{6,1};
+		auto const wb = strides_type(nb);
+		auto const b  = vector_type(nb.product(), value_type{3});
+		auto c = vector_type(1, value_type{7});
+		ublas::ttv(size_type(1), size_type(1), c.data(), nb.data(), wb.data(), a.data(), nb.data(), wb.data(), b.data(), nb.data(), wb.data());
+		BOOST_CHECK_EQUAL( c[0], value_type{36} );
+	}
+
+	// and adds the product to C otherwise
+	{
+		auto const nb = extents_type{3,1};
+		auto const wb = strides_type(nb);
+		auto const b  = vector_type(nb.product(), value_type{3});
+		auto const nc = extents_type{2,1};
+		auto const wc = strides_type(nc);
+		auto c = vector_type(nc.product(), value_type{1});
+		ublas::ttv(size_type(2), na.size(), c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+		for(auto const& v : c)
+			BOOST_CHECK_EQUAL( v, value_type{19} );
+	}
+
+	// ttt overwrites C if the product has no free modes
+	{
+		auto const b  = vector_type(na.product(), value_type{3});
+		auto const nc = extents_type{1,1};
+		auto const wc = strides_type(nc);
+		auto c = vector_type(1, value_type{7});
+		ublas::ttt(na.size(), na.size(), na.size(), c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), na.data(), wa.data());
+		BOOST_CHECK_EQUAL( c[0], value_type{36} );
+	}
+
+	// and adds the product to C otherwise
+	{
+		auto const nb = extents_type{4,3};
+		auto const wb = strides_type(nb);
+		auto const b  = vector_type(nb.product(), value_type{3});
+		auto const nc = extents_type{2,4};
+		auto const wc = strides_type(nc);
+		auto c = vector_type(nc.product(), value_type{1});
+		ublas::ttt(na.size(), nb.size(), size_type(1), c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+		for(auto const& v : c)
+			BOOST_CHECK_EQUAL( v, value_type{19} );
+	}
+
+	// ttm and ttt with permutation tuples add the product to C
+	{
+		auto const nb = extents_type{4,3};
+		auto const wb = strides_type(nb);
+		auto const b  = vector_type(nb.product(), value_type{3});
+		auto const nc = extents_type{2,4};
+		auto const wc = strides_type(nc);
+		auto c = vector_type(nc.product(), value_type{1});
+		ublas::ttm(size_type(2), na.size(), c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+		for(auto const& v : c)
+			BOOST_CHECK_EQUAL( v, value_type{19} );
+
+		auto const phi = std::vector<size_type>{1,2};
+		ublas::ttt(na.size(), nb.size(), size_type(1), phi.data(), phi.data(), c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+		for(auto const& v : c)
+			BOOST_CHECK_EQUAL( v, value_type{37} );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_fixed, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using strides_type = ublas::strides<layout_type>;
+	using vector_type  = std::vector<value_type>;
+	using extents_type = ublas::shape;
+	using size_type    = typename strides_type::value_type;
+
+	// extents 2, 3, 4 and 8 are computed with unrolled kernels, 5 is not
+	for(auto const& na : {extents_type{2,3}, extents_type{3,4,2}, extents_type{8,1,3}, extents_type{2,5,4,3}}) {
+
+		auto const wa = strides_type(na);
+		auto const p  = na.size();
+
+		auto a = vector_type(na.product());
+		for(auto i = 0ul; i < a.size(); ++i) a[i] = value_type( i%5 + 1);
+
+		for(auto m = 0ul; m < p; ++m) {
+			auto const nb = extents_type{na[m],1};
+			auto b = vector_type(nb.product());
+			for(auto i = 0ul; i < b.size(); ++i) b[i] = value_type( i%3 + 1);
+
+			auto nc_base = na.base();
+			nc_base.erase(nc_base.begin()+m);
+			if(nc_base.size() == 1u) nc_base.push_back(1);
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			auto c    = vector_type(nc.product(), value_type{1});
+			auto cref = c;
+
+			auto const fixed = ublas::detail::fixed::ttv(size_type(m), p, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), true);
+			BOOST_CHECK_EQUAL( fixed, na[m] != 5u && na[m] != 1u );
+			if(!fixed)
+				ublas::ttv(size_type(m+1), p, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), nb.data());
+
+			if(p == 2)
+				ublas::detail::recursive::mtv(size_type(m), cref.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data());
+			else if(m == 0)
+				ublas::detail::recursive::ttv0(p-1, cref.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data());
+			else
+				ublas::detail::recursive::ttv(size_type(m), p-1, p-2, cref.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data());
+
+			BOOST_CHECK( c == cref );
+		}
+
+		for(auto m = 0ul; m < p; ++m) {
+			for(auto j : {2ul, 3ul, 5ul}) {
+				auto const nb = extents_type{j, na[m]};
+				auto const wb = strides_type(nb);
+				auto b = vector_type(nb.product());
+				for(auto i = 0ul; i < b.size(); ++i) b[i] = value_type( i%3 + 1);
+
+				auto nc_base = na.base();
+				nc_base[m] = nb[0];
+				auto const nc = extents_type(nc_base);
+				auto const wc = strides_type(nc);
+
+				auto c    = vector_type(nc.product(), value_type{1});
+				auto cref = c;
+
+				auto const fixed = ublas::detail::fixed::ttm(size_type(m), p, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data(), true);
+				BOOST_CHECK_EQUAL( fixed, j != 5u && na[m] != 5u && na[m] != 1u );
+				if(!fixed)
+					ublas::ttm(size_type(m+1), p, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+
+				if(m == 0)
+					ublas::detail::recursive::ttm0(p-1, cref.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+				else
+					ublas::detail::recursive::ttm(size_type(m), p-1, cref.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+
+				BOOST_CHECK( c == cref );
+			}
+		}
+
+		// contracts q modes of A with the reversed trailing modes of B
+		auto phia = std::vector<size_type>(p);
+		std::iota(phia.begin(), phia.end(), 1ul);
+		do {
+			for(auto q = size_type(1); q <= p; ++q) {
+				auto const r  = p - q;
+				auto const s  = size_type(1);
+				auto const pb = s + q;
+
+				auto nb_base = std::vector<size_type>(pb);
+				auto phib    = std::vector<size_type>(pb);
+				nb_base[0] = 3; phib[0] = 1;
+				for(auto i = 0ul; i < q; ++i){
+					nb_base[pb-1-i] = na[phia[r+i]-1];
+					phib[s+i]       = pb-i;
+				}
+				auto const nb = extents_type(nb_base);
+				auto const wb = strides_type(nb);
+				auto b = vector_type(nb.product());
+				for(auto i = 0ul; i < b.size(); ++i) b[i] = value_type( i%3 + 1);
+
+				auto nc_base = std::vector<size_type>(r+s);
+				for(auto i = 0ul; i < r; ++i) nc_base[i] = na[phia[i]-1];
+				nc_base[r] = nb[0];
+				if(nc_base.size() == 1u) nc_base.push_back(1);
+				auto const nc = extents_type(nc_base);
+				auto const wc = strides_type(nc);
+
+				auto c    = vector_type(nc.product(), value_type{1});
+				auto cref = c;
+
+				// contraction modes with extent one are skipped
+				auto contracted = 0ul;
+				auto supported = true;
+				for(auto i = 0ul; i < q; ++i){
+					contracted += na[phia[r+i]-1] != 1u;
+					supported = supported && na[phia[r+i]-1] != 5u;
+				}
+				supported = supported && contracted > 0u && contracted <= 2u;
+
+				auto const fixed = ublas::detail::fixed::ttt(r, s, q, phia.data(), phib.data(), c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data(), true);
+				BOOST_CHECK_EQUAL( fixed, supported );
+				if(!fixed)
+					ublas::ttt(p, pb, q, phia.data(), phib.data(), c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+
+				ublas::detail::recursive::ttt(size_type(0), r, s, q, phia.data(), phib.data(), cref.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+
+				BOOST_CHECK( c == cref );
+			}
+		}
+		while(std::next_permutation(phia.begin(), phia.end()));
+	}
+
+	// products with more multiply-adds than the threshold are not computed with unrolled kernels
+	auto const na = extents_type{8,8,8,8};
+	auto const wa = strides_type(na);
+	auto const nb = extents_type{8,8};
+	auto const wb = strides_type(nb);
+	auto a = vector_type(na.product(), value_type{1});
+	auto b = vector_type(nb.product(), value_type{1});
+	auto c = vector_type(na.product(), value_type{1});
+	BOOST_CHECK( !ublas::detail::fixed::ttm(size_type(1), na.size(), c.data(), na.data(), wa.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data(), true) );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
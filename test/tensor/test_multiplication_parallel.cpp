@@ -0,0 +1,229 @@
+//  Copyright (c) 2018-2019 Cem Bassoy
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer and Google in producing this work
+//  which started as a Google Summer of Code project.
+//
+
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <boost/numeric/ublas/tensor.hpp>
+#include <boost/numeric/ublas/tensor/multiplication.hpp>
+#include <boost/numeric/ublas/tensor/extents.hpp>
+#include <boost/numeric/ublas/tensor/strides.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestTensorParallel
+
+#include <boost/test/unit_test.hpp>
+#include "utility.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// is built with OpenMP, see test/tensor/Jamfile
+BOOST_AUTO_TEST_SUITE ( test_tensor_parallel_contraction )
+
+
+using test_types = zip<int,long,float,double,std::complex<float>>::with_t<boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
+
+
+BOOST_AUTO_TEST_CASE( test_tensor_parallel_partition )
+{
+	using namespace boost::numeric;
+
+	auto const threshold = ublas::get_parallel_threshold();
+	ublas::set_parallel_threshold(0);
+	ublas::set_num_threads(3);
+
+	auto ids   = std::set<int>{};
+	auto mutex = std::mutex{};
+	auto seen  = std::vector<int>(10, 0);
+	ublas::detail::parallel::for_each_range(100u, seen.size(), [&](std::size_t first, std::size_t last){
+		for(auto i = first; i < last; ++i)
+			++seen[i];
+#ifdef _OPENMP
+		auto const lock = std::lock_guard<std::mutex>(mutex);
+		ids.insert(omp_get_thread_num());
+#endif
+	});
+
+	ublas::set_num_threads(0);
+	ublas::set_parallel_threshold(threshold);
+
+	BOOST_CHECK( std::all_of(seen.begin(), seen.end(), [](int n){ return n == 1; }) );
+#ifdef _OPENMP
+	BOOST_CHECK_EQUAL( ids.size(), 3u );
+#else
+	BOOST_TEST_MESSAGE( "OpenMP is not enabled, the kernels run with one thread." );
+#endif
+}
+
+
+// records the threads that apply the epilogue, ublas::apply only takes functions without state
+std::mutex    epilogue_mutex;
+std::set<int> epilogue_threads;
+
+double twice(double const& x)
+{
+#ifdef _OPENMP
+	auto const lock = std::lock_guard<std::mutex>(epilogue_mutex);
+	epilogue_threads.insert(omp_get_thread_num());
+#endif
+	return x+x;
+}
+
+
+BOOST_AUTO_TEST_CASE( test_tensor_parallel_fused_epilogue )
+{
+	using namespace boost::numeric::ublas;
+	using namespace boost::numeric::ublas::index;
+	using tensor_type = tensor<double>;
+
+	auto const threshold = get_parallel_threshold();
+	set_parallel_threshold(0);
+
+	auto A = tensor_type(shape{6,5}), B = tensor_type(shape{5,7}), C = tensor_type(shape{6,7}, 1.0);
+	for(auto i = 0u; i < A.size(); ++i) A[i] = double(i%4);
+	for(auto i = 0u; i < B.size(); ++i) B[i] = double(i%3);
+
+	set_num_threads(1);
+	tensor_type ref = boost::numeric::ublas::apply( A(_i,_j) * B(_j,_k) + C, [](double const& x){ return twice(x); } );
+	epilogue_threads.clear();
+	set_num_threads(3);
+	tensor_type res = boost::numeric::ublas::apply( A(_i,_j) * B(_j,_k) + C, [](double const& x){ return twice(x); } );
+	set_num_threads(0);
+	set_parallel_threshold(threshold);
+
+	BOOST_CHECK( std::equal(res.begin(), res.end(), ref.begin(), ref.end()) );
+#ifdef _OPENMP
+	BOOST_CHECK_EQUAL( epilogue_threads.size(), 3u );
+#endif
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_parallel, value,  test_types )
+{
+	using namespace boost::numeric;
+	using value_type   = typename value::first_type;
+	using layout_type  = typename value::second_type;
+	using strides_type = ublas::strides<layout_type>;
+	using vector_type  = std::vector<value_type>;
+	using extents_type = ublas::shape;
+	using size_type    = typename strides_type::value_type;
+
+	auto const threshold = ublas::get_parallel_threshold();
+	ublas::set_parallel_threshold(0);
+
+	// computes f with one and with three threads
+	auto const check = [](auto const& f){
+		ublas::set_num_threads(1);
+		auto const ref = f();
+		ublas::set_num_threads(3);
+		auto const res = f();
+		ublas::set_num_threads(0);
+		BOOST_CHECK( res == ref );
+	};
+
+	for(auto const& na : {extents_type{4,5,6}, extents_type{7,3,2,5}, extents_type{1,9,1}, extents_type{5,8}}) {
+
+		auto const wa = strides_type(na);
+		auto const p  = na.size();
+
+		auto a = vector_type(na.product());
+		for(auto i = 0ul; i < a.size(); ++i) a[i] = value_type( i%5 + 1);
+
+		for(auto m = 0ul; m < p; ++m) {
+
+			auto const nb = extents_type{na[m],1};
+			auto b = vector_type(nb.product(), value_type{2});
+
+			auto nc_base = na.base();
+			nc_base.erase(nc_base.begin()+m);
+			if(nc_base.size() == 1u) nc_base.push_back(1);
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			check([&]{
+				auto c = vector_type(nc.product());
+				ublas::ttv(size_type(m+1), p, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), nb.data());
+				return c;
+			});
+		}
+
+		for(auto m = 0ul; m < p; ++m) {
+
+			auto const nb = extents_type{4, na[m]};
+			auto const wb = strides_type(nb);
+			auto b = vector_type(nb.product(), value_type{3});
+
+			auto nc_base = na.base();
+			nc_base[m] = nb[0];
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			check([&]{
+				auto c = vector_type(nc.product());
+				ublas::ttm(size_type(m+1), p, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+				return c;
+			});
+		}
+
+		for(auto q = 0ul; q <= p; ++q) {
+
+			auto const r = p-q;
+			auto nb_base = typename extents_type::base_type{3};
+			nb_base.insert(nb_base.end(), na.begin()+r, na.end());
+			if(nb_base.size() == 1u) nb_base.push_back(2);
+			auto const nb = extents_type(nb_base);
+			auto const wb = strides_type(nb);
+			auto b = vector_type(nb.product(), value_type{2});
+
+			auto const s  = nb.size()-q;
+			auto nc_base = typename extents_type::base_type(na.begin(), na.begin()+r);
+			nc_base.insert(nc_base.end(), nb.begin(), nb.begin()+s);
+			if(nc_base.size() == 1u) nc_base.push_back(1);
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			check([&]{
+				auto c = vector_type(nc.product());
+				ublas::ttt(p, nb.size(), q, c.data(), nc.data(), wc.data(), a.data(), na.data(), wa.data(), b.data(), nb.data(), wb.data());
+				return c;
+			});
+		}
+
+		check([&]{
+			return ublas::inner(p, na.data(), a.data(), wa.data(), a.data(), wa.data(), value_type(1));
+		});
+
+		check([&]{
+			auto const nb = extents_type{2,3};
+			auto const wb = strides_type(nb);
+			auto b = vector_type(nb.product(), value_type{3});
+
+			auto nc_base = na.base();
+			nc_base.insert(nc_base.end(), nb.begin(), nb.end());
+			auto const nc = extents_type(nc_base);
+			auto const wc = strides_type(nc);
+
+			auto c = vector_type(nc.product());
+			ublas::outer(c.data(), nc.size(), nc.data(), wc.data(), a.data(), p, na.data(), wa.data(), b.data(), nb.size(), nb.data(), wb.data());
+			return c;
+		});
+	}
+
+	ublas::set_parallel_threshold(threshold);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
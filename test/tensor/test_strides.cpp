@@ -15,6 +15,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/numeric/ublas/tensor/strides.hpp>
 #include <boost/numeric/ublas/tensor/extents.hpp>
+#include <boost/numeric/ublas/tensor/static_strides.hpp>
 
 //BOOST_AUTO_TEST_SUITE(test_strides, * boost::unit_test::depends_on("test_extents"));
 
@@ -169,4 +170,55 @@ BOOST_AUTO_TEST_CASE( test_strides_ctor_access_last_order)
 }
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_fixed_rank_strides, value, test_types)
+{
+	using namespace boost::numeric;
+
+	using extents_type = ublas::basic_extents<std::size_t>;
+	using strides_type = ublas::strides<value>;
+
+	constexpr auto e = ublas::fixed_rank_extents<3>{4,2,3};
+	constexpr auto w = ublas::fixed_rank_strides<3,value>{e};
+	static_assert ( w.size() == 3 );
+	static_assert ( w.offset(0,0,0) == 0 );
+	static_assert ( w.offset(3,1,2) == 3*w[0] + 1*w[1] + 2*w[2] );
+	static_assert ( ublas::detail::access<0>(0, w, 3,1,2) == w.offset(3,1,2) );
+	static_assert ( ublas::detail::access<1>(5, w, 1,2) == 5 + w[1] + 2*w[2] );
+
+	auto extents = std::vector<ublas::fixed_rank_extents<3>>{{1,1,1},{1,2,1},{2,1,1},{2,3,1},{1,2,3},{2,1,3},{4,2,3}};
+	for(auto const& n : extents){
+		auto const wf = ublas::fixed_rank_strides<3,value>{n};
+		auto const wd = strides_type{extents_type(n)};
+		BOOST_CHECK( wf == wd );
+		BOOST_CHECK( strides_type(wf) == wd );
+		BOOST_CHECK_EQUAL( ublas::detail::access<0>(0, wf, 1,0,0), ublas::detail::access<0>(0ul, wd, 1ul,0ul,0ul) );
+		BOOST_CHECK_EQUAL( ublas::detail::access(std::array<std::size_t,3>{0,1,0}, wf), wd[1] );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_static_strides, value, test_types)
+{
+	using namespace boost::numeric;
+
+	using extents_type = ublas::static_extents<4,2,3>;
+	using strides_type = ublas::static_strides<extents_type,value>;
+
+	constexpr auto w = strides_type{};
+	if constexpr ( std::is_same<value,ublas::first_order>::value ){
+		static_assert ( w[0] == 1 && w[1] == 4 && w[2] == 8 );
+	} else {
+		static_assert ( w[0] == 6 && w[1] == 3 && w[2] == 1 );
+	}
+	static_assert ( w.offset(3,1,2) == 3*w[0] + 1*w[1] + 2*w[2] );
+	static_assert ( ublas::detail::access<0>(0, w, 3,1,2) == w.offset(3,1,2) );
+	static_assert ( ublas::fixed_rank_strides<3,value>(w) == ublas::fixed_rank_strides<3,value>(extents_type{}) );
+
+	static_assert ( ublas::static_strides<ublas::static_extents<1,4>,value>{}[1] == 1 );
+	static_assert ( ublas::static_strides<ublas::static_extents<1,1,1>,value>{}[2] == 1 );
+
+	BOOST_CHECK( w == ublas::strides<value>(ublas::shape(extents_type{})) );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
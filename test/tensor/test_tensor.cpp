@@ -371,6 +371,69 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_read_write_multi_index_access_at,
 
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_static_extents, value,  test_types)
+{
+	using namespace boost::numeric;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using array_type  = std::vector<value_type>;
+	using extents_type = ublas::static_extents<4,2,3>;
+	using tensor_type = ublas::tensor<value_type, layout_type>;
+	using static_type = ublas::tensor<value_type, layout_type, array_type, extents_type>;
+	using fixed_type  = ublas::tensor<value_type, layout_type, array_type, ublas::fixed_rank_extents<3>>;
+
+	static_assert( std::is_same_v<typename static_type::strides_type, ublas::static_strides<extents_type,layout_type>> );
+	static_assert( std::is_same_v<typename fixed_type::strides_type, ublas::fixed_rank_strides<3,layout_type>> );
+	static_assert( std::is_empty_v<typename static_type::strides_type> );
+	static_assert( typename static_type::strides_type{}.offset(3,1,2) == ( std::is_same_v<layout_type,ublas::first_order> ? 3+4+16 : 18+3+2 ) );
+
+	auto a = static_type{};
+	BOOST_CHECK_EQUAL( a.size(), 24ul );
+	BOOST_CHECK_EQUAL( a.rank(), 3ul );
+	for(auto const& v : a)
+		BOOST_CHECK_EQUAL( v, value_type{} );
+
+	for(auto i = 0ul; i < a.size(); ++i)
+		a[i] = value_type(i);
+
+	auto d = tensor_type(a);
+	auto f = fixed_type(a);
+	BOOST_CHECK( d.extents() == (ublas::shape{4,2,3}) );
+	BOOST_CHECK( f.extents() == (ublas::fixed_rank_extents<3>{4,2,3}) );
+	BOOST_CHECK( a.strides() == d.strides() );
+	BOOST_CHECK( f.strides() == d.strides() );
+
+	for(auto i = 0ul; i < 4; ++i)
+		for(auto j = 0ul; j < 2; ++j)
+			for(auto k = 0ul; k < 3; ++k){
+				BOOST_CHECK_EQUAL( a.at(i,j,k), d.at(i,j,k) );
+				BOOST_CHECK_EQUAL( f.at(i,j,k), d.at(i,j,k) );
+			}
+
+	a.at(3,1,2) = value_type{42};
+	BOOST_CHECK_EQUAL( a[23], value_type{42} );
+
+	auto b = static_type(d);
+	BOOST_CHECK( std::equal(b.begin(), b.end(), d.begin()) );
+	b = tensor_type(extents_type{}, value_type{2});
+	for(auto const& v : b)
+		BOOST_CHECK_EQUAL( v, value_type{2} );
+
+	BOOST_CHECK_THROW( static_type(tensor_type{4,3,2}), std::length_error );
+	BOOST_CHECK_THROW( fixed_type(tensor_type{4,3}), std::length_error );
+
+	f.reshape(ublas::fixed_rank_extents<3>{2,3,1}, value_type{1});
+	BOOST_CHECK_EQUAL( f.size(), 6ul );
+	BOOST_CHECK( f.strides() == (ublas::strides<layout_type>(ublas::shape{2,3,1})) );
+
+	auto v = a(ublas::range(1,3), ublas::range::all(), ublas::range(2,3));
+	BOOST_CHECK( v.extents() == (ublas::shape{2,2,1}) );
+	BOOST_CHECK_EQUAL( v.at(1,1,0), a.at(2,1,2) );
+}
+
+
+
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_reshape, value,  test_types, fixture)
 {
 	using namespace boost::numeric;
@@ -486,4 +549,26 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_throw, value, test_types, fixture)
 
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_subtensor, value,  test_types)
+{
+	using namespace boost::numeric;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = ublas::tensor<value_type, layout_type>;
+
+	// ranges and slices are complete with the tensor header alone
+	auto t = tensor_type{4,3};
+	for(auto i = 0ul; i < t.size(); ++i)
+		t[i] = value_type(i);
+
+	auto v = t(ublas::range(1,3), ublas::slice(0,2,2));
+	BOOST_CHECK( v.extents() == (ublas::shape{2,2}) );
+	for(auto i = 0ul; i < 2; ++i)
+		for(auto j = 0ul; j < 2; ++j)
+			BOOST_CHECK_EQUAL( v.at(i,j), t.at(1+i,2*j) );
+
+	auto w = t(ublas::range::all(), ublas::range(2,3));
+	BOOST_CHECK_EQUAL( w.size(), 4ul );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
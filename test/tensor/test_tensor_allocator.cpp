@@ -0,0 +1,335 @@
+//  Copyright (c) 2018-2019 Cem Bassoy
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer and Google in producing this work
+//  which started as a Google Summer of Code project.
+//
+
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <vector>
+#include <boost/numeric/ublas/tensor.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility.hpp"
+
+BOOST_AUTO_TEST_SUITE ( test_tensor_allocator )
+
+using test_types = zip<int,long,float,double,std::complex<float>>::with_t<boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
+
+// counts the elements that are constructed with a value
+template<class value_type>
+struct counting_allocator : std::allocator<value_type>
+{
+	template<class U> struct rebind { using other = counting_allocator<U>; };
+
+	counting_allocator() = default;
+	template<class U> counting_allocator(counting_allocator<U> const&) noexcept {}
+
+	template<class U, class ... Args>
+	void construct(U* p, Args&& ... args)
+	{
+		++count;
+		::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+	}
+
+	static inline std::size_t count = 0u;
+};
+
+template<class value_type>
+bool is_aligned(value_type const* p, std::size_t alignment)
+{
+	return reinterpret_cast<std::uintptr_t>(p) % alignment == 0u;
+}
+
+
+BOOST_AUTO_TEST_CASE( test_tensor_arena_size_classes )
+{
+	using namespace boost::numeric::ublas;
+
+	BOOST_CHECK_EQUAL( detail::arena_class(1u), 0u );
+	BOOST_CHECK_EQUAL( detail::arena_class(64u), 0u );
+	BOOST_CHECK_EQUAL( detail::arena_class_size(0u), 64u );
+	BOOST_CHECK_EQUAL( detail::arena_class(std::size_t(1)<<31), detail::arena_classes );
+
+	auto previous = std::size_t{0};
+	for(auto c = 0u; c < detail::arena_classes; ++c){
+		auto const n = detail::arena_class_size(c);
+		BOOST_CHECK_GT( n, previous );
+		BOOST_CHECK_EQUAL( detail::arena_class(n), c );
+		BOOST_CHECK_EQUAL( detail::arena_class(previous+1u), c );
+		if(c > 0u)
+			BOOST_CHECK_LE( 4u*(n-previous-1u), n );
+		previous = n;
+	}
+	BOOST_CHECK_EQUAL( previous, std::size_t(1)<<30 );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_aligned_allocator, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+
+	for(auto n : {1u, 3u, 17u, 100u, 1000u}){
+		auto v = std::vector<value_type,aligned_allocator<value_type>>(n, value_type{1});
+		BOOST_CHECK( is_aligned(v.data(), BOOST_UBLAS_TENSOR_ALIGNMENT) );
+
+		auto w = std::vector<value_type,aligned_allocator<value_type,256>>(n);
+		BOOST_CHECK( is_aligned(w.data(), 256u) );
+	}
+
+	BOOST_CHECK( aligned_allocator<value_type>{} == aligned_allocator<char>{} );
+	BOOST_CHECK( !(aligned_allocator<value_type>{} != aligned_allocator<char>{}) );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_tensor_arena_scope )
+{
+	using namespace boost::numeric::ublas;
+	using vector_type = std::vector<float,aligned_allocator<float>>;
+
+	BOOST_CHECK( tensor_arena::current() == nullptr );
+
+	auto arena = tensor_arena{};
+	{
+		auto scope = arena_scope(arena);
+		BOOST_CHECK( tensor_arena::current() == &arena );
+
+		auto const* p = vector_type(100u).data();
+		BOOST_CHECK_EQUAL( arena.cached(), detail::arena_class_size(detail::arena_class(400u)) );
+
+		// a block of the same size class is reused
+		auto v = vector_type(97u);
+		BOOST_CHECK_EQUAL( v.data(), p );
+		BOOST_CHECK_EQUAL( arena.cached(), 0u );
+
+		auto inner = tensor_arena{};
+		{
+			auto inner_scope = arena_scope(inner);
+			BOOST_CHECK( tensor_arena::current() == &inner );
+			auto w = vector_type(100u);
+			BOOST_CHECK_NE( w.data(), p );
+		}
+		BOOST_CHECK( tensor_arena::current() == &arena );
+		BOOST_CHECK_GT( inner.cached(), 0u );
+		inner.release();
+		BOOST_CHECK_EQUAL( inner.cached(), 0u );
+
+		// v outlives the scope and is returned to the heap
+	}
+	BOOST_CHECK( tensor_arena::current() == nullptr );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_arena_temporaries, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using array_type  = std::vector<value_type,aligned_allocator<value_type>>;
+	using tensor_type = tensor<value_type,layout_type,array_type>;
+	using reference_type = tensor<value_type,layout_type>;
+
+	auto a = tensor_type(shape{4,3,2});
+	auto b = tensor_type(shape{3,5});
+	auto e = tensor_type(shape{5,2},value_type{3});
+	auto ra = reference_type(a.extents());
+	auto rb = reference_type(b.extents());
+	auto re = reference_type(e.extents(),value_type{3});
+	for(auto i = 0u; i < a.size(); ++i) a[i] = ra[i] = value_type(int(i%7));
+	for(auto i = 0u; i < b.size(); ++i) b[i] = rb[i] = value_type(int(i%5));
+
+	BOOST_CHECK( is_aligned(a.data(), BOOST_UBLAS_TENSOR_ALIGNMENT) );
+
+	auto const rc = reference_type(prod(ra, matrix<value_type,layout_type>(5,3,value_type{2}), 2));
+	auto const rd = reference_type(ra(index::_i,index::_j,index::_k)*rb(index::_j,index::_l)*re(index::_l,index::_m)*value_type{2});
+
+	auto arena = tensor_arena{};
+	auto c = tensor_type{}, d = tensor_type{};
+	for(auto k = 0u; k < 3u; ++k){
+		auto scope = arena_scope(arena);
+		auto const cached = arena.cached();
+
+		c = prod(a, matrix<value_type,layout_type,array_type>(5,3,value_type{2}), 2);
+		d = a(index::_i,index::_j,index::_k)*b(index::_j,index::_l)*e(index::_l,index::_m)*value_type{2};
+
+		BOOST_CHECK( is_aligned(c.data(), BOOST_UBLAS_TENSOR_ALIGNMENT) );
+		BOOST_CHECK( is_aligned(d.data(), BOOST_UBLAS_TENSOR_ALIGNMENT) );
+		BOOST_CHECK( c.extents() == rc.extents() );
+		BOOST_CHECK( d.extents() == rd.extents() );
+		for(auto i = 0u; i < c.size(); ++i)
+			BOOST_CHECK_EQUAL( c[i], rc[i] );
+		for(auto i = 0u; i < d.size(); ++i)
+			BOOST_CHECK_EQUAL( d[i], rd[i] );
+
+		// the blocks of c and d are cached from the second iteration on
+		if(k > 1u)
+			BOOST_CHECK_EQUAL( arena.cached(), cached );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_arena_expression_temporaries, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+
+	auto a = tensor_type(shape{4,3});
+	auto b = tensor_type(shape{3,5});
+	auto e = tensor_type(shape{4,5},value_type{1});
+	for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%7));
+	for(auto i = 0u; i < b.size(); ++i) b[i] = value_type(int(i%5));
+
+	auto const r = tensor_type(prod(a, b, {2}, {1}));
+
+	// the contraction is not fused and materialized into an arena buffer
+	auto const bytes = r.size()*sizeof(value_type);
+	auto const block = detail::arena_class_size(detail::arena_class(bytes));
+
+	auto arena = tensor_arena{};
+	auto d = tensor_type{};
+	for(auto k = 0u; k < 3u; ++k){
+		auto scope = arena_scope(arena);
+		auto const cached = arena.cached();
+
+		d = e + a(index::_i,index::_j)*b(index::_j,index::_k) + e;
+
+		BOOST_CHECK( d.extents() == r.extents() );
+		for(auto i = 0u; i < d.size(); ++i)
+			BOOST_CHECK_EQUAL( d[i], r[i] + value_type{2} );
+
+		// the temporary is returned to the arena and taken from it again
+		BOOST_CHECK_EQUAL( arena.cached(), block );
+		if(k > 0u)
+			BOOST_CHECK_EQUAL( arena.cached(), cached );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_default_init_allocator, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using allocator_type = default_init_allocator<aligned_allocator<value_type>>;
+	using array_type  = std::vector<value_type,allocator_type>;
+	using tensor_type = tensor<value_type,layout_type,array_type>;
+
+	using rebound = typename std::allocator_traits<allocator_type>::template rebind_alloc<char>;
+	static_assert( std::is_same_v<rebound, default_init_allocator<aligned_allocator<char>>> );
+	BOOST_CHECK( allocator_type{} == rebound{} );
+
+	auto v = array_type(5u, value_type{3});
+	BOOST_CHECK( std::all_of(v.begin(), v.end(), [](auto const& x){ return x == value_type{3}; }) );
+	BOOST_CHECK( is_aligned(v.data(), BOOST_UBLAS_TENSOR_ALIGNMENT) );
+
+	// the default storage is zero-initialized even with the tag
+	using default_array = typename tensor<value_type,layout_type>::array_type;
+	static_assert( std::is_same_v<default_array, std::vector<value_type>> );
+	auto z = tensor<value_type,layout_type>(shape{3,4}, uninitialized);
+	BOOST_CHECK( z.extents() == (shape{3,4}) );
+	BOOST_CHECK( std::all_of(z.begin(), z.end(), [](auto const& x){ return x == value_type{}; }) );
+
+	// storage with default_init_allocator is initialized without the tag
+	auto y = tensor_type(shape{3,4});
+	BOOST_CHECK( std::all_of(y.begin(), y.end(), [](auto const& x){ return x == value_type{}; }) );
+
+	auto a = tensor_type(shape{3,4}, uninitialized);
+	BOOST_CHECK( a.extents() == (shape{3,4}) );
+	BOOST_CHECK_EQUAL( a.size(), 12u );
+	for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%5));
+
+	auto const x = vector<value_type>(4, value_type{2});
+	auto const c = prod(a, x, 2);
+	auto const t = trans(a, {2,1});
+	BOOST_CHECK( c.extents() == (shape{3,1}) );
+	for(auto i = 0u; i < 3u; ++i){
+		auto s = value_type{};
+		for(auto j = 0u; j < 4u; ++j){
+			s += a.at(i,j) * value_type{2};
+			BOOST_CHECK_EQUAL( t.at(j,i), a.at(i,j) );
+		}
+		BOOST_CHECK_EQUAL( c[i], s );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_uninitialized_results, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+	using result_type = tensor<value_type,layout_type,std::vector<value_type,default_init_allocator<std::allocator<value_type>>>>;
+
+	// results of the default tensor type are not zero-filled before the kernels write them
+	static_assert( std::is_same_v<typename tensor_type::tensor_temporary_type, result_type> );
+	static_assert( std::is_same_v<typename tensor_view<value_type,layout_type>::tensor_temporary_type, result_type> );
+
+	auto a = tensor_type(shape{3,4});
+	auto b = tensor_type(shape{4,2});
+	for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%5));
+	for(auto i = 0u; i < b.size(); ++i) b[i] = value_type(int(i%3));
+
+	auto const c = prod(a, b, {2}, {1});
+	auto const o = outer_prod(a, b);
+	auto const t = trans(a, {2,1});
+	auto const e = (a + a).template eval<value_type,layout_type>();
+	static_assert( std::is_same_v<std::decay_t<decltype(c)>, result_type> );
+	static_assert( std::is_same_v<std::decay_t<decltype(o)>, result_type> );
+	static_assert( std::is_same_v<std::decay_t<decltype(t)>, result_type> );
+	static_assert( std::is_same_v<std::decay_t<decltype(e)>, result_type> );
+
+	// results convert to the default tensor type
+	tensor_type d = c;
+	BOOST_CHECK( d.extents() == (shape{3,2}) );
+	for(auto i = 0u; i < 3u; ++i)
+		for(auto j = 0u; j < 2u; ++j){
+			auto s = value_type{};
+			for(auto k = 0u; k < 4u; ++k)
+				s += a.at(i,k) * b.at(k,j);
+			BOOST_CHECK_EQUAL( d.at(i,j), s );
+		}
+	d = t;
+	BOOST_CHECK( d.extents() == (shape{4,3}) );
+	for(auto i = 0u; i < 3u; ++i)
+		for(auto j = 0u; j < 4u; ++j)
+			BOOST_CHECK_EQUAL( d.at(j,i), a.at(i,j) );
+	d = e;
+	for(auto i = 0u; i < a.size(); ++i)
+		BOOST_CHECK_EQUAL( d[i], value_type{2}*a[i] );
+	BOOST_CHECK_EQUAL( o.size(), a.size()*b.size() );
+
+	// results are allocated without constructing their elements with a value
+	using counted_array = std::vector<value_type,counting_allocator<value_type>>;
+	using counted_type  = tensor<value_type,layout_type,counted_array>;
+	auto const ca = counted_type(a.extents(), counted_array(a.begin(), a.end()));
+	auto const cb = counted_type(b.extents(), counted_array(b.begin(), b.end()));
+	auto& count = counting_allocator<value_type>::count;
+	count = 0u;
+	auto const cc = prod(ca, cb, {2}, {1});
+	auto const ct = trans(ca, {2,1});
+	BOOST_CHECK_EQUAL( count, 0u );
+	auto const filled = counted_type(shape{3,2});
+	BOOST_CHECK_EQUAL( count, 6u );
+	for(auto i = 0u; i < cc.size(); ++i)
+		BOOST_CHECK_EQUAL( cc[i], c[i] );
+	for(auto i = 0u; i < ct.size(); ++i)
+		BOOST_CHECK_EQUAL( ct[i], t[i] );
+	BOOST_CHECK( filled.extents() == cc.extents() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
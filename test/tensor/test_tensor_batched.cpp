@@ -0,0 +1,171 @@
+//  Copyright (c) 2018-2019 Cem Bassoy
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer and Google in producing this work
+//  which started as a Google Summer of Code project.
+//
+
+
+#include <complex>
+#include <vector>
+#include <boost/numeric/ublas/tensor.hpp>
+#include <boost/numeric/ublas/storage.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility.hpp"
+
+BOOST_AUTO_TEST_SUITE ( test_tensor_batched )
+
+using test_types = zip<int,long,float,double,std::complex<float>>::with_t<boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_batched_prod, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+	using plan_type   = contraction_plan<value_type,layout_type>;
+
+	struct fixture_type {
+		shape na, nb;
+		std::vector<std::size_t> phia, phib;
+	};
+
+	auto const fixtures = std::vector<fixture_type>{
+		{ shape{4,3}, shape{3,5}, {2}, {1} },
+		{ shape{4,3,2}, shape{2,3,5}, {2,3}, {2,1} },
+		{ shape{2,3,4}, shape{2,3,4}, {1,2,3}, {1,2,3} },
+		{ shape{3,2}, shape{4,2}, {}, {} },
+		{ shape{5,4,3,2}, shape{3,4,6}, {2}, {2} },
+		{ shape{2,5,4}, shape{5,1,2}, {1,2}, {3,1} },
+		// large enough for the planned blocked kernel, with and without copies
+		{ shape{16,8,4}, shape{8,4,10}, {2,3}, {1,2} },
+		{ shape{16,4,8}, shape{8,10,4}, {2,3}, {3,1} }
+	};
+
+	auto const batch = 13u;
+
+	for(auto const& f : fixtures){
+		auto a = std::vector<tensor_type>{};
+		auto b = std::vector<tensor_type>{};
+		for(auto k = 0u; k < batch; ++k){
+			a.emplace_back(f.na);
+			b.emplace_back(f.nb);
+			for(auto i = 0u; i < a[k].size(); ++i) a[k][i] = value_type(int((i+k)%5));
+			for(auto i = 0u; i < b[k].size(); ++i) b[k][i] = value_type(int((2*i+k)%7));
+		}
+
+		auto const plan = plan_type(f.na, f.nb, f.phia, f.phib);
+
+		auto c = batched_prod(plan, a, b);
+		BOOST_REQUIRE_EQUAL( c.size(), batch );
+		for(auto k = 0u; k < batch; ++k){
+			auto const r = prod(a[k], b[k], f.phia, f.phib);
+			BOOST_CHECK( c[k].extents() == r.extents() );
+			BOOST_CHECK( plan.extents() == r.extents() );
+			for(auto i = 0u; i < r.size(); ++i)
+				BOOST_CHECK_EQUAL( c[k][i], r[i] );
+		}
+
+		// preallocated outputs are overwritten or accumulated
+		auto d = std::vector<tensor_type>(batch, tensor_type(plan.extents(), value_type{1}));
+		batched_prod(plan, a, b, d);
+		for(auto k = 0u; k < batch; ++k)
+			for(auto i = 0u; i < d[k].size(); ++i)
+				BOOST_CHECK_EQUAL( d[k][i], c[k][i] );
+
+		// outer products always overwrite the outputs
+		auto const factor = f.phia.empty() ? value_type{1} : value_type{2};
+		batched_prod(plan, a, b, d, true);
+		for(auto k = 0u; k < batch; ++k)
+			for(auto i = 0u; i < d[k].size(); ++i)
+				BOOST_CHECK_EQUAL( d[k][i], factor*c[k][i] );
+
+		auto e = plan.make_result();
+		plan(a[1], b[1], e);
+		for(auto i = 0u; i < e.size(); ++i)
+			BOOST_CHECK_EQUAL( e[i], c[1][i] );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_batched_prod_views, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+	using view_type   = tensor_view<value_type,layout_type>;
+	using cview_type  = tensor_view<value_type const,layout_type>;
+
+	// operands are slices of one large tensor each
+	auto const batch = 6u;
+	auto a = tensor_type(shape{4,3,2*batch});
+	auto b = tensor_type(shape{3,5,batch});
+	for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%9));
+	for(auto i = 0u; i < b.size(); ++i) b[i] = value_type(int(i%4));
+
+	auto const& ca = a;
+	auto const& cb = b;
+	auto va = std::vector<cview_type>{};
+	auto vb = std::vector<cview_type>{};
+	for(auto k = 0u; k < batch; ++k){
+		va.push_back(ca(range::all(), range::all(), range(2*k,2*k+2)));
+		vb.push_back(cb(range::all(), range::all(), range(k,k+1)));
+	}
+
+	auto const plan = contraction_plan<value_type,layout_type>(va[0].extents(), vb[0].extents(), {2}, {1});
+	BOOST_CHECK( plan.extents() == (shape{4,2,5,1}) );
+	auto c = tensor_type(shape{4,2,5,batch});
+	auto vc = std::vector<view_type>{};
+	for(auto k = 0u; k < batch; ++k)
+		vc.push_back(c(range::all(), range::all(), range::all(), range(k,k+1)));
+
+	batched_prod(plan, va, vb, vc);
+
+	for(auto k = 0u; k < batch; ++k){
+		auto const r = prod(tensor_type(va[k]), tensor_type(vb[k]), {2}, {1});
+		auto const ck = tensor_type(vc[k]);
+		BOOST_CHECK( ck.extents() == r.extents() );
+		for(auto i = 0u; i < r.size(); ++i)
+			BOOST_CHECK_EQUAL( ck[i], r[i] );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( test_batched_prod_errors )
+{
+	using namespace boost::numeric::ublas;
+	using tensor_type = tensor<float>;
+	using plan_type   = contraction_plan<float>;
+
+	BOOST_CHECK_THROW( plan_type(shape{4,3}, shape{4,3}, {2}, {1}), std::runtime_error );
+	BOOST_CHECK_THROW( plan_type(shape{4,3}, shape{3,4}, {2}, {1,2}), std::runtime_error );
+	BOOST_CHECK_THROW( plan_type(shape{4,4}, shape{4,4}, {1,1}, {1,2}), std::runtime_error );
+	BOOST_CHECK_THROW( plan_type(shape{4,3}, shape{3,4}, {3}, {1}), std::runtime_error );
+	BOOST_CHECK_THROW( plan_type(shape{2,2}, shape{2,2}, {1,2,1}, {1,2,2}), std::runtime_error );
+
+	auto const plan = plan_type(shape{4,3}, shape{3,5}, {2}, {1});
+	BOOST_CHECK( plan.extents() == (shape{4,5}) );
+	BOOST_CHECK_EQUAL( plan.work(), 60u );
+
+	auto a = std::vector<tensor_type>(3, tensor_type(shape{4,3}));
+	auto b = std::vector<tensor_type>(3, tensor_type(shape{3,5}));
+	auto c = std::vector<tensor_type>(2, plan.make_result());
+	BOOST_CHECK_THROW( batched_prod(plan, a, b, c), std::length_error );
+
+	c.push_back(tensor_type(shape{5,4}));
+	BOOST_CHECK_THROW( batched_prod(plan, a, b, c), std::runtime_error );
+
+	b[2] = tensor_type(shape{3,4});
+	BOOST_CHECK_THROW( batched_prod(plan, a, b), std::runtime_error );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
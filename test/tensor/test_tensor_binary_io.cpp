@@ -0,0 +1,193 @@
+//  Copyright (c) 2018-2019 Cem Bassoy
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer and Google in producing this work
+//  which started as a Google Summer of Code project.
+//
+
+
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <boost/numeric/ublas/tensor.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility.hpp"
+
+BOOST_AUTO_TEST_SUITE ( test_tensor_binary_io )
+
+using test_types = zip<int,long,float,double,std::complex<float>>::with_t<boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
+
+
+BOOST_AUTO_TEST_CASE( test_file_checksum_chunks )
+{
+	using namespace boost::numeric::ublas;
+
+	auto bytes = std::vector<char>(1000u);
+	for(auto i = 0u; i < bytes.size(); ++i) bytes[i] = char(i*7u);
+
+	auto whole = file_checksum{};
+	whole.update(bytes.data(), bytes.size());
+
+	for(auto chunk : {1u, 3u, 8u, 13u, 999u}){
+		auto sum = file_checksum{};
+		for(auto i = 0u; i < bytes.size(); i += chunk)
+			sum.update(bytes.data()+i, std::min<std::size_t>(chunk, bytes.size()-i));
+		BOOST_CHECK_EQUAL( sum.value(), whole.value() );
+	}
+
+	auto other = file_checksum{};
+	bytes[500] ^= 1;
+	other.update(bytes.data(), bytes.size());
+	BOOST_CHECK_NE( other.value(), whole.value() );
+
+	auto shorter = file_checksum{};
+	shorter.update(bytes.data(), bytes.size()-1u);
+	BOOST_CHECK_NE( shorter.value(), other.value() );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_binary_round_trip, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+	using aligned_type = tensor<value_type,layout_type,std::vector<value_type,aligned_allocator<value_type>>>;
+
+	for(auto const& e : {shape{1,1}, shape{4,3}, shape{4,3,2}, shape{2,3,4,5}}){
+		auto a = tensor_type(e);
+		for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%11));
+
+		for(auto checksum : {false, true}){
+			auto s = std::stringstream{};
+			write_binary(s, a, checksum);
+			BOOST_CHECK_EQUAL( s.str().size(), file_header::size_of(e.size()) + a.size()*sizeof(value_type) );
+
+			auto b = read_binary<value_type,layout_type>(s);
+			BOOST_CHECK( bool(b == a) );
+
+			s.seekg(0);
+			auto c = aligned_type{};
+			read_binary(s, c);
+			BOOST_CHECK( c.extents() == e );
+			for(auto i = 0u; i < c.size(); ++i)
+				BOOST_CHECK_EQUAL( c[i], a[i] );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_binary_streaming, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+
+	auto const e = shape{5,4,3};
+	auto a = tensor_type(e);
+	for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%13));
+
+	auto s = std::stringstream{};
+	{
+		auto w = tensor_writer<value_type,layout_type>(s, e, true);
+		for(auto i = 0u; w.remaining() > 0u; i += 7u)
+			w.write(a.data()+i, std::min<std::size_t>(7u, w.remaining()));
+		BOOST_CHECK_THROW( w.write(a.data(), 1u), std::length_error );
+		w.close();
+	}
+
+	auto expected = std::stringstream{};
+	write_binary(expected, a, true);
+	BOOST_CHECK( s.str() == expected.str() );
+
+	auto r = tensor_reader<value_type,layout_type>(s);
+	BOOST_CHECK( r.extents() == e );
+	BOOST_CHECK( (r.header().flags & file_header::has_checksum) != 0u );
+	auto b = tensor_type(e);
+	auto n = std::size_t{0};
+	while(r.remaining() > 0u)
+		n += r.read(b.data()+n, 11u);
+	BOOST_CHECK_EQUAL( n, a.size() );
+	BOOST_CHECK_EQUAL( r.read(b.data(), 1u), 0u );
+	BOOST_CHECK( bool(b == a) );
+
+	auto incomplete = std::stringstream{};
+	auto w = tensor_writer<value_type,layout_type>(incomplete, e);
+	w.write(a.data(), 3u);
+	BOOST_CHECK_THROW( w.close(), std::length_error );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_binary_errors, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+	using other_layout = std::conditional_t<std::is_same_v<layout_type,first_order>, last_order, first_order>;
+
+	auto a = tensor_type(shape{4,3,2}, value_type{2});
+	auto s = std::stringstream{};
+	write_binary(s, a, true);
+	auto const bytes = s.str();
+
+	auto corrupted = bytes;
+	corrupted[bytes.size()-1u] ^= 1;
+	auto s1 = std::stringstream(corrupted);
+	BOOST_CHECK_THROW( (read_binary<value_type,layout_type>(s1)), std::runtime_error );
+
+	auto truncated = std::stringstream(bytes.substr(0u, bytes.size()-3u));
+	BOOST_CHECK_THROW( (read_binary<value_type,layout_type>(truncated)), std::runtime_error );
+
+	auto s2 = std::stringstream(bytes);
+	BOOST_CHECK_THROW( (read_binary<value_type,other_layout>(s2)), std::runtime_error );
+
+	auto s3 = std::stringstream(bytes);
+	BOOST_CHECK_THROW( (read_binary<char,layout_type>(s3)), std::runtime_error );
+
+	auto s4 = std::stringstream(std::string(100u, 'x'));
+	BOOST_CHECK_THROW( (read_binary<value_type,layout_type>(s4)), std::runtime_error );
+
+	// corrupted headers are rejected before the extents or the padding are read
+	auto const set = [&bytes](std::size_t offset, std::uint64_t v){
+		auto b = bytes;
+		std::memcpy(b.data()+offset, &v, sizeof(v));
+		return b;
+	};
+	auto s5 = std::stringstream(set(32u, std::uint64_t(1) << 60));
+	BOOST_CHECK_THROW( (read_binary<value_type,layout_type>(s5)), std::runtime_error );
+	auto s6 = std::stringstream(set(32u, 3000u));
+	BOOST_CHECK_THROW( (read_binary<value_type,layout_type>(s6)), std::runtime_error );
+	auto s7 = std::stringstream(set(40u, std::uint64_t(1) << 40));
+	BOOST_CHECK_THROW( (read_binary<value_type,layout_type>(s7)), std::runtime_error );
+	auto s8 = std::stringstream(set(40u, 192u));
+	BOOST_CHECK_THROW( (read_binary<value_type,layout_type>(s8)), std::runtime_error );
+	auto s9 = std::stringstream(bytes.substr(0u, 80u));
+	BOOST_CHECK_THROW( (read_binary<value_type,layout_type>(s9)), std::runtime_error );
+
+	// checksums are written into the header after the elements
+	struct sink_type : std::streambuf {
+		std::size_t count = 0u;
+		int_type overflow(int_type c) override { ++count; return c; }
+	};
+	auto sink = sink_type{};
+	auto unseekable = std::ostream(&sink);
+	write_binary(unseekable, a);
+	BOOST_CHECK_EQUAL( sink.count, bytes.size() );
+	BOOST_CHECK_THROW( write_binary(unseekable, a, true), std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
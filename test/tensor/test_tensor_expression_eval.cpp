@@ -12,11 +12,14 @@
 #include <boost/numeric/ublas/tensor/expression_operator.hpp>
 #include <boost/numeric/ublas/tensor/tensor.hpp>
 #include <boost/numeric/ublas/tensor/tensor_expression.hpp>
+#include <boost/numeric/ublas/storage.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include "utility.hpp"
 
+#include <cmath>
 #include <functional>
+#include <limits>
 
 using test_types = zip<int, long, float, double, std::complex<float>>::with_t<
     boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
@@ -126,4 +129,458 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(test_tensor_expression_eval_to, value,
       BOOST_CHECK_EQUAL(result3(st), static_cast<value_type>(
                                          ((2.0f * t(st)) / (t(st) + 1.0f))));
   }
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_tensor_expression_eval_plan, value,
+                              test_types) {
+  using namespace boost::numeric;
+  using value_type = typename value::first_type;
+  using layout_type = typename value::second_type;
+  using tensor_type = ublas::tensor<value_type, layout_type>;
+
+  auto const threshold = ublas::get_parallel_threshold();
+
+  for (auto work : {threshold, std::size_t{0}}) {
+    ublas::set_parallel_threshold(work);
+
+    auto a = tensor_type{ublas::shape{31, 17, 3}};
+    auto b = tensor_type{ublas::shape{31, 17, 3}};
+    for (auto i = 0u; i < a.size(); ++i) {
+      a[i] = value_type(i % 5 + 1);
+      b[i] = value_type(i % 3 + 1);
+    }
+
+    tensor_type c = -a + b * value_type{2} - (+b);
+    for (auto i = 0u; i < c.size(); ++i)
+      BOOST_CHECK_EQUAL(c[i], -a[i] + b[i] * value_type{2} - b[i]);
+
+    tensor_type d = ublas::apply(a * b + value_type{1},
+                                 [](auto const &x) { return x * x; });
+    for (auto i = 0u; i < d.size(); ++i)
+      BOOST_CHECK_EQUAL(d[i], (a[i] * b[i] + value_type{1}) *
+                                  (a[i] * b[i] + value_type{1}));
+
+    // the target may be an operand of the expression
+    c = c + a;
+    for (auto i = 0u; i < c.size(); ++i)
+      BOOST_CHECK_EQUAL(c[i], -a[i] + b[i] * value_type{2} - b[i] + a[i]);
+  }
+
+  ublas::set_parallel_threshold(threshold);
+}
+
+using packed_test_types =
+    zip<float, double, std::complex<float>, std::complex<double>>::with_t<
+        boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_tensor_expression_eval_packed, value,
+                              packed_test_types) {
+  using namespace boost::numeric;
+  using value_type = typename value::first_type;
+  using layout_type = typename value::second_type;
+  using tensor_type = ublas::tensor<value_type, layout_type>;
+  using real_type = decltype(std::abs(value_type{}));
+
+  auto const tolerance = real_type(1e-5);
+  auto const close = [tolerance](value_type const &x, value_type const &y) {
+    return std::abs(x - y) <= tolerance * std::max(real_type(1), std::abs(y));
+  };
+
+  // the number of elements is not a multiple of a register width
+  auto a = tensor_type{ublas::shape{31, 17, 3}};
+  auto b = tensor_type{ublas::shape{31, 17, 3}};
+  for (auto i = 0u; i < a.size(); ++i) {
+    a[i] = value_type(real_type(i % 5 + 1) / real_type(4));
+    b[i] = value_type(real_type(i % 3 + 1) / real_type(8));
+  }
+
+  tensor_type c = a * b - -a + real_type(3) * b / real_type(2);
+  for (auto i = 0u; i < c.size(); ++i)
+    BOOST_CHECK(close(c[i], a[i] * b[i] + a[i] + real_type(3) * b[i] /
+                                                     real_type(2)));
+
+  tensor_type d = ublas::apply(a + b, ublas::elementwise::sqrt);
+  tensor_type e = ublas::apply(a - b * b, ublas::elementwise::exp);
+  tensor_type f = ublas::apply(a / b, ublas::elementwise::sqrt,
+                               ublas::elementwise::exp);
+  for (auto i = 0u; i < d.size(); ++i) {
+    BOOST_CHECK(close(d[i], std::sqrt(a[i] + b[i])));
+    BOOST_CHECK(close(e[i], std::exp(a[i] - b[i] * b[i])));
+    BOOST_CHECK(close(f[i], std::exp(std::sqrt(a[i] / b[i]))));
+  }
+
+  // real operands are combined with split complex registers element by element
+  if constexpr (!std::is_same_v<value_type, real_type>) {
+    auto r = ublas::tensor<real_type, layout_type>{a.extents()};
+    for (auto i = 0u; i < r.size(); ++i)
+      r[i] = real_type(i % 7 + 1) / real_type(2);
+
+    tensor_type m = a * r + r - b / r;
+    for (auto i = 0u; i < m.size(); ++i)
+      BOOST_CHECK(close(m[i], a[i] * r[i] + r[i] - b[i] / r[i]));
+  }
+
+  // the exponential function is applied on packed registers of real numbers
+  auto g = ublas::apply(a - b * b, ublas::elementwise::exp);
+  using plan_type = decltype(ublas::detail::make_plan<layout_type>(g));
+  static_assert(plan_type::template packable<real_type>() ==
+                (std::is_same_v<value_type, real_type> &&
+                 ublas::detail::simd::pack<real_type>::width > 1u));
+
+  // and is accurate over the whole range including overflow and underflow
+  auto x = tensor_type{ublas::shape{97, 3}};
+  auto const lo = std::log(std::numeric_limits<real_type>::denorm_min());
+  auto const hi = std::log(std::numeric_limits<real_type>::max());
+  for (auto i = 0u; i < x.size(); ++i)
+    x[i] = value_type(lo - real_type(2) +
+                      (hi - lo + real_type(4)) * real_type(i) /
+                          real_type(x.size() - 1u));
+  x[1] = value_type(0);
+  x[2] = value_type(-std::numeric_limits<real_type>::infinity());
+  x[3] = value_type(std::numeric_limits<real_type>::infinity());
+  x[4] = value_type(std::numeric_limits<real_type>::quiet_NaN());
+  tensor_type y = ublas::apply(x, ublas::elementwise::exp);
+  BOOST_CHECK(std::isnan(std::real(y[4])));
+  for (auto i = 0u; i < y.size(); ++i) {
+    if (i == 4u) continue;
+    auto const r = std::exp(std::real(x[i]));
+    auto const v = std::real(y[i]);
+    if (std::isinf(r))
+      BOOST_CHECK(std::isinf(v) && v > 0);
+    else
+      BOOST_CHECK_LE(std::abs(v - r),
+                     8 * std::numeric_limits<real_type>::epsilon() * r +
+                         2 * std::numeric_limits<real_type>::denorm_min());
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_tensor_expression_eval_mixed_layout, value,
+                              test_types) {
+  using namespace boost::numeric;
+  using value_type = typename value::first_type;
+  using layout_type = typename value::second_type;
+  using other_layout_type =
+      std::conditional_t<std::is_same_v<layout_type, ublas::first_order>,
+                         ublas::last_order, ublas::first_order>;
+  using tensor_type = ublas::tensor<value_type, layout_type>;
+  using other_tensor_type = ublas::tensor<value_type, other_layout_type>;
+
+  auto const threshold = ublas::get_parallel_threshold();
+
+  for (auto work : {threshold, std::size_t{0}}) {
+    ublas::set_parallel_threshold(work);
+
+    for (auto const &n :
+         {ublas::shape{37, 45, 3}, ublas::shape{1, 70, 1, 40},
+          ublas::shape{50, 1}, ublas::shape{3, 4, 5, 6}}) {
+      auto a = tensor_type{n};
+      auto b = other_tensor_type{n};
+      for (auto i = 0u; i < a.size(); ++i) {
+        a[i] = value_type(i % 7 + 1);
+        b[i] = value_type(i % 11 + 1);
+      }
+
+      // compares the elements of a tensor with a function of the multi-index
+      auto const check = [&n](auto const &t, auto const &f) {
+        auto const &w = t.strides();
+        for (auto i = 0u; i < t.size(); ++i) {
+          auto r = i;
+          auto idx = std::vector<std::size_t>(n.size());
+          for (auto k = 0u; k < n.size(); ++k) {
+            auto const m = std::is_same_v<typename std::decay_t<decltype(
+                                              t)>::layout_type,
+                                          ublas::first_order>
+                               ? n.size() - 1 - k
+                               : k;
+            idx[m] = r / w[m];
+            r %= w[m];
+          }
+          BOOST_CHECK_EQUAL(t[i], f(idx));
+        }
+      };
+      auto const offset = [&n](auto const &t, auto const &idx) {
+        auto j = std::size_t{0};
+        for (auto k = 0u; k < n.size(); ++k) j += idx[k] * t.strides()[k];
+        return j;
+      };
+      auto const sum = [&](auto const &idx) {
+        return a[offset(a, idx)] + value_type{2} * b[offset(b, idx)];
+      };
+
+      tensor_type c = a + value_type{2} * b;
+      check(c, sum);
+
+      other_tensor_type d = a + value_type{2} * b;
+      check(d, sum);
+
+      tensor_type e = ublas::apply(b - a, [](auto const &x) { return x * x; });
+      check(e, [&](auto const &idx) {
+        auto const x = b[offset(b, idx)] - a[offset(a, idx)];
+        return x * x;
+      });
+
+      // the repeated difference is computed once per element
+      tensor_type g = (b - a) * a + (b - a);
+      check(g, [&](auto const &idx) {
+        auto const x = b[offset(b, idx)] - a[offset(a, idx)];
+        return x * a[offset(a, idx)] + x;
+      });
+
+      other_tensor_type f = b;
+      BOOST_CHECK((bool)(a + b == b + a));
+      BOOST_CHECK((bool)(f == b));
+      BOOST_CHECK((bool)(c != a));
+    }
+  }
+
+  ublas::set_parallel_threshold(threshold);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_tensor_expression_eval_broadcast, value,
+                              test_types) {
+  using namespace boost::numeric;
+  using value_type = typename value::first_type;
+  using layout_type = typename value::second_type;
+  using other_layout_type =
+      std::conditional_t<std::is_same_v<layout_type, ublas::first_order>,
+                         ublas::last_order, ublas::first_order>;
+  using tensor_type = ublas::tensor<value_type, layout_type>;
+  using other_tensor_type = ublas::tensor<value_type, other_layout_type>;
+
+  // element of a broadcast operand at the multi-index idx of the result
+  auto const at = [](auto const &t, auto const &idx) {
+    auto j = std::size_t{0};
+    for (auto k = 0u; k < t.rank(); ++k)
+      if (t.extents()[k] > 1u) j += idx[k] * t.strides()[k];
+    return t.data()[j];
+  };
+  // compares the elements of a tensor with a function of the multi-index
+  auto const check = [](auto const &t, auto const &f) {
+    auto const &n = t.extents();
+    auto const &w = t.strides();
+    for (auto i = 0u; i < t.size(); ++i) {
+      auto idx = std::vector<std::size_t>(n.size());
+      for (auto k = 0u; k < n.size(); ++k) idx[k] = i / w[k] % n[k];
+      BOOST_CHECK_EQUAL(t[i], f(idx));
+    }
+  };
+
+  auto const threshold = ublas::get_parallel_threshold();
+
+  for (auto work : {threshold, std::size_t{0}}) {
+    ublas::set_parallel_threshold(work);
+
+    auto x = tensor_type{ublas::shape{5, 4, 3, 2}};
+    auto mean = tensor_type{ublas::shape{1, 4, 1, 1}};
+    auto scale = tensor_type{ublas::shape{1, 4}};
+    auto bias = other_tensor_type{ublas::shape{5, 1, 3}};
+    for (auto i = 0u; i < x.size(); ++i) x[i] = value_type(i % 7 + 1);
+    for (auto i = 0u; i < mean.size(); ++i) mean[i] = value_type(i + 1);
+    for (auto i = 0u; i < scale.size(); ++i) scale[i] = value_type(3 - i % 2);
+    for (auto i = 0u; i < bias.size(); ++i) bias[i] = value_type(i % 4);
+
+    auto const normalized = [&](auto const &idx) {
+      return (at(x, idx) - at(mean, idx)) * at(scale, idx) + at(bias, idx) +
+             value_type{1};
+    };
+
+    tensor_type c = (x - mean) * scale + bias + value_type{1};
+    BOOST_CHECK(c.extents() == x.extents());
+    check(c, normalized);
+
+    other_tensor_type d = (x - mean) * scale + bias + value_type{1};
+    check(d, normalized);
+
+    other_tensor_type h = (x - mean) * scale + (x - mean);
+    check(h, [&](auto const &idx) {
+      return (at(x, idx) - at(mean, idx)) * at(scale, idx) +
+             (at(x, idx) - at(mean, idx));
+    });
+
+    // views are read with their strides at the broadcast multi-index
+    auto y = tensor_type{ublas::shape{2, 4, 3, 2}};
+    for (auto i = 0u; i < y.size(); ++i) y[i] = value_type(i % 5);
+    auto const v = y(ublas::range(1, 2), ublas::range::all(),
+                     ublas::range(2, 3), ublas::range::all());
+    tensor_type e = x * v - mean;
+    check(e, [&](auto const &idx) {
+      return at(x, idx) * y.at(1, idx[1], 2, idx[3]) - at(mean, idx);
+    });
+
+    auto z = tensor_type{ublas::shape{5, 4, 3, 2}, value_type{}};
+    z(ublas::range::all(), ublas::range::all(), ublas::range::all(),
+      ublas::range::all()) = x + mean;
+    check(z, [&](auto const &idx) { return at(x, idx) + at(mean, idx); });
+
+    // compound assignment broadcasts the right-hand side
+    tensor_type f = x;
+    f += mean;
+    f -= scale * value_type{2};
+    check(f, [&](auto const &idx) {
+      return at(x, idx) + at(mean, idx) - at(scale, idx) * value_type{2};
+    });
+    BOOST_CHECK_THROW(mean += x, std::runtime_error);
+
+    // the target may be a broadcast operand of the expression
+    tensor_type g = mean;
+    g = g + x;
+    check(g, [&](auto const &idx) { return at(mean, idx) + at(x, idx); });
+
+    BOOST_CHECK((bool)(x + mean == mean + x));
+    BOOST_CHECK((bool)(x * scale != x * scale + value_type{1}));
+
+    // == and != compare the extents of both sides without broadcasting them
+    auto const ones = tensor_type{ublas::shape{5, 4, 3, 2}, value_type{1}};
+    auto const one = tensor_type{ublas::shape{5, 1, 3, 1}, value_type{1}};
+    BOOST_CHECK(!(bool)(ones == one));
+    BOOST_CHECK((bool)(ones != one));
+    BOOST_CHECK((bool)(ones == one + ones - ones));
+    // ordering comparisons broadcast both sides
+    if constexpr (std::is_arithmetic_v<value_type>) {
+      BOOST_CHECK((bool)(x + mean > mean));
+      BOOST_CHECK((bool)(ones <= one));
+    }
+
+    auto const n = tensor_type{ublas::shape{5, 3}};
+    if constexpr (std::is_arithmetic_v<value_type>)
+      BOOST_CHECK_THROW((bool)(x < n), std::runtime_error);
+    BOOST_CHECK_THROW(tensor_type h = x + n, std::runtime_error);
+    BOOST_CHECK_THROW(tensor_type h = mean + n, std::runtime_error);
+  }
+
+  ublas::set_parallel_threshold(threshold);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_tensor_expression_eval_aliasing, value,
+                              test_types) {
+  using namespace boost::numeric;
+  using value_type = typename value::first_type;
+  using layout_type = typename value::second_type;
+  using tensor_type = ublas::tensor<value_type, layout_type>;
+  using view_type = ublas::tensor_view<value_type, layout_type>;
+  using ublas::range;
+  using ublas::detail::aliasing;
+  using ublas::detail::get_expression_aliasing;
+
+  auto const init = [](auto &t, int k) {
+    for (auto i = 0u; i < t.size(); ++i) t[i] = value_type((i * k) % 11 + 1);
+  };
+
+  auto a = tensor_type{ublas::shape{6, 3}};
+  auto b = tensor_type{ublas::shape{6, 3}};
+  init(a, 3);
+  init(b, 5);
+  auto const a0 = a;
+
+  // the target is read at the multi-index that is written
+  BOOST_CHECK(get_expression_aliasing(b + value_type{1}, a, a.extents()) ==
+              aliasing::none);
+  BOOST_CHECK(get_expression_aliasing(a * value_type{2} + b, a, a.extents()) ==
+              aliasing::elementwise);
+  auto const *data = a.data();
+  a = a * value_type{2} + b;
+  BOOST_CHECK_EQUAL(a.data(), data);
+  for (auto i = 0u; i < a.size(); ++i)
+    BOOST_CHECK_EQUAL(a[i], a0[i] * value_type{2} + b[i]);
+
+  a = a0;
+  a += a;
+  for (auto i = 0u; i < a.size(); ++i)
+    BOOST_CHECK_EQUAL(a[i], a0[i] + a0[i]);
+
+  // views of the target at another offset are read before they are written
+  a = a0;
+  auto const lower = a(range(0, 5), range::all());
+  auto const upper = a(range(1, 6), range::all());
+  BOOST_CHECK(get_expression_aliasing(upper + value_type{1}, lower,
+                                      lower.extents()) == aliasing::unsafe);
+  BOOST_CHECK(get_expression_aliasing(lower + value_type{1}, lower,
+                                      lower.extents()) == aliasing::elementwise);
+  a(range(0, 5), range::all()) = a(range(1, 6), range::all()) + value_type{1};
+  for (auto i = 0u; i < 5u; ++i)
+    for (auto j = 0u; j < 3u; ++j)
+      BOOST_CHECK_EQUAL(a.at(i, j), a0.at(i + 1, j) + value_type{1});
+
+  a = a0;
+  a(range(1, 6), range::all()) += a(range(0, 5), range::all());
+  for (auto i = 0u; i < 5u; ++i)
+    for (auto j = 0u; j < 3u; ++j)
+      BOOST_CHECK_EQUAL(a.at(i + 1, j), a0.at(i + 1, j) + a0.at(i, j));
+
+  // transposed view of the target
+  auto c = tensor_type{ublas::shape{3, 3}};
+  init(c, 7);
+  auto const c0 = c;
+  auto const &w = c.strides();
+  auto const t = view_type(c.data(), c.extents(),
+                           {std::ptrdiff_t(w[1]), std::ptrdiff_t(w[0])});
+  BOOST_CHECK(get_expression_aliasing(t * value_type{2}, c, c.extents()) ==
+              aliasing::unsafe);
+  c = t * value_type{2};
+  for (auto i = 0u; i < 3u; ++i)
+    for (auto j = 0u; j < 3u; ++j)
+      BOOST_CHECK_EQUAL(c.at(i, j), c0.at(j, i) * value_type{2});
+
+  // the target is resized before it is written
+  a = a0;
+  a = a(range(2, 4), range::all()) + b(range(0, 2), range::all());
+  BOOST_CHECK(a.extents() == (ublas::shape{2, 3}));
+  for (auto i = 0u; i < 2u; ++i)
+    for (auto j = 0u; j < 3u; ++j)
+      BOOST_CHECK_EQUAL(a.at(i, j), a0.at(i + 2, j) + b.at(i, j));
+
+  auto d = tensor_type{ublas::shape{2, 3}};
+  init(d, 2);
+  auto const d0 = d;
+  d = d(range(1, 2), range::all()) + b;
+  BOOST_CHECK(d.extents() == b.extents());
+  for (auto i = 0u; i < 6u; ++i)
+    for (auto j = 0u; j < 3u; ++j)
+      BOOST_CHECK_EQUAL(d.at(i, j), d0.at(1, j) + b.at(i, j));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_tensor_expression_eval_static_extents,
+                              value, test_types) {
+  using namespace boost::numeric;
+  using value_type = typename value::first_type;
+  using layout_type = typename value::second_type;
+  using array_type = std::vector<value_type>;
+  using tensor_type = ublas::tensor<value_type, layout_type>;
+  using static_type = ublas::tensor<value_type, layout_type, array_type,
+                                    ublas::static_extents<4, 2, 3>>;
+  using column_type = ublas::tensor<value_type, layout_type, array_type,
+                                    ublas::static_extents<4, 1, 1>>;
+  using fixed_type = ublas::tensor<value_type, layout_type, array_type,
+                                   ublas::fixed_rank_extents<3>>;
+
+  auto a = static_type{};
+  auto s = column_type{};
+  auto d = tensor_type{ublas::shape{4, 2, 3}};
+  for (auto i = 0u; i < a.size(); ++i) a[i] = value_type(i % 5 + 1);
+  for (auto i = 0u; i < s.size(); ++i) s[i] = value_type(i + 1);
+  for (auto i = 0u; i < d.size(); ++i) d[i] = value_type(i % 3);
+
+  static_type b = a + d * value_type{2};
+  for (auto i = 0u; i < b.size(); ++i)
+    BOOST_CHECK_EQUAL(b[i], a[i] + d[i] * value_type{2});
+
+  tensor_type e = a * s;
+  fixed_type f = a - d;
+  BOOST_CHECK(e.extents() == a.extents());
+  BOOST_CHECK(f.extents() == a.extents());
+  for (auto i = 0u; i < 4u; ++i)
+    for (auto j = 0u; j < 2u; ++j)
+      for (auto k = 0u; k < 3u; ++k) {
+        BOOST_CHECK_EQUAL(e.at(i, j, k), a.at(i, j, k) * s.at(i, 0, 0));
+        BOOST_CHECK_EQUAL(f.at(i, j, k), a.at(i, j, k) - d.at(i, j, k));
+      }
+
+  b = a;
+  b += d;
+  for (auto i = 0u; i < b.size(); ++i)
+    BOOST_CHECK_EQUAL(b[i], a[i] + d[i]);
+
+  auto const c = tensor_type{ublas::shape{4, 3, 2}};
+  auto const g = tensor_type{ublas::shape{4, 3}};
+  BOOST_CHECK_THROW(b = c + value_type{1}, std::length_error);
+  BOOST_CHECK_THROW(b += g, std::runtime_error);
+}
@@ -0,0 +1,357 @@
+//  Copyright (c) 2018-2019 Cem Bassoy
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer and Google in producing this work
+//  which started as a Google Summer of Code project.
+//
+
+
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/numeric/ublas/tensor.hpp>
+#include <boost/numeric/ublas/tensor/mapped_storage.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestTensorMapped
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility.hpp"
+
+BOOST_AUTO_TEST_SUITE ( test_tensor_mapped )
+
+using test_types = zip<int,long,float,double,std::complex<float>>::with_t<boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
+
+// creates an empty file with a unique name in the temporary directory
+struct temporary_file
+{
+	temporary_file()
+	{
+		auto const* dir = std::getenv("TMPDIR");
+		auto name = std::string(dir && *dir ? dir : "/tmp") + "/ublas_tensor_XXXXXX";
+		auto const fd = ::mkstemp(name.data());
+		BOOST_REQUIRE( fd >= 0 );
+		::close(fd);
+		path = name;
+	}
+	~temporary_file() { std::remove(path.c_str()); }
+
+	static std::size_t size_of(std::string const& path)
+	{
+		struct stat s {};
+		return ::stat(path.c_str(), &s) == 0 ? std::size_t(s.st_size) : 0u;
+	}
+
+	std::string path;
+};
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_mapped_array_anonymous, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using array_type  = mapped_array<value_type>;
+
+	auto a = array_type{};
+	BOOST_CHECK( a.empty() );
+	BOOST_CHECK_EQUAL( a.data(), nullptr );
+
+	auto b = array_type(100u);
+	BOOST_CHECK_EQUAL( b.size(), 100u );
+	BOOST_CHECK( !b.is_mapped_file() );
+	for(auto const& x : b) BOOST_CHECK_EQUAL( x, value_type{} );
+
+	auto c = array_type(50u, value_type{2});
+	for(auto const& x : c) BOOST_CHECK_EQUAL( x, value_type{2} );
+
+	c.resize(60u, value_type{3});
+	BOOST_CHECK_EQUAL( c.size(), 60u );
+	BOOST_CHECK_EQUAL( c[49], value_type{2} );
+	BOOST_CHECK_EQUAL( c[50], value_type{3} );
+
+	a = c;
+	BOOST_CHECK_EQUAL( a.size(), 60u );
+	BOOST_CHECK_NE( a.data(), c.data() );
+	BOOST_CHECK_EQUAL( a[59], value_type{3} );
+
+	auto const* p = a.data();
+	auto d = std::move(a);
+	BOOST_CHECK_EQUAL( d.data(), p );
+	BOOST_CHECK( a.empty() );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_mapped_tensor_create_open, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+
+	auto file = temporary_file{};
+	auto const e = shape{4,3,2};
+	{
+		auto a = create_mapped_tensor<value_type,layout_type>(file.path, e);
+		BOOST_CHECK( a.extents() == e );
+		BOOST_CHECK( a.base().is_mapped_file() );
+		for(auto const& x : a) BOOST_CHECK_EQUAL( x, value_type{} );
+		for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%7));
+		a.base().sync();
+	}
+
+	auto const h = read_file_header(file.path);
+	BOOST_CHECK( h.type == dtype_of<value_type>() );
+	BOOST_CHECK_EQUAL( h.element_size, sizeof(value_type) );
+	BOOST_CHECK( h.extents == e );
+	BOOST_CHECK_EQUAL( h.data_offset % 64u, 0u );
+	BOOST_CHECK_EQUAL( h.data_size, e.product()*sizeof(value_type) );
+	BOOST_CHECK_EQUAL( temporary_file::size_of(file.path), h.data_offset + h.data_size );
+
+	auto b = open_mapped_tensor<value_type,layout_type>(file.path, mapped_mode::read_only, mapped_access::sequential);
+	BOOST_CHECK( b.extents() == e );
+	for(auto i = 0u; i < b.size(); ++i)
+		BOOST_CHECK_EQUAL( b[i], value_type(int(i%7)) );
+
+	// modifications of a private mapping are not written to the file
+	{
+		auto c = open_mapped_tensor<value_type,layout_type>(file.path, mapped_mode::copy_on_write);
+		c[0] = value_type{42};
+		BOOST_CHECK_EQUAL( c[0], value_type{42} );
+		BOOST_CHECK_EQUAL( b[0], value_type{0} );
+	}
+
+	// expressions are evaluated into the file
+	{
+		auto d = open_mapped_tensor<value_type,layout_type>(file.path);
+		d.base().prefetch(0u, d.size());
+		d = d + d;
+		BOOST_CHECK_THROW( d.base().resize(5u), std::length_error );
+	}
+	for(auto i = 0u; i < b.size(); ++i)
+		BOOST_CHECK_EQUAL( b[i], value_type(2*int(i%7)) );
+
+	using other_layout = std::conditional_t<std::is_same_v<layout_type,first_order>, last_order, first_order>;
+	BOOST_CHECK_THROW( (open_mapped_tensor<value_type,other_layout>(file.path)), std::runtime_error );
+	BOOST_CHECK_THROW( (open_mapped_tensor<char,layout_type>(file.path)), std::runtime_error );
+	BOOST_CHECK_THROW( (open_mapped_tensor<value_type,layout_type>(file.path + ".missing")), std::system_error );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_mapped_tensor_operations, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using reference_type = tensor<value_type,layout_type>;
+
+	auto file = temporary_file{};
+	auto a = create_mapped_tensor<value_type,layout_type>(file.path, shape{4,3,2});
+	auto ra = reference_type(a.extents());
+	for(auto i = 0u; i < a.size(); ++i) a[i] = ra[i] = value_type(int(i%5));
+
+	auto const m = matrix<value_type,layout_type>(5,3,value_type{2});
+	auto const c = prod(a, m, 2);
+	auto const rc = prod(ra, m, 2);
+	BOOST_CHECK( c.extents() == rc.extents() );
+	BOOST_CHECK( !c.base().is_mapped_file() );
+	for(auto i = 0u; i < c.size(); ++i)
+		BOOST_CHECK_EQUAL( c[i], rc[i] );
+
+	auto const d = reference_type(a*value_type{2} + ra);
+	for(auto i = 0u; i < d.size(); ++i)
+		BOOST_CHECK_EQUAL( d[i], value_type{3}*ra[i] );
+
+	BOOST_CHECK_EQUAL( inner_prod(a, ra), inner_prod(ra, ra) );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_mapped_tensor_assignment, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using mapped_type = mapped_tensor<value_type,layout_type>;
+
+	// only tensors that swap their arrays are moved without throwing
+	static_assert( !std::is_nothrow_move_assignable_v<mapped_type> );
+	static_assert(  std::is_nothrow_move_assignable_v<tensor<value_type,layout_type>> );
+
+	auto file = temporary_file{};
+	auto a = create_mapped_tensor<value_type,layout_type>(file.path, shape{4,3,2});
+	auto const data = a.data();
+
+	// copies and moves are written into the mapped file
+	auto b = mapped_type(shape{4,3,2}, value_type{3});
+	a = b;
+	BOOST_CHECK( a.base().is_mapped_file() );
+	BOOST_CHECK_EQUAL( a.data(), data );
+	BOOST_CHECK( !b.empty() );
+	for(auto i = 0u; i < b.size(); ++i) b[i] = value_type(int(i));
+	a = std::move(b);
+	BOOST_CHECK( a.base().is_mapped_file() );
+	BOOST_CHECK_EQUAL( a.data(), data );
+	a.base().sync();
+
+	auto const c = open_mapped_tensor<value_type,layout_type>(file.path, mapped_mode::read_only);
+	for(auto i = 0u; i < c.size(); ++i)
+		BOOST_CHECK_EQUAL( c[i], value_type(int(i)) );
+
+	// the file cannot be resized
+	BOOST_CHECK_THROW( a = mapped_type(shape{4,3}), std::length_error );
+	BOOST_CHECK( a.extents() == (shape{4,3,2}) );
+
+	// the extents in the header of the file cannot be changed
+	BOOST_CHECK_THROW( a = mapped_type(shape{2,3,4}, value_type{7}), std::length_error );
+	BOOST_CHECK_THROW( a = mapped_type(shape{6,4}) + value_type{1}, std::length_error );
+	BOOST_CHECK_THROW( a.reshape(shape{6,4}), std::length_error );
+	BOOST_CHECK( a.extents() == (shape{4,3,2}) );
+	a.base().sync();
+	{
+		auto const reopened = open_mapped_tensor<value_type,layout_type>(file.path, mapped_mode::read_only);
+		BOOST_CHECK( reopened.extents() == (shape{4,3,2}) );
+		for(auto i = 0u; i < reopened.size(); ++i)
+			BOOST_CHECK_EQUAL( reopened[i], value_type(int(i)) );
+	}
+
+	// anonymous mappings are resized
+	auto d = mapped_type(shape{2,2});
+	d = c;
+	BOOST_CHECK( d.extents() == c.extents() );
+	BOOST_CHECK( !d.base().is_mapped_file() );
+	for(auto i = 0u; i < d.size(); ++i)
+		BOOST_CHECK_EQUAL( d[i], c[i] );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_file_header_corrupted )
+{
+	using namespace boost::numeric::ublas;
+
+	auto h = file_header::make<float,first_order>(shape{2,3});
+	auto bytes = h.encode();
+	BOOST_CHECK_EQUAL( bytes.size(), 128u );
+	BOOST_CHECK( file_header::decode(bytes.data(), bytes.size()).extents == (shape{2,3}) );
+
+	auto const set = [](std::vector<char> b, std::size_t offset, std::uint64_t v){
+		std::memcpy(b.data()+offset, &v, sizeof(v));
+		return b;
+	};
+
+	auto wrong_size = bytes;
+	wrong_size[48] = 1;
+	BOOST_CHECK_THROW( file_header::decode(wrong_size.data(), wrong_size.size()), std::runtime_error );
+
+	auto wrong_magic = bytes;
+	wrong_magic[0] = 'X';
+	BOOST_CHECK_THROW( file_header::decode(wrong_magic.data(), wrong_magic.size()), std::runtime_error );
+
+	// the rank must not exceed the buffer or max_rank
+	BOOST_CHECK_THROW( file_header::decode(bytes.data(), 64u+16u), std::runtime_error );
+	BOOST_CHECK_THROW( file_header::decode(bytes.data(), 32u), std::runtime_error );
+	auto const large_rank = set(bytes, 32u, std::uint64_t(1) << 60);
+	BOOST_CHECK_THROW( file_header::rank_of(large_rank.data()), std::runtime_error );
+	BOOST_CHECK_THROW( file_header::decode(large_rank.data(), large_rank.size()), std::runtime_error );
+
+	// the data offset must be aligned and lie behind the extents and strides
+	auto const small_offset = set(bytes, 40u, 64u);
+	BOOST_CHECK_THROW( file_header::decode(small_offset.data(), small_offset.size()), std::runtime_error );
+	auto const unaligned_offset = set(bytes, 40u, 130u);
+	BOOST_CHECK_THROW( file_header::decode(unaligned_offset.data(), unaligned_offset.size()), std::runtime_error );
+
+	// the number of bytes of the elements must not overflow
+	auto huge = set(bytes, 64u, std::uint64_t(1) << 62);
+	huge = set(huge, 72u, 8u);
+	huge = set(huge, 48u, 0u);
+	BOOST_CHECK_THROW( file_header::decode(huge.data(), huge.size()), std::runtime_error );
+
+	// a truncated or corrupted file is rejected before its elements are mapped
+	auto file = temporary_file{};
+	auto const write = [&file](std::vector<char> const& b, std::size_t n){
+		auto* f = std::fopen(file.path.c_str(), "wb");
+		std::fwrite(b.data(), 1u, n, f);
+		std::fclose(f);
+	};
+	write(bytes, 80u);
+	BOOST_CHECK_THROW( read_file_header(file.path), std::runtime_error );
+	write(bytes, 40u);
+	BOOST_CHECK_THROW( read_file_header(file.path), std::runtime_error );
+	write(set(bytes, 32u, 1000u), bytes.size());
+	BOOST_CHECK_THROW( read_file_header(file.path), std::runtime_error );
+	write(large_rank, large_rank.size());
+	BOOST_CHECK_THROW( (open_mapped_tensor<float,first_order>(file.path)), std::runtime_error );
+	write(bytes, bytes.size());
+	BOOST_CHECK_THROW( (open_mapped_tensor<float,first_order>(file.path)), std::runtime_error );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_binary_mapped_round_trip, value,  test_types)
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+
+	auto file = temporary_file{};
+	auto const& path = file.path;
+	auto a = tensor_type(shape{4,3,2});
+	for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%7));
+
+	// written with write_binary and mapped
+	{
+		auto out = std::ofstream(path, std::ios::binary);
+		write_binary(out, a, true);
+	}
+	{
+		auto m = open_mapped_tensor<value_type,layout_type>(path, mapped_mode::read_only);
+		BOOST_CHECK( m.extents() == a.extents() );
+		for(auto i = 0u; i < m.size(); ++i)
+			BOOST_CHECK_EQUAL( m[i], a[i] );
+
+		// a mapped tensor is written as any other tensor
+		auto s = std::stringstream{};
+		write_binary(s, m);
+		auto b = read_binary<value_type,layout_type>(s);
+		BOOST_CHECK( bool(b == a) );
+	}
+
+	// created as mapped tensor and read with read_binary
+	{
+		auto m = create_mapped_tensor<value_type,layout_type>(path, shape{2,3});
+		for(auto i = 0u; i < m.size(); ++i) m[i] = value_type(int(i+1));
+		m.base().sync();
+
+		auto in = std::ifstream(path, std::ios::binary);
+		auto b = read_binary<value_type,layout_type>(in);
+		BOOST_CHECK( b.extents() == (shape{2,3}) );
+		for(auto i = 0u; i < b.size(); ++i)
+			BOOST_CHECK_EQUAL( b[i], value_type(int(i+1)) );
+
+		// read in place into the mapped file
+		auto s = std::stringstream{};
+		write_binary(s, tensor_type(shape{2,3}, value_type{5}));
+		read_binary(s, m);
+		BOOST_CHECK( m.base().is_mapped_file() );
+	}
+	{
+		auto m = open_mapped_tensor<value_type,layout_type>(path, mapped_mode::read_only);
+		for(auto i = 0u; i < m.size(); ++i)
+			BOOST_CHECK_EQUAL( m[i], value_type{5} );
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
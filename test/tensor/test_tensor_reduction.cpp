@@ -0,0 +1,266 @@
+//  Copyright (c) 2018-2019 Cem Bassoy
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer and Google in producing this work
+//  which started as a Google Summer of Code project.
+//
+
+
+#include <algorithm>
+#include <complex>
+#include <functional>
+#include <numeric>
+#include <vector>
+#include <boost/numeric/ublas/tensor.hpp>
+#include <boost/numeric/ublas/storage.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility.hpp"
+
+BOOST_AUTO_TEST_SUITE ( test_tensor_reduction )
+
+using test_types = zip<int,long,float,double,std::complex<float>>::with_t<boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
+using real_types = zip<int,long,float,double>::with_t<boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
+
+
+struct fixture
+{
+	using extents_type = boost::numeric::ublas::shape;
+	fixture()
+		: extents {
+			extents_type{1,1},
+			extents_type{1,2},
+			extents_type{2,1},
+			extents_type{7,3},
+			extents_type{3,2,5},
+			extents_type{4,1,3,2},
+			extents_type{37,2,3},
+			extents_type{2,3,4,5,3}}
+	{}
+	std::vector<extents_type> extents;
+};
+
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_sum, value,  test_types, fixture )
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+
+	BOOST_CHECK_EQUAL( sum(tensor_type{}), value_type{} );
+
+	for(auto const& n : extents){
+		auto a = tensor_type(n);
+		for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%7));
+
+		auto const r = std::accumulate(a.begin(), a.end(), value_type{});
+		BOOST_CHECK_EQUAL( sum(a), r );
+
+		auto const s = std::inner_product(a.begin(), a.end(), a.begin(), value_type{});
+		BOOST_CHECK_EQUAL( norm(a), std::sqrt(s) );
+
+		BOOST_CHECK_EQUAL( any(a), std::any_of(a.begin(), a.end(), [](auto x){ return x != value_type{}; }) );
+		BOOST_CHECK_EQUAL( all(a), std::all_of(a.begin(), a.end(), [](auto x){ return x != value_type{}; }) );
+	}
+}
+
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_min_max, value,  real_types, fixture )
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+
+	BOOST_CHECK_THROW( min(tensor_type{}), std::runtime_error );
+	BOOST_CHECK_THROW( max(tensor_type{}), std::runtime_error );
+
+	for(auto const& n : extents){
+		auto a = tensor_type(n);
+		for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int((i*5)%11) - 4);
+
+		BOOST_CHECK_EQUAL( min(a), *std::min_element(a.begin(), a.end()) );
+		BOOST_CHECK_EQUAL( max(a), *std::max_element(a.begin(), a.end()) );
+
+		// extremes at the first and the last element
+		a[a.size()-1] = value_type{-9};
+		a[0] = value_type{9};
+		BOOST_CHECK_EQUAL( max(a), value_type{9} );
+		BOOST_CHECK_EQUAL( min(a), a.size() > 1u ? value_type{-9} : value_type{9} );
+
+		BOOST_CHECK( any(a, [](auto x){ return x == value_type{9}; }) );
+		BOOST_CHECK( !any(a, [](auto x){ return x > value_type{9}; }) );
+		BOOST_CHECK( all(a, [](auto x){ return x >= value_type{-9}; }) );
+		BOOST_CHECK_EQUAL( all(a, [](auto x){ return x > value_type{-9}; }), a.size() == 1u );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_reduction_views, value,  real_types )
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+
+	auto a = tensor_type(shape{9,8,7});
+	for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int((i*7)%13));
+
+	// strided sub-tensor whose contiguous mode is not the innermost one
+	auto const v = a(slice(1,2,4), range(1,7), slice(0,3,3));
+	auto const b = tensor_type(v);
+
+	BOOST_CHECK_EQUAL( sum(v), sum(b) );
+	BOOST_CHECK_EQUAL( norm(v), norm(b) );
+	BOOST_CHECK_EQUAL( min(v), min(b) );
+	BOOST_CHECK_EQUAL( max(v), max(b) );
+
+	auto const t = trans(b, {3,1,2});
+	BOOST_CHECK_EQUAL( sum(t), sum(b) );
+	BOOST_CHECK_EQUAL( max(t), max(b) );
+}
+
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( test_tensor_reduce_modes, value,  test_types, fixture )
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+
+	for(auto const& n : extents){
+		auto a = tensor_type(n);
+		auto b = tensor_type(n);
+		for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%9));
+		for(auto i = 0u; i < b.size(); ++i) b[i] = value_type(i%3 == 0u ? -1 : 1);
+		auto const p = n.size();
+
+		// all subsets of modes
+		for(auto set = 0u; set < (1u << p); ++set){
+			auto modes = std::vector<std::size_t>{};
+			for(auto i = 0u; i < p; ++i)
+				if(set & (1u << i)) modes.push_back(i+1);
+
+			auto const c = reduce(a, modes, std::plus<>{});
+			auto const d = reduce(b, modes, std::multiplies<>{});
+			auto const e = reduce(a, modes, [](auto l, auto r){ return l + r*r; }, value_type{1});
+
+			auto nc = std::vector<std::size_t>{};
+			for(auto i = 0u; i < p; ++i)
+				if(!(set & (1u << i))) nc.push_back(n[i]);
+			while(nc.size() < 2u) nc.push_back(1u);
+			BOOST_REQUIRE( c.extents() == shape(nc.begin(), nc.end()) );
+
+			auto rc = tensor_type(c.extents(), value_type{0});
+			auto rd = tensor_type(c.extents(), value_type{1});
+			auto re = tensor_type(c.extents(), value_type{1});
+
+			// reference with multi-indices
+			auto idx = std::vector<std::size_t>(p, 0u);
+			for(auto k = 0u; k < a.size(); ++k){
+				auto j = std::size_t(0), ja = std::size_t(0);
+				for(auto i = 0u, l = 0u; i < p; ++i){
+					ja += idx[i]*a.strides()[i];
+					if(!(set & (1u << i))) j += idx[i]*c.strides()[l++];
+				}
+				rc[j] += a[ja];
+				rd[j] *= b[ja];
+				re[j] += a[ja]*a[ja];
+
+				for(auto i = 0u; i < p && ++idx[i] == n[i]; ++i)
+					idx[i] = 0u;
+			}
+
+			for(auto j = 0u; j < c.size(); ++j){
+				BOOST_CHECK_EQUAL( c[j], rc[j] );
+				BOOST_CHECK_EQUAL( d[j], rd[j] );
+				BOOST_CHECK_EQUAL( e[j], re[j] );
+			}
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_summation_policies, value,  test_types )
+{
+	using namespace boost::numeric::ublas;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = tensor<value_type,layout_type>;
+
+	auto a = tensor_type(shape{37,5,300});
+	auto b = tensor_type(shape{37,5,300});
+	for(auto i = 0u; i < a.size(); ++i) a[i] = value_type(int(i%5));
+	for(auto i = 0u; i < b.size(); ++i) b[i] = value_type(int(i%3)-1);
+
+	// small integers are summed up exactly with every policy
+	auto const s = sum(a);
+	auto const d = inner_prod(a, b);
+	auto const n = norm(a);
+	BOOST_CHECK_EQUAL( sum(a, naive_summation{}), s );
+	BOOST_CHECK_EQUAL( sum(a, pairwise_summation{}), s );
+	BOOST_CHECK_EQUAL( sum(a, compensated_summation{}), s );
+	BOOST_CHECK_EQUAL( inner_prod(a, b, pairwise_summation{}), d );
+	BOOST_CHECK_EQUAL( inner_prod(a, b, compensated_summation{}), d );
+	BOOST_CHECK_EQUAL( norm(a, pairwise_summation{}), n );
+	BOOST_CHECK_EQUAL( norm(a, compensated_summation{}), n );
+
+	// strided views
+	auto const v = a(slice(1,3,12), range::all(), slice(1,2,150));
+	auto const w = b(slice(1,3,12), range::all(), slice(1,2,150));
+	auto const c = tensor_type(v);
+	BOOST_CHECK_EQUAL( sum(v, pairwise_summation{}), sum(c) );
+	BOOST_CHECK_EQUAL( sum(v, compensated_summation{}), sum(c) );
+	BOOST_CHECK_EQUAL( inner_prod(v, w, pairwise_summation{}), inner_prod(c, tensor_type(w)) );
+	BOOST_CHECK_EQUAL( norm(trans(c,{3,1,2}), compensated_summation{}), norm(c) );
+
+	auto const e = tensor_type(shape{1,1}, value_type{3});
+	BOOST_CHECK_EQUAL( sum(e, pairwise_summation{}), value_type{3} );
+	BOOST_CHECK_EQUAL( sum(e, compensated_summation{}), value_type{3} );
+	BOOST_CHECK_EQUAL( sum(tensor_type{}, pairwise_summation{}), value_type{} );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_tensor_summation_accuracy )
+{
+	using namespace boost::numeric::ublas;
+
+	// 0.1f is not representable so that every addition of the naive sum rounds
+	auto a = tensor<float>(shape{1u<<12,1u<<10}, 0.1f);
+	auto const exact = double(0.1f) * double(a.size());
+
+	auto const error = [exact](float s) { return std::abs(double(s) - exact) / exact; };
+
+	BOOST_CHECK_LT( error(sum(a, pairwise_summation{})), 1e-6 );
+	BOOST_CHECK_LT( error(sum(a, compensated_summation{})), 1e-7 );
+	BOOST_CHECK_LT( error(inner_prod(a, a, pairwise_summation{})/0.1f), 1e-6 );
+	BOOST_CHECK_LT( error(inner_prod(a, a, compensated_summation{})/0.1f), 1e-6 );
+
+	auto const v = a(range::all(), slice(0,2,512));
+	BOOST_CHECK_LT( std::abs(double(sum(v, compensated_summation{})) - exact/2) / (exact/2), 1e-7 );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_tensor_reduce_errors )
+{
+	using namespace boost::numeric::ublas;
+	using tensor_type = tensor<float>;
+
+	auto a = tensor_type(shape{3,4,2}, 1.0f);
+	BOOST_CHECK_THROW( reduce(a, {0}, std::plus<>{}), std::runtime_error );
+	BOOST_CHECK_THROW( reduce(a, {4}, std::plus<>{}), std::runtime_error );
+	BOOST_CHECK_THROW( reduce(a, {2,2}, std::plus<>{}), std::runtime_error );
+
+	auto const c = reduce(a, {1,3}, std::plus<>{});
+	BOOST_CHECK( c.extents() == (shape{4,1}) );
+	for(auto const& x : c) BOOST_CHECK_EQUAL( x, 6.0f );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,381 @@
+//  Copyright (c) 2018-2019 Cem Bassoy
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+//  The authors gratefully acknowledge the support of
+//  Fraunhofer and Google in producing this work
+//  which started as a Google Summer of Code project.
+//
+
+
+#include <complex>
+#include <vector>
+#include <boost/numeric/ublas/tensor.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility.hpp"
+
+BOOST_AUTO_TEST_SUITE ( test_tensor_view )
+
+template<class iterator, class value_type>
+void fill_sequence(iterator first, iterator last, value_type v)
+{
+	for(; first != last; ++first, v += value_type{1})
+		*first = v;
+}
+
+using test_types = zip<int,long,float,double,std::complex<float>>::with_t<boost::numeric::ublas::first_order, boost::numeric::ublas::last_order>;
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_view_ctor, value,  test_types)
+{
+	using namespace boost::numeric;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using view_type   = ublas::tensor_view<value_type, layout_type>;
+	using strides_type = ublas::basic_strides<std::size_t,layout_type>;
+	using index_type  = typename view_type::difference_type;
+
+	auto v1 = view_type{};
+	BOOST_CHECK( v1.empty() );
+	BOOST_CHECK_EQUAL( v1.size(), 0ul );
+	BOOST_CHECK_EQUAL( v1.data(), nullptr );
+
+	auto m = std::vector<value_type>(4*3*2);
+	auto v2 = view_type(m.data(), ublas::shape{4,3,2});
+	BOOST_CHECK( !v2.empty() );
+	BOOST_CHECK_EQUAL( v2.size(), m.size() );
+	BOOST_CHECK_EQUAL( v2.rank(), 3ul );
+	BOOST_CHECK_EQUAL( v2.data(), m.data() );
+	auto const w2 = strides_type(v2.extents());
+	for(auto r = 0ul; r < v2.rank(); ++r)
+		BOOST_CHECK_EQUAL( v2.stride(r), index_type(w2[r]) );
+	BOOST_CHECK( v2.is_contiguous() );
+
+	auto v3 = view_type(m.data(), ublas::shape{2,3,2}, {2,4,12});
+	BOOST_CHECK_EQUAL( v3.stride(0), 2 );
+	BOOST_CHECK_EQUAL( v3.stride(1), 4 );
+	BOOST_CHECK_EQUAL( v3.stride(2), 12 );
+	BOOST_CHECK( !v3.is_contiguous() );
+
+	auto v4 = view_type(m.data(), ublas::shape{4,3,2}, std::vector<std::size_t>{1,4,12});
+	BOOST_CHECK_EQUAL( v4.stride(2), 12 );
+
+	BOOST_CHECK_THROW( view_type(m.data(), ublas::shape{4,3,2}, {1,4}), std::length_error );
+
+	// negative strides traverse the modes backwards from the last element
+	fill_sequence(m.begin(), m.end(), value_type{});
+	auto v7 = view_type(m.data()+m.size()-1, ublas::shape{4,3,2}, {-1,-4,-12});
+	BOOST_CHECK_EQUAL( v7.stride(1), -4 );
+	BOOST_CHECK( !v7.is_contiguous() );
+	for(auto i = 0ul; i < 4; ++i)
+		for(auto j = 0ul; j < 3; ++j)
+			for(auto k = 0ul; k < 2; ++k)
+				BOOST_CHECK_EQUAL( v7.at(i,j,k), m[23 - i - 4*j - 12*k] );
+
+	auto v8 = view_type(m.data()+8, ublas::shape{4,3,2}, std::vector<index_type>{1,-4,12});
+	BOOST_CHECK_EQUAL( v8.at(3,2,1), m[3 + 12] );
+
+	auto t = ublas::tensor<value_type, layout_type>{4,3,2};
+	auto v5 = view_type(t);
+	BOOST_CHECK_EQUAL( v5.data(), t.data() );
+	BOOST_CHECK( v5.extents() == t.extents() );
+
+	auto v6 = ublas::tensor_view<value_type const, layout_type>(v5);
+	BOOST_CHECK_EQUAL( v6.data(), t.data() );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_view_access, value,  test_types)
+{
+	using namespace boost::numeric;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using view_type   = ublas::tensor_view<value_type, layout_type>;
+
+	// last-order memory of a 4x3x2 tensor read in first-order
+	auto m = std::vector<value_type>(4*3*2);
+	fill_sequence(m.begin(), m.end(), value_type{});
+	auto v = view_type(m.data(), ublas::shape{4,3,2}, {6,2,1});
+
+	for(auto i = 0ul; i < 4; ++i)
+		for(auto j = 0ul; j < 3; ++j)
+			for(auto k = 0ul; k < 2; ++k)
+				BOOST_CHECK_EQUAL( v.at(i,j,k), m[6*i + 2*j + k] );
+
+	auto w = ublas::basic_strides<std::size_t,layout_type>(v.extents());
+	for(auto i = 0ul; i < 4; ++i)
+		for(auto j = 0ul; j < 3; ++j)
+			for(auto k = 0ul; k < 2; ++k){
+				auto const l = i*w[0] + j*w[1] + k*w[2];
+				BOOST_CHECK_EQUAL( v[l], v.at(i,j,k) );
+				BOOST_CHECK_EQUAL( v(l), v.at(i,j,k) );
+			}
+
+	v.at(1,2,1) = value_type{100};
+	BOOST_CHECK_EQUAL( m[6 + 4 + 1], value_type{100} );
+
+	v = value_type{2};
+	for(auto const& e : m)
+		BOOST_CHECK_EQUAL( e, value_type{2} );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_view_copy, value,  test_types)
+{
+	using namespace boost::numeric;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = ublas::tensor<value_type, layout_type>;
+
+	// every second element of a 4x6 last-order matrix
+	auto m = std::vector<value_type>(4*6);
+	fill_sequence(m.begin(), m.end(), value_type{});
+	auto v = ublas::tensor_view<value_type const, layout_type>(m.data(), ublas::shape{4,3}, {6,2});
+
+	auto t = tensor_type(v);
+	BOOST_CHECK( t.extents() == v.extents() );
+	for(auto i = 0ul; i < 4; ++i)
+		for(auto j = 0ul; j < 3; ++j)
+			BOOST_CHECK_EQUAL( t.at(i,j), m[6*i+2*j] );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_view_expression, value,  test_types)
+{
+	using namespace boost::numeric;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = ublas::tensor<value_type, layout_type>;
+	using view_type   = ublas::tensor_view<value_type, layout_type>;
+
+	auto m = std::vector<value_type>(4*3*2);
+	fill_sequence(m.begin(), m.end(), value_type{});
+	auto v = view_type(m.data(), ublas::shape{4,3,2}, {6,2,1});
+	auto c = view_type(m.data(), ublas::shape{4,3,2}, {1,4,12});
+
+	auto a = tensor_type{4,3,2};
+	fill_sequence(a.begin(), a.end(), value_type{1});
+
+	tensor_type b = value_type{2}*v + a - c;
+	for(auto i = 0ul; i < 4; ++i)
+		for(auto j = 0ul; j < 3; ++j)
+			for(auto k = 0ul; k < 2; ++k)
+				BOOST_CHECK_EQUAL( b.at(i,j,k), value_type{2}*v.at(i,j,k) + a.at(i,j,k) - c.at(i,j,k) );
+
+	BOOST_CHECK( bool(v + a == a + v) );
+
+	// views are lowered into an evaluation plan, views with the strides of the
+	// target are read like tensors and other views with their own strides
+	auto w = view_type(m.data(), ublas::shape{4,3,2});
+	auto e = value_type{2}*w + a;
+	static_assert( ublas::detail::is_plannable<decltype(e)>() );
+	using plan_type = decltype(ublas::detail::make_plan<layout_type>(e));
+	static_assert( std::is_same_v<decltype(plan_type::left.right), ublas::detail::plan_tensor<value_type>> );
+	BOOST_CHECK( ublas::detail::has_target_strides(e, a.rank(), a.strides().data()) );
+	BOOST_CHECK( !ublas::detail::has_target_strides(ublas::reverse(w, 2) + a, a.rank(), a.strides().data()) );
+
+	tensor_type d = e;
+	for(auto i = 0ul; i < d.size(); ++i)
+		BOOST_CHECK_EQUAL( d[i], value_type{2}*w[i] + a[i] );
+	tensor_type r = ublas::reverse(w, 2) + a;
+	for(auto i = 0ul; i < 4; ++i)
+		for(auto j = 0ul; j < 3; ++j)
+			for(auto k = 0ul; k < 2; ++k)
+				BOOST_CHECK_EQUAL( r.at(i,j,k), w.at(i,2-j,k) + a.at(i,j,k) );
+
+	// evaluates into strided memory without a temporary
+	auto n = std::vector<value_type>(4*3*2*2);
+	auto u = view_type(n.data(), ublas::shape{4,3,2}, {2,8,24});
+	u = a + v;
+	for(auto i = 0ul; i < 4; ++i)
+		for(auto j = 0ul; j < 3; ++j)
+			for(auto k = 0ul; k < 2; ++k){
+				BOOST_CHECK_EQUAL( n[2*i+8*j+24*k], a.at(i,j,k) + v.at(i,j,k) );
+				BOOST_CHECK_EQUAL( n[2*i+8*j+24*k+1], value_type{} );
+			}
+
+	auto s = view_type(n.data(), ublas::shape{4,3,2});
+	s = a*value_type{3};
+	for(auto i = 0ul; i < a.size(); ++i)
+		BOOST_CHECK_EQUAL( s[i], value_type{3}*a[i] );
+
+	BOOST_CHECK_THROW( (u = tensor_type{4,3} + value_type{1}), std::runtime_error );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_view_functions, value,  test_types)
+{
+	using namespace boost::numeric;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = ublas::tensor<value_type, layout_type>;
+	using view_type   = ublas::tensor_view<value_type const, layout_type>;
+
+	for(auto n : std::vector<std::size_t>{3,24}){
+		// small integers so that sums in different orders are equal
+		auto m = std::vector<value_type>(n*n*n);
+		for(auto i = 0ul; i < m.size(); ++i)
+			m[i] = value_type(int(i%7));
+
+		// the view permutes the modes of the memory, the tensor is its copy
+		auto v = view_type(m.data(), ublas::shape{n,n,n}, std::vector<std::size_t>{n*n,1,n});
+		auto a = tensor_type(v);
+
+		auto check = [](auto const& x, auto const& y){
+			BOOST_CHECK( x.extents() == y.extents() );
+			for(auto i = 0ul; i < x.size(); ++i)
+				BOOST_CHECK_EQUAL( x[i], y[i] );
+		};
+
+		auto b = ublas::vector<value_type>(n, value_type{2});
+		for(auto q = 1ul; q <= 3ul; ++q)
+			check( ublas::prod(v, b, q), ublas::prod(a, b, q) );
+
+		auto c = ublas::matrix<value_type,layout_type>(n+1, n, value_type{2});
+		for(auto q = 1ul; q <= 3ul; ++q)
+			check( ublas::prod(v, c, q), ublas::prod(a, c, q) );
+
+		auto phia = std::vector<std::size_t>{1,3};
+		auto phib = std::vector<std::size_t>{2,1};
+		check( ublas::prod(v, v, phia, phib), ublas::prod(a, a, phia, phib) );
+		check( ublas::prod(a, v, phia, phib), ublas::prod(a, a, phia, phib) );
+		check( ublas::prod(v, a, phia), ublas::prod(a, a, phia) );
+
+		BOOST_CHECK_EQUAL( ublas::inner_prod(v, v), ublas::inner_prod(a, a) );
+		BOOST_CHECK_EQUAL( ublas::inner_prod(v, a), ublas::inner_prod(a, a) );
+		BOOST_CHECK_EQUAL( ublas::norm(v), ublas::norm(a) );
+
+		auto tau = std::vector<std::size_t>{3,1,2};
+		check( ublas::trans(v, tau), ublas::trans(a, tau) );
+
+		for(auto q = 1ul; q <= 3ul; ++q)
+			check( ublas::reverse(v, q), ublas::reverse(a, q) );
+
+		if(n < 10u)
+			check( ublas::outer_prod(v, a), ublas::outer_prod(a, a) );
+
+		// results of views have the default storage of tensors
+		tensor_type d = ublas::prod(v, b, 3);
+		check( d, ublas::prod(a, b, 3) );
+		tensor_type t = ublas::trans(v, tau);
+		check( t, ublas::trans(a, tau) );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_tensor_view_subtensor, value,  test_types)
+{
+	using namespace boost::numeric;
+	using value_type  = typename value::first_type;
+	using layout_type = typename value::second_type;
+	using tensor_type = ublas::tensor<value_type, layout_type>;
+
+	auto a = tensor_type{6,5,8};
+	fill_sequence(a.begin(), a.end(), value_type{});
+
+	auto b = a(ublas::range(1,4), ublas::range::all(), ublas::slice(1,3,3));
+	BOOST_CHECK( b.extents() == (ublas::shape{3,5,3}) );
+	for(auto i = 0ul; i < 3; ++i)
+		for(auto j = 0ul; j < 5; ++j)
+			for(auto k = 0ul; k < 3; ++k)
+				BOOST_CHECK_EQUAL( b.at(i,j,k), a.at(1+i,j,1+3*k) );
+
+	// sub-tensor of a sub-tensor
+	auto c = b(ublas::slice(0,2,2), ublas::range(1,3), ublas::range(1,2));
+	for(auto i = 0ul; i < 2; ++i)
+		for(auto j = 0ul; j < 2; ++j)
+			BOOST_CHECK_EQUAL( c.at(i,j,0), a.at(1+2*i,1+j,4) );
+
+	// modes are traversed backwards by views with a negative stride
+	auto r = ublas::reverse(b, 3);
+	BOOST_CHECK( r.extents() == b.extents() );
+	BOOST_CHECK_EQUAL( r.stride(2), -b.stride(2) );
+	BOOST_CHECK_EQUAL( r.data(), &b.at(0,0,2) );
+	for(auto i = 0ul; i < 3; ++i)
+		for(auto j = 0ul; j < 5; ++j)
+			for(auto k = 0ul; k < 3; ++k)
+				BOOST_CHECK_EQUAL( r.at(i,j,k), a.at(1+i,j,7-3*k) );
+	BOOST_CHECK_THROW( ublas::reverse(b, 0), std::length_error );
+	BOOST_CHECK_THROW( ublas::reverse(b, 4), std::length_error );
+
+	auto rs = a(ublas::slice(5,-1,3), ublas::range::all(), ublas::slice(7,-3,3));
+	BOOST_CHECK_EQUAL( rs.stride(0), -a.strides()[0] );
+	for(auto i = 0ul; i < 3; ++i)
+		for(auto j = 0ul; j < 5; ++j)
+			for(auto k = 0ul; k < 3; ++k)
+				BOOST_CHECK_EQUAL( rs.at(i,j,k), a.at(5-i,j,7-3*k) );
+	auto rr = ublas::reverse(ublas::reverse(a, 2), 2);
+	BOOST_CHECK( rr.is_contiguous() );
+	BOOST_CHECK_EQUAL( rr.data(), a.data() );
+
+	auto const& ca = a;
+	auto d = ca(ublas::range(0,2), ublas::range(0,2), ublas::range(0,2));
+	BOOST_CHECK( (std::is_same_v<typename decltype(d)::element_type, value_type const>) );
+	BOOST_CHECK_EQUAL( d.at(1,1,1), a.at(1,1,1) );
+
+	BOOST_CHECK_THROW( a(ublas::range(0,7), ublas::range::all(), ublas::range::all()), std::out_of_range );
+	BOOST_CHECK_THROW( a(ublas::slice(0,2,4), ublas::range::all(), ublas::range::all()), std::out_of_range );
+	BOOST_CHECK_THROW( a(ublas::slice(1,-1,3), ublas::range::all(), ublas::range::all()), std::out_of_range );
+	BOOST_CHECK_THROW( a(ublas::range::all(), ublas::range::all()), std::length_error );
+
+	// tiles are updated in place
+	auto e = tensor_type{6,5,8};
+	auto f = tensor_type(ublas::shape{2,5,4}, value_type{1});
+	e(ublas::range(0,2), ublas::range::all(), ublas::range(4,8)) = f + f;
+	e(ublas::range(0,2), ublas::range::all(), ublas::range(4,8)) += f;
+	e(ublas::range(2,4), ublas::range::all(), ublas::range(0,4)) = e(ublas::range(0,2), ublas::range::all(), ublas::range(4,8));
+	for(auto i = 0ul; i < 6; ++i)
+		for(auto j = 0ul; j < 5; ++j)
+			for(auto k = 0ul; k < 8; ++k){
+				auto const in_first  = i < 2 && k >= 4;
+				auto const in_second = i >= 2 && i < 4 && k < 4;
+				BOOST_CHECK_EQUAL( e.at(i,j,k), (in_first || in_second) ? value_type{3} : value_type{} );
+			}
+
+	BOOST_CHECK_THROW( (e(ublas::range(0,2), ublas::range::all(), ublas::range(4,8)) = a), std::runtime_error );
+
+	// reversed tiles are written backwards, also by expressions that read them
+	auto fs = tensor_type(ublas::shape{2,5,4});
+	fill_sequence(fs.begin(), fs.end(), value_type{});
+	auto ev = ublas::reverse(e(ublas::range(0,2), ublas::range::all(), ublas::range(4,8)), 1);
+	ev = fs;
+	for(auto i = 0ul; i < 2; ++i)
+		for(auto j = 0ul; j < 5; ++j)
+			for(auto k = 0ul; k < 4; ++k)
+				BOOST_CHECK_EQUAL( e.at(i,j,4+k), fs.at(1-i,j,k) );
+	ev = ev + fs;
+	for(auto i = 0ul; i < 2; ++i)
+		for(auto j = 0ul; j < 5; ++j)
+			for(auto k = 0ul; k < 4; ++k)
+				BOOST_CHECK_EQUAL( e.at(i,j,4+k), fs.at(1-i,j,k) + fs.at(1-i,j,k) );
+
+	// contractions of tiles
+	auto x = ublas::vector<value_type>(5, value_type{1});
+	auto g = ublas::prod(b, x, 2);
+	auto h = ublas::prod(tensor_type(b), x, 2);
+	for(auto i = 0ul; i < g.size(); ++i)
+		BOOST_CHECK_EQUAL( g[i], h[i] );
+
+	auto phi = std::vector<std::size_t>{2};
+	auto y = ublas::prod(b, a(ublas::range(0,2), ublas::range::all(), ublas::range(0,2)), phi);
+	auto z = ublas::prod(tensor_type(b), tensor_type(a(ublas::range(0,2), ublas::range::all(), ublas::range(0,2))), phi);
+	BOOST_CHECK( y.extents() == z.extents() );
+	for(auto i = 0ul; i < y.size(); ++i)
+		BOOST_CHECK_EQUAL( y[i], z[i] );
+
+	// reversed views are copied before they are passed to the kernels
+	auto gr = ublas::prod(ublas::reverse(b, 1), x, 2);
+	auto hr = ublas::prod(tensor_type(ublas::reverse(b, 1)), x, 2);
+	for(auto i = 0ul; i < gr.size(); ++i)
+		BOOST_CHECK_EQUAL( gr[i], hr[i] );
+	BOOST_CHECK_EQUAL( ublas::sum(ublas::reverse(b, 2)), ublas::sum(b) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()